@@ -0,0 +1,126 @@
+/**
+ * @file edtsp_actuate.h
+ * @brief EDTSP Actuator Command Path (relay / PWM outputs)
+ *
+ * Slave side: output callbacks registered per output type, applied once
+ * per command sequence even when the master retransmits.
+ *
+ * Master side: outstanding commands are tracked until acknowledged,
+ * retransmitted after a short timeout and their round trip (command sent
+ * to ack received) and slave-side apply time are recorded.
+ */
+
+#ifndef EDTSP_ACTUATE_H
+#define EDTSP_ACTUATE_H
+
+#include "protocol.h"
+#include "edtsp_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Output types: capability bit index (EDTSP_CAP_RELAY = bit 14, EDTSP_CAP_PWM = bit 15) */
+#define EDTSP_OUTPUT_RELAY 14
+#define EDTSP_OUTPUT_PWM   15
+
+/** Output callback slots (one per capability bit) */
+#define EDTSP_ACTUATE_OUTPUTS 16
+
+/** Outstanding commands on the master */
+#define EDTSP_ACTUATE_PENDING 64
+
+/** Transmissions per command before it is reported failed */
+#define EDTSP_ACTUATE_MAX_TRIES 4
+
+/** Retransmission timeout floor (microseconds); urgent commands use half */
+#define EDTSP_ACTUATE_RTO_MIN_US 2000
+
+/** Recently applied sequences remembered by a slave (retransmission filter) */
+#define EDTSP_ACTUATE_HISTORY 16
+
+/**
+ * Output callback (slave)
+ *
+ * @return EDTSP_ACTUATE_STATUS_OK or EDTSP_ACTUATE_STATUS_REJECTED
+ */
+typedef uint8_t (*EDTSPOutputFn)(uint8_t output_id, uint8_t channel, uint32_t value, void *ctx);
+
+/** Actuation counters (master and slave) */
+typedef struct {
+    uint32_t sent;            /**< Commands issued (master) */
+    uint32_t retransmits;     /**< Command retransmissions (master) */
+    uint32_t acked;           /**< Commands acknowledged (master) */
+    uint32_t failed;          /**< Commands never acknowledged (master) */
+    uint32_t nacked;          /**< Acks with a non-OK status (master) */
+    uint32_t applied;         /**< Commands applied (slave) */
+    uint32_t duplicates;      /**< Retransmissions re-acked, not re-applied (slave) */
+    uint32_t srtt_us;         /**< Smoothed command round trip (master) */
+    EDTSPHistogram rtt_us;    /**< Command sent -> ack received (master clock) */
+    EDTSPHistogram apply_us;  /**< Slave receive -> output applied (slave clock) */
+} EDTSPActuateStats;
+
+/** Reset callbacks, pending commands and counters */
+void edtsp_actuate_init(void);
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+/** Register the callback that drives an output type */
+bool edtsp_actuate_register_output(uint8_t output_id, EDTSPOutputFn fn, void *ctx);
+
+/** Capability bits for the registered outputs */
+EDTSPCapabilityMask edtsp_actuate_capabilities(void);
+
+/**
+ * Apply a command (host byte order)
+ *
+ * A sequence already applied for this master returns the stored status
+ * without calling the output again.
+ *
+ * @param duplicate Set to true for a retransmission
+ * @return EDTSP_ACTUATE_STATUS_*
+ */
+uint8_t edtsp_actuate_apply(uint32_t master_id, const EDTSPActuatePacket *cmd, bool *duplicate);
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+/**
+ * Track an outgoing command (host byte order copy, kept for retransmission)
+ *
+ * @return false if too many commands are outstanding
+ */
+bool edtsp_actuate_track(const EDTSPActuatePacket *cmd, uint64_t now_us);
+
+/**
+ * Match an acknowledgement (host byte order)
+ *
+ * @param now_us Local receive time
+ * @return true if it completed an outstanding command
+ */
+bool edtsp_actuate_on_ack(const EDTSPActuatePacket *ack, uint64_t now_us);
+
+/**
+ * Collect commands whose retransmission timeout expired
+ *
+ * Commands out of tries are dropped and counted as failed.
+ *
+ * @param out Host byte order copies to resend (t1 updated to now_us)
+ * @return Number of commands written to out
+ */
+int edtsp_actuate_due(uint64_t now_us, EDTSPActuatePacket *out, int max);
+
+/** Get counters */
+const EDTSPActuateStats *edtsp_actuate_stats(void);
+
+/** Print counters and latency percentiles (stats endpoint) */
+void edtsp_actuate_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_ACTUATE_H
@@ -0,0 +1,205 @@
+/**
+ * @file edtsp_aead.h
+ * @brief EDTSP Payload Encryption (AEAD with per-session keys)
+ *
+ * On shared WiFi, packet authentication (edtsp_auth.h) stops forgery but
+ * leaves sensor values readable. With encryption on, DATA-class frames
+ * (edtsp_tclass.h) from a slave to its master carry the payload sealed
+ * with an AEAD. The AEAD is AES-128-GCM on x86 CPUs with AES-NI and
+ * PCLMULQDQ, and ChaCha20-Poly1305 everywhere else. The v2 header is the
+ * associated data, and its sequence number is the nonce. A 16-byte AEAD
+ * tag follows the ciphertext inside the payload, and
+ * EDTSP_FLAG_ENCRYPTED is set. The frame is then signed as usual.
+ *
+ * Keys are per session. In the join handshake the slave's SYN and the
+ * master's SYN-ACK each carry a SESSION descriptor (edtsp_capdesc.h) with
+ * a random 64-bit nonce. The slave's descriptor also lists the AEADs it
+ * runs, and the master's names the one chosen. Both sides then derive
+ * the session key from the network key, the two device IDs and the two
+ * nonces (SipHash-2-4 as a PRF in counter mode). A rejoin gives a fresh
+ * key. Key holders that watched the handshake can derive it too: this
+ * hides data from outsiders, not from other nodes with the network key.
+ *
+ * Receivers open the encrypted frames of a receive batch together, on
+ * the raw datagrams, after the tag check and before decoding. Keystream
+ * blocks of all frames are computed in one pass, eight AES blocks or four
+ * ChaCha20 blocks at a time in independent lanes. The payload is
+ * decrypted in place and the AEAD tag removed, so decoding and handlers
+ * see a plaintext frame. Nothing is allocated per packet.
+ */
+
+#ifndef EDTSP_AEAD_H
+#define EDTSP_AEAD_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Session key and AEAD tag sizes (bytes) */
+#define EDTSP_AEAD_KEY_LEN 32
+#define EDTSP_AEAD_TAG_LEN 16
+
+/** Peers holding a session key (power of two; twice the device table, so probes stay short) */
+#define EDTSP_AEAD_SESSIONS (2 * EDTSP_MAX_DEVICES)
+
+/** Frames opened per pass (larger batches are split) */
+#define EDTSP_AEAD_BATCH 32
+
+/** Sequence numbers a sender may use under one key before it must rejoin */
+#define EDTSP_AEAD_MAX_FRAMES 0x80000000u
+
+/** AEAD algorithms (bits of the SESSION descriptor's algorithm mask) */
+typedef enum {
+    EDTSP_AEAD_CHACHA20_POLY1305 = 0x01,
+    EDTSP_AEAD_AES128_GCM        = 0x02
+} EDTSPAeadAlg;
+
+/**
+ * Expanded key. What a short frame reads (algorithm, nonce, AES schedule,
+ * first GHASH powers) comes first and 16-byte aligned.
+ */
+typedef struct {
+    uint8_t alg;                    /**< EDTSPAeadAlg, 0 = none */
+    uint8_t nonce_fixed[8];         /**< Nonce bytes before the big-endian seq (zero for session keys) */
+    uint8_t round_keys[11][16] __attribute__((aligned(16)));  /**< AES-128 key schedule */
+    uint8_t ghash_pow[8][16];       /**< GHASH H^1..H^8, byte-reflected, times x */
+    uint8_t key[EDTSP_AEAD_KEY_LEN];/**< ChaCha20 key (AES uses the first 16 bytes) */
+} EDTSPAeadKey;
+
+/** One message of a batch (in place) */
+typedef struct {
+    const EDTSPAeadKey *key;
+    uint32_t       seq;             /**< Nonce (after the key's fixed part) */
+    const uint8_t *aad;
+    size_t         aad_len;
+    uint8_t       *data;            /**< Text, followed by the tag */
+    size_t         len;             /**< Text length (without the tag) */
+} EDTSPAeadMsg;
+
+/** Session with one peer (six cache lines, the lookup and a short frame touch five) */
+typedef struct {
+    uint32_t     peer_id;
+    bool         used;
+    bool         sealing;           /**< first_seq is set */
+    uint32_t     first_seq;         /**< Our first sequence number under the key */
+    EDTSPAeadKey key;
+    uint64_t     slave_nonce;
+    uint64_t     master_nonce;
+} __attribute__((aligned(64))) EDTSPAeadSession;
+
+/** Counters */
+typedef struct {
+    uint32_t sessions;              /**< Keys installed (joins and rejoins) */
+    uint32_t sealed;                /**< Frames encrypted */
+    uint32_t opened;                /**< Frames decrypted */
+    uint32_t bad_tag;               /**< Dropped: AEAD tag mismatch */
+    uint32_t no_session;            /**< Dropped: encrypted for a key we do not hold */
+    uint32_t plaintext;             /**< Dropped: DATA-class frame sent in the clear */
+    uint32_t held;                  /**< Not sent: no session (yet) or key used up */
+} EDTSPAeadStats;
+
+// ============================================================================
+// AEAD
+// ============================================================================
+
+/** AEADs this CPU runs (EDTSPAeadAlg mask) */
+uint8_t edtsp_aead_supported(void);
+
+/** Name of an algorithm */
+const char *edtsp_aead_name(uint8_t alg);
+
+/** Expand a key for alg (fixed nonce part zero) */
+void edtsp_aead_set_key(EDTSPAeadKey *k, EDTSPAeadAlg alg, const uint8_t key[EDTSP_AEAD_KEY_LEN]);
+
+/** Encrypt len bytes in place and write the tag behind them */
+void edtsp_aead_seal(const EDTSPAeadKey *k, uint32_t seq, const uint8_t *aad, size_t aad_len,
+                     uint8_t *data, size_t len);
+
+/**
+ * Check the tag behind len bytes and decrypt them in place
+ *
+ * @return false if the tag does not match (data left encrypted)
+ */
+bool edtsp_aead_open(const EDTSPAeadKey *k, uint32_t seq, const uint8_t *aad, size_t aad_len,
+                     uint8_t *data, size_t len);
+
+/** edtsp_aead_open() over a batch; keys and algorithms may differ per message */
+void edtsp_aead_open_batch(const EDTSPAeadMsg *msgs, int n, bool *ok);
+
+// ============================================================================
+// SESSIONS
+// ============================================================================
+
+/**
+ * Turn encryption on or off; clears all sessions
+ *
+ * @param algs    AEADs to offer or accept (EDTSPAeadAlg mask, limited to
+ *                those this CPU runs)
+ * @param self_id Own device ID (our own frames looped back are not opened)
+ */
+void edtsp_aead_init(bool enabled, uint8_t algs, uint32_t self_id);
+
+/** True once enabled */
+bool edtsp_aead_enabled(void);
+
+/** AEADs offered in a SYN */
+uint8_t edtsp_aead_offer(void);
+
+/** Master: AEAD for a slave offering these (0 = none in common) */
+uint8_t edtsp_aead_choose(uint8_t offered);
+
+/**
+ * Derive and install the key of a session (needs the network key)
+ *
+ * Installing the same nonces again keeps the session (retransmitted
+ * SYN / SYN-ACK).
+ *
+ * @param peer_id Other end (the slave on the master, the master on a slave)
+ * @return Session, NULL if the table is full or alg unknown
+ */
+const EDTSPAeadSession *edtsp_aead_install(uint32_t peer_id, uint32_t master_id, uint32_t slave_id,
+                                           uint64_t slave_nonce, uint64_t master_nonce, uint8_t alg);
+
+/** Session with a peer, NULL if none */
+const EDTSPAeadSession *edtsp_aead_session(uint32_t peer_id);
+
+/** Drop the key of a peer and free its slot (timed out, key used up) */
+void edtsp_aead_forget(uint32_t peer_id);
+
+/**
+ * Encrypt the payload of a v2 frame for a peer (before signing)
+ *
+ * Sets EDTSP_FLAG_ENCRYPTED and grows payload_len by EDTSP_AEAD_TAG_LEN.
+ *
+ * @param frame Header + payload, with EDTSP_AEAD_TAG_LEN bytes of room behind
+ * @return New frame length, 0 if there is no session or its key is used up
+ */
+size_t edtsp_aead_seal_frame(uint8_t *frame, size_t len, uint32_t peer_id);
+
+/**
+ * Open the encrypted frames of a receive batch (raw, tags checked)
+ *
+ * Encrypted frames are decrypted in place and turned into plaintext
+ * frames: flag cleared, AEAD tag cut out, lens[i] shortened. Plaintext
+ * DATA-class frames are refused while encryption is on. Other frames pass
+ * unchanged.
+ *
+ * @param ok In: frames to look at (false: already dropped, e.g. bad
+ *           authentication tag); out: false to drop
+ */
+void edtsp_aead_open_frames(uint8_t *const *frames, uint16_t *lens, int n, bool *ok);
+
+/** Counters */
+const EDTSPAeadStats *edtsp_aead_stats(void);
+
+/** Print counters (stats endpoint) */
+void edtsp_aead_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_AEAD_H
@@ -0,0 +1,136 @@
+/**
+ * @file edtsp_auth.h
+ * @brief EDTSP Packet Authentication (pre-shared key, SipHash MAC)
+ *
+ * Without authentication anyone on the multicast group can send a
+ * HEARTBEAT from source 0xFFFFFFFF and win the election. With a
+ * pre-shared key configured, every frame goes out as v2 with
+ * EDTSP_FLAG_AUTHENTICATED set and an 8-byte SipHash-2-4 tag right
+ * behind the payload (before any redundancy trailer). The tag covers the
+ * whole header, including source ID and sequence number, and the
+ * payload.
+ *
+ * Receivers with the key drop every frame that is v1, lacks the flag or
+ * carries a wrong tag, before rate limiting, dedup or any handler looks
+ * at it. A per-source window over the v2 sequence number (highest seen
+ * plus a 64-bit bitmap, as in IPsec) then drops replayed frames.
+ *
+ * Tags are checked once per receive batch, on the raw datagrams, at a few
+ * dozen nanoseconds per frame.
+ *
+ * Senders start their sequence at the wall clock in ~1 ms ticks, so a
+ * restarted node normally comes back ahead of the window its peers
+ * remember. One that sent faster than ~1000 frames/s, or whose clock
+ * stepped back, comes back behind it. Its frames are dropped until its
+ * old run has been quiet for EDTSP_AUTH_RESYNC_MS; the next verified
+ * frame then restarts the window. A live source keeps advancing its
+ * window, so replayed old frames never trigger this. Windows also restart
+ * at a new join handshake, and are freed when the device times out or
+ * has been idle for EDTSP_AUTH_IDLE_MS.
+ */
+
+#ifndef EDTSP_AUTH_H
+#define EDTSP_AUTH_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Pre-shared key and tag sizes (bytes) */
+#define EDTSP_AUTH_KEY_LEN 16
+#define EDTSP_AUTH_TAG_LEN 8
+
+/** Replay window (sequence numbers behind the highest one seen) */
+#define EDTSP_AUTH_WINDOW 64
+
+/** Sources with a replay window (power of two) */
+#define EDTSP_AUTH_SOURCES 512
+
+/** Quiet time after which a source far behind its window is taken as restarted */
+#define EDTSP_AUTH_RESYNC_MS (2 * EDTSP_HEARTBEAT_INTERVAL_MS)
+
+/** Idle time after which a window may be given to a new source */
+#define EDTSP_AUTH_IDLE_MS (12 * EDTSP_HEARTBEAT_TIMEOUT_MS)
+
+/** Counters */
+typedef struct {
+    uint32_t signed_frames;     /**< Tags appended */
+    uint32_t verified;          /**< Tags that matched */
+    uint32_t unauthenticated;   /**< Dropped: v1 or no tag */
+    uint32_t bad_tag;           /**< Dropped: tag mismatch (forged or corrupted) */
+    uint32_t replayed;          /**< Dropped: sequence already seen or behind the window */
+    uint32_t sources;           /**< Sources holding a window */
+    uint32_t resyncs;           /**< Windows restarted for a source that came back behind */
+} EDTSPAuthStats;
+
+/**
+ * Set the pre-shared key
+ *
+ * @param key EDTSP_AUTH_KEY_LEN bytes, or NULL to turn authentication off
+ */
+void edtsp_auth_init(const uint8_t *key);
+
+/** True once a key is set */
+bool edtsp_auth_enabled(void);
+
+/**
+ * Parse a key given as 32 hex digits
+ *
+ * @return false if the string is not exactly 32 hex digits
+ */
+bool edtsp_auth_parse_key(const char *hex, uint8_t key[EDTSP_AUTH_KEY_LEN]);
+
+/** SipHash-2-4 of data under the configured key */
+uint64_t edtsp_auth_mac(const void *data, size_t len);
+
+/**
+ * Sign a v2 frame in place: set EDTSP_FLAG_AUTHENTICATED and append the tag
+ *
+ * @param frame Header + payload, with EDTSP_AUTH_TAG_LEN bytes of room behind
+ * @return New frame length (len + EDTSP_AUTH_TAG_LEN)
+ */
+size_t edtsp_auth_sign(uint8_t *frame, size_t len);
+
+/**
+ * Verify the tags of a receive batch (raw frames, before decoding)
+ *
+ * @param frames Wire buffers
+ * @param lens   Datagram lengths
+ * @param ok     Set per frame: v2, flagged and tag matches
+ */
+void edtsp_auth_verify_batch(const uint8_t *const *frames, const uint16_t *lens, int n, bool *ok);
+
+/** Verify one frame (edtsp_auth_verify_batch() with n = 1) */
+bool edtsp_auth_verify(const uint8_t *frame, size_t len);
+
+/**
+ * Record a verified frame's sequence number
+ *
+ * @param now_ms Monotonic time (idle and resync detection)
+ * @return false if it was seen before or lies behind the window (replay)
+ */
+bool edtsp_auth_replay_check(uint32_t source_id, uint32_t seq, uint64_t now_ms);
+
+/** Restart a source's window at seq (a verified frame of a new join) */
+void edtsp_auth_reset(uint32_t source_id, uint32_t seq, uint64_t now_ms);
+
+/** Free a source's window (device timed out) */
+void edtsp_auth_forget(uint32_t source_id);
+
+/** First v2 sequence number for this run (wall clock based, see above) */
+uint32_t edtsp_auth_initial_seq(uint64_t wall_clock_us);
+
+/** Counters */
+const EDTSPAuthStats *edtsp_auth_stats(void);
+
+/** Print counters (stats endpoint) */
+void edtsp_auth_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_AUTH_H
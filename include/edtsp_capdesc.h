@@ -0,0 +1,178 @@
+/**
+ * @file edtsp_capdesc.h
+ * @brief EDTSP Capability Descriptors (TLV, exchanged in the join SYN)
+ *
+ * The 16-bit EDTSPCapabilityMask says which sensor kinds a slave has, no
+ * more. A descriptor adds what the master needs to plan a configuration:
+ * the instance number (two temperature probes), unit, value range and the
+ * fastest sampling interval the hardware supports.
+ *
+ * Descriptors travel as TLV records at the end of a HANDSHAKE SYN:
+ * type u8, len u8, value[len], big-endian. Unknown types are skipped and
+ * a SENSOR value may be shorter (missing fields are 0) or longer (extra
+ * bytes ignored), so newer slaves can add fields without breaking older
+ * masters. The mask stays in the fixed header as the fast-path summary.
+ * With encryption on, SYN and SYN-ACK also carry a SESSION record with
+ * the key exchange nonces (edtsp_aead.h).
+ *
+ * The master interns descriptor sets: slaves running the same firmware
+ * report the same set, which is stored once and referenced per device.
+ */
+
+#ifndef EDTSP_CAPDESC_H
+#define EDTSP_CAPDESC_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** TLV record types */
+#define EDTSP_CAPDESC_SENSOR  1
+#define EDTSP_CAPDESC_SESSION 2     /**< Encryption nonce and AEADs (SYN, SYN-ACK; edtsp_aead.h) */
+
+/** Encoded SENSOR value length (current version) */
+#define EDTSP_CAPDESC_SENSOR_LEN 10
+
+/** Encoded SESSION value length: nonce u64, AEAD mask u8 */
+#define EDTSP_CAPDESC_SESSION_LEN 9
+
+/** Sensors described per device */
+#define EDTSP_CAPDESC_MAX_SENSORS 16
+
+/** Distinct descriptor sets the master keeps */
+#define EDTSP_CAPDESC_SETS 32
+
+/** Measurement units */
+typedef enum {
+    EDTSP_UNIT_NONE = 0,
+    EDTSP_UNIT_CELSIUS,
+    EDTSP_UNIT_PERCENT_RH,
+    EDTSP_UNIT_PASCAL,
+    EDTSP_UNIT_METER,
+    EDTSP_UNIT_LUX,
+    EDTSP_UNIT_G,
+    EDTSP_UNIT_DEG_PER_S,
+    EDTSP_UNIT_MICROTESLA,
+    EDTSP_UNIT_AMPERE,
+    EDTSP_UNIT_VOLT,
+    EDTSP_UNIT_PPM,
+    EDTSP_UNIT_DEGREE
+} EDTSPUnit;
+
+/** One sensor (host byte order) */
+typedef struct {
+    uint8_t  kind;              /**< Capability bit index */
+    uint8_t  instance;          /**< 0, 1, ... for several sensors of one kind */
+    uint8_t  unit;              /**< EDTSPUnit */
+    int8_t   scale;             /**< Value = raw x 10^scale units */
+    int16_t  range_min;         /**< Raw range */
+    int16_t  range_max;
+    uint16_t min_interval_ms;   /**< Fastest native sampling interval (0 = no limit) */
+} EDTSPSensorDesc;
+
+/** Master counters */
+typedef struct {
+    uint32_t received;          /**< SYNs carrying descriptors */
+    uint32_t malformed;         /**< Descriptor blocks rejected */
+    uint32_t interned;          /**< Sets created */
+    uint32_t shared;            /**< Assignments that reused a set */
+    uint32_t table_full;        /**< Sets not stored (EDTSP_CAPDESC_SETS) */
+    uint32_t plans_clamped;     /**< Planned intervals raised to a sensor limit */
+    uint32_t plans_skipped;     /**< Devices left out: no such sensor */
+} EDTSPCapDescStats;
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+/**
+ * Encode sensor descriptors as TLV
+ *
+ * @return Bytes written, -1 if they do not fit in max
+ */
+int edtsp_capdesc_encode(const EDTSPSensorDesc *desc, int n, uint8_t *out, int max);
+
+/**
+ * Append encoded descriptors to a built HANDSHAKE (network byte order)
+ *
+ * @return Frame length to send, 0 if the descriptors do not fit
+ */
+size_t edtsp_capdesc_attach(EDTSPHandshakePacket *pkt, const uint8_t *tlv, int len);
+
+/** Capability mask summarizing a descriptor list */
+EDTSPCapabilityMask edtsp_capdesc_mask(const EDTSPSensorDesc *desc, int n);
+
+/**
+ * Encode a SESSION record (slave SYN: AEADs offered; master SYN-ACK: the one chosen)
+ *
+ * @return Bytes written, -1 if it does not fit in max
+ */
+int edtsp_capdesc_encode_session(uint64_t nonce, uint8_t algs, uint8_t *out, int max);
+
+/**
+ * SESSION record of a received HANDSHAKE
+ *
+ * @param len Bytes received from the start of the header
+ * @return false if the packet carries none
+ */
+bool edtsp_capdesc_find_session(const EDTSPHandshakePacket *pkt, size_t len, uint64_t *nonce, uint8_t *algs);
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+/**
+ * Decode TLV descriptors (unknown record types are skipped)
+ *
+ * @return Sensors written to out (at most max), -1 if malformed
+ */
+int edtsp_capdesc_decode(const uint8_t *tlv, int len, EDTSPSensorDesc *out, int max);
+
+/** Drop every interned set and assignment */
+void edtsp_capdesc_init(void);
+
+/**
+ * Record the descriptors of a received SYN for the device in slot
+ *
+ * A SYN without descriptors (desc_len 0, or a frame that ends before the
+ * descriptor block) clears the slot: the device is planned from its mask.
+ *
+ * @param pkt Packet with decoded fixed fields (host byte order)
+ * @param len Bytes received from the start of the header
+ * @return true if the slot's descriptor set changed
+ */
+bool edtsp_capdesc_set(int slot, const EDTSPHandshakePacket *pkt, size_t len);
+
+/**
+ * Descriptors of the device in slot
+ *
+ * @return Interned list (shared, read-only), NULL if none; count set to its length
+ */
+const EDTSPSensorDesc *edtsp_capdesc_get(int slot, int *count);
+
+/**
+ * Sampling interval to configure for one sensor kind on the device in slot
+ *
+ * @return requested_ms raised to the slowest native limit among the
+ *         device's instances of that kind; requested_ms if the device sent
+ *         no descriptors; 0 if its descriptors show no such sensor
+ */
+uint16_t edtsp_capdesc_plan_interval(int slot, uint8_t kind, uint16_t requested_ms);
+
+/** Changes on every slot assignment (re-plan when it moves) */
+uint32_t edtsp_capdesc_generation(void);
+
+/** Get counters */
+const EDTSPCapDescStats *edtsp_capdesc_stats(void);
+
+/** Print interned sets and counters (stats endpoint) */
+void edtsp_capdesc_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_CAPDESC_H
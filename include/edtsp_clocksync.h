@@ -0,0 +1,86 @@
+/**
+ * @file edtsp_clocksync.h
+ * @brief EDTSP Master-Driven Clock Synchronization
+ * 
+ * The master keeps an offset/drift model per slave from SYNC exchanges
+ * and maps DATA timestamps (32-bit slave uptime in ms) onto its own
+ * 64-bit microsecond timebase at ingest.
+ */
+
+#ifndef EDTSP_CLOCKSYNC_H
+#define EDTSP_CLOCKSYNC_H
+
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Exchanges kept for min-RTT filtering */
+#define EDTSP_SYNC_FILTER_LEN 8
+
+/** Minimum master-time span between drift anchors (microseconds) */
+#define EDTSP_SYNC_DRIFT_SPAN_US 15000000ull
+
+/** Per-slave clock model: master = ref_master + d - d*drift, d = slave - ref_slave */
+typedef struct {
+    uint32_t slave_id;            /**< Slave device ID */
+    bool     synced;              /**< At least one exchange completed */
+    uint64_t ref_master_us;       /**< Anchor point, master clock */
+    uint64_t ref_slave_us;        /**< Anchor point, slave sample clock */
+    int64_t  drift_ppb;           /**< Slave rate error (parts per billion) */
+    int64_t  drift_q32;           /**< drift_ppb as Q32 fraction (ingest fast path) */
+    uint32_t last_rtt_us;         /**< RTT of the filtered exchange */
+    uint32_t exchanges;           /**< Completed exchanges */
+    
+    // Min-RTT filter window
+    uint64_t win_master_us[EDTSP_SYNC_FILTER_LEN];
+    int64_t  win_offset_us[EDTSP_SYNC_FILTER_LEN];
+    uint32_t win_rtt_us[EDTSP_SYNC_FILTER_LEN];
+    
+    // Previous drift anchor
+    uint64_t drift_anchor_master_us;
+    int64_t  drift_anchor_offset_us;
+} EDTSPClockModel;
+
+/** Reset all slave models */
+void edtsp_clock_init(void);
+
+/**
+ * Feed a completed SYNC exchange
+ * 
+ * @param slave_id Slave that replied
+ * @param t1_us    Master transmit (master clock)
+ * @param t2_us    Slave receive (slave clock)
+ * @param t3_us    Slave transmit (slave clock)
+ * @param t4_us    Master receive (master clock)
+ */
+void edtsp_clock_on_reply(uint32_t slave_id, uint64_t t1_us, uint64_t t2_us,
+                          uint64_t t3_us, uint64_t t4_us);
+
+/**
+ * Convert a DATA timestamp to the master timebase
+ * 
+ * Unwraps the 32-bit millisecond uptime against the slave's estimated
+ * current time, then applies offset and drift.
+ * 
+ * @param slave_id      Sending slave
+ * @param timestamp_ms  DATA timestamp (slave uptime, wraps after 49 days)
+ * @param now_master_us Master arrival time (fallback and unwrap reference)
+ * @param out_us        Master timebase, microseconds
+ * @return true if a sync model was used, false if arrival time was used
+ */
+bool edtsp_clock_to_master_us(uint32_t slave_id, uint32_t timestamp_ms,
+                              uint64_t now_master_us, uint64_t *out_us);
+
+/** Model for a slave (NULL if unknown) */
+const EDTSPClockModel *edtsp_clock_model(uint32_t slave_id);
+
+/** Print per-slave offset/drift table (stats endpoint) */
+void edtsp_clock_print(uint64_t now_master_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_CLOCKSYNC_H
@@ -0,0 +1,118 @@
+/**
+ * @file edtsp_deadband.h
+ * @brief EDTSP Report-by-Exception (deadband / deadline filtering)
+ *
+ * A slave still samples every sampling interval, but sends DATA only when
+ * the value moved more than the deadband away from the last value sent,
+ * or when max_silence_ms passed without a send (the master then knows the
+ * sensor is alive and the value unchanged). Both are set per sensor by
+ * CONFIG.
+ *
+ * Every sample, sent or not, advances a per-sensor sequence number that
+ * travels in the report. From the sequence gap between two reports the
+ * master knows how many samples were suppressed and rebuilds them as the
+ * last reported value, at timestamps spaced evenly between the two
+ * reports. A rebuilt sample is within the deadband of the real one unless
+ * a report was lost in between; the next report (at the latest after
+ * max_silence_ms) repairs the series.
+ *
+ * DATA record (data_len = EDTSP_DEADBAND_RECORD_LEN, big-endian):
+ * value i32 (raw sensor units), sample_seq u16.
+ */
+
+#ifndef EDTSP_DEADBAND_H
+#define EDTSP_DEADBAND_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** DATA payload bytes of one report */
+#define EDTSP_DEADBAND_RECORD_LEN 6
+
+/** Master reconstruction streams (device x sensor, power of two) */
+#define EDTSP_RECON_STREAMS 1024
+
+/** Per-sensor filter (slave) */
+typedef struct {
+    uint16_t deadband;          /**< Raw units, 0 = send every sample */
+    uint32_t max_silence_ms;    /**< 0 = no deadline */
+    bool     reported;          /**< A value was sent since (re)configuration */
+    int32_t  last_value;        /**< Last value sent */
+    uint32_t last_ms;           /**< When it was sent */
+    uint16_t seq;               /**< Sample sequence (every sample) */
+    uint32_t samples;           /**< Samples taken */
+    uint32_t sent;              /**< Reports sent */
+    uint32_t deadline_sent;     /**< ... of which only because of max_silence_ms */
+} EDTSPDeadband;
+
+/** Per-sensor reconstruction counters (master, all devices) */
+typedef struct {
+    uint32_t reports;           /**< DATA records received */
+    uint32_t samples;           /**< Samples in the rebuilt series (reports + held) */
+    uint32_t resyncs;           /**< Series restarted (slave reboot, sequence jump) */
+} EDTSPReconSensorStats;
+
+/**
+ * Rebuilt sample callback
+ *
+ * @param timestamp_ms Slave sample clock (DATA timestamp domain)
+ * @param reported     true for the sample carried by the report, false for a held one
+ */
+typedef void (*EDTSPSampleFn)(uint32_t device_id, uint8_t sensor_id, uint32_t timestamp_ms,
+                              int32_t value, bool reported, void *ctx);
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+/** Set thresholds; the next sample is always sent */
+void edtsp_deadband_configure(EDTSPDeadband *db, uint16_t deadband, uint32_t max_silence_ms);
+
+/**
+ * Take one sample
+ *
+ * @return true if it must be reported (write it with edtsp_deadband_record)
+ */
+bool edtsp_deadband_sample(EDTSPDeadband *db, int32_t value, uint32_t now_ms);
+
+/**
+ * Encode the report of the sample just taken
+ *
+ * @param out At least EDTSP_DEADBAND_RECORD_LEN bytes
+ * @return Bytes written (DATA data_len)
+ */
+uint8_t edtsp_deadband_record(const EDTSPDeadband *db, int32_t value, uint8_t *out);
+
+/** Print per-sensor samples / reports / bytes saved (stats endpoint) */
+void edtsp_deadband_print(const EDTSPDeadband *filters, int count);
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+/** Reset all streams; fn (may be NULL) receives every rebuilt sample */
+void edtsp_recon_init(EDTSPSampleFn fn, void *ctx);
+
+/**
+ * Rebuild the series up to a received report
+ *
+ * @param pkt DATA packet (host byte order)
+ * @return Samples emitted (held + reported), -1 if the payload is not a record
+ */
+int edtsp_recon_on_data(const EDTSPDataPacket *pkt);
+
+/** Counters for one sensor (capability bit index) */
+const EDTSPReconSensorStats *edtsp_recon_stats(uint8_t sensor_id);
+
+/** Print per-sensor reports / rebuilt samples / bandwidth saved (stats endpoint) */
+void edtsp_recon_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_DEADBAND_H
@@ -0,0 +1,68 @@
+/**
+ * @file edtsp_dedup.h
+ * @brief EDTSP Duplicate Elimination for Dual-Path Transmission
+ * 
+ * Per-source sliding sequence window (64-bit bitmap) in the style of
+ * IEC 62439-3 PRP duplicate discard. Lookup and update are O(1).
+ * 
+ * The window never moves backward: a copy more than a window behind
+ * (a path lagging by 64 frames or more) is dropped as stale. Only a
+ * source whose window has not advanced for EDTSP_DEDUP_RESTART_MS may
+ * start its sequence over. A source's window is freed when its device
+ * times out, and one idle for EDTSP_DEDUP_IDLE_MS may go to a new source.
+ */
+
+#ifndef EDTSP_DEDUP_H
+#define EDTSP_DEDUP_H
+
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Sequence window size (bits) */
+#define EDTSP_DEDUP_WINDOW 64
+
+/** Source table capacity (power of two, > EDTSP_MAX_DEVICES) */
+#define EDTSP_DEDUP_TABLE_SIZE 512
+
+/** Silence after which a sequence far behind the window is a restart */
+#define EDTSP_DEDUP_RESTART_MS (2 * EDTSP_HEARTBEAT_INTERVAL_MS)
+
+/** Idle time after which a window may be given to a new source */
+#define EDTSP_DEDUP_IDLE_MS (12 * EDTSP_HEARTBEAT_TIMEOUT_MS)
+
+/** Duplicate elimination counters */
+typedef struct {
+    uint32_t accepted;        /**< First copies passed to handlers */
+    uint32_t duplicates;      /**< Second copies dropped */
+    uint32_t stale;           /**< Copies behind the window dropped (lagging path) */
+    uint32_t window_resets;   /**< Sequence restarted after the source went quiet */
+    uint32_t sources;         /**< Sources holding a window */
+} EDTSPDedupStats;
+
+/** Clear all per-source windows */
+void edtsp_dedup_init(void);
+
+/**
+ * Check and record a sequence number
+ * 
+ * @param source_id Sending device
+ * @param seq       Redundancy sequence number from the trailer
+ * @param now_ms    Receive time (restart detection)
+ * @return true if this is the first copy (deliver), false if duplicate or stale
+ */
+bool edtsp_dedup_accept(uint32_t source_id, uint16_t seq, uint64_t now_ms);
+
+/** Free a source's window (device timed out) */
+void edtsp_dedup_forget(uint32_t source_id);
+
+/** Get counters */
+const EDTSPDedupStats *edtsp_dedup_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_DEDUP_H
@@ -0,0 +1,83 @@
+/**
+ * @file edtsp_devindex.h
+ * @brief EDTSP Capability / Interface Device Index (master)
+ *
+ * Inverted index over device table slots: one bitset of active slots, one
+ * per capability bit and one per interface type. Sets are maintained on
+ * liveness changes (join / timeout), HANDSHAKE (capabilities) and
+ * DISCOVERY (interface), so a selection such as "active devices with
+ * humidity and temperature on WiFi" is a handful of bitset ANDs instead
+ * of a scan of the device table.
+ *
+ * The AND runs 256 bits at a time on compiler vector types (SSE2/AVX2 or
+ * NEON, whatever the target provides) with a scalar fallback.
+ */
+
+#ifndef EDTSP_DEVINDEX_H
+#define EDTSP_DEVINDEX_H
+
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Indexed slots (device table size, overridable for simulations) */
+#ifndef EDTSP_INDEX_SLOTS
+#define EDTSP_INDEX_SLOTS EDTSP_MAX_DEVICES
+#endif
+
+/** 64-bit words per bitset, rounded up to whole 256-bit vectors */
+#define EDTSP_INDEX_WORDS (((EDTSP_INDEX_SLOTS + 255) / 256) * 4)
+
+/** Capability bits (EDTSPCapabilityMask) and interface types indexed */
+#define EDTSP_INDEX_CAPS   16
+#define EDTSP_INDEX_IFACES 4
+
+/** Set of device slots */
+typedef struct {
+    uint64_t w[EDTSP_INDEX_WORDS];
+} __attribute__((aligned(32))) EDTSPBitset;
+
+/** Any interface (edtsp_index_select) */
+#define EDTSP_INDEX_ANY_IFACE 0xFF
+
+/** Clear all sets */
+void edtsp_index_init(void);
+
+/** Device in slot joined (active) or timed out */
+void edtsp_index_set_active(int slot, uint32_t device_id, bool active);
+
+/** Capabilities reported by the device in slot (HANDSHAKE) */
+void edtsp_index_set_capabilities(int slot, EDTSPCapabilityMask caps);
+
+/** Interface the device in slot announced (DISCOVERY) */
+void edtsp_index_set_interface(int slot, uint8_t iface_type);
+
+/**
+ * Active devices having every capability in caps, on an interface type
+ *
+ * @param iface_type EDTSPInterfaceType or EDTSP_INDEX_ANY_IFACE
+ * @param out        Resulting slot set
+ * @return Number of devices selected
+ */
+int edtsp_index_select(EDTSPCapabilityMask caps, uint8_t iface_type, EDTSPBitset *out);
+
+/**
+ * Device IDs of a slot set (ascending slot order)
+ *
+ * @return Number of IDs written (at most max)
+ */
+int edtsp_index_ids(const EDTSPBitset *set, uint32_t *ids, int max);
+
+/** Number of slots in a set */
+int edtsp_index_count(const EDTSPBitset *set);
+
+/** Print per-capability / per-interface device counts (stats endpoint) */
+void edtsp_index_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_DEVINDEX_H
@@ -0,0 +1,103 @@
+/**
+ * @file edtsp_dispatch.h
+ * @brief EDTSP Table-Driven Packet Dispatch
+ *
+ * Handler registry indexed by packet type: each entry holds the minimum
+ * frame length, the payload decoder and the callback. Built-in types
+ * default to the generated codecs (edtsp_codecs[]); applications and
+ * plugins register handlers for any type, including new ones.
+ *
+ * Batch dispatch groups received packets by type (stable counting sort)
+ * so each handler runs over a contiguous run of its packets. Priority
+ * types (e.g. ACTUATE) run before everything else in their batch.
+ */
+
+#ifndef EDTSP_DISPATCH_H
+#define EDTSP_DISPATCH_H
+
+#include "protocol.h"
+#include "edtsp_pool.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Registry size: one slot per possible type byte, no bounds check needed */
+#define EDTSP_DISPATCH_TYPES 256
+
+/** Maximum packets per dispatch batch */
+#define EDTSP_DISPATCH_BATCH 64
+
+/** A received packet, validated and ready for dispatch */
+typedef struct {
+    uint8_t        *pkt;     /**< v1-layout packet view, header in host order */
+    uint16_t        len;     /**< Bytes available at pkt */
+    EDTSPFrameInfo  frame;   /**< Decoded header (version, flags, seq) */
+    void           *iface;   /**< Receiving interface (platform specific) */
+    uint64_t        rx_us;   /**< Receive timestamp (microseconds) */
+    EDTSPArena     *arena;   /**< Per-batch scratch memory (reset after dispatch) */
+} EDTSPRxPacket;
+
+/** Payload decoder (network to host byte order, in place) */
+typedef void (*EDTSPDecodeFn)(void *pkt);
+
+/** Packet handler, called after the decoder */
+typedef void (*EDTSPHandlerFn)(void *pkt, const EDTSPRxPacket *rx, void *ctx);
+
+/** Per-type dispatch counters */
+typedef struct {
+    uint32_t dispatched;   /**< Packets that passed the length check */
+    uint32_t too_short;    /**< Dropped: shorter than min_len */
+    uint32_t unhandled;    /**< No handler registered */
+} EDTSPDispatchStats;
+
+/**
+ * Reset the registry
+ *
+ * Every type falls back to the unhandled handler until registered.
+ */
+void edtsp_dispatch_init(void);
+
+/**
+ * Register a handler for a packet type
+ *
+ * @param min_len Minimum frame length (header included); 0 = use the
+ *                generated codec's minimum for built-in types
+ * @param decode  Payload decoder; NULL = generated codec for built-in
+ *                types, no decoding otherwise
+ * @return false if the type is 0 or handler is NULL
+ */
+bool edtsp_dispatch_register(uint8_t type, uint16_t min_len, EDTSPDecodeFn decode,
+                             EDTSPHandlerFn handler, void *ctx);
+
+/** Run a type ahead of the rest of each batch (control traffic) */
+void edtsp_dispatch_set_priority(uint8_t type, bool priority);
+
+/** Handler for types without a registered handler (default: count only) */
+void edtsp_dispatch_set_unhandled(EDTSPHandlerFn handler, void *ctx);
+
+/** Dispatch a single packet */
+void edtsp_dispatch(EDTSPRxPacket *rx);
+
+/**
+ * Dispatch a batch grouped by type
+ *
+ * Priority types first, then the others in order of first appearance;
+ * packets of the same type keep their arrival order.
+ *
+ * @param count At most EDTSP_DISPATCH_BATCH
+ */
+void edtsp_dispatch_batch(EDTSPRxPacket *rx, int count);
+
+/** Counters for one type */
+const EDTSPDispatchStats *edtsp_dispatch_stats(uint8_t type);
+
+/** Print per-type counters (for the stats endpoint) */
+void edtsp_dispatch_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_DISPATCH_H
@@ -0,0 +1,172 @@
+/**
+ * @file edtsp_flow.h
+ * @brief EDTSP Credit-Based Flow Control (master -> slaves backpressure)
+ *
+ * When the master cannot keep up with DATA, the surplus used to pile up in
+ * its socket receive buffer and overflow there: random frames of random
+ * slaves lost without a trace. Instead the master now watches its receive
+ * queue and advertises a frame budget in CREDIT:
+ *
+ * - The queue (socket memory in use vs buffer size, kernel drop counter)
+ *   is sampled every EDTSP_FLOW_SAMPLE_MS.
+ * - Every EDTSP_FLOW_PERIOD_MS the total budget is cut to 3/4 of the rate
+ *   actually served when the queue passed EDTSP_FLOW_HIGH_PCT or frames
+ *   were dropped, and raised by 1/8 while it stays under EDTSP_FLOW_LOW_PCT.
+ * - The budget is split max-min fair: one per-slave cap such that slaves
+ *   under it keep their rate and the heavy ones share the rest. A cap
+ *   that no slave reaches any more is lifted.
+ *
+ * One cap serves every slave (target 0), so a CREDIT is a single small
+ * multicast regardless of the slave count. It is refreshed every period
+ * while in force and lapses EDTSP_FLOW_LIFETIME_MS after the last one, so
+ * a failed master cannot leave slaves throttled.
+ *
+ * A slave over its cap does not drop: it averages 2^level consecutive
+ * samples of each sensor into one (timestamped at the first), which keeps
+ * the series' mean and a regular grid for packing and report-by-exception.
+ * The level follows the measured frame rate, one step down at a time.
+ * Window summaries are already aggregated and are not averaged further.
+ */
+
+#ifndef EDTSP_FLOW_H
+#define EDTSP_FLOW_H
+
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** CREDIT max_fps: no limit */
+#define EDTSP_FLOW_UNLIMITED 0xFFFF
+
+/** Master: queue sampling and control intervals */
+#define EDTSP_FLOW_SAMPLE_MS 100
+#define EDTSP_FLOW_PERIOD_MS 500
+
+/** Master: queue fill that cuts / raises the budget (percent of the receive buffer) */
+#define EDTSP_FLOW_HIGH_PCT 50
+#define EDTSP_FLOW_LOW_PCT  10
+
+/** A cap lapses this long after the last CREDIT */
+#define EDTSP_FLOW_LIFETIME_MS 3000
+
+/** Slave: rate measurement interval and deepest averaging (2^level samples) */
+#define EDTSP_FLOW_RATE_MS   1000
+#define EDTSP_FLOW_MAX_LEVEL 7
+
+/** Slaves tracked by the master: one per device-table slot */
+#define EDTSP_FLOW_SLAVES EDTSP_MAX_DEVICES
+
+/** Slave state */
+typedef struct {
+    uint16_t max_fps;           /**< Current cap, EDTSP_FLOW_UNLIMITED = none */
+    uint8_t  level;             /**< Samples averaged: 2^level */
+    uint32_t expires_ms;        /**< Cap lapses at this time */
+    uint32_t period_start_ms;
+    uint32_t frames;            /**< DATA frames sent this period */
+    uint32_t rate_fps;          /**< Last measured rate */
+    uint32_t credits;           /**< CREDIT packets applied */
+    uint32_t level_changes;
+    uint8_t  max_level;         /**< Deepest level used */
+    uint32_t merged;            /**< Samples folded into an average */
+} EDTSPFlowSlave;
+
+/** Per-sensor averaging state (slave) */
+typedef struct {
+    int64_t  sum;
+    uint16_t count;
+    uint32_t first_ms;
+} EDTSPDecimator;
+
+/** Master counters */
+typedef struct {
+    uint32_t periods;           /**< Control periods run */
+    uint32_t congested;         /**< Periods that cut the budget */
+    uint32_t limited;           /**< Periods with a cap in force */
+    uint32_t credits;           /**< CREDIT packets sent */
+    uint32_t kernel_drops;      /**< Receive buffer overflows seen */
+    uint8_t  peak_pct;          /**< Highest queue fill sampled */
+    uint16_t slaves;            /**< Slaves with a rate entry */
+    uint32_t evicted;           /**< Entries dropped after idle periods */
+} EDTSPFlowStats;
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+/** No cap, level 0 */
+void edtsp_flow_slave_init(EDTSPFlowSlave *f, uint32_t now_ms);
+
+/**
+ * Apply a CREDIT packet (host byte order)
+ *
+ * @return false if it targets another slave
+ */
+bool edtsp_flow_on_credit(EDTSPFlowSlave *f, const EDTSPCreditPacket *pkt, uint32_t my_id, uint32_t now_ms);
+
+/** Count one DATA frame sent */
+void edtsp_flow_on_sent(EDTSPFlowSlave *f);
+
+/**
+ * Measure the frame rate and pick the averaging level (call every loop)
+ *
+ * @return true if the level changed
+ */
+bool edtsp_flow_slave_tick(EDTSPFlowSlave *f, uint32_t now_ms);
+
+/**
+ * Average 2^level consecutive samples
+ *
+ * @param out    Mean of the group (rounded)
+ * @param out_ms Time of the group's first sample
+ * @return true if a group closed and out should be reported
+ */
+bool edtsp_decimate(EDTSPFlowSlave *f, EDTSPDecimator *d, int32_t value, uint32_t now_ms,
+                    int32_t *out, uint32_t *out_ms);
+
+/** Print cap, level and measured rate (stats endpoint) */
+void edtsp_flow_slave_print(const EDTSPFlowSlave *f);
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+/** Reset the controller: no cap */
+void edtsp_flow_init(void);
+
+/**
+ * Count one DATA frame served
+ *
+ * @param slot Sender's device-table slot; -1 (not joined) is not counted
+ */
+void edtsp_flow_on_data(int slot);
+
+/**
+ * Receive queue sample (every EDTSP_FLOW_SAMPLE_MS)
+ *
+ * @param fill_pct Fullest socket receive buffer, percent
+ * @param drops    Total datagrams the kernel dropped on full buffers
+ */
+void edtsp_flow_on_queue(uint8_t fill_pct, uint32_t drops);
+
+/**
+ * Run the controller once per EDTSP_FLOW_PERIOD_MS
+ *
+ * @param max_fps   Cap to advertise
+ * @param queue_pct Queue fill over the period
+ * @return true if a CREDIT should be sent now
+ */
+bool edtsp_flow_tick(uint32_t now_ms, uint16_t *max_fps, uint8_t *queue_pct);
+
+/** Counters */
+const EDTSPFlowStats *edtsp_flow_stats(void);
+
+/** Print budget, cap and queue state (stats endpoint) */
+void edtsp_flow_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_FLOW_H
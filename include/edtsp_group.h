@@ -0,0 +1,104 @@
+/**
+ * @file edtsp_group.h
+ * @brief EDTSP Group-Addressed Configuration (GROUP_CONFIG)
+ *
+ * One GROUP_CONFIG packet carries several sensor settings and a target
+ * set: every slave (ALL), every slave with a set of capabilities (CAPS),
+ * or an explicit list of slave IDs (IDS). The ID list is sorted on the
+ * wire, so a slave tests membership with a binary search over the packet
+ * body - O(log n), no decoding, no false positives. A list longer than
+ * one packet is split into consecutive ranges of the sorted IDs.
+ *
+ * Body layout: setting_count x { sensor_id u8, enable u8, rate_ms u16 },
+ * then target_count x slave ID u32, all big-endian.
+ */
+
+#ifndef EDTSP_GROUP_H
+#define EDTSP_GROUP_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Encoded size of one sensor setting / one target ID */
+#define EDTSP_GROUP_SETTING_SIZE 4
+#define EDTSP_GROUP_ID_SIZE      4
+
+/** Body capacity (bytes) */
+#define EDTSP_GROUP_BODY_MAX ((int)sizeof(((EDTSPGroupConfigPacket*)0)->body))
+
+/** Target IDs that fit in one packet next to n settings */
+#define EDTSP_GROUP_IDS_PER_PACKET(n) \
+    ((EDTSP_GROUP_BODY_MAX - (n) * EDTSP_GROUP_SETTING_SIZE) / EDTSP_GROUP_ID_SIZE)
+
+/** Sensor settings per packet (one per capability bit) */
+#define EDTSP_GROUP_MAX_SETTINGS 16
+
+/** One sensor setting (host byte order) */
+typedef struct {
+    uint8_t  sensor_id;          /**< Capability bit index */
+    uint8_t  enable;             /**< 1 = sample, 0 = stop */
+    uint16_t sampling_rate_ms;   /**< Sampling interval */
+} EDTSPSensorSetting;
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+/**
+ * Sort a target list and drop duplicate IDs (required before building)
+ *
+ * @return Number of unique IDs left at the front of ids
+ */
+int edtsp_group_sort_ids(uint32_t *ids, int n);
+
+/**
+ * Build one GROUP_CONFIG packet (network byte order, ready to send)
+ *
+ * For EDTSP_GROUP_IDS the packet takes as many IDs from the front of the
+ * sorted list as fit; call again with the rest until all are consumed.
+ *
+ * @param caps     CAPS selector: required capability bits
+ * @param ids      IDS selector: sorted unique slave IDs (NULL otherwise)
+ * @param consumed Set to the number of IDs placed in this packet
+ * @return Frame length to send, 0 if the settings do not fit
+ */
+size_t edtsp_group_build(EDTSPGroupConfigPacket *pkt, uint32_t source_id, uint16_t config_seq,
+                         uint8_t selector, EDTSPCapabilityMask caps,
+                         const EDTSPSensorSetting *settings, int nsettings,
+                         const uint32_t *ids, int nids, int *consumed);
+
+/** Packets needed to address nids slaves by ID with nsettings settings */
+int edtsp_group_packets_needed(int nsettings, int nids);
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+/**
+ * Check counts against the body length and the received frame
+ *
+ * @param pkt Packet with decoded fixed fields (host byte order)
+ * @param len Bytes received from the start of the header
+ */
+bool edtsp_group_valid(const EDTSPGroupConfigPacket *pkt, size_t len);
+
+/** Is this slave addressed? (validated packet, host byte order) */
+bool edtsp_group_match(const EDTSPGroupConfigPacket *pkt, uint32_t device_id,
+                       EDTSPCapabilityMask capabilities);
+
+/**
+ * Extract the sensor settings
+ *
+ * @return Settings written to out (at most max)
+ */
+int edtsp_group_settings(const EDTSPGroupConfigPacket *pkt, EDTSPSensorSetting *out, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_GROUP_H
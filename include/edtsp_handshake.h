@@ -0,0 +1,140 @@
+/**
+ * @file edtsp_handshake.h
+ * @brief EDTSP 3-Way Join Handshake (SYN / SYN-ACK / ACK)
+ *
+ * A slave that learns who the master is sends SYN with its capabilities,
+ * the master answers SYN-ACK with its own, and the slave completes with
+ * ACK. Both sides retransmit on timers, with exponential backoff.
+ *
+ * The master keeps no per-join ordering. Every SYN is answered as it
+ * arrives and tracked in a hash table. Hundreds of joiners after a site
+ * power-up are therefore handshaked concurrently, not one after another.
+ * Joiners add random jitter before their first SYN, so a power-up does
+ * not arrive as a single burst.
+ *
+ * Packets are emitted through a send callback, so the same state machine
+ * drives the PC node and simulations (many EDTSPJoin instances against
+ * one master table).
+ */
+
+#ifndef EDTSP_HANDSHAKE_H
+#define EDTSP_HANDSHAKE_H
+
+#include "protocol.h"
+#include "edtsp_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** First retransmission timeout (microseconds), doubled per retry */
+#define EDTSP_HS_RTO_US 200000
+
+/** Backoff ceiling for the joiner's SYN (microseconds) */
+#define EDTSP_HS_RTO_MAX_US 3200000
+
+/** Random delay before a joiner's first SYN (microseconds) */
+#define EDTSP_HS_JITTER_US 50000
+
+/** SYN-ACK transmissions before the master drops a half-open join */
+#define EDTSP_HS_MAX_TRIES 5
+
+/** Master join table (power of two, at least 2x EDTSP_MAX_DEVICES) */
+#define EDTSP_HS_TABLE 512
+
+/** Master SYN-ACK retransmissions per poll (spreads a retransmit wave) */
+#define EDTSP_HS_BURST 32
+
+/**
+ * Emit a HANDSHAKE packet
+ *
+ * @param step   EDTSP_HANDSHAKE_SYN / SYN_ACK / ACK
+ * @param target Peer device ID
+ */
+typedef void (*EDTSPHandshakeSendFn)(uint8_t step, uint32_t target, void *ctx);
+
+/** Joiner (slave) state */
+typedef enum {
+    EDTSP_JOIN_IDLE = 0,      /**< No master known */
+    EDTSP_JOIN_WAIT,          /**< Jitter delay before the first SYN */
+    EDTSP_JOIN_SYN_SENT,      /**< Waiting for SYN-ACK */
+    EDTSP_JOIN_ESTABLISHED    /**< ACK sent, capabilities known to the master */
+} EDTSPJoinState;
+
+/** Joiner (slave side, one per node) */
+typedef struct {
+    EDTSPJoinState       state;
+    uint32_t             master_id;     /**< Master being joined */
+    uint64_t             start_us;      /**< Join started (master learned) */
+    uint64_t             due_us;        /**< Next (re)transmission */
+    uint32_t             rto_us;        /**< Current backoff */
+    uint32_t             rng;           /**< Jitter source (xorshift32) */
+    uint32_t             syns;          /**< SYNs sent for this join */
+    uint32_t             join_us;       /**< Start -> established (last join) */
+    EDTSPCapabilityMask  master_caps;   /**< Reported in SYN-ACK */
+    EDTSPHandshakeSendFn send;
+    void                *ctx;
+} EDTSPJoin;
+
+/** Master counters */
+typedef struct {
+    uint32_t syns;              /**< SYNs received */
+    uint32_t duplicate_syns;    /**< SYNs for a join already in progress */
+    uint32_t synack_retx;       /**< SYN-ACK retransmissions */
+    uint32_t established;       /**< Joins completed (ACK received) */
+    uint32_t expired;           /**< Half-open joins dropped */
+    uint32_t in_progress;       /**< Half-open joins now */
+    uint32_t peers;             /**< Established slaves now */
+    EDTSPHistogram join_us;     /**< First SYN -> ACK */
+} EDTSPHandshakeStats;
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+/** Set up a joiner; seed makes the jitter differ between nodes */
+void edtsp_join_init(EDTSPJoin *join, uint32_t seed, EDTSPHandshakeSendFn send, void *ctx);
+
+/**
+ * Master changed: start a new join (0 = no master, go idle)
+ *
+ * Calling again with the current master does nothing.
+ */
+void edtsp_join_set_master(EDTSPJoin *join, uint32_t master_id, uint64_t now_us);
+
+/** Handle a HANDSHAKE packet addressed to this node (host byte order) */
+void edtsp_join_on_packet(EDTSPJoin *join, const EDTSPHandshakePacket *pkt, uint64_t now_us);
+
+/** Send the first SYN / retransmissions that are due */
+void edtsp_join_poll(EDTSPJoin *join, uint64_t now_us);
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+/** Reset the join table; packets go out through send */
+void edtsp_hs_init(EDTSPHandshakeSendFn send, void *ctx);
+
+/** Handle a HANDSHAKE packet addressed to the master (host byte order) */
+void edtsp_hs_on_packet(const EDTSPHandshakePacket *pkt, uint64_t now_us);
+
+/** Retransmit SYN-ACKs that are due, drop joins out of tries */
+void edtsp_hs_poll(uint64_t now_us);
+
+/** Slave timed out or left: it must handshake again */
+void edtsp_hs_forget(uint32_t device_id);
+
+/** Has this slave completed the handshake? */
+bool edtsp_hs_established(uint32_t device_id);
+
+/** Get counters */
+const EDTSPHandshakeStats *edtsp_hs_stats(void);
+
+/** Print master counters and the joiner state (stats endpoint) */
+void edtsp_hs_print(const EDTSPJoin *join);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_HANDSHAKE_H
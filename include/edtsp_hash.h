@@ -0,0 +1,33 @@
+/**
+ * @file edtsp_hash.h
+ * @brief EDTSP Device ID Mixing
+ *
+ * Device IDs are often sequential. Ring positions and digests need every
+ * output bit to depend on every ID bit, which the multiplicative hashes of
+ * the lookup tables do not give.
+ */
+
+#ifndef EDTSP_HASH_H
+#define EDTSP_HASH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** murmur3 32-bit finalizer: full avalanche, bijective */
+static inline uint32_t edtsp_hash_mix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_HASH_H
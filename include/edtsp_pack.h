@@ -0,0 +1,147 @@
+/**
+ * @file edtsp_pack.h
+ * @brief EDTSP Packed Sample Blocks (delta + zigzag + bit-packing)
+ *
+ * Consecutive readings of a sensor differ by a few raw units, but one DATA
+ * frame per sample spends 22 bytes of framing and 4 bytes of value on
+ * each. With packing configured (CONFIG pack_samples), the slave collects
+ * samples into a block and sends one DATA frame per block:
+ *
+ *   first value i32 | count u16 | width u8 | interval_ms u16 | deltas
+ *
+ * The deltas are the differences to the previous sample (wrapping 32-bit
+ * arithmetic), zigzag coded (0, -1, 1, -2 ... -> 0, 1, 2, 3 ...) and
+ * bit-packed at the block's widest delta, width bits each, in four
+ * interleaved lanes (see edtsp_pack.c). Sample k was taken at
+ * timestamp_ms + k x interval_ms. Block header fields are big-endian.
+ *
+ * Blocks go out only with the v2 header, flagged EDTSP_PACK_FLAGS. The
+ * block starts at DATA data and runs to the end of the payload, up to
+ * EDTSP_PACK_BLOCK_MAX bytes (one MTU); data_len is 0.
+ *
+ * One width per block (rather than simple8b selectors) puts four
+ * consecutive deltas at the same bit offset of four lanes, so the master
+ * decodes them with one vector shift, zigzag and an in-register prefix sum
+ * on compiler vector types, with a scalar fallback (or -DEDTSP_PACK_SCALAR).
+ */
+
+#ifndef EDTSP_PACK_H
+#define EDTSP_PACK_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** v2 header flags of a DATA frame holding a packed block */
+#define EDTSP_PACK_FLAGS (EDTSP_FLAG_AGGREGATED | EDTSP_FLAG_COMPRESSED)
+
+/** Block header bytes (first, count, width, interval) */
+#define EDTSP_PACK_HEADER_LEN 9
+
+/** Block bytes: the v2 payload after the DATA fields */
+#define EDTSP_PACK_BLOCK_MAX (EDTSP_MAX_PAYLOAD_V2 - (offsetof(EDTSPDataPacket, data) - sizeof(EDTSPHeader)))
+
+/** Samples per block (cap for near-constant signals; wider deltas fill the block first) */
+#define EDTSP_PACK_MAX_SAMPLES 2048
+
+/** CONFIG pack_samples: as many samples as fit one block */
+#define EDTSP_PACK_FILL 255
+
+/** Decode buffer length: whole 4-lane groups past the last sample */
+#define EDTSP_PACK_OUT_LEN (EDTSP_PACK_MAX_SAMPLES + 3)
+
+/** Per-sensor packer (slave) */
+typedef struct {
+    uint16_t max_samples;       /**< Block size limit, < 2 = packing off */
+    uint16_t count;             /**< Samples in the open block */
+    uint8_t  width;             /**< Widest zigzag delta so far (bits) */
+    int32_t  first;
+    int32_t  prev;
+    uint32_t start_ms;
+    uint32_t last_ms;
+    uint32_t interval_ms;
+    uint32_t zz[EDTSP_PACK_MAX_SAMPLES - 1];
+    uint32_t samples;           /**< Samples packed */
+    uint32_t blocks;            /**< Blocks sent */
+    uint32_t bytes;             /**< DATA payload bytes sent */
+} EDTSPPacker;
+
+/** Per-sensor counters (master, all devices) */
+typedef struct {
+    uint32_t blocks;            /**< Blocks decoded */
+    uint32_t samples;           /**< Samples they carried */
+    uint32_t bytes;             /**< Block payload bytes */
+    uint32_t malformed;         /**< Blocks rejected */
+} EDTSPPackStats;
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+/**
+ * Set the block size from CONFIG pack_samples (< 2 = off, EDTSP_PACK_FILL =
+ * fill the block); an open block is discarded
+ */
+void edtsp_pack_configure(EDTSPPacker *p, uint8_t pack_samples);
+
+/**
+ * Add one sample
+ *
+ * A block is finished when it is full, or when the sample does not fit
+ * (too wide, or off the sampling grid) and starts the next one.
+ *
+ * @param out      At least EDTSP_PACK_BLOCK_MAX bytes (at DATA data)
+ * @param start_ms Set to the finished block's first timestamp
+ * @return Bytes of a finished block written to out, 0 if none
+ */
+uint16_t edtsp_pack_sample(EDTSPPacker *p, int32_t value, uint32_t now_ms, uint8_t *out, uint32_t *start_ms);
+
+/**
+ * Finish the open block early (idle sensor, shutdown)
+ *
+ * @return Bytes written to out, 0 if no block is open
+ */
+uint16_t edtsp_pack_flush(EDTSPPacker *p, uint8_t *out, uint32_t *start_ms);
+
+/** Print per-sensor samples / blocks / bits per sample (stats endpoint) */
+void edtsp_pack_print(const EDTSPPacker *packers, int count);
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+/**
+ * Decode a block
+ *
+ * @param out At least EDTSP_PACK_OUT_LEN values
+ * @return Samples decoded, -1 if malformed
+ */
+int edtsp_unpack(const uint8_t *data, int len, int32_t *out, uint16_t *interval_ms);
+
+/** Reset counters */
+void edtsp_unpack_init(void);
+
+/**
+ * Decode a packed DATA frame (flagged EDTSP_PACK_FLAGS) and count it
+ *
+ * @param pkt DATA packet (host byte order)
+ * @param len Bytes at pkt, header included; the block is the rest after data
+ * @param out At least EDTSP_PACK_OUT_LEN values
+ * @return Samples written to out, -1 if not a valid block
+ */
+int edtsp_unpack_on_data(const EDTSPDataPacket *pkt, size_t len, int32_t *out, uint16_t *interval_ms);
+
+/** Counters for one sensor (capability bit index) */
+const EDTSPPackStats *edtsp_unpack_stats(uint8_t sensor_id);
+
+/** Print per-sensor blocks / samples / compression (stats endpoint) */
+void edtsp_unpack_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_PACK_H
@@ -0,0 +1,125 @@
+/**
+ * @file edtsp_pool.h
+ * @brief EDTSP Packet Buffer Pool and Batch Arena
+ *
+ * Fixed-size, cache-line aligned packet buffers carved from one block at
+ * startup. Each thread keeps a small private free list; a lock-free shared
+ * stack balances buffers between threads. Short-lived per-batch data
+ * (decoded records, scratch space) comes from a bump arena that is reset
+ * after every receive batch. After init the data path never calls malloc.
+ */
+
+#ifndef EDTSP_POOL_H
+#define EDTSP_POOL_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Cache line size (buffer and arena alignment) */
+#define EDTSP_CACHE_LINE 64
+
+/** Packet buffer size: largest v2 frame + trailer, rounded to cache lines */
+#define EDTSP_POOL_BUF_SIZE 1536
+
+/** Per-thread free list capacity (half is moved on refill/spill) */
+#define EDTSP_POOL_THREAD_CACHE 32
+
+/** Threads that may use the pool (counters are kept per thread) */
+#define EDTSP_POOL_MAX_THREADS 16
+
+_Static_assert(EDTSP_POOL_BUF_SIZE % EDTSP_CACHE_LINE == 0, "buffers must stay cache aligned");
+_Static_assert(EDTSP_POOL_BUF_SIZE >= EDTSP_MAX_PAYLOAD_V2 + sizeof(EDTSPHeaderV2) + sizeof(EDTSPRedundancyTrailer),
+               "buffer must hold a full v2 frame");
+
+/** Allocation counters (summed over all threads) */
+typedef struct {
+    uint32_t capacity;      /**< Buffers in the pool */
+    uint32_t in_use;        /**< Buffers currently allocated */
+    uint64_t allocs;        /**< Buffers handed out */
+    uint64_t frees;         /**< Buffers returned */
+    uint64_t refills;       /**< Thread cache refilled from the shared stack */
+    uint64_t spills;        /**< Thread cache overflowed to the shared stack */
+    uint64_t exhausted;     /**< Allocations that failed (pool empty) */
+    uint32_t heap_allocs;   /**< malloc calls made by the pool (init only) */
+} EDTSPPoolStats;
+
+/**
+ * Create the pool (the only heap allocation)
+ *
+ * @param count Number of buffers
+ * @return false if already initialized or out of memory
+ */
+bool edtsp_pool_init(uint32_t count);
+
+/** Release the pool memory (no buffer may be in use) */
+void edtsp_pool_destroy(void);
+
+/**
+ * Take a buffer (EDTSP_POOL_BUF_SIZE bytes, cache-line aligned)
+ *
+ * @return Buffer, or NULL if the pool is exhausted
+ */
+void *edtsp_pool_alloc(void);
+
+/** Return a buffer (any thread may free any buffer) */
+void edtsp_pool_free(void *buf);
+
+/** Hand the calling thread's cached buffers back (call before thread exit) */
+void edtsp_pool_thread_flush(void);
+
+/** Get counters */
+void edtsp_pool_stats(EDTSPPoolStats *out);
+
+/** Print counters (for the stats endpoint) */
+void edtsp_pool_print(void);
+
+// ============================================================================
+// BATCH ARENA
+// ============================================================================
+
+/**
+ * Bump allocator over caller-provided memory
+ *
+ * Allocation is a pointer increment; everything is released at once by
+ * edtsp_arena_reset(). Not thread safe: one arena per receive loop.
+ */
+typedef struct {
+    uint8_t *base;        /**< Backing memory */
+    size_t   size;        /**< Backing memory size */
+    size_t   used;        /**< Bytes handed out since the last reset */
+    size_t   peak;        /**< Highest `used` ever seen */
+    uint64_t allocs;      /**< Allocations served */
+    uint64_t resets;      /**< Batches completed */
+    uint64_t overflows;   /**< Allocations that did not fit */
+} EDTSPArena;
+
+/** Attach an arena to backing memory */
+void edtsp_arena_init(EDTSPArena *arena, void *mem, size_t size);
+
+/**
+ * Allocate from the arena
+ *
+ * @param align Power of two (0 = 8 bytes)
+ * @return Memory valid until the next reset, or NULL if it does not fit
+ */
+void *edtsp_arena_alloc(EDTSPArena *arena, size_t size, size_t align);
+
+/** Release everything allocated since the last reset */
+static inline void edtsp_arena_reset(EDTSPArena *arena) {
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    arena->used = 0;
+    arena->resets++;
+}
+
+/** Print arena counters (for the stats endpoint) */
+void edtsp_arena_print(const char *name, const EDTSPArena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_POOL_H
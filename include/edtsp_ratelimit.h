@@ -0,0 +1,105 @@
+/**
+ * @file edtsp_ratelimit.h
+ * @brief EDTSP Per-Source Rate Limiting (receive path)
+ *
+ * Every source ID gets a token bucket: rate tokens per second refill it up
+ * to burst, and each received frame takes one token. The check runs right
+ * after header validation, before dedup, dispatch and any handler, so a
+ * misbehaving or spoofing node flooding the segment costs the master one
+ * hash probe per frame instead of a handler call.
+ *
+ * Devices in the device table (joined, not timed out) get the device rate;
+ * other source IDs (discovery, handshakes of joining nodes, rogue traffic)
+ * get the lower stranger rate. Frames over the limit are dropped, except
+ * one in sample_every which is let through so the flood stays visible to
+ * the handlers and logs (what is it sending?) at a bounded fraction.
+ *
+ * Buckets live in a fixed table hashed on source ID. When a burst of new
+ * IDs fills it, further unknown sources share one overflow bucket at the
+ * stranger rate, so ID spoofing cannot exhaust memory or the rate budget.
+ */
+
+#ifndef EDTSP_RATELIMIT_H
+#define EDTSP_RATELIMIT_H
+
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Tracked sources (power of two; 4x the device table) */
+#define EDTSP_RATELIMIT_SOURCES (4 * EDTSP_MAX_DEVICES)
+
+/** Slots probed per lookup */
+#define EDTSP_RATELIMIT_PROBE 8
+
+/** Unknown sources idle this long give up their slot */
+#define EDTSP_RATELIMIT_IDLE_US 30000000ULL
+
+/** Defaults: a slave sends a few frames per sampled sensor per second */
+#define EDTSP_RATELIMIT_DEVICE_PPS      1000
+#define EDTSP_RATELIMIT_DEVICE_BURST    200
+#define EDTSP_RATELIMIT_STRANGER_PPS    20
+#define EDTSP_RATELIMIT_STRANGER_BURST  20
+#define EDTSP_RATELIMIT_SAMPLE_EVERY    1000
+
+/** Limits (0 pps = class not limited) */
+typedef struct {
+    uint32_t device_pps;
+    uint32_t device_burst;
+    uint32_t stranger_pps;
+    uint32_t stranger_burst;
+    uint32_t sample_every;      /**< Let 1 in N excess frames through (0 = drop all) */
+} EDTSPRateLimitConfig;
+
+/** Per-source counters */
+typedef struct {
+    uint32_t source_id;
+    bool     known;             /**< In the device table (device rate) */
+    uint32_t passed;            /**< Within the limit */
+    uint32_t dropped;           /**< Over the limit, discarded */
+    uint32_t sampled;           /**< Over the limit, let through */
+} EDTSPRateSource;
+
+/** Totals */
+typedef struct {
+    uint32_t passed;
+    uint32_t dropped;
+    uint32_t sampled;
+    uint32_t sources;           /**< Sources holding a bucket */
+    uint32_t overflow;          /**< Frames charged to the shared bucket */
+} EDTSPRateLimitStats;
+
+/** Clear all buckets (cfg NULL = defaults) */
+void edtsp_ratelimit_init(const EDTSPRateLimitConfig *cfg);
+
+/** Device joined (device rate) or timed out (stranger rate) */
+void edtsp_ratelimit_set_known(uint32_t source_id, bool known);
+
+/**
+ * Charge one received frame to its source
+ *
+ * @param now_us Receive time (a step backwards skips the refill)
+ * @return false if the frame is over the limit and must be dropped
+ */
+bool edtsp_ratelimit_admit(uint32_t source_id, uint64_t now_us);
+
+/**
+ * Counters of one source
+ *
+ * @return false if the source holds no bucket
+ */
+bool edtsp_ratelimit_source(uint32_t source_id, EDTSPRateSource *out);
+
+/** Totals */
+const EDTSPRateLimitStats *edtsp_ratelimit_stats(void);
+
+/** Print totals and the sources with drops (stats endpoint) */
+void edtsp_ratelimit_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_RATELIMIT_H
@@ -0,0 +1,84 @@
+/**
+ * @file edtsp_rtt.h
+ * @brief EDTSP Round-Trip and One-Way Latency Tracking
+ * 
+ * Per-peer SRTT/RTTVAR (RFC 6298 smoothing) from PROBE exchanges,
+ * rolling RTT and one-way latency histograms, and a per-interface SRTT
+ * used for link selection.
+ */
+
+#ifndef EDTSP_RTT_H
+#define EDTSP_RTT_H
+
+#include "protocol.h"
+#include "edtsp_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Lower bound for retransmission timeouts (milliseconds) */
+#define EDTSP_RTO_MIN_MS 200
+
+/** RTO before any sample exists (milliseconds, RFC 6298 initial value) */
+#define EDTSP_RTO_INITIAL_MS 1000
+
+/** Interface type slots (EDTSPInterfaceType values) */
+#define EDTSP_IFACE_SLOTS 4
+
+/** Exchanges kept for min-RTT filtering (older minimums age out) */
+#define EDTSP_RTT_FILTER_LEN 8
+
+/** Per-peer latency state */
+typedef struct {
+    uint32_t       peer_id;          /**< Peer device ID */
+    uint32_t       srtt_us;          /**< Smoothed RTT */
+    uint32_t       rttvar_us;        /**< RTT variation */
+    uint32_t       min_rtt_us;       /**< Lowest RTT in the filter window */
+    int64_t        offset_us;        /**< Peer clock - local clock, from the min-RTT exchange */
+    uint32_t       win_rtt_us[EDTSP_RTT_FILTER_LEN];    /**< Min-RTT filter window */
+    int64_t        win_offset_us[EDTSP_RTT_FILTER_LEN];
+    uint32_t       samples;          /**< Echoes received */
+    uint32_t       losses;           /**< Probes never answered */
+    uint32_t       iface_srtt_us[EDTSP_IFACE_SLOTS]; /**< SRTT per interface type */
+    EDTSPHistogram rtt_hist;         /**< Rolling RTT distribution */
+    EDTSPHistogram owd_hist;         /**< Rolling one-way (outbound) latency distribution */
+} EDTSPPeerLatency;
+
+/** Reset all peers */
+void edtsp_rtt_init(void);
+
+/**
+ * Record a completed probe exchange
+ * 
+ * @param peer_id Responder
+ * @param iface   Interface type the probe travelled on
+ * @param t1_us   Local transmit time
+ * @param t2_us   Peer receive time (peer clock)
+ * @param t3_us   Peer transmit time (peer clock)
+ * @param t4_us   Local receive time
+ * @return Measured RTT in microseconds
+ */
+uint32_t edtsp_rtt_on_echo(uint32_t peer_id, uint8_t iface,
+                           uint64_t t1_us, uint64_t t2_us, uint64_t t3_us, uint64_t t4_us);
+
+/** Record an unanswered probe */
+void edtsp_rtt_on_loss(uint32_t peer_id);
+
+/** Peer state (NULL if never measured) */
+const EDTSPPeerLatency *edtsp_rtt_peer(uint32_t peer_id);
+
+/** Retransmission timeout for a peer: SRTT + 4*RTTVAR, clamped (milliseconds) */
+uint32_t edtsp_rtt_rto_ms(uint32_t peer_id);
+
+/** SRTT over all peers for an interface type (0 = no samples) */
+uint32_t edtsp_rtt_iface_srtt_us(uint8_t iface);
+
+/** Print per-peer latency table (stats endpoint) */
+void edtsp_rtt_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_RTT_H
@@ -0,0 +1,151 @@
+/**
+ * @file edtsp_shard.h
+ * @brief EDTSP Sharded Ingest (consistent hashing over ingest nodes)
+ *
+ * Zones bound the devices per master, but every DATA frame of a network
+ * still ends at one node. Sharding spreads the DATA of one network over
+ * several ingest nodes:
+ *
+ * - An ingest node (PC, --ingest) opens a unicast ingest socket and
+ *   advertises its address and port in every HEARTBEAT.
+ * - The elected master places every live ingest node on a hash ring at
+ *   EDTSP_SHARD_VNODES points. A slave belongs to the node owning the
+ *   first point at or after the hash of its ID.
+ * - The master sends each slave its node in a CONFIG with sensor_id
+ *   EDTSP_CONFIG_NO_SENSOR (ingest_id/addr/port). The slave then sends its
+ *   DATA by unicast to that node instead of to the group.
+ *
+ * When a node joins or times out, only the arcs it gains or loses change
+ * owner: about 1/N of the slaves move, and only those get a new CONFIG.
+ * Assignments are also refreshed every EDTSP_SHARD_REFRESH_MS, so a lost
+ * CONFIG costs at most one refresh. A slave whose node has timed out in
+ * its own device table falls back to the group (and the master) until it
+ * is reassigned. Slaves the ring has no node for, and ingest nodes
+ * themselves, stay with the master.
+ *
+ * The master's view of the ingest nodes is kept on every node, so a newly
+ * elected master builds the same ring and moves nobody.
+ */
+
+#ifndef EDTSP_SHARD_H
+#define EDTSP_SHARD_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** CONFIG sensor_id: no sensor setting, ingest assignment only */
+#define EDTSP_CONFIG_NO_SENSOR 0xFF
+
+/** Ingest nodes on the ring */
+#define EDTSP_SHARD_MAX_NODES 16
+
+/** Ring points per ingest node */
+#define EDTSP_SHARD_VNODES 64
+
+#define EDTSP_SHARD_POINTS (EDTSP_SHARD_MAX_NODES * EDTSP_SHARD_VNODES)
+
+/** Every assignment is re-sent at least this often */
+#define EDTSP_SHARD_REFRESH_MS 10000
+
+/** Where a slave sends its DATA (id 0 = the master, over the group) */
+typedef struct {
+    uint32_t id;
+    uint32_t addr;               /**< IPv4, host byte order */
+    uint16_t port;
+} EDTSPShardTarget;
+
+/** Consistent-hash ring: sorted points, each owned by one node */
+typedef struct {
+    uint32_t hash[EDTSP_SHARD_POINTS];
+    uint8_t  owner[EDTSP_SHARD_POINTS];   /**< Index into ids */
+    uint32_t ids[EDTSP_SHARD_MAX_NODES];
+    int      nodes;
+    int      points;
+} EDTSPShardRing;
+
+/** Counters */
+typedef struct {
+    uint32_t ring_changes;       /**< Node joins and timeouts */
+    uint32_t configs;            /**< Master: assignment CONFIGs sent */
+    uint32_t moved;              /**< Master: slaves moved to another node, all changes */
+    uint32_t last_moved;         /**< Master: slaves moved by the last ring change */
+    uint32_t ingested;           /**< Ingest node: DATA frames taken on the ingest socket */
+    uint32_t fallbacks;          /**< Slave: DATA sent to the group while the node was gone */
+} EDTSPShardStats;
+
+/** Hash of a slave ID (ring key) */
+uint32_t edtsp_shard_hash(uint32_t device_id);
+
+/**
+ * Place nodes on a ring, EDTSP_SHARD_VNODES points each
+ *
+ * The points depend on the node IDs only, not their order.
+ *
+ * @param n Nodes (at most EDTSP_SHARD_MAX_NODES are used)
+ */
+void edtsp_shard_ring_build(EDTSPShardRing *r, const uint32_t *ids, int n);
+
+/** Node owning a slave (0 if the ring is empty) */
+uint32_t edtsp_shard_ring_lookup(const EDTSPShardRing *r, uint32_t device_id);
+
+// ============================================================================
+// MASTER (assignment)
+// ============================================================================
+
+/** Forget every ingest node and assignment */
+void edtsp_shard_init(uint32_t self_id);
+
+/**
+ * HEARTBEAT hook: a node advertises its ingest socket (every node keeps
+ * the table; the master also adds itself here when it ingests)
+ *
+ * @param port 0 = not an ingest node
+ */
+void edtsp_shard_on_ingest(uint32_t device_id, uint32_t addr, uint16_t port, uint64_t now_ms);
+
+/** Drop ingest nodes silent for EDTSP_HEARTBEAT_TIMEOUT_MS (call every second) */
+void edtsp_shard_check_timeouts(uint64_t now_ms);
+
+/** Ingest nodes on the ring */
+int edtsp_shard_nodes(void);
+
+/**
+ * Assignment of the slave in a device table slot
+ *
+ * @param target Node for the slave
+ * @return true if a CONFIG is due: the node changed, or the last one is
+ *         EDTSP_SHARD_REFRESH_MS old. It is counted as sent.
+ */
+bool edtsp_shard_assign(int slot, uint32_t slave_id, uint64_t now_ms, EDTSPShardTarget *target);
+
+// ============================================================================
+// SLAVE / INGEST NODE
+// ============================================================================
+
+/** Slave: node named by the master's last assignment */
+void edtsp_shard_set_target(const EDTSPShardTarget *target);
+
+/** Slave: current node (id 0 = the master) */
+const EDTSPShardTarget *edtsp_shard_target(void);
+
+/** Slave: DATA went to the group because the node was gone */
+void edtsp_shard_on_fallback(void);
+
+/** Ingest node: one DATA frame taken on the ingest socket */
+void edtsp_shard_on_data(void);
+
+/** Counters */
+const EDTSPShardStats *edtsp_shard_stats(void);
+
+/** Print ring, assignments and counters (stats endpoint) */
+void edtsp_shard_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_SHARD_H
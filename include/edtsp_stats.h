@@ -0,0 +1,54 @@
+/**
+ * @file edtsp_stats.h
+ * @brief EDTSP Statistics Primitives
+ * 
+ * Log-linear latency histogram (HDR style: 8 sub-buckets per power of
+ * two, ~12% resolution) with O(1) record and exponential decay so that
+ * percentiles follow recent behaviour.
+ */
+
+#ifndef EDTSP_STATS_H
+#define EDTSP_STATS_H
+
+#include "protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Sub-bucket bits per power of two */
+#define EDTSP_HIST_SUB_BITS 3
+
+/** Bucket count (covers the full uint32_t range) */
+#define EDTSP_HIST_BUCKETS ((32 - EDTSP_HIST_SUB_BITS + 1) << EDTSP_HIST_SUB_BITS)
+
+/** Halve all counts once this many samples are held (rolling window) */
+#define EDTSP_HIST_DECAY_AT 4096
+
+/** Latency histogram (values in microseconds) */
+typedef struct {
+    uint32_t counts[EDTSP_HIST_BUCKETS]; /**< Samples per bucket */
+    uint32_t total;                      /**< Samples currently held */
+    uint32_t min;                        /**< Lowest value ever recorded */
+    uint32_t max;                        /**< Highest value ever recorded */
+} EDTSPHistogram;
+
+/** Reset histogram */
+void edtsp_hist_init(EDTSPHistogram *h);
+
+/** Record one value */
+void edtsp_hist_record(EDTSPHistogram *h, uint32_t value);
+
+/**
+ * Value at percentile (bucket upper bound)
+ * 
+ * @param pct Percentile 0-100
+ * @return Value, or 0 if empty
+ */
+uint32_t edtsp_hist_percentile(const EDTSPHistogram *h, double pct);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_STATS_H
@@ -0,0 +1,114 @@
+/**
+ * @file edtsp_tclass.h
+ * @brief EDTSP Traffic Classes (control ahead of data)
+ *
+ * Every packet type belongs to one of two classes. CONTROL carries
+ * election, membership, configuration, timing and commands: DISCOVERY,
+ * HEARTBEAT, HANDSHAKE, CONFIG, GROUP_CONFIG, PROBE, SYNC, ACTUATE,
+ * CREDIT and ZONE_SUMMARY. DATA carries sensor samples and any type not
+ * declared control.
+ *
+ * Receive: control packets are dispatched as soon as they are read. DATA
+ * packets are deferred to a bounded queue that the event loop serves in
+ * time slices, after its timers and after everything control that has
+ * arrived. A burst of sensor data (or a slow DATA handler) then delays
+ * other DATA, not the heartbeats that edtsp_check_timeouts() relies on.
+ *
+ * Transmit: each class gets its own DSCP (CS6 for control, AF11 for
+ * data), set per packet. Switches honouring DSCP and the kernel's
+ * priority qdiscs (pfifo_fast, prio) then queue the two classes apart and
+ * serve control first.
+ *
+ * Per class: frames, receive-to-handler wait, and lateness of timed sends
+ * (heartbeats, sensor samples) against their schedule.
+ */
+
+#ifndef EDTSP_TCLASS_H
+#define EDTSP_TCLASS_H
+
+#include "protocol.h"
+#include "edtsp_dispatch.h"
+#include "edtsp_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Traffic classes, highest priority first */
+typedef enum {
+    EDTSP_CLASS_CONTROL = 0,
+    EDTSP_CLASS_DATA    = 1
+} EDTSPTrafficClass;
+
+#define EDTSP_CLASS_COUNT 2
+
+/** DSCP code points (RFC 4594: network control, low-priority bulk data) */
+#define EDTSP_DSCP_CONTROL 48   /* CS6 */
+#define EDTSP_DSCP_DATA    10   /* AF11 */
+
+/** Deferred DATA packets held (power of two) */
+#define EDTSP_TCLASS_QUEUE 256
+
+/** DATA dispatch per event loop iteration before control gets its turn */
+#define EDTSP_TCLASS_SLICE_US 2000
+
+/** Per-class counters */
+typedef struct {
+    uint32_t       rx;          /**< Packets dispatched */
+    uint32_t       tx;          /**< Packets sent */
+    uint32_t       dropped;     /**< DATA lost to a full queue */
+    uint32_t       peak_depth;  /**< Deepest queue seen */
+    EDTSPHistogram wait_us;     /**< Receive to handler */
+    EDTSPHistogram late_us;     /**< Timed sends: schedule to transmit */
+} EDTSPClassStats;
+
+/** Default classes, empty queue, counters cleared */
+void edtsp_tclass_init(void);
+
+/** Move a packet type to another class (application types default to DATA) */
+void edtsp_tclass_set(uint8_t type, EDTSPTrafficClass cls);
+
+/** Class of a packet type */
+EDTSPTrafficClass edtsp_tclass_of(uint8_t type);
+
+/** IP TOS byte of a class (DSCP in the upper six bits, ECN clear) */
+uint8_t edtsp_tclass_tos(EDTSPTrafficClass cls);
+
+/**
+ * Queue a DATA packet for later dispatch
+ *
+ * @param buf Buffer holding the packet, returned by edtsp_tclass_next()
+ * @return false if the queue is full (packet counted as dropped)
+ */
+bool edtsp_tclass_defer(const EDTSPRxPacket *rx, void *buf);
+
+/**
+ * Oldest deferred packet
+ *
+ * @return false if the queue is empty
+ */
+bool edtsp_tclass_next(EDTSPRxPacket *rx, void **buf);
+
+/** Deferred packets waiting */
+uint32_t edtsp_tclass_backlog(void);
+
+/** Count a packet dispatched after waiting wait_us since receive */
+void edtsp_tclass_on_rx(EDTSPTrafficClass cls, uint32_t wait_us);
+
+/** Count a packet sent */
+void edtsp_tclass_on_tx(EDTSPTrafficClass cls);
+
+/** Record how late a scheduled send went out */
+void edtsp_tclass_on_late(EDTSPTrafficClass cls, uint32_t late_us);
+
+/** Counters of a class */
+const EDTSPClassStats *edtsp_tclass_stats(EDTSPTrafficClass cls);
+
+/** Print per-class counters and percentiles (stats endpoint) */
+void edtsp_tclass_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_TCLASS_H
@@ -0,0 +1,122 @@
+/**
+ * @file edtsp_window.h
+ * @brief EDTSP Windowed Aggregation (slave-side summaries)
+ *
+ * For a fast sensor whose raw samples the master does not need, CONFIG can
+ * set a window length. The slave then folds each sample into running
+ * min / max / sum / sum of squares and, once per tumbling window, sends a
+ * single DATA record summarizing it: min, max, mean, RMS and sample count.
+ *
+ * Folding a sample is a compare-and-add on fixed fields (no allocation, no
+ * floating point, no division), so it fits the ESP32 loop at any sampling
+ * rate. Mean and RMS are computed once per window when it closes.
+ *
+ * A window starts at its first sample and closes at the first sample
+ * window_ms or more later, which opens the next one. DATA timestamp_ms is
+ * the window start.
+ *
+ * DATA record (data_len = EDTSP_WINDOW_RECORD_LEN, big-endian):
+ * min i32, max i32, mean i32, rms u32 (raw sensor units), count u16.
+ */
+
+#ifndef EDTSP_WINDOW_H
+#define EDTSP_WINDOW_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** DATA payload bytes of one summary */
+#define EDTSP_WINDOW_RECORD_LEN 18
+
+/** Window summary (host byte order) */
+typedef struct {
+    uint32_t start_ms;          /**< First sample (DATA timestamp_ms) */
+    uint16_t count;             /**< Samples in the window */
+    int32_t  min;
+    int32_t  max;
+    int32_t  mean;              /**< Rounded to the nearest raw unit */
+    uint32_t rms;               /**< Rounded down (integer square root) */
+} EDTSPWindowSummary;
+
+/**
+ * Per-sensor window (slave)
+ *
+ * The sum of squares is exact while |value| < 2^24 raw units; sensors
+ * report 16-bit ranges (edtsp_capdesc.h).
+ */
+typedef struct {
+    uint32_t window_ms;         /**< 0 = aggregation off */
+    uint32_t start_ms;
+    uint16_t count;             /**< 0 = no window open */
+    int32_t  min;
+    int32_t  max;
+    int64_t  sum;
+    uint64_t sum_sq;
+    uint32_t samples;           /**< Samples taken */
+    uint32_t windows;           /**< Summaries sent */
+} EDTSPWindow;
+
+/** Per-sensor counters (master, all devices) */
+typedef struct {
+    uint32_t summaries;         /**< Summary records received */
+    uint32_t samples;           /**< Samples they cover */
+} EDTSPSummaryStats;
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+/** Set the window length (0 = off); an open window is discarded */
+void edtsp_window_configure(EDTSPWindow *w, uint32_t window_ms);
+
+/**
+ * Fold one sample
+ *
+ * If the sample falls past the open window, that window is closed into
+ * out and the sample opens the next one.
+ *
+ * @return true if out holds a summary to send
+ */
+bool edtsp_window_sample(EDTSPWindow *w, int32_t value, uint32_t now_ms, EDTSPWindowSummary *out);
+
+/**
+ * Encode a summary
+ *
+ * @param out At least EDTSP_WINDOW_RECORD_LEN bytes
+ * @return Bytes written (DATA data_len)
+ */
+uint8_t edtsp_window_record(const EDTSPWindowSummary *s, uint8_t *out);
+
+/** Print per-sensor samples / summaries / bytes saved (stats endpoint) */
+void edtsp_window_print(const EDTSPWindow *windows, int count);
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+/** Reset counters */
+void edtsp_summary_init(void);
+
+/**
+ * Decode a summary record and count it
+ *
+ * @param pkt DATA packet (host byte order)
+ * @return false if the payload is not a summary record
+ */
+bool edtsp_summary_on_data(const EDTSPDataPacket *pkt, EDTSPWindowSummary *out);
+
+/** Counters for one sensor (capability bit index) */
+const EDTSPSummaryStats *edtsp_summary_stats(uint8_t sensor_id);
+
+/** Print per-sensor summaries / samples covered / bandwidth saved (stats endpoint) */
+void edtsp_summary_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_WINDOW_H
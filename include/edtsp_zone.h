@@ -0,0 +1,223 @@
+/**
+ * @file edtsp_zone.h
+ * @brief EDTSP Hierarchical Zones (sub-masters and a top master)
+ *
+ * A flat network puts every device on one multicast group with one
+ * master: that master ingests all DATA, and every node tracks every
+ * other one in a table capped at EDTSP_MAX_DEVICES. Zones split the
+ * network in two tiers:
+ *
+ * - Zone z (1..EDTSP_ZONE_MAX_ID) has its own group and port (see
+ *   protocol.h). Election, join, configuration and DATA stay inside the
+ *   zone, so each zone is a flat network of at most EDTSP_MAX_DEVICES.
+ * - The master of a zone (sub-master) ingests its zone's DATA and, once
+ *   per heartbeat interval, sends one ZONE_SUMMARY on the uplink group:
+ *   membership (count, digest, joins/leaves) and the interval's DATA
+ *   (frame/byte totals, per-sensor samples/min/max/mean).
+ * - Sub-masters elect a top master on the uplink with the zone rule:
+ *   highest SourceID among the sub-masters heard within
+ *   EDTSP_HEARTBEAT_TIMEOUT_MS. The top master keeps one entry per zone.
+ *
+ * Ingest at the top is one summary per zone per second, whatever the
+ * zone sizes; membership at the top is one entry per zone. A zone keeps
+ * its entry across a sub-master handover: a lower SourceID takes a zone
+ * over once the current holder has missed EDTSP_ZONE_HANDOVER_MS of
+ * summaries (a higher one at once, as the zone election would).
+ *
+ * The member digest is the XOR of a hash of every member's ID, so it is
+ * updated in O(1) per join or leave and two sub-masters with the same
+ * view of a zone report the same digest.
+ *
+ * Sensor values are 16-bit ranges (edtsp_capdesc.h); records carry them
+ * clamped to int16.
+ */
+
+#ifndef EDTSP_ZONE_H
+#define EDTSP_ZONE_H
+
+#include "protocol.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Sensors aggregated per zone (one per capability bit) */
+#define EDTSP_ZONE_SENSORS 16
+
+/** Encoded size of one sensor record in ZONE_SUMMARY */
+#define EDTSP_ZONE_RECORD_SIZE 11
+
+/** Body capacity (bytes) */
+#define EDTSP_ZONE_BODY_MAX ((int)sizeof(((EDTSPZoneSummaryPacket*)0)->body))
+
+/** Summary silence after which a lower SourceID may take a zone over */
+#define EDTSP_ZONE_HANDOVER_MS (2 * EDTSP_HEARTBEAT_INTERVAL_MS)
+
+/** One sensor over one interval (host byte order) */
+typedef struct {
+    uint32_t samples;
+    int32_t  min;
+    int32_t  max;
+    int64_t  sum;                /**< For the mean */
+} EDTSPZoneSensorAgg;
+
+/** Sub-master aggregate: the zone's membership and the DATA since the last summary */
+typedef struct {
+    uint16_t members;            /**< Active devices, self included */
+    uint32_t digest;             /**< XOR of edtsp_zone_member_hash() of the members */
+    uint16_t joins;              /**< This interval */
+    uint16_t leaves;
+    uint32_t frames;
+    uint32_t bytes;
+    uint64_t start_ms;           /**< Interval start */
+    uint16_t sensor_mask;        /**< Sensors with samples this interval */
+    EDTSPZoneSensorAgg sensors[EDTSP_ZONE_SENSORS];
+} EDTSPZoneAgg;
+
+/** One zone as seen by the top master */
+typedef struct {
+    uint32_t sub_master;         /**< Sender of the last summary, 0 = never heard */
+    uint64_t last_ms;            /**< Last summary */
+    bool     active;
+    uint16_t members;
+    uint32_t digest;
+    uint32_t frames_per_s;       /**< Last interval */
+    uint64_t frames;             /**< Totals over all summaries */
+    uint64_t bytes;
+    uint32_t summaries;
+    uint32_t membership_changes; /**< Summaries with joins, leaves or a new digest */
+    uint32_t handovers;          /**< Sub-master changes */
+} EDTSPZoneEntry;
+
+/** Top-tier counters */
+typedef struct {
+    uint32_t summaries;          /**< Accepted */
+    uint32_t rejected;           /**< Malformed, or a claim on a live zone by a lower ID */
+    uint16_t zones;              /**< Active zones */
+    uint32_t members;            /**< Devices in active zones */
+    uint32_t frames_per_s;       /**< DATA rate of active zones (last intervals) */
+    uint64_t frames;             /**< DATA frames summarized since init */
+    uint64_t bytes;
+    uint32_t top_changes;
+    EDTSPZoneSensorAgg sensors[EDTSP_ZONE_SENSORS];  /**< Since init, all zones */
+} EDTSPZoneStats;
+
+/** Hash of a member ID folded into the digest */
+uint32_t edtsp_zone_member_hash(uint32_t device_id);
+
+// ============================================================================
+// SUB-MASTER (aggregation)
+// ============================================================================
+
+/**
+ * Empty aggregate: no members, no DATA
+ *
+ * Every node keeps one for its zone (membership follows the device
+ * table whatever the role), so a newly elected sub-master already has
+ * the zone's digest.
+ */
+void edtsp_zone_agg_reset(EDTSPZoneAgg *a, uint64_t now_ms);
+
+/** A member joined (true) or timed out (false) */
+void edtsp_zone_agg_member(EDTSPZoneAgg *a, uint32_t device_id, bool joined);
+
+/** Count one ingested DATA frame */
+void edtsp_zone_agg_frame(EDTSPZoneAgg *a, uint16_t payload_bytes);
+
+/** Fold decoded samples of a sensor (capability bit index) */
+void edtsp_zone_agg_samples(EDTSPZoneAgg *a, uint8_t sensor, const int32_t *values, int n);
+
+/** Fold a window summary (count samples with this min/max/mean) */
+void edtsp_zone_agg_window(EDTSPZoneAgg *a, uint8_t sensor, uint32_t count,
+                           int32_t min, int32_t max, int32_t mean);
+
+/**
+ * Build the interval's ZONE_SUMMARY (network byte order, ready to send)
+ * and start the next interval; membership carries over
+ *
+ * @param role EDTSP_ROLE_MASTER if the sender is the top master
+ * @return Frame length
+ */
+size_t edtsp_zone_agg_build(EDTSPZoneAgg *a, EDTSPZoneSummaryPacket *pkt, uint32_t source_id,
+                            uint16_t zone, uint8_t role, uint64_t now_ms);
+
+// ============================================================================
+// NODE
+// ============================================================================
+
+/**
+ * Set the zone of this node (0 = flat network, module idle)
+ *
+ * Resets the local aggregate (self as its only member) and the top tier.
+ */
+void edtsp_zone_init(uint16_t zone, uint32_t self_id);
+
+/** Zone of this node (0 = flat) */
+uint16_t edtsp_zone_id(void);
+
+/** Aggregate of this node's zone */
+EDTSPZoneAgg *edtsp_zone_agg(void);
+
+/** Device table hook: a device joined or timed out */
+void edtsp_zone_on_member(uint32_t device_id, bool joined);
+
+/**
+ * Sub-master: build this interval's summary for the uplink
+ *
+ * Own summaries are not heard back, so the zone is also recorded in
+ * the local top-tier table here.
+ *
+ * @return Frame length (network byte order), 0 if not on the uplink
+ */
+size_t edtsp_zone_summary(EDTSPZoneSummaryPacket *pkt, uint64_t now_ms);
+
+// ============================================================================
+// TOP TIER (uplink)
+// ============================================================================
+
+/**
+ * This node became (true) or stopped being (false) a sub-master
+ *
+ * Going down forgets every zone: the uplink is only heard while up.
+ */
+void edtsp_zone_set_uplink(bool up, uint64_t now_ms);
+
+/** Node is a sub-master on the uplink */
+bool edtsp_zone_uplink(void);
+
+/** Check a received summary (host byte order) */
+bool edtsp_zone_summary_valid(const EDTSPZoneSummaryPacket *pkt, size_t len);
+
+/**
+ * Record a zone summary heard on the uplink (host byte order) and run
+ * the top election
+ *
+ * @return false if rejected
+ */
+bool edtsp_zone_on_summary(uint32_t source_id, const EDTSPZoneSummaryPacket *pkt, size_t len,
+                           uint64_t now_ms);
+
+/** Expire silent zones and re-elect (call every second) */
+void edtsp_zone_check_timeouts(uint64_t now_ms);
+
+/** Current top master (own ID when top, 0 when not on the uplink) */
+uint32_t edtsp_zone_top_id(void);
+
+/** Node is the top master */
+bool edtsp_zone_is_top(void);
+
+/** Zone entry (NULL if out of range) */
+const EDTSPZoneEntry *edtsp_zone_entry(uint16_t zone);
+
+/** Counters (zones, members and rate refreshed by every call) */
+const EDTSPZoneStats *edtsp_zone_stats(void);
+
+/** Print zone, tier role and the zone table (stats endpoint) */
+void edtsp_zone_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EDTSP_ZONE_H
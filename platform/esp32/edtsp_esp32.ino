@@ -34,7 +34,32 @@ const char* DEVICE_NAME = "ESP32-EDTSP";
 const EDTSPCapabilityMask MY_CAPABILITIES = 
     EDTSP_CAP_TEMPERATURE | 
     EDTSP_CAP_HUMIDITY | 
-    EDTSP_CAP_DISTANCE;
+    EDTSP_CAP_DISTANCE |
+    EDTSP_CAP_RELAY |
+    EDTSP_CAP_PWM;
+
+// Capability descriptors sent in the join SYN (TLV, see edtsp_capdesc.h):
+// type 1 = SENSOR, len 10: kind, instance, unit, scale, range_min, range_max,
+// fastest sampling interval (ms), big-endian. Lets the master plan rates the
+// hardware can deliver.
+const uint8_t MY_DESCRIPTORS[] = {
+    1, 10, 0, 0, 1, 0xFF, 0xFE, 0x70, 0x03, 0x20, 0x07, 0xD0,  // DHT22 temperature: -40.0..80.0 C, 2 s
+    1, 10, 1, 0, 2, 0xFF, 0x00, 0x00, 0x03, 0xE8, 0x07, 0xD0,  // DHT22 humidity: 0..100.0 %RH, 2 s
+    1, 10, 3, 0, 4, 0xFE, 0x00, 0x02, 0x01, 0x90, 0x00, 0x3C,  // HC-SR04 distance: 0.02..4.00 m, 60 ms
+};
+
+// Zone (1-EDTSP_ZONE_MAX_ID, 0 = flat network): the zone's own group and port,
+// see edtsp_zone.h. Only PC nodes send zone summaries: give each zone a PC
+// node with a higher ID than its ESP32s so it is elected zone master.
+const uint16_t ZONE = 0;
+
+// Actuator outputs (channel 0 of each output type)
+const int RELAY_PIN = 26;
+const int PWM_PIN = 27;
+
+// Output type = capability bit index (see edtsp_actuate.h)
+#define OUTPUT_RELAY 14
+#define OUTPUT_PWM   15
 
 // ============================================================================
 // GLOBAL STATE
@@ -43,6 +68,7 @@ const EDTSPCapabilityMask MY_CAPABILITIES =
 WiFiUDP udp;
 Preferences preferences;
 IPAddress multicast_ip;
+uint16_t multicast_port = EDTSP_PORT;
 
 uint32_t my_device_id = 0;
 uint8_t my_role = EDTSP_ROLE_UNKNOWN;
@@ -58,6 +84,60 @@ struct DeviceInfo {
 
 #define MAX_TRACKED_DEVICES 16
 DeviceInfo tracked_devices[MAX_TRACKED_DEVICES];
+
+// Recently applied commands: a retransmission is re-acked, not re-applied
+#define ACTUATE_HISTORY 8
+uint32_t actuate_master = 0;
+uint16_t actuate_seqs[ACTUATE_HISTORY];
+uint8_t actuate_status[ACTUATE_HISTORY];
+uint8_t actuate_count = 0;
+uint8_t actuate_next = 0;
+
+// Join handshake (slave side): SYN timer with jitter and backoff
+#define JOIN_RTO_MS     200
+#define JOIN_RTO_MAX_MS 3200
+#define JOIN_JITTER_MS  50
+uint32_t master_id = 0;
+uint32_t join_master = 0;
+bool join_established = false;
+unsigned long join_due_ms = 0;
+unsigned long join_rto_ms = 0;
+
+// Sampling interval per sensor (capability bit index), 0 = disabled
+uint16_t sensor_rate_ms[16] = {0};
+
+// Report by exception / window summary per sensor (CONFIG, see edtsp_deadband.h
+// and edtsp_window.h)
+struct SensorReport {
+    uint16_t deadband;
+    uint32_t max_silence_ms;
+    bool reported;
+    int32_t last_value;
+    unsigned long last_ms;
+    unsigned long next_sample_ms;
+    uint16_t seq;
+    uint32_t window_ms;                          // 0 = send samples
+    unsigned long win_start_ms;
+    uint16_t win_count;                          // 0 = no window open
+    int32_t win_min;
+    int32_t win_max;
+    int64_t win_sum;
+    uint64_t win_sum_sq;
+    int64_t avg_sum;                             // Samples averaged under a CREDIT cap
+    uint16_t avg_count;
+    unsigned long avg_first_ms;
+};
+SensorReport sensor_report[16];
+
+// Flow control: the master's CREDIT cap on DATA frames (see edtsp_flow.h)
+#define FLOW_UNLIMITED 0xFFFF
+#define FLOW_RATE_MS 1000
+#define FLOW_MAX_LEVEL 7
+uint16_t flow_max_fps = FLOW_UNLIMITED;
+unsigned long flow_expires_ms = 0;
+unsigned long flow_period_start = 0;
+uint32_t flow_frames = 0;                        // DATA frames this period
+uint8_t flow_level = 0;                          // Samples averaged: 2^level
 int device_count = 0;
 
 // ============================================================================
@@ -115,11 +195,16 @@ bool setup_wifi() {
 }
 
 bool setup_multicast() {
-    multicast_ip.fromString(EDTSP_MULTICAST_ADDR);
+    if (ZONE) {
+        multicast_ip = IPAddress(239, 255, 1 + ZONE / 256, ZONE % 256);
+        multicast_port = EDTSP_PORT + ZONE;
+    } else {
+        multicast_ip.fromString(EDTSP_MULTICAST_ADDR);
+    }
     
-    if (udp.beginMulticast(multicast_ip, EDTSP_PORT)) {
+    if (udp.beginMulticast(multicast_ip, multicast_port)) {
         Serial.printf("[NETWORK] Joined multicast %s:%d\n", 
-                     EDTSP_MULTICAST_ADDR, EDTSP_PORT);
+                     multicast_ip.toString().c_str(), multicast_port);
         return true;
     }
     
@@ -132,7 +217,7 @@ bool setup_multicast() {
 // ============================================================================
 
 void send_packet(const void* data, size_t len) {
-    udp.beginPacket(multicast_ip, EDTSP_PORT);
+    udp.beginPacket(multicast_ip, multicast_port);
     udp.write((const uint8_t*)data, len);
     udp.endPacket();
 }
@@ -165,13 +250,131 @@ void send_heartbeat() {
     pkt.header.payload_len = sizeof(pkt) - sizeof(EDTSPHeader);
     
     pkt.role = my_role;
-    pkt.uptime_ms = htonl(millis() - start_time_ms);
+    pkt.uptime_ms = millis() - start_time_ms;
     pkt.active_devices = get_active_device_count();
+    edtsp_encode_heartbeat(&pkt);
     
     send_packet(&pkt, sizeof(pkt));
     Serial.printf("[TX] HEARTBEAT: Role=%s\n", edtsp_role_name(my_role));
 }
 
+void send_probe_echo(const EDTSPProbePacket* req, uint64_t rx_us) {
+    EDTSPProbePacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    
+    pkt.header.magic = htons(EDTSP_MAGIC);
+    pkt.header.type = EDTSP_TYPE_PROBE;
+    pkt.header.source_id = htonl(my_device_id);
+    pkt.header.payload_len = sizeof(pkt) - sizeof(EDTSPHeader);
+    
+    pkt.kind = EDTSP_PROBE_ECHO;
+    pkt.interface_type = req->interface_type;
+    pkt.probe_seq = req->probe_seq;
+    pkt.target_id = req->header.source_id;
+    pkt.t1_us = req->t1_us;                      // Opaque to us, echo as-is
+    pkt.t2_us = rx_us;
+    pkt.t3_us = (uint64_t)esp_timer_get_time();
+    edtsp_encode_probe(&pkt);
+    
+    send_packet(&pkt, sizeof(pkt));
+}
+
+void send_sync_reply(const EDTSPSyncPacket* req, uint64_t rx_us) {
+    EDTSPSyncPacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    
+    pkt.header.magic = htons(EDTSP_MAGIC);
+    pkt.header.type = EDTSP_TYPE_SYNC;
+    pkt.header.source_id = htonl(my_device_id);
+    pkt.header.payload_len = sizeof(pkt) - sizeof(EDTSPHeader);
+    
+    // esp_timer and millis() share the boot epoch: this is our sample clock
+    pkt.kind = EDTSP_SYNC_REPLY;
+    pkt.sync_seq = req->sync_seq;
+    pkt.target_id = req->header.source_id;
+    pkt.t1_us = req->t1_us;
+    pkt.t2_us = rx_us;
+    pkt.t3_us = (uint64_t)esp_timer_get_time();
+    edtsp_encode_sync(&pkt);
+    
+    send_packet(&pkt, sizeof(pkt));
+}
+
+void send_handshake(uint8_t step, uint32_t target) {
+    EDTSPHandshakePacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    
+    pkt.header.magic = htons(EDTSP_MAGIC);
+    pkt.header.type = EDTSP_TYPE_HANDSHAKE;
+    pkt.header.source_id = htonl(my_device_id);
+    
+    pkt.handshake_step = step;
+    pkt.target_id = target;
+    pkt.capabilities = MY_CAPABILITIES;
+    pkt.interface_type = EDTSP_IFACE_WIFI;
+    if (step == EDTSP_HANDSHAKE_SYN) {
+        memcpy(pkt.descriptors, MY_DESCRIPTORS, sizeof(MY_DESCRIPTORS));
+        pkt.desc_len = sizeof(MY_DESCRIPTORS);
+    }
+    edtsp_encode_handshake(&pkt);
+    
+    size_t len = offsetof(EDTSPHandshakePacket, descriptors) + pkt.desc_len;
+    pkt.header.payload_len = len - sizeof(EDTSPHeader);
+    send_packet(&pkt, len);
+}
+
+void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+void send_data(uint8_t sensor, const uint8_t* record, uint8_t record_len, unsigned long timestamp) {
+    EDTSPDataPacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    
+    size_t len = offsetof(EDTSPDataPacket, data) + record_len;
+    pkt.header.magic = htons(EDTSP_MAGIC);
+    pkt.header.type = EDTSP_TYPE_DATA;
+    pkt.header.source_id = htonl(my_device_id);
+    pkt.header.payload_len = len - sizeof(EDTSPHeader);
+    
+    pkt.sensor_id = sensor;
+    pkt.timestamp_ms = timestamp;                // millis(): same epoch as the SYNC sample clock
+    pkt.data_len = record_len;
+    memcpy(pkt.data, record, record_len);
+    edtsp_encode_data(&pkt);
+    
+    send_packet(&pkt, len);
+    flow_frames++;
+}
+
+void send_actuate_ack(const EDTSPActuatePacket* cmd, uint8_t status, uint64_t rx_us) {
+    EDTSPActuatePacket pkt;
+    memset(&pkt, 0, sizeof(pkt));
+    
+    pkt.header.magic = htons(EDTSP_MAGIC);
+    pkt.header.type = EDTSP_TYPE_ACTUATE;
+    pkt.header.source_id = htonl(my_device_id);
+    pkt.header.payload_len = sizeof(pkt) - sizeof(EDTSPHeader);
+    
+    pkt.kind = EDTSP_ACTUATE_ACK;
+    pkt.priority = cmd->priority;
+    pkt.act_seq = cmd->act_seq;
+    pkt.target_id = cmd->header.source_id;
+    pkt.output_id = cmd->output_id;
+    pkt.channel = cmd->channel;
+    pkt.status = status;
+    pkt.value = cmd->value;
+    pkt.t1_us = cmd->t1_us;                      // Master's clock, echoed for its RTT
+    pkt.t2_us = rx_us;
+    pkt.t3_us = (uint64_t)esp_timer_get_time();
+    edtsp_encode_actuate(&pkt);
+    
+    send_packet(&pkt, sizeof(pkt));
+}
+
 // ============================================================================
 // LEADER ELECTION (Simplified)
 // ============================================================================
@@ -230,6 +433,7 @@ void perform_election() {
     
     // Set role
     my_role = (highest_id == my_device_id) ? EDTSP_ROLE_MASTER : EDTSP_ROLE_SLAVE;
+    master_id = highest_id;
     
     if (old_role != my_role) {
         Serial.printf("\n*** ROLE CHANGE: %s -> %s ***\n", 
@@ -239,6 +443,25 @@ void perform_election() {
     }
 }
 
+/** Join the current master: first SYN after a random delay, then backoff */
+void run_join() {
+    uint32_t master = (my_role == EDTSP_ROLE_SLAVE) ? master_id : 0;
+    unsigned long now = millis();
+    
+    if (master != join_master) {
+        join_master = master;
+        join_established = false;
+        join_rto_ms = 0;
+        join_due_ms = now + esp_random() % JOIN_JITTER_MS;
+    }
+    if (!join_master || join_established || (long)(now - join_due_ms) < 0) return;
+    
+    send_handshake(EDTSP_HANDSHAKE_SYN, join_master);
+    join_rto_ms = join_rto_ms ? join_rto_ms * 2 : JOIN_RTO_MS;
+    if (join_rto_ms > JOIN_RTO_MAX_MS) join_rto_ms = JOIN_RTO_MAX_MS;
+    join_due_ms = now + join_rto_ms - join_rto_ms / 4 + esp_random() % (join_rto_ms / 2);
+}
+
 uint8_t get_active_device_count() {
     uint8_t count = 1; // Self
     for (int i = 0; i < device_count; i++) {
@@ -261,32 +484,231 @@ void handle_discovery(EDTSPDiscoveryPacket* pkt) {
 }
 
 void handle_heartbeat(EDTSPHeartbeatPacket* pkt) {
-    uint32_t uptime = ntohl(pkt->uptime_ms);
+    edtsp_decode_heartbeat(pkt);
     
     Serial.printf("[RX] HEARTBEAT from 0x%08X: Role=%s, Uptime=%u ms\n",
-                 pkt->header.source_id, edtsp_role_name(pkt->role), uptime);
+                 pkt->header.source_id, edtsp_role_name(pkt->role), pkt->uptime_ms);
     
     update_device(pkt->header.source_id, pkt->role);
     perform_election();
 }
 
-void receive_packets() {
+void handle_handshake(EDTSPHandshakePacket* pkt) {
+    edtsp_decode_handshake(pkt);
+    if (pkt->target_id != my_device_id) return;
+    
+    // Master side is stateless here: every SYN gets a SYN-ACK
+    if (pkt->handshake_step == EDTSP_HANDSHAKE_SYN && my_role == EDTSP_ROLE_MASTER) {
+        send_handshake(EDTSP_HANDSHAKE_SYN_ACK, pkt->header.source_id);
+        return;
+    }
+    if (pkt->handshake_step != EDTSP_HANDSHAKE_SYN_ACK || pkt->header.source_id != join_master) return;
+    
+    // A retransmitted SYN-ACK means our ACK was lost: answer again
+    send_handshake(EDTSP_HANDSHAKE_ACK, join_master);
+    if (!join_established) {
+        join_established = true;
+        Serial.printf("[JOIN] Established with master 0x%08X\n", join_master);
+    }
+}
+
+void handle_probe(EDTSPProbePacket* pkt, uint64_t rx_us) {
+    edtsp_decode_probe(pkt);
+    
+    // Only answer requests addressed to us; ESP32 does not originate probes
+    if (pkt->kind != EDTSP_PROBE_REQUEST) return;
+    if (pkt->target_id != my_device_id) return;
+    
+    send_probe_echo(pkt, rx_us);
+}
+
+void handle_sync(EDTSPSyncPacket* pkt, uint64_t rx_us) {
+    edtsp_decode_sync(pkt);
+    
+    if (pkt->kind != EDTSP_SYNC_REQUEST) return;
+    if (pkt->target_id != my_device_id) return;
+    
+    send_sync_reply(pkt, rx_us);
+}
+
+uint8_t apply_output(const EDTSPActuatePacket* cmd) {
+    if (cmd->channel != 0) return EDTSP_ACTUATE_STATUS_REJECTED;
+    
+    if (cmd->output_id == OUTPUT_RELAY) {
+        digitalWrite(RELAY_PIN, cmd->value ? HIGH : LOW);
+    } else if (cmd->output_id == OUTPUT_PWM) {
+        if (cmd->value > 10000) return EDTSP_ACTUATE_STATUS_REJECTED;
+        analogWrite(PWM_PIN, cmd->value * 255 / 10000); // 0.01 % -> 8-bit duty
+    } else {
+        return EDTSP_ACTUATE_STATUS_NO_OUTPUT;
+    }
+    return EDTSP_ACTUATE_STATUS_OK;
+}
+
+void handle_actuate(EDTSPActuatePacket* pkt, uint64_t rx_us) {
+    edtsp_decode_actuate(pkt);
+    
+    if (pkt->kind != EDTSP_ACTUATE_COMMAND) return;
+    if (pkt->target_id != my_device_id) return;
+    
+    if (pkt->header.source_id != actuate_master) {
+        actuate_master = pkt->header.source_id;
+        actuate_count = 0;
+        actuate_next = 0;
+    }
+    
+    for (uint8_t i = 0; i < actuate_count; i++) {
+        if (actuate_seqs[i] == pkt->act_seq) {
+            send_actuate_ack(pkt, actuate_status[i], rx_us);
+            return;
+        }
+    }
+    
+    uint8_t status = apply_output(pkt);
+    actuate_seqs[actuate_next] = pkt->act_seq;
+    actuate_status[actuate_next] = status;
+    actuate_next = (actuate_next + 1) % ACTUATE_HISTORY;
+    if (actuate_count < ACTUATE_HISTORY) actuate_count++;
+    
+    send_actuate_ack(pkt, status, rx_us);
+}
+
+/** Binary search of the sorted, big-endian target list in the packet body */
+bool group_addressed(const EDTSPGroupConfigPacket* pkt) {
+    if (pkt->selector == EDTSP_GROUP_ALL) return true;
+    if (pkt->selector == EDTSP_GROUP_CAPS) {
+        return (MY_CAPABILITIES & pkt->capabilities) == pkt->capabilities;
+    }
+    if (pkt->selector != EDTSP_GROUP_IDS) return false;
+    
+    const uint8_t* ids = pkt->body + pkt->setting_count * 4;
+    int lo = 0;
+    int hi = (int)pkt->target_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        const uint8_t* p = ids + mid * 4;
+        uint32_t id = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        if (id == my_device_id) return true;
+        if (id < my_device_id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return false;
+}
+
+void handle_config(EDTSPConfigPacket* pkt, int len) {
+    edtsp_decode_config(pkt);
+    if (pkt->target_id != my_device_id || pkt->sensor_id >= 16) return;
+    
+    // Older masters send CONFIG without the report-by-exception / window fields.
+    // pack_samples is ignored: this node sends samples unpacked, which masters accept.
+    // Ingest assignments (EDTSP_CONFIG_NO_SENSOR) are skipped above: DATA stays on the group.
+    bool report = len >= (int)offsetof(EDTSPConfigPacket, window_ms);
+    bool window = len >= (int)offsetof(EDTSPConfigPacket, pack_samples);
+    SensorReport* r = &sensor_report[pkt->sensor_id];
+    sensor_rate_ms[pkt->sensor_id] = pkt->enable ? pkt->sampling_rate_ms : 0;
+    r->deadband = report ? pkt->deadband : 0;
+    r->max_silence_ms = report ? pkt->max_silence_ms : 0;
+    r->reported = false;                         // Next sample goes out
+    r->window_ms = window ? pkt->window_ms : 0;
+    r->win_count = 0;
+    r->avg_count = 0;
+    
+    Serial.printf("[RX] CONFIG: sensor %u every %u ms, deadband %u, max silence %u ms, window %u ms\n",
+                  pkt->sensor_id, sensor_rate_ms[pkt->sensor_id], r->deadband, r->max_silence_ms,
+                  r->window_ms);
+}
+
+void handle_group_config(EDTSPGroupConfigPacket* pkt, int len) {
+    edtsp_decode_group_config(pkt);
+    
+    if (len < (int)offsetof(EDTSPGroupConfigPacket, body) + pkt->body_len) return;
+    if ((pkt->setting_count + pkt->target_count) * 4 > pkt->body_len) return;
+    if (!group_addressed(pkt)) return;
+    
+    for (int i = 0; i < pkt->setting_count; i++) {
+        const uint8_t* p = pkt->body + i * 4;
+        if (p[0] >= 16) continue;
+        sensor_rate_ms[p[0]] = p[1] ? (uint16_t)((p[2] << 8) | p[3]) : 0;
+        Serial.printf("[RX] GROUP_CONFIG: sensor %u every %u ms\n", p[0], sensor_rate_ms[p[0]]);
+    }
+}
+
+void handle_credit(EDTSPCreditPacket* pkt) {
+    edtsp_decode_credit(pkt);
+    if (pkt->target_id && pkt->target_id != my_device_id) return;
+    
+    if (pkt->max_fps != flow_max_fps) {
+        Serial.printf("[RX] CREDIT: cap %u frames/s (master queue %u%%)\n", pkt->max_fps, pkt->queue_pct);
+    }
+    flow_max_fps = pkt->max_fps ? pkt->max_fps : 1;
+    flow_expires_ms = millis() + (pkt->lifetime_ms ? pkt->lifetime_ms : 3000);
+}
+
+/** Measure the DATA rate once per second; each level halves it */
+void flow_tick() {
+    unsigned long now = millis();
+    if (flow_max_fps != FLOW_UNLIMITED && (long)(now - flow_expires_ms) >= 0) {
+        flow_max_fps = FLOW_UNLIMITED;           // Cap lapsed without a refresh
+    }
+    
+    unsigned long elapsed = now - flow_period_start;
+    if (elapsed < FLOW_RATE_MS) return;
+    
+    uint32_t rate = (uint32_t)((uint64_t)flow_frames * 1000 / elapsed);
+    flow_frames = 0;
+    flow_period_start = now;
+    
+    uint8_t level = flow_level;
+    if (flow_max_fps != FLOW_UNLIMITED && rate > flow_max_fps) {
+        for (uint32_t r = rate; r > flow_max_fps && level < FLOW_MAX_LEVEL; r >>= 1) level++;
+    } else if (level && (flow_max_fps == FLOW_UNLIMITED || rate * 2 <= flow_max_fps)) {
+        level--;
+    }
+    if (level != flow_level) {
+        Serial.printf("[FLOW] Sending %u frames/s: averaging %u sample(s)\n", rate, 1u << level);
+        flow_level = level;
+    }
+}
+
+/** @return false once no datagram is pending */
+bool receive_packets() {
     int packet_size = udp.parsePacket();
-    if (packet_size == 0) return;
+    if (packet_size == 0) return false;
+    
+    uint64_t rx_us = (uint64_t)esp_timer_get_time();
     
     uint8_t buffer[512];
     int len = udp.read(buffer, sizeof(buffer));
     
-    if (len < sizeof(EDTSPHeader)) return;
+    if (len < (int)sizeof(EDTSPHeader)) return true;
     
     // Parse header
     EDTSPHeader* header = (EDTSPHeader*)buffer;
     uint16_t magic = ntohs(header->magic);
     uint32_t source_id = ntohl(header->source_id);
     
+    // v2 frame: rebase to a v1 header directly in front of the payload
+    if (magic == EDTSP_MAGIC_V2) {
+        if (len < (int)sizeof(EDTSPHeaderV2)) return true;
+        
+        EDTSPHeaderV2 v2;
+        memcpy(&v2, buffer, sizeof(v2));
+        if (v2.header_len < sizeof(EDTSPHeaderV2) || v2.header_len > len) return true;
+        
+        uint16_t payload_len = ntohs(v2.payload_len);
+        int offset = v2.header_len - sizeof(EDTSPHeader);
+        memmove(buffer, buffer + offset, len - offset);
+        len -= offset;
+        
+        header->type = v2.type;
+        header->payload_len = payload_len > EDTSP_MAX_PAYLOAD ? EDTSP_MAX_PAYLOAD : payload_len;
+        source_id = ntohl(v2.source_id);
+        magic = EDTSP_MAGIC;
+    }
+    
     // Validate
-    if (magic != EDTSP_MAGIC) return;
-    if (source_id == my_device_id) return; // Ignore own packets
+    if (magic != EDTSP_MAGIC) return true;
+    if (source_id == my_device_id) return true; // Ignore own packets
     
     // Update header with host byte order
     header->magic = magic;
@@ -299,18 +721,184 @@ void receive_packets() {
                 handle_discovery((EDTSPDiscoveryPacket*)buffer);
             }
             break;
-            
+        
         case EDTSP_TYPE_HEARTBEAT:
             if (len >= sizeof(EDTSPHeartbeatPacket)) {
                 handle_heartbeat((EDTSPHeartbeatPacket*)buffer);
             }
             break;
-            
+        
+        case EDTSP_TYPE_HANDSHAKE:
+            if (len >= (int)offsetof(EDTSPHandshakePacket, desc_len)) {
+                handle_handshake((EDTSPHandshakePacket*)buffer);
+            }
+            break;
+        
+        case EDTSP_TYPE_PROBE:
+            if (len >= sizeof(EDTSPProbePacket)) {
+                handle_probe((EDTSPProbePacket*)buffer, rx_us);
+            }
+            break;
+        
+        case EDTSP_TYPE_SYNC:
+            if (len >= sizeof(EDTSPSyncPacket)) {
+                handle_sync((EDTSPSyncPacket*)buffer, rx_us);
+            }
+            break;
+        
+        case EDTSP_TYPE_CONFIG:
+            if (len >= (int)offsetof(EDTSPConfigPacket, deadband)) {
+                handle_config((EDTSPConfigPacket*)buffer, len);
+            }
+            break;
+        
+        case EDTSP_TYPE_GROUP_CONFIG:
+            if (len >= (int)offsetof(EDTSPGroupConfigPacket, body)) {
+                handle_group_config((EDTSPGroupConfigPacket*)buffer, len);
+            }
+            break;
+        
+        case EDTSP_TYPE_ACTUATE:
+            if (len >= sizeof(EDTSPActuatePacket)) {
+                handle_actuate((EDTSPActuatePacket*)buffer, rx_us);
+            }
+            break;
+        
+        case EDTSP_TYPE_CREDIT:
+            if (len >= sizeof(EDTSPCreditPacket)) {
+                handle_credit((EDTSPCreditPacket*)buffer);
+            }
+            break;
+        
         default:
             Serial.printf("[RX] Packet type %s from 0x%08X\n",
                          edtsp_type_name(header->type), source_id);
             break;
     }
+    return true;
+}
+
+// ============================================================================
+// SAMPLING (report by exception)
+// ============================================================================
+
+/**
+ * Read a sensor in raw units
+ * 
+ * The chip temperature stands in for the DHT22 until its driver is wired;
+ * sensors without a reader are not sampled.
+ */
+bool read_sensor(uint8_t sensor, int32_t* value) {
+    switch (sensor) {
+        case 0:
+            *value = (int32_t)(temperatureRead() * 10.0f);  // 0.1 C
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** Bitwise integer square root (floor) */
+uint32_t isqrt64(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = 1ull << 62;
+    
+    while (bit > x) bit >>= 2;
+    while (bit) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+/**
+ * Fold a sample into the sensor's tumbling window (edtsp_window.h)
+ * 
+ * Per sample: two compares and three adds. The window closing on this
+ * sample is sent as min, max, mean, rms i32/u32 and count u16.
+ */
+void window_sample(uint8_t sensor, SensorReport* r, int32_t value, unsigned long now) {
+    if (r->win_count && (now - r->win_start_ms >= r->window_ms || r->win_count == 0xFFFF)) {
+        uint8_t record[18];
+        int64_t half = r->win_count / 2;
+        int64_t sum = r->win_sum;
+        put_u32(record, (uint32_t)r->win_min);
+        put_u32(record + 4, (uint32_t)r->win_max);
+        put_u32(record + 8, (uint32_t)(int32_t)((sum >= 0 ? sum + half : sum - half) / r->win_count));
+        put_u32(record + 12, isqrt64(r->win_sum_sq / r->win_count));
+        record[16] = (uint8_t)(r->win_count >> 8);
+        record[17] = (uint8_t)r->win_count;
+        send_data(sensor, record, sizeof(record), r->win_start_ms);
+        r->win_count = 0;
+    }
+    
+    if (!r->win_count) {
+        r->win_start_ms = now;
+        r->win_min = value;
+        r->win_max = value;
+        r->win_sum = 0;
+        r->win_sum_sq = 0;
+    }
+    if (value < r->win_min) r->win_min = value;
+    if (value > r->win_max) r->win_max = value;
+    r->win_sum += value;
+    r->win_sum_sq += (uint64_t)((int64_t)value * value);
+    r->win_count++;
+}
+
+/** Sample due sensors; summarize per window, or send moves past the deadband / after max silence */
+void sample_sensors() {
+    unsigned long now = millis();
+    
+    for (uint8_t i = 0; i < 16; i++) {
+        SensorReport* r = &sensor_report[i];
+        if (!sensor_rate_ms[i] || (long)(now - r->next_sample_ms) < 0) continue;
+        r->next_sample_ms = now + sensor_rate_ms[i];
+        
+        int32_t value;
+        if (!read_sensor(i, &value)) continue;
+        if (r->window_ms) {
+            window_sample(i, r, value, now);
+            continue;
+        }
+        
+        // Over the master's cap: report the average of 2^level samples,
+        // stamped with the first one
+        if (!r->avg_count) {
+            r->avg_sum = 0;
+            r->avg_first_ms = now;
+        }
+        r->avg_sum += value;
+        if (++r->avg_count < (1u << flow_level)) continue;
+        int64_t half = r->avg_count / 2;
+        value = (int32_t)((r->avg_sum >= 0 ? r->avg_sum + half : r->avg_sum - half) / r->avg_count);
+        unsigned long sample_ms = r->avg_first_ms;
+        r->avg_count = 0;
+        
+        r->seq++;                                // Every sample, sent or not
+        
+        int32_t delta = value - r->last_value;
+        if (delta < 0) delta = -delta;
+        bool moved = !r->reported || r->deadband == 0 || delta > r->deadband;
+        bool overdue = r->max_silence_ms && now - r->last_ms >= r->max_silence_ms;
+        if (!moved && !overdue) continue;
+        
+        r->reported = true;
+        r->last_value = value;
+        r->last_ms = now;
+        
+        // Record: value i32, sample sequence u16 (big-endian)
+        uint8_t record[6];
+        put_u32(record, (uint32_t)value);
+        record[4] = (uint8_t)(r->seq >> 8);
+        record[5] = (uint8_t)r->seq;
+        send_data(i, record, sizeof(record), sample_ms);
+    }
 }
 
 // ============================================================================
@@ -341,6 +929,10 @@ void setup() {
         while(1) delay(1000);
     }
     
+    pinMode(RELAY_PIN, OUTPUT);
+    digitalWrite(RELAY_PIN, LOW);
+    pinMode(PWM_PIN, OUTPUT);
+    
     // Send initial discovery
     send_discovery();
     
@@ -375,8 +967,12 @@ void loop() {
         last_status = now;
     }
     
-    // Receive packets
-    receive_packets();
+    run_join();
+    flow_tick();
+    sample_sensors();
+    
+    // Receive packets: drain the socket so a command never waits behind a sleep
+    while (receive_packets()) {}
     
-    delay(10); // Small delay to prevent watchdog issues
+    delay(1); // Yield to the WiFi task / watchdog
 }
@@ -0,0 +1,533 @@
+/**
+ * @file edtsp_packets.h
+ * @brief EDTSP Packet Layouts and Codecs
+ * 
+ * GENERATED by tools/codegen/edtsp_codegen.py from tools/codegen/edtsp.schema - do not edit.
+ * Run `make generate` after changing the schema.
+ * 
+ * Included by protocol.h; relies on EDTSPHeader and EDTSPCapabilityMask.
+ */
+
+#ifndef EDTSP_PACKETS_H
+#define EDTSP_PACKETS_H
+
+// ============================================================================
+// PACKET TYPES
+// ============================================================================
+
+/** Packet type enumeration */
+typedef enum {
+    EDTSP_TYPE_DISCOVERY     = 1,  /**< Device announcement and presence declaration */
+    EDTSP_TYPE_HEARTBEAT     = 2,  /**< Liveness signal + Master/Slave role status */
+    EDTSP_TYPE_HANDSHAKE     = 3,  /**< 3-way handshake + Capability mask reporting */
+    EDTSP_TYPE_CONFIG        = 4,  /**< Master→Slave configuration (sampling rates) */
+    EDTSP_TYPE_DATA          = 5,  /**< Sensor data stream */
+    EDTSP_TYPE_PROBE         = 6,  /**< Latency probe / echo (microsecond timestamps) */
+    EDTSP_TYPE_SYNC          = 7,  /**< Master-driven clock synchronization */
+    EDTSP_TYPE_ACTUATE       = 8,  /**< Relay/PWM output command and acknowledgement */
+    EDTSP_TYPE_GROUP_CONFIG  = 9,  /**< Master→Slaves configuration for a set of targets */
+    EDTSP_TYPE_CREDIT        = 10,  /**< Master→Slaves flow control (DATA frame budget) */
+    EDTSP_TYPE_ZONE_SUMMARY  = 11   /**< Sub-master→Top master zone aggregate (uplink group) */
+} EDTSPPacketType;
+
+/** Highest valid packet type */
+#define EDTSP_TYPE_MAX EDTSP_TYPE_ZONE_SUMMARY
+
+// ============================================================================
+// PACKET STRUCTURES
+// ============================================================================
+
+#pragma pack(push, 1)
+
+/**
+ * Type 1: DISCOVERY Packet
+ * 
+ * Sent by devices when joining network or periodically
+ * Announces presence and interface type
+ */
+typedef struct {
+    EDTSPHeader header;              /**< Standard header */
+    uint8_t     interface_type;      /**< EDTSPInterfaceType */
+    uint8_t     version;             /**< Protocol version */
+    char        device_name[32];     /**< Human-readable device name */
+} EDTSPDiscoveryPacket;
+
+/**
+ * Type 2: HEARTBEAT Packet
+ * 
+ * Periodic liveness signal
+ * Declares current role and uptime, and the sender's ingest socket
+ * when it takes sharded DATA (see edtsp_shard.h)
+ */
+typedef struct {
+    EDTSPHeader header;              /**< Standard header */
+    uint8_t     role;                /**< EDTSPRole (Master/Slave) */
+    uint32_t    uptime_ms;           /**< Device uptime in milliseconds */
+    uint8_t     active_devices;      /**< Number of known active devices (saturates at 255) */
+    uint32_t    ingest_addr;         /**< IPv4 address of the ingest socket (0 = not an ingest node) */
+    uint16_t    ingest_port;         /**< UDP port of the ingest socket */
+} EDTSPHeartbeatPacket;
+
+/**
+ * Type 3: HANDSHAKE Packet (ACK/Capability Report)
+ * 
+ * Three-way handshake and capability exchange
+ * Slave reports sensors and features to Master
+ */
+typedef struct {
+    EDTSPHeader         header;           /**< Standard header */
+    uint8_t             handshake_step;   /**< EDTSP_HANDSHAKE_SYN / SYN_ACK / ACK */
+    uint32_t            target_id;        /**< Target device ID (for handshake) */
+    EDTSPCapabilityMask capabilities;     /**< Available sensors/features (16-bit mask) */
+    uint8_t             interface_type;   /**< Current active interface */
+    uint8_t             desc_len;         /**< Bytes of capability descriptors (0 = mask only) */
+    uint8_t             descriptors[200]; /**< TLV records (edtsp_capdesc.h), SYN only */
+} EDTSPHandshakePacket;
+
+/**
+ * Type 4: CONFIG Packet
+ * 
+ * Master sends configuration to Slave
+ * Specifies which sensors to sample and at what rate, and when a sample
+ * is worth sending (report by exception, see edtsp_deadband.h) or summarized
+ * over a window (see edtsp_window.h) or packed into blocks (see edtsp_pack.h).
+ * With sensor_id EDTSP_CONFIG_NO_SENSOR it sets no sensor but names the ingest
+ * node the slave sends its DATA to (see edtsp_shard.h)
+ */
+typedef struct {
+    EDTSPHeader header;              /**< Standard header */
+    uint32_t    target_id;           /**< Target Slave device ID */
+    uint8_t     sensor_id;           /**< Sensor to configure (capability bit index) */
+    uint16_t    sampling_rate_ms;    /**< Sampling interval in milliseconds */
+    uint8_t     enable;              /**< 1=enable, 0=disable */
+    uint16_t    deadband;            /**< Send when the value moves more than this (raw units, 0 = every sample) */
+    uint32_t    max_silence_ms;      /**< Send at least this often (0 = no deadline) */
+    uint32_t    window_ms;           /**< Send one min/max/mean/RMS summary per window (0 = samples) */
+    uint8_t     pack_samples;        /**< Samples per packed DATA block (0 = one per frame, 255 = fill the frame) */
+    uint32_t    ingest_id;           /**< Send DATA to this node (0 = the master, over the group) */
+    uint32_t    ingest_addr;         /**< IPv4 address of its ingest socket */
+    uint16_t    ingest_port;         /**< UDP port of its ingest socket */
+} EDTSPConfigPacket;
+
+/**
+ * Type 5: DATA Packet
+ * 
+ * Slave sends sensor data to Master
+ * Contains raw sensor reading with timestamp
+ * v2 flags AGGREGATED|COMPRESSED: a packed sample block starts at data and runs
+ * to the end of the payload, data_len 0 (see edtsp_pack.h)
+ */
+typedef struct {
+    EDTSPHeader header;              /**< Standard header */
+    uint8_t     sensor_id;           /**< Sensor ID (capability bit index) */
+    uint32_t    timestamp_ms;        /**< Timestamp in milliseconds */
+    uint8_t     data_len;            /**< Length of sensor data */
+    uint8_t     data[64];            /**< Raw sensor data (flexible, max 64 bytes) */
+} EDTSPDataPacket;
+
+/**
+ * Type 6: PROBE Packet (request / echo)
+ * 
+ * Originator sends a request stamped with t1; the target echoes it back
+ * with its own receive (t2) and transmit (t3) times. With the local
+ * receive time t4: RTT = (t4 - t1) - (t3 - t2),
+ * clock offset = ((t2 - t1) + (t3 - t4)) / 2.
+ */
+typedef struct {
+    EDTSPHeader header;              /**< Standard header */
+    uint8_t     kind;                /**< EDTSP_PROBE_REQUEST / EDTSP_PROBE_ECHO */
+    uint8_t     interface_type;      /**< Interface the request was sent on */
+    uint16_t    probe_seq;           /**< Originator sequence number */
+    uint32_t    target_id;           /**< Request: responder ID, Echo: originator ID */
+    uint64_t    t1_us;               /**< Originator transmit time (originator clock) */
+    uint64_t    t2_us;               /**< Responder receive time (responder clock) */
+    uint64_t    t3_us;               /**< Responder transmit time (responder clock) */
+} EDTSPProbePacket;
+
+/**
+ * Type 7: SYNC Packet (request / reply)
+ * 
+ * Master stamps t1 with its clock; the slave answers with t2/t3 taken
+ * from its sample clock (the 64-bit microsecond uptime that DATA
+ * timestamp_ms is derived from). The master computes offset and drift
+ * per slave and converts DATA timestamps to its own timebase.
+ */
+typedef struct {
+    EDTSPHeader header;              /**< Standard header */
+    uint8_t     kind;                /**< EDTSP_SYNC_REQUEST / EDTSP_SYNC_REPLY */
+    uint8_t     reserved;            /**< Always 0 */
+    uint16_t    sync_seq;            /**< Master sequence number */
+    uint32_t    target_id;           /**< Request: slave ID, Reply: master ID */
+    uint64_t    t1_us;               /**< Master transmit time (master clock) */
+    uint64_t    t2_us;               /**< Slave receive time (slave sample clock) */
+    uint64_t    t3_us;               /**< Slave transmit time (slave sample clock) */
+} EDTSPSyncPacket;
+
+/**
+ * Type 8: ACTUATE Packet (command / ack)
+ * 
+ * Master drives an output on a slave (EDTSP_CAP_RELAY, EDTSP_CAP_PWM).
+ * The slave applies it through its registered output callback and
+ * acknowledges with the same sequence number, echoing t1 and adding
+ * its receive (t2) and applied (t3) times. Retransmitted commands are
+ * acknowledged again but applied once.
+ */
+typedef struct {
+    EDTSPHeader header;              /**< Standard header */
+    uint8_t     kind;                /**< EDTSP_ACTUATE_COMMAND / EDTSP_ACTUATE_ACK */
+    uint8_t     priority;            /**< EDTSP_ACTUATE_PRIO_* */
+    uint16_t    act_seq;             /**< Master sequence number (echoed in the ack) */
+    uint32_t    target_id;           /**< Command: slave ID, Ack: master ID */
+    uint8_t     output_id;           /**< Output type (capability bit index: 14=relay, 15=PWM) */
+    uint8_t     channel;             /**< Output channel on the slave */
+    uint8_t     status;              /**< Ack: EDTSP_ACTUATE_STATUS_* (0 in commands) */
+    uint8_t     reserved;            /**< Always 0 */
+    uint32_t    value;               /**< Relay: 0/1, PWM: duty in 0.01% (0-10000) */
+    uint64_t    t1_us;               /**< Master transmit time (master clock) */
+    uint64_t    t2_us;               /**< Slave receive time (slave clock) */
+    uint64_t    t3_us;               /**< Output callback returned (slave clock) */
+} EDTSPActuatePacket;
+
+/**
+ * Type 9: GROUP_CONFIG Packet
+ * 
+ * One packet configures many slaves: body holds setting_count sensor
+ * settings (4 bytes each: sensor_id, enable, sampling_rate_ms) followed
+ * by target_count slave IDs (u32, ascending, network order) for the IDS
+ * selector. Slaves binary-search the ID list (see edtsp_group.h).
+ */
+typedef struct {
+    EDTSPHeader         header;        /**< Standard header */
+    uint8_t             selector;      /**< EDTSP_GROUP_ALL / IDS / CAPS */
+    uint8_t             setting_count; /**< Sensor settings in body */
+    uint16_t            config_seq;    /**< Master sequence number */
+    EDTSPCapabilityMask capabilities;  /**< CAPS: targets have all of these bits */
+    uint16_t            target_count;  /**< IDS: slave IDs in body */
+    uint8_t             body_len;      /**< Bytes used in body */
+    uint8_t             body[246];     /**< Settings, then sorted target IDs */
+} EDTSPGroupConfigPacket;
+
+/**
+ * Type 10: CREDIT Packet
+ * 
+ * Master advertises how many DATA frames per second a slave may send,
+ * derived from its receive queue depth (see edtsp_flow.h). A slave over
+ * the limit averages consecutive samples instead of dropping them. The
+ * limit lapses if it is not refreshed within lifetime_ms.
+ */
+typedef struct {
+    EDTSPHeader header;              /**< Standard header */
+    uint32_t    target_id;           /**< Slave ID, 0 = every slave */
+    uint16_t    credit_seq;          /**< Master sequence number */
+    uint16_t    max_fps;             /**< DATA frames per second per slave (0xFFFF = unlimited) */
+    uint16_t    lifetime_ms;         /**< Limit lapses without a refresh */
+    uint8_t     queue_pct;           /**< Master receive queue fill (diagnostic) */
+    uint8_t     reserved;            /**< Always 0 */
+} EDTSPCreditPacket;
+
+/**
+ * Type 11: ZONE_SUMMARY Packet
+ * 
+ * Sent once per heartbeat interval by the master of a zone (sub-master)
+ * on the uplink group, where sub-masters elect a top master. Carries
+ * the zone's membership (count, digest, changes) and its DATA over the
+ * interval: frame and byte totals, then sensor_count records of
+ * { sensor_id u8, samples u32, min i16, max i16, mean i16 }, big-endian
+ * (see edtsp_zone.h).
+ */
+typedef struct {
+    EDTSPHeader header;              /**< Standard header */
+    uint16_t    zone_id;             /**< Zone of the sender (1..EDTSP_ZONE_MAX_ID) */
+    uint8_t     role;                /**< MASTER if the sender is the top master */
+    uint8_t     sensor_count;        /**< Sensor records in body */
+    uint16_t    members;             /**< Active devices in the zone, sub-master included */
+    uint16_t    joins;               /**< Devices that joined during the interval */
+    uint16_t    leaves;              /**< Devices that timed out during the interval */
+    uint16_t    reserved;            /**< Always 0 */
+    uint32_t    member_digest;       /**< XOR of hashed member IDs (order independent) */
+    uint32_t    interval_ms;         /**< Time covered by the DATA totals */
+    uint32_t    data_frames;         /**< DATA frames ingested by the sub-master */
+    uint32_t    data_bytes;          /**< DATA payload bytes ingested */
+    uint8_t     body_len;            /**< Bytes used in body */
+    uint8_t     body[176];           /**< Per-sensor aggregates */
+} EDTSPZoneSummaryPacket;
+
+#pragma pack(pop)
+
+_Static_assert(sizeof(EDTSPDiscoveryPacket) == 42, "EDTSPDiscoveryPacket must be 42 bytes");
+_Static_assert(sizeof(EDTSPHeartbeatPacket) == 20, "EDTSPHeartbeatPacket must be 20 bytes");
+_Static_assert(sizeof(EDTSPHandshakePacket) == 217, "EDTSPHandshakePacket must be 217 bytes");
+_Static_assert(sizeof(EDTSPConfigPacket) == 37, "EDTSPConfigPacket must be 37 bytes");
+_Static_assert(sizeof(EDTSPDataPacket) == 78, "EDTSPDataPacket must be 78 bytes");
+_Static_assert(sizeof(EDTSPProbePacket) == 40, "EDTSPProbePacket must be 40 bytes");
+_Static_assert(sizeof(EDTSPSyncPacket) == 40, "EDTSPSyncPacket must be 40 bytes");
+_Static_assert(sizeof(EDTSPActuatePacket) == 48, "EDTSPActuatePacket must be 48 bytes");
+_Static_assert(sizeof(EDTSPGroupConfigPacket) == 263, "EDTSPGroupConfigPacket must be 263 bytes");
+_Static_assert(sizeof(EDTSPCreditPacket) == 20, "EDTSPCreditPacket must be 20 bytes");
+_Static_assert(sizeof(EDTSPZoneSummaryPacket) == 213, "EDTSPZoneSummaryPacket must be 213 bytes");
+
+/** HANDSHAKE steps */
+#define EDTSP_HANDSHAKE_SYN     1
+#define EDTSP_HANDSHAKE_SYN_ACK 2
+#define EDTSP_HANDSHAKE_ACK     3
+
+/** PROBE packet kinds */
+#define EDTSP_PROBE_REQUEST 1
+#define EDTSP_PROBE_ECHO    2
+
+/** SYNC packet kinds */
+#define EDTSP_SYNC_REQUEST 1
+#define EDTSP_SYNC_REPLY   2
+
+/** ACTUATE packet kinds */
+#define EDTSP_ACTUATE_COMMAND 1
+#define EDTSP_ACTUATE_ACK     2
+
+/** ACTUATE command priorities */
+#define EDTSP_ACTUATE_PRIO_NORMAL 0
+#define EDTSP_ACTUATE_PRIO_URGENT 1
+
+/** ACTUATE acknowledgement status */
+#define EDTSP_ACTUATE_STATUS_OK        0
+#define EDTSP_ACTUATE_STATUS_NO_OUTPUT 1
+#define EDTSP_ACTUATE_STATUS_REJECTED  2
+
+/** GROUP_CONFIG target selectors */
+#define EDTSP_GROUP_ALL  0
+#define EDTSP_GROUP_IDS  1
+#define EDTSP_GROUP_CAPS 2
+
+// ============================================================================
+// CODECS (payload fields, header handled by edtsp_init_header/parse_header)
+// ============================================================================
+
+// Wire order is big-endian; the swap is selected at compile time so every
+// codec is a straight sequence of byte-swap instructions without branches
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define EDTSP_WIRE16(x) (x)
+#define EDTSP_WIRE32(x) (x)
+#define EDTSP_WIRE64(x) (x)
+#else
+#define EDTSP_WIRE16(x) __builtin_bswap16(x)
+#define EDTSP_WIRE32(x) __builtin_bswap32(x)
+#define EDTSP_WIRE64(x) __builtin_bswap64(x)
+#endif
+
+/** DISCOVERY payload: host to network byte order */
+static inline void edtsp_encode_discovery(EDTSPDiscoveryPacket *pkt) {
+    (void)pkt;
+}
+
+/** DISCOVERY payload: network to host byte order */
+static inline void edtsp_decode_discovery(EDTSPDiscoveryPacket *pkt) {
+    (void)pkt;
+}
+
+/** HEARTBEAT payload: host to network byte order */
+static inline void edtsp_encode_heartbeat(EDTSPHeartbeatPacket *pkt) {
+    pkt->uptime_ms = EDTSP_WIRE32(pkt->uptime_ms);
+    pkt->ingest_addr = EDTSP_WIRE32(pkt->ingest_addr);
+    pkt->ingest_port = EDTSP_WIRE16(pkt->ingest_port);
+}
+
+/** HEARTBEAT payload: network to host byte order */
+static inline void edtsp_decode_heartbeat(EDTSPHeartbeatPacket *pkt) {
+    pkt->uptime_ms = EDTSP_WIRE32(pkt->uptime_ms);
+    pkt->ingest_addr = EDTSP_WIRE32(pkt->ingest_addr);
+    pkt->ingest_port = EDTSP_WIRE16(pkt->ingest_port);
+}
+
+/** HANDSHAKE payload: host to network byte order */
+static inline void edtsp_encode_handshake(EDTSPHandshakePacket *pkt) {
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->capabilities = EDTSP_WIRE16(pkt->capabilities);
+}
+
+/** HANDSHAKE payload: network to host byte order */
+static inline void edtsp_decode_handshake(EDTSPHandshakePacket *pkt) {
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->capabilities = EDTSP_WIRE16(pkt->capabilities);
+}
+
+/** CONFIG payload: host to network byte order */
+static inline void edtsp_encode_config(EDTSPConfigPacket *pkt) {
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->sampling_rate_ms = EDTSP_WIRE16(pkt->sampling_rate_ms);
+    pkt->deadband = EDTSP_WIRE16(pkt->deadband);
+    pkt->max_silence_ms = EDTSP_WIRE32(pkt->max_silence_ms);
+    pkt->window_ms = EDTSP_WIRE32(pkt->window_ms);
+    pkt->ingest_id = EDTSP_WIRE32(pkt->ingest_id);
+    pkt->ingest_addr = EDTSP_WIRE32(pkt->ingest_addr);
+    pkt->ingest_port = EDTSP_WIRE16(pkt->ingest_port);
+}
+
+/** CONFIG payload: network to host byte order */
+static inline void edtsp_decode_config(EDTSPConfigPacket *pkt) {
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->sampling_rate_ms = EDTSP_WIRE16(pkt->sampling_rate_ms);
+    pkt->deadband = EDTSP_WIRE16(pkt->deadband);
+    pkt->max_silence_ms = EDTSP_WIRE32(pkt->max_silence_ms);
+    pkt->window_ms = EDTSP_WIRE32(pkt->window_ms);
+    pkt->ingest_id = EDTSP_WIRE32(pkt->ingest_id);
+    pkt->ingest_addr = EDTSP_WIRE32(pkt->ingest_addr);
+    pkt->ingest_port = EDTSP_WIRE16(pkt->ingest_port);
+}
+
+/** DATA payload: host to network byte order */
+static inline void edtsp_encode_data(EDTSPDataPacket *pkt) {
+    pkt->timestamp_ms = EDTSP_WIRE32(pkt->timestamp_ms);
+}
+
+/** DATA payload: network to host byte order */
+static inline void edtsp_decode_data(EDTSPDataPacket *pkt) {
+    pkt->timestamp_ms = EDTSP_WIRE32(pkt->timestamp_ms);
+}
+
+/** PROBE payload: host to network byte order */
+static inline void edtsp_encode_probe(EDTSPProbePacket *pkt) {
+    pkt->probe_seq = EDTSP_WIRE16(pkt->probe_seq);
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->t1_us = EDTSP_WIRE64(pkt->t1_us);
+    pkt->t2_us = EDTSP_WIRE64(pkt->t2_us);
+    pkt->t3_us = EDTSP_WIRE64(pkt->t3_us);
+}
+
+/** PROBE payload: network to host byte order */
+static inline void edtsp_decode_probe(EDTSPProbePacket *pkt) {
+    pkt->probe_seq = EDTSP_WIRE16(pkt->probe_seq);
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->t1_us = EDTSP_WIRE64(pkt->t1_us);
+    pkt->t2_us = EDTSP_WIRE64(pkt->t2_us);
+    pkt->t3_us = EDTSP_WIRE64(pkt->t3_us);
+}
+
+/** SYNC payload: host to network byte order */
+static inline void edtsp_encode_sync(EDTSPSyncPacket *pkt) {
+    pkt->sync_seq = EDTSP_WIRE16(pkt->sync_seq);
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->t1_us = EDTSP_WIRE64(pkt->t1_us);
+    pkt->t2_us = EDTSP_WIRE64(pkt->t2_us);
+    pkt->t3_us = EDTSP_WIRE64(pkt->t3_us);
+}
+
+/** SYNC payload: network to host byte order */
+static inline void edtsp_decode_sync(EDTSPSyncPacket *pkt) {
+    pkt->sync_seq = EDTSP_WIRE16(pkt->sync_seq);
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->t1_us = EDTSP_WIRE64(pkt->t1_us);
+    pkt->t2_us = EDTSP_WIRE64(pkt->t2_us);
+    pkt->t3_us = EDTSP_WIRE64(pkt->t3_us);
+}
+
+/** ACTUATE payload: host to network byte order */
+static inline void edtsp_encode_actuate(EDTSPActuatePacket *pkt) {
+    pkt->act_seq = EDTSP_WIRE16(pkt->act_seq);
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->value = EDTSP_WIRE32(pkt->value);
+    pkt->t1_us = EDTSP_WIRE64(pkt->t1_us);
+    pkt->t2_us = EDTSP_WIRE64(pkt->t2_us);
+    pkt->t3_us = EDTSP_WIRE64(pkt->t3_us);
+}
+
+/** ACTUATE payload: network to host byte order */
+static inline void edtsp_decode_actuate(EDTSPActuatePacket *pkt) {
+    pkt->act_seq = EDTSP_WIRE16(pkt->act_seq);
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->value = EDTSP_WIRE32(pkt->value);
+    pkt->t1_us = EDTSP_WIRE64(pkt->t1_us);
+    pkt->t2_us = EDTSP_WIRE64(pkt->t2_us);
+    pkt->t3_us = EDTSP_WIRE64(pkt->t3_us);
+}
+
+/** GROUP_CONFIG payload: host to network byte order */
+static inline void edtsp_encode_group_config(EDTSPGroupConfigPacket *pkt) {
+    pkt->config_seq = EDTSP_WIRE16(pkt->config_seq);
+    pkt->capabilities = EDTSP_WIRE16(pkt->capabilities);
+    pkt->target_count = EDTSP_WIRE16(pkt->target_count);
+}
+
+/** GROUP_CONFIG payload: network to host byte order */
+static inline void edtsp_decode_group_config(EDTSPGroupConfigPacket *pkt) {
+    pkt->config_seq = EDTSP_WIRE16(pkt->config_seq);
+    pkt->capabilities = EDTSP_WIRE16(pkt->capabilities);
+    pkt->target_count = EDTSP_WIRE16(pkt->target_count);
+}
+
+/** CREDIT payload: host to network byte order */
+static inline void edtsp_encode_credit(EDTSPCreditPacket *pkt) {
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->credit_seq = EDTSP_WIRE16(pkt->credit_seq);
+    pkt->max_fps = EDTSP_WIRE16(pkt->max_fps);
+    pkt->lifetime_ms = EDTSP_WIRE16(pkt->lifetime_ms);
+}
+
+/** CREDIT payload: network to host byte order */
+static inline void edtsp_decode_credit(EDTSPCreditPacket *pkt) {
+    pkt->target_id = EDTSP_WIRE32(pkt->target_id);
+    pkt->credit_seq = EDTSP_WIRE16(pkt->credit_seq);
+    pkt->max_fps = EDTSP_WIRE16(pkt->max_fps);
+    pkt->lifetime_ms = EDTSP_WIRE16(pkt->lifetime_ms);
+}
+
+/** ZONE_SUMMARY payload: host to network byte order */
+static inline void edtsp_encode_zone_summary(EDTSPZoneSummaryPacket *pkt) {
+    pkt->zone_id = EDTSP_WIRE16(pkt->zone_id);
+    pkt->members = EDTSP_WIRE16(pkt->members);
+    pkt->joins = EDTSP_WIRE16(pkt->joins);
+    pkt->leaves = EDTSP_WIRE16(pkt->leaves);
+    pkt->reserved = EDTSP_WIRE16(pkt->reserved);
+    pkt->member_digest = EDTSP_WIRE32(pkt->member_digest);
+    pkt->interval_ms = EDTSP_WIRE32(pkt->interval_ms);
+    pkt->data_frames = EDTSP_WIRE32(pkt->data_frames);
+    pkt->data_bytes = EDTSP_WIRE32(pkt->data_bytes);
+}
+
+/** ZONE_SUMMARY payload: network to host byte order */
+static inline void edtsp_decode_zone_summary(EDTSPZoneSummaryPacket *pkt) {
+    pkt->zone_id = EDTSP_WIRE16(pkt->zone_id);
+    pkt->members = EDTSP_WIRE16(pkt->members);
+    pkt->joins = EDTSP_WIRE16(pkt->joins);
+    pkt->leaves = EDTSP_WIRE16(pkt->leaves);
+    pkt->reserved = EDTSP_WIRE16(pkt->reserved);
+    pkt->member_digest = EDTSP_WIRE32(pkt->member_digest);
+    pkt->interval_ms = EDTSP_WIRE32(pkt->interval_ms);
+    pkt->data_frames = EDTSP_WIRE32(pkt->data_frames);
+    pkt->data_bytes = EDTSP_WIRE32(pkt->data_bytes);
+}
+
+/** Codec entry (one per packet type) */
+typedef struct {
+    const char *name;              /**< Type name */
+    uint16_t    size;              /**< Packet struct size */
+    uint16_t    min_len;           /**< Smallest valid v1 frame (header + fixed fields) */
+    void      (*encode)(void *pkt);  /**< Payload to network byte order */
+    void      (*decode)(void *pkt);  /**< Payload to host byte order */
+} EDTSPCodec;
+
+/** Dispatch table indexed by packet type (entry 0 unused, src/edtsp_codec.c) */
+extern const EDTSPCodec edtsp_codecs[EDTSP_TYPE_MAX + 1];
+
+/**
+ * Get packet type name (for debugging)
+ * 
+ * @param type Packet type
+ * @return String name
+ */
+static inline const char* edtsp_type_name(uint8_t type) {
+    switch (type) {
+        case EDTSP_TYPE_DISCOVERY:    return "DISCOVERY";
+        case EDTSP_TYPE_HEARTBEAT:    return "HEARTBEAT";
+        case EDTSP_TYPE_HANDSHAKE:    return "HANDSHAKE";
+        case EDTSP_TYPE_CONFIG:       return "CONFIG";
+        case EDTSP_TYPE_DATA:         return "DATA";
+        case EDTSP_TYPE_PROBE:        return "PROBE";
+        case EDTSP_TYPE_SYNC:         return "SYNC";
+        case EDTSP_TYPE_ACTUATE:      return "ACTUATE";
+        case EDTSP_TYPE_GROUP_CONFIG: return "GROUP_CONFIG";
+        case EDTSP_TYPE_CREDIT:       return "CREDIT";
+        case EDTSP_TYPE_ZONE_SUMMARY: return "ZONE_SUMMARY";
+        default:                      return "UNKNOWN";
+    }
+}
+
+#endif // EDTSP_PACKETS_H
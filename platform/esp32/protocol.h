@@ -19,6 +19,9 @@
 #include <stdbool.h>
 
 #ifdef __cplusplus
+#ifndef _Static_assert
+#define _Static_assert static_assert
+#endif
 extern "C" {
 #endif
 
@@ -29,39 +32,55 @@ extern "C" {
 /** Protocol magic number - identifies EDTSP packets */
 #define EDTSP_MAGIC 0xED61
 
-/** Protocol version */
-#define EDTSP_VERSION 1
+/** Protocol v2 magic number - v1 decoders ignore these packets */
+#define EDTSP_MAGIC_V2 0xED62
+
+/** Protocol version (highest version this node can decode) */
+#define EDTSP_VERSION 2
 
 /** Maximum payload size (1 byte length field) */
 #define EDTSP_MAX_PAYLOAD 255
 
+/** Maximum payload size with the v2 header (16-bit length, one MTU) */
+#define EDTSP_MAX_PAYLOAD_V2 1400
+
+/** Per-peer latency probe period (milliseconds) */
+#define EDTSP_PROBE_PERIOD_MS 2000
+
+/** Per-slave clock sync period (milliseconds) */
+#define EDTSP_SYNC_PERIOD_MS 4000
+
 /** Default multicast group */
 #define EDTSP_MULTICAST_ADDR "239.255.0.1"
 
 /** Default UDP port */
 #define EDTSP_PORT 5000
 
+/**
+ * Zones (hierarchical deployments, see edtsp_zone.h): zone z in
+ * 1..EDTSP_ZONE_MAX_ID runs on group 239.255.(1 + z / 256).(z % 256),
+ * port EDTSP_PORT + z. Zone 0 is the flat network above.
+ */
+#define EDTSP_ZONE_MAX_ID 999
+
+/** Group and port where sub-masters meet and elect the top master */
+#define EDTSP_ZONE_UPLINK_ADDR "239.255.0.2"
+#define EDTSP_ZONE_UPLINK_PORT 4999
+
 /** Heartbeat interval (milliseconds) */
 #define EDTSP_HEARTBEAT_INTERVAL_MS 1000
 
 /** Heartbeat timeout (milliseconds) - consider device dead after this */
 #define EDTSP_HEARTBEAT_TIMEOUT_MS 5000
 
+/** Delay before answering a newcomer with our own DISCOVERY (milliseconds) */
+#define EDTSP_DISCOVERY_REPLY_DELAY_MS 500
+
 /** Maximum number of devices in network */
 #define EDTSP_MAX_DEVICES 256
 
-// ============================================================================
-// PACKET TYPES
-// ============================================================================
-
-/** Packet type enumeration */
-typedef enum {
-    EDTSP_TYPE_DISCOVERY  = 1,  /**< Device announcement and presence declaration */
-    EDTSP_TYPE_HEARTBEAT  = 2,  /**< Liveness signal + Master/Slave role status */
-    EDTSP_TYPE_HANDSHAKE  = 3,  /**< 3-way handshake + Capability mask reporting */
-    EDTSP_TYPE_CONFIG     = 4,  /**< Master→Slave configuration (sampling rates) */
-    EDTSP_TYPE_DATA       = 5   /**< Sensor data stream */
-} EDTSPPacketType;
+/** Redundancy trailer suffix (same marker as IEC 62439-3 PRP) */
+#define EDTSP_RCT_SUFFIX 0x88FB
 
 // ============================================================================
 // DEVICE ROLES
@@ -147,81 +166,80 @@ typedef struct {
 _Static_assert(sizeof(EDTSPHeader) == 8, "EDTSPHeader must be 8 bytes");
 
 // ============================================================================
-// PACKET STRUCTURES
+// PROTOCOL HEADER v2 (16 bytes, naturally aligned)
 // ============================================================================
 
-#pragma pack(push, 1)
-
 /**
- * Type 1: DISCOVERY Packet
+ * EDTSP Protocol Header v2 (16 bytes)
  * 
- * Sent by devices when joining network or periodically
- * Announces presence and interface type
+ * Every field sits at an offset that is a multiple of its size, so the
+ * header decodes with aligned loads. Sent only once every known peer has
+ * announced version >= 2 in DISCOVERY; v1 packets are always accepted.
+ * All multi-byte fields are in network byte order (big-endian).
  */
 typedef struct {
-    EDTSPHeader header;              /**< Standard header */
-    uint8_t     interface_type;      /**< EDTSPInterfaceType */
-    uint8_t     version;             /**< Protocol version */
-    char        device_name[32];     /**< Human-readable device name */
-} EDTSPDiscoveryPacket;
+    uint16_t magic;        /**< Protocol identifier: 0xED62 */
+    uint8_t  type;         /**< Packet type */
+    uint8_t  flags;        /**< EDTSP_FLAG_* */
+    uint32_t source_id;    /**< Unique device identifier */
+    uint16_t payload_len;  /**< Payload size in bytes (0-65535) */
+    uint8_t  version;      /**< Header version (2) */
+    uint8_t  header_len;   /**< Header size in bytes (16, room for extension) */
+    uint32_t seq;          /**< Per-source packet sequence number */
+} EDTSPHeaderV2;
+
+_Static_assert(sizeof(EDTSPHeaderV2) == 16, "EDTSPHeaderV2 must be 16 bytes");
+
+/** v2 header flags */
+#define EDTSP_FLAG_AGGREGATED    0x01  /**< Payload carries several records */
+#define EDTSP_FLAG_COMPRESSED    0x02  /**< Payload is compressed */
+#define EDTSP_FLAG_AUTHENTICATED 0x04  /**< MAC tag behind the payload (edtsp_auth.h) */
+#define EDTSP_FLAG_ENCRYPTED     0x10  /**< Payload sealed with an AEAD (edtsp_aead.h) */
 
 /**
- * Type 2: HEARTBEAT Packet
- * 
- * Periodic liveness signal
- * Declares current role and uptime
+ * Decoded frame information (host byte order, both header versions)
  */
 typedef struct {
-    EDTSPHeader header;              /**< Standard header */
-    uint8_t     role;                /**< EDTSPRole (Master/Slave) */
-    uint32_t    uptime_ms;           /**< Device uptime in milliseconds */
-    uint8_t     active_devices;      /**< Number of known active devices */
-} EDTSPHeartbeatPacket;
+    uint8_t  version;      /**< 1 or 2 */
+    uint8_t  type;         /**< Packet type */
+    uint8_t  flags;        /**< EDTSP_FLAG_* (0 for v1) */
+    uint8_t  header_len;   /**< 8 (v1) or 16+ (v2) */
+    uint32_t source_id;    /**< Sender */
+    uint32_t seq;          /**< v2 sequence number (0 for v1) */
+    uint16_t payload_len;  /**< Payload size (up to EDTSP_MAX_PAYLOAD_V2; the v1 view's
+                                 8-bit field saturates at EDTSP_MAX_PAYLOAD) */
+    uint16_t offset;       /**< Start of the v1-layout packet view in the buffer */
+} EDTSPFrameInfo;
 
-/**
- * Type 3: HANDSHAKE Packet (ACK/Capability Report)
- * 
- * Three-way handshake and capability exchange
- * Slave reports sensors and features to Master
- */
-typedef struct {
-    EDTSPHeader          header;         /**< Standard header */
-    uint8_t              handshake_step; /**< Handshake phase (1=SYN, 2=SYN-ACK, 3=ACK) */
-    uint32_t             target_id;      /**< Target device ID (for handshake) */
-    EDTSPCapabilityMask  capabilities;   /**< Available sensors/features (16-bit mask) */
-    uint8_t              interface_type; /**< Current active interface */
-} EDTSPHandshakePacket;
+// ============================================================================
+// REDUNDANCY TRAILER
+// ============================================================================
 
-/**
- * Type 4: CONFIG Packet
- * 
- * Master sends configuration to Slave
- * Specifies which sensors to sample and at what rate
- */
-typedef struct {
-    EDTSPHeader header;              /**< Standard header */
-    uint32_t    target_id;           /**< Target Slave device ID */
-    uint8_t     sensor_id;           /**< Sensor to configure (capability bit index) */
-    uint16_t    sampling_rate_ms;    /**< Sampling interval in milliseconds */
-    uint8_t     enable;              /**< 1=enable, 0=disable */
-} EDTSPConfigPacket;
+#pragma pack(push, 1)
 
 /**
- * Type 5: DATA Packet
+ * Redundancy Control Trailer (6 bytes, PRP style)
  * 
- * Slave sends sensor data to Master
- * Contains raw sensor reading with timestamp
+ * Appended after the payload when a packet is sent on two interfaces at
+ * once. Receivers that do not know the trailer ignore it (it lies beyond
+ * header + payload_len); aware receivers drop the second copy.
  */
 typedef struct {
-    EDTSPHeader header;              /**< Standard header */
-    uint8_t     sensor_id;           /**< Sensor ID (capability bit index) */
-    uint32_t    timestamp_ms;        /**< Timestamp in milliseconds */
-    uint8_t     data_len;            /**< Length of sensor data */
-    uint8_t     data[64];            /**< Raw sensor data (flexible, max 64 bytes) */
-} EDTSPDataPacket;
+    uint16_t seq;          /**< Per-source redundancy sequence number */
+    uint16_t path_size;    /**< Path ID (upper 4 bits: 0xA/0xB) | frame size (lower 12 bits) */
+    uint16_t suffix;       /**< EDTSP_RCT_SUFFIX */
+} EDTSPRedundancyTrailer;
 
 #pragma pack(pop)
 
+/** Redundancy path identifiers (PRP LAN A / LAN B) */
+#define EDTSP_PATH_A 0xA
+#define EDTSP_PATH_B 0xB
+
+// Packet types, packet structs and per-type codecs are generated from
+// tools/codegen/edtsp.schema (`make generate`)
+#include "edtsp_packets.h"
+
 // ============================================================================
 // UTILITY FUNCTIONS
 // ============================================================================
@@ -229,33 +247,20 @@ typedef struct {
 /**
  * Validate packet header
  * 
+ * Types above EDTSP_TYPE_MAX are valid on the wire: they reach handlers
+ * registered by applications (see edtsp_dispatch.h) or are counted as
+ * unhandled.
+ * 
  * @param header Pointer to header
  * @return true if valid, false otherwise
  */
 static inline bool edtsp_header_valid(const EDTSPHeader *header) {
     if (!header) return false;
     if (header->magic != EDTSP_MAGIC) return false;
-    if (header->type < EDTSP_TYPE_DISCOVERY || header->type > EDTSP_TYPE_DATA) return false;
+    if (header->type < EDTSP_TYPE_DISCOVERY) return false;
     return true;
 }
 
-/**
- * Get packet type name (for debugging)
- * 
- * @param type Packet type
- * @return String name
- */
-static inline const char* edtsp_type_name(uint8_t type) {
-    switch (type) {
-        case EDTSP_TYPE_DISCOVERY: return "DISCOVERY";
-        case EDTSP_TYPE_HEARTBEAT: return "HEARTBEAT";
-        case EDTSP_TYPE_HANDSHAKE: return "HANDSHAKE";
-        case EDTSP_TYPE_CONFIG:    return "CONFIG";
-        case EDTSP_TYPE_DATA:      return "DATA";
-        default:                   return "UNKNOWN";
-    }
-}
-
 /**
  * Get role name (for debugging)
  * 
@@ -0,0 +1,131 @@
+/**
+ * @file busy_poll.c
+ * @brief EDTSP Low-Latency Busy-Poll Mode (PC/Linux)
+ *
+ * Latencies are recorded in nanoseconds into the shared log-linear
+ * histogram (edtsp_stats.h), which resolves ~12% at any magnitude.
+ */
+
+#define _GNU_SOURCE  // CPU affinity
+
+#include "busy_poll.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+static EDTSPBusyPollConfig config;
+static EDTSPHistogram latency_ns;
+static bool busy_poll_ok = false;
+static bool fifo_ok = false;
+static uint64_t loops = 0;
+static uint64_t idle_loops = 0;
+
+void edtsp_busy_enable_timestamps(void) {
+    int on = 1;
+    
+    edtsp_hist_init(&latency_ns);
+    for (int i = 0; i < edtsp_net_iface_count(); i++) {
+        EDTSPNetIface *iface = edtsp_net_iface(i);
+        if (setsockopt(iface->fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) < 0) {
+            perror("[NETWORK] SO_TIMESTAMPNS");
+        }
+    }
+}
+
+bool edtsp_busy_setup(const EDTSPBusyPollConfig *cfg) {
+    config = *cfg;
+    if (!config.enabled) return true;
+    
+    // Pin the loop thread: the spinning core keeps its caches and never migrates
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (config.cpu < 0 || config.cpu >= cpus) config.cpu = (int)cpus - 1;
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(config.cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err) {
+        fprintf(stderr, "[MAIN] Cannot pin to CPU %d: %s\n", config.cpu, strerror(err));
+        return false;
+    }
+    
+    // Poll the device queue from recvmmsg() instead of waiting for the softirq
+    int budget = EDTSP_BUSY_POLL_US;
+    busy_poll_ok = true;
+    for (int i = 0; i < edtsp_net_iface_count(); i++) {
+        EDTSPNetIface *iface = edtsp_net_iface(i);
+        if (setsockopt(iface->fd, SOL_SOCKET, SO_BUSY_POLL, &budget, sizeof(budget)) < 0) {
+            busy_poll_ok = false;
+        }
+#ifdef SO_PREFER_BUSY_POLL
+        int on = 1;
+        setsockopt(iface->fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &on, sizeof(on));
+#endif
+    }
+    if (!busy_poll_ok) {
+        fprintf(stderr, "[MAIN] SO_BUSY_POLL refused (%s), spinning in user space only\n",
+                strerror(errno));
+    }
+    
+    // A real-time spinner on the only CPU would starve the rest of the system
+    if (config.fifo_prio > 0 && cpus < 2) {
+        fprintf(stderr, "[MAIN] SCHED_FIFO skipped: only one CPU online\n");
+        config.fifo_prio = 0;
+    }
+    
+    if (config.fifo_prio > 0) {
+        struct sched_param sp = { .sched_priority = config.fifo_prio };
+        err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+        fifo_ok = err == 0;
+        if (!fifo_ok) {
+            fprintf(stderr, "[MAIN] SCHED_FIFO %d refused: %s\n", config.fifo_prio, strerror(err));
+        }
+    }
+    
+    // Page faults on the hot path cost more than the spin saves
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        fprintf(stderr, "[MAIN] mlockall refused: %s\n", strerror(errno));
+    }
+    
+    printf("[MAIN] Busy-poll mode: CPU %d, SO_BUSY_POLL %s, %s\n", config.cpu,
+           busy_poll_ok ? "on" : "off", fifo_ok ? "SCHED_FIFO" : "SCHED_OTHER");
+    return true;
+}
+
+void edtsp_busy_record(const struct timespec *kernel_ts, const struct timespec *now) {
+    int64_t ns = (int64_t)(now->tv_sec - kernel_ts->tv_sec) * 1000000000ll +
+                 (now->tv_nsec - kernel_ts->tv_nsec);
+    
+    // Realtime clock steps can make the difference negative
+    if (ns < 0) return;
+    edtsp_hist_record(&latency_ns, ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns);
+}
+
+void edtsp_busy_count_loop(bool idle) {
+    loops++;
+    if (idle) idle_loops++;
+}
+
+void edtsp_busy_print(void) {
+    if (config.enabled) {
+        printf("  Loop: busy-poll CPU %d (%s, %s), spins=%llu idle=%.1f%%\n", config.cpu,
+               busy_poll_ok ? "SO_BUSY_POLL" : "user-space spin",
+               fifo_ok ? "SCHED_FIFO" : "SCHED_OTHER", (unsigned long long)loops,
+               loops ? 100.0 * (double)idle_loops / (double)loops : 0.0);
+    } else {
+        printf("  Loop: sleeping (event wait)\n");
+    }
+    
+    if (latency_ns.total == 0) return;
+    printf("  Rx->handler latency (us): p50=%.1f p90=%.1f p99=%.1f p99.9=%.1f min=%.1f max=%.1f samples=%u\n",
+           edtsp_hist_percentile(&latency_ns, 50) / 1000.0,
+           edtsp_hist_percentile(&latency_ns, 90) / 1000.0,
+           edtsp_hist_percentile(&latency_ns, 99) / 1000.0,
+           edtsp_hist_percentile(&latency_ns, 99.9) / 1000.0,
+           latency_ns.min / 1000.0, latency_ns.max / 1000.0, latency_ns.total);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file busy_poll.h
+ * @brief EDTSP Low-Latency Busy-Poll Mode (PC/Linux)
+ *
+ * Opt-in mode for masters driving relay/PWM control loops: the event loop
+ * thread is pinned to one CPU and spins on its non-blocking sockets
+ * instead of sleeping in epoll, the sockets busy-poll the NIC queue
+ * (SO_BUSY_POLL), and the thread can run under SCHED_FIFO. One core is
+ * spent to remove the scheduler wakeup from the receive path.
+ *
+ * Kernel receive timestamps (SO_TIMESTAMPNS) are enabled in every mode,
+ * so the receive-to-handler latency distribution can be compared between
+ * the sleeping and the spinning loop.
+ */
+
+#ifndef EDTSP_BUSY_POLL_H
+#define EDTSP_BUSY_POLL_H
+
+#include "net_iface.h"
+#include "../../include/edtsp_stats.h"
+#include <time.h>
+
+/** Socket busy-poll budget (microseconds, SO_BUSY_POLL) */
+#define EDTSP_BUSY_POLL_US 50
+
+/** Busy-poll mode settings */
+typedef struct {
+    bool enabled;      /**< Spin instead of sleeping */
+    int  cpu;          /**< CPU to pin the loop thread to (-1 = last online CPU) */
+    int  fifo_prio;    /**< SCHED_FIFO priority (0 = keep SCHED_OTHER) */
+} EDTSPBusyPollConfig;
+
+/** Enable kernel receive timestamps on all interface sockets */
+void edtsp_busy_enable_timestamps(void);
+
+/**
+ * Apply busy-poll settings to the calling thread and all sockets
+ *
+ * Each step that needs privileges (SO_BUSY_POLL above the sysctl limit,
+ * SCHED_FIFO, mlockall) is reported and skipped if refused.
+ *
+ * @return false if the mode could not be enabled at all
+ */
+bool edtsp_busy_setup(const EDTSPBusyPollConfig *cfg);
+
+/**
+ * Record the latency of one packet from kernel receive to dispatch
+ *
+ * @param kernel_ts SO_TIMESTAMPNS value (CLOCK_REALTIME)
+ * @param now       CLOCK_REALTIME at dispatch
+ */
+void edtsp_busy_record(const struct timespec *kernel_ts, const struct timespec *now);
+
+/** Count one spin of the event loop (busy-poll mode) */
+void edtsp_busy_count_loop(bool idle);
+
+/** Print mode and latency percentiles (for the stats endpoint) */
+void edtsp_busy_print(void);
+
+#endif // EDTSP_BUSY_POLL_H
@@ -5,7 +5,32 @@
  * Standalone application for PC/Linux devices
  */
 
+#define _GNU_SOURCE  // recvmmsg
+
 #include "../../include/protocol.h"
+#include "../../include/edtsp_dedup.h"
+#include "../../include/edtsp_rtt.h"
+#include "../../include/edtsp_clocksync.h"
+#include "../../include/edtsp_dispatch.h"
+#include "../../include/edtsp_pool.h"
+#include "../../include/edtsp_actuate.h"
+#include "../../include/edtsp_group.h"
+#include "../../include/edtsp_devindex.h"
+#include "../../include/edtsp_handshake.h"
+#include "../../include/edtsp_capdesc.h"
+#include "../../include/edtsp_deadband.h"
+#include "../../include/edtsp_window.h"
+#include "../../include/edtsp_pack.h"
+#include "../../include/edtsp_ratelimit.h"
+#include "../../include/edtsp_flow.h"
+#include "../../include/edtsp_tclass.h"
+#include "../../include/edtsp_auth.h"
+#include "../../include/edtsp_aead.h"
+#include "../../include/edtsp_zone.h"
+#include "../../include/edtsp_shard.h"
+#include "net_iface.h"
+#include "io_uring_engine.h"
+#include "busy_poll.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,29 +39,162 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
 #include <signal.h>
 #include <errno.h>
+#include <getopt.h>
+#include <sys/random.h>
 
 // External functions from other modules
 extern uint32_t edtsp_get_device_id(void);
 extern void edtsp_init_header(EDTSPHeader *header, uint8_t type, uint32_t source_id, uint8_t payload_len);
 extern void edtsp_build_discovery(EDTSPDiscoveryPacket *pkt, uint32_t source_id, uint8_t iface_type, const char *device_name);
-extern void edtsp_build_heartbeat(EDTSPHeartbeatPacket *pkt, uint32_t source_id, uint8_t role, uint32_t uptime_ms, uint8_t active_devices);
+extern void edtsp_build_heartbeat(EDTSPHeartbeatPacket *pkt, uint32_t source_id, uint8_t role, uint32_t uptime_ms, uint16_t active_devices, uint32_t ingest_addr, uint16_t ingest_port);
 extern bool edtsp_parse_header(EDTSPHeader *header);
-extern void edtsp_parse_heartbeat(EDTSPHeartbeatPacket *pkt);
+extern size_t edtsp_reframe_v2(uint8_t *out, size_t out_size, const void *v1_pkt, size_t v1_len, uint8_t flags, uint32_t seq);
+extern bool edtsp_decode_frame(uint8_t *buf, size_t len, EDTSPFrameInfo *info);
+extern size_t edtsp_append_trailer(uint8_t *buf, size_t frame_len, uint16_t seq, uint8_t path);
+extern bool edtsp_parse_trailer(const uint8_t *buf, size_t len, size_t frame_len, uint16_t *seq);
+extern void edtsp_build_handshake(EDTSPHandshakePacket *pkt, uint32_t source_id, uint8_t step, uint32_t target_id, EDTSPCapabilityMask caps, uint8_t iface_type);
+extern void edtsp_build_config(EDTSPConfigPacket *pkt, uint32_t source_id, uint32_t target_id, uint8_t sensor_id, uint16_t sampling_rate_ms, uint8_t enable, uint16_t deadband, uint32_t max_silence_ms, uint32_t window_ms, uint8_t pack_samples);
+extern void edtsp_build_assign(EDTSPConfigPacket *pkt, uint32_t source_id, uint32_t target_id, uint32_t ingest_id, uint32_t ingest_addr, uint16_t ingest_port);
+extern void edtsp_build_data(EDTSPDataPacket *pkt, uint32_t source_id, uint8_t sensor_id, uint32_t timestamp_ms, const uint8_t *data, uint8_t data_len);
+extern void edtsp_build_packed_data(EDTSPDataPacket *pkt, uint32_t source_id, uint8_t sensor_id, uint32_t timestamp_ms, uint16_t block_len);
+extern void edtsp_build_probe(EDTSPProbePacket *pkt, uint32_t source_id, uint8_t kind, uint8_t iface_type, uint16_t probe_seq, uint32_t target_id, uint64_t t1_us, uint64_t t2_us, uint64_t t3_us);
+extern void edtsp_build_sync(EDTSPSyncPacket *pkt, uint32_t source_id, uint8_t kind, uint16_t sync_seq, uint32_t target_id, uint64_t t1_us, uint64_t t2_us, uint64_t t3_us);
+extern void edtsp_build_actuate(EDTSPActuatePacket *pkt, uint32_t source_id, uint8_t kind, uint8_t priority, uint16_t act_seq, uint32_t target_id, uint8_t output_id, uint8_t channel, uint8_t status, uint32_t value, uint64_t t1_us, uint64_t t2_us, uint64_t t3_us);
+extern void edtsp_build_credit(EDTSPCreditPacket *pkt, uint32_t source_id, uint32_t target_id, uint16_t credit_seq, uint16_t max_fps, uint16_t lifetime_ms, uint8_t queue_pct);
 extern void edtsp_election_init(uint32_t device_id);
-extern void edtsp_update_device(uint32_t device_id, uint64_t timestamp_ms, uint8_t role);
+extern bool edtsp_update_device(uint32_t device_id, uint64_t timestamp_ms, uint8_t role);
+extern void edtsp_set_device_version(uint32_t device_id, uint8_t version);
+extern void edtsp_set_device_capabilities(uint32_t device_id, EDTSPCapabilityMask caps);
+extern void edtsp_set_device_interface(uint32_t device_id, uint8_t iface_type);
+extern int edtsp_get_device_slot(uint32_t device_id);
+extern bool edtsp_is_device_active(uint32_t device_id);
+extern uint8_t edtsp_get_min_peer_version(void);
 extern void edtsp_check_timeouts(uint64_t current_time_ms);
 extern void edtsp_perform_election(void);
 extern EDTSPRole edtsp_get_my_role(void);
-extern uint8_t edtsp_get_active_device_count(void);
+extern bool edtsp_is_master(void);
+extern uint32_t edtsp_get_master_id(void);
+extern uint16_t edtsp_get_active_device_count(void);
+extern int edtsp_get_active_device_ids(uint32_t *ids, int max);
 extern void edtsp_print_device_list(void);
 
 // Global state
-static int udp_socket = -1;
 static uint32_t my_id = 0;
 static uint64_t start_time_ms = 0;
+static uint64_t start_time_us = 0;
 static volatile bool running = true;
+static bool redundant_mode = false;   // Send every packet on two interfaces
+static bool use_io_uring = false;     // io_uring backend instead of epoll
+static EDTSPBusyPollConfig busy_poll = { .enabled = false, .cpu = -1, .fifo_prio = 0 };
+static uint16_t redundancy_seq = 0;
+static volatile bool stats_requested = false;
+static uint32_t tx_seq = 0;              // v2 header sequence number
+static uint64_t discovery_due_ms = 0;    // Answer newcomers with our version
+static uint32_t rx_frames[3] = {0};      // Received frames per header version
+static uint32_t rx_bad_data_len = 0;     // DATA whose data_len overruns the frame or the field
+
+// Largest frame sent: full v2 payload, AEAD and authentication tags
+#define TX_FRAME_MAX (EDTSP_MAX_PAYLOAD_V2 + sizeof(EDTSPHeaderV2) + EDTSP_AEAD_TAG_LEN + EDTSP_AUTH_TAG_LEN)
+
+// Receive batching (recvmmsg)
+#define RX_BATCH 32
+#define RX_DRAIN_BATCHES 8    // Per call, so a backlog cannot starve timers and flow control
+#define RX_POOL_BUFFERS (RX_BATCH * (EDTSP_MAX_IFACES + 2) + EDTSP_TCLASS_QUEUE)  // Posted rings + in flight + deferred DATA
+#define RX_ARENA_SIZE (64 * 1024)                            // Per-batch scratch memory
+
+static EDTSPArena rx_arena;
+
+// Outstanding latency probes
+#define MAX_PENDING_PROBES 32
+
+typedef struct {
+    bool     in_use;
+    bool     round_answered;   // Peer answered this round on another link
+    uint16_t seq;
+    uint16_t round;            // One round = same peer probed on every link
+    uint32_t peer_id;
+    int      iface_idx;
+    uint64_t t1_us;
+    uint64_t deadline_ms;
+} PendingProbe;
+
+static PendingProbe pending_probes[MAX_PENDING_PROBES];
+static uint16_t probe_seq = 0;
+static uint16_t probe_round = 0;
+static uint32_t probe_cursor = 0;
+static uint16_t sync_seq = 0;
+static uint32_t sync_cursor = 0;
+
+// Actuation
+static uint16_t actuate_seq = 0;
+static uint32_t actuate_cursor = 0;
+static uint32_t actuate_test_hz = 0;      // Master test traffic (--actuate)
+static uint8_t sim_relay = 0;             // Simulated outputs (bit per channel)
+static uint32_t sim_pwm[4] = {0};
+
+#ifdef EDTSP_TEST_HOOKS
+// Test hook: simulated slow storage per ingested DATA (--ingest-cost)
+static uint32_t ingest_cost_us = 0;
+#endif
+
+// Join handshake (slave side; the master side lives in edtsp_handshake.c)
+static EDTSPJoin join;
+static EDTSPSensorDesc my_sensors[EDTSP_CAPDESC_MAX_SENSORS];  // Simulated (--sensor)
+static int my_sensor_count = 0;
+
+// Group configuration
+static uint16_t group_seq = 0;
+static EDTSPSensorSetting configure_setting;    // Master: pushed to all slaves (--configure)
+static bool configure_enabled = false;
+static int configured_slaves = -1;              // Active count at the last push
+static uint32_t configured_generation = 0;      // Descriptor generation at the last push
+static bool configure_report = false;           // Master: deadband/deadline/window/pack given, push CONFIG
+static uint16_t configure_deadband = 0;
+static uint32_t configure_silence_ms = 0;
+static uint32_t configure_window_ms = 0;
+static uint8_t configure_pack = 0;
+static uint16_t sensor_rate_ms[EDTSP_GROUP_MAX_SETTINGS] = {0};  // Slave: 0 = disabled
+
+// Receive rate limits (--rate-limit)
+static EDTSPRateLimitConfig rate_limit = {
+    EDTSP_RATELIMIT_DEVICE_PPS, EDTSP_RATELIMIT_DEVICE_BURST,
+    EDTSP_RATELIMIT_STRANGER_PPS, EDTSP_RATELIMIT_STRANGER_BURST,
+    EDTSP_RATELIMIT_SAMPLE_EVERY
+};
+
+// Network key (--auth-key or EDTSP_AUTH_KEY)
+static uint8_t auth_key[EDTSP_AUTH_KEY_LEN];
+static bool auth_keyed = false;
+
+// Payload encryption (--encrypt): AEADs offered, 0 = off
+static uint8_t encrypt_algs = 0;
+static uint64_t join_nonce = 0;          // SESSION nonce of the current join (slave)
+
+// Hierarchical zones: own zone group, uplink while zone master (--zone)
+static uint16_t zone_opt = 0;
+
+// Sharded ingest (--ingest)
+static bool ingest_opt = false;
+
+// Sampling (slave): simulated slow-changing values, summarized, packed or reported by exception
+static EDTSPDeadband sensor_filter[EDTSP_GROUP_MAX_SETTINGS];
+static EDTSPWindow sensor_window[EDTSP_GROUP_MAX_SETTINGS];
+static EDTSPPacker sensor_packer[EDTSP_GROUP_MAX_SETTINGS];
+static EDTSPDecimator sensor_decimator[EDTSP_GROUP_MAX_SETTINGS];
+static uint64_t next_sample_ms[EDTSP_GROUP_MAX_SETTINGS];
+static int32_t sim_value[EDTSP_GROUP_MAX_SETTINGS];
+
+// Flow control: slave honours the master's CREDIT cap, master advertises it
+static EDTSPFlowSlave flow;
+static uint16_t credit_seq = 0;
+
+// Forward declarations
+void send_discovery(void);
+EDTSPCapabilityMask my_capabilities(void);
 
 // ============================================================================
 // UTILITIES
@@ -48,6 +206,29 @@ uint64_t get_time_ms(void) {
     return (uint64_t)(tv.tv_sec) * 1000 + (uint64_t)(tv.tv_usec) / 1000;
 }
 
+uint64_t get_time_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)(tv.tv_sec) * 1000000 + (uint64_t)(tv.tv_usec);
+}
+
+/** Sample clock: 64-bit uptime in microseconds (DATA timestamps derive from it) */
+uint64_t get_sample_clock_us(void) {
+    return get_time_us() - start_time_us;
+}
+
+/** Random 64-bit SESSION nonce */
+uint64_t random_nonce(void) {
+    uint64_t nonce;
+    if (getrandom(&nonce, sizeof(nonce), 0) != sizeof(nonce)) nonce = get_time_us() ^ ((uint64_t)rand() << 32);
+    return nonce;
+}
+
+void stats_signal_handler(int sig) {
+    (void)sig;
+    stats_requested = true;
+}
+
 void signal_handler(int sig) {
     (void)sig;
     running = false;
@@ -55,145 +236,1252 @@ void signal_handler(int sig) {
 }
 
 // ============================================================================
-// NETWORK SETUP
+// NETWORK
 // ============================================================================
 
-bool setup_udp_socket(void) {
-    struct sockaddr_in addr;
-    struct ip_mreq mreq;
-    int reuse = 1;
+/**
+ * Dual-path transmission: same packet + trailer on the two best links
+ * 
+ * Falls back to a single (trailer-tagged) copy if only one link is healthy.
+ */
+bool send_packet_redundant(const void *data, size_t len, uint8_t tos) {
+    uint8_t frame[TX_FRAME_MAX + sizeof(EDTSPRedundancyTrailer)];
     
-    // Create UDP socket
-    udp_socket = socket(AF_INET, SOCK_DGRAM, 0);
-    if (udp_socket < 0) {
-        perror("[NETWORK] Failed to create socket");
-        return false;
-    }
+    if (len + sizeof(EDTSPRedundancyTrailer) > sizeof(frame)) return edtsp_net_send(data, len, tos);
     
-    // Allow address reuse (for multiple instances)
-    if (setsockopt(udp_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0) {
-        perror("[NETWORK] Failed to set SO_REUSEADDR");
-    }
+    uint16_t seq = redundancy_seq++;
+    EDTSPNetIface *primary = edtsp_net_active();
+    EDTSPNetIface *standby = edtsp_net_standby();
+    bool sent = false;
     
-    // Bind to multicast port
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(EDTSP_PORT);
+    memcpy(frame, data, len);
     
-    if (bind(udp_socket, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        perror("[NETWORK] Failed to bind socket");
-        close(udp_socket);
-        return false;
+    size_t frame_len = edtsp_append_trailer(frame, len, seq, EDTSP_PATH_A);
+    sent |= edtsp_net_send_on(primary, frame, frame_len, tos);
+    
+    frame_len = edtsp_append_trailer(frame, len, seq, EDTSP_PATH_B);
+    sent |= edtsp_net_send_on(standby, frame, frame_len, tos);
+    
+    // Both copies failed: let failover pick whatever is left
+    if (!sent) {
+        frame_len = edtsp_append_trailer(frame, len, seq, EDTSP_PATH_A);
+        sent = edtsp_net_send(frame, frame_len, tos);
     }
+    return sent;
+}
+
+/** Packets of this type go out with the v2 header (every peer reads v2, or signed) */
+bool tx_v2(uint8_t type) {
+    return edtsp_auth_enabled() || (type != EDTSP_TYPE_DISCOVERY && edtsp_get_min_peer_version() >= 2);
+}
+
+/**
+ * Reframe a v1-built packet with the v2 header, signed when authentication
+ * is on. With encryption, DATA-class payloads are sealed for the master.
+ * The payload may exceed the v1 limit (EDTSP_MAX_PAYLOAD): the v2 length
+ * is taken from len, not from the v1 header.
+ * 
+ * @param frame Output, EDTSP_AEAD_TAG_LEN + EDTSP_AUTH_TAG_LEN bytes larger
+ *              than the v2 frame
+ * @param flags Payload flags (EDTSP_FLAG_AGGREGATED, EDTSP_FLAG_COMPRESSED)
+ * @return Frame length, 0 if it does not fit or has no session key
+ */
+size_t frame_v2(uint8_t *frame, size_t size, const void *data, size_t len, uint8_t flags) {
+    // The flag goes in now: with encryption the header is sealed before signing
+    if (edtsp_auth_enabled()) flags |= EDTSP_FLAG_AUTHENTICATED;
+    size_t v2_len = edtsp_reframe_v2(frame, size - EDTSP_AEAD_TAG_LEN - EDTSP_AUTH_TAG_LEN,
+                                     data, len, flags, tx_seq);
+    if (!v2_len) return 0;
     
-    // Join multicast group
-    mreq.imr_multiaddr.s_addr = inet_addr(EDTSP_MULTICAST_ADDR);
-    mreq.imr_interface.s_addr = INADDR_ANY;
+    if (edtsp_aead_enabled() && edtsp_tclass_of(((const EDTSPHeader*)data)->type) == EDTSP_CLASS_DATA) {
+        uint32_t master = edtsp_get_master_id();
+        v2_len = edtsp_aead_seal_frame(frame, v2_len, master);
+        if (!v2_len) {
+            // Key used up: a rejoin brings a fresh one
+            if (edtsp_aead_session(master)) {
+                edtsp_aead_forget(master);
+                edtsp_join_set_master(&join, 0, get_time_us());
+            }
+            return 0;
+        }
+    }
     
-    if (setsockopt(udp_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
-        perror("[NETWORK] Failed to join multicast group");
-        close(udp_socket);
-        return false;
+    tx_seq++;
+    return edtsp_auth_enabled() ? edtsp_auth_sign(frame, v2_len) : v2_len;
+}
+
+/**
+ * Send a v1-built packet, upgraded to the v2 header once every peer has
+ * announced v2 support. DISCOVERY stays v1 so that any newcomer can read it.
+ * With a network key everything goes out as signed v2, DISCOVERY included.
+ * The packet is marked with the DSCP of its traffic class.
+ * 
+ * @param dest  Unicast destination (sharded DATA), NULL = the group
+ * @param flags v2 payload flags; a flagged packet, or one larger than
+ *              EDTSP_MAX_PAYLOAD, is only sent while v2 can be used
+ */
+bool send_packet_to(const struct sockaddr_in *dest, const void *data, size_t len, uint8_t flags) {
+    uint8_t frame[TX_FRAME_MAX];
+    const EDTSPHeader *header = (const EDTSPHeader*)data;
+    EDTSPTrafficClass cls = edtsp_tclass_of(header->type);
+    uint8_t tos = edtsp_tclass_tos(cls);
+    
+    edtsp_tclass_on_tx(cls);
+    
+    if (tx_v2(header->type)) {
+        size_t v2_len = frame_v2(frame, sizeof(frame), data, len, flags);
+        if (v2_len) {
+            data = frame;
+            len = v2_len;
+        } else if (edtsp_auth_enabled()) {
+            return false; // Unsigned (or unsealed) would be dropped anyway
+        }
     }
+    if (data != frame && (flags || len > sizeof(EDTSPHeader) + EDTSP_MAX_PAYLOAD)) return false;
     
-    printf("[NETWORK] Listening on %s:%d\n", EDTSP_MULTICAST_ADDR, EDTSP_PORT);
-    return true;
+    if (dest) return edtsp_net_send_unicast(dest, data, len, tos);
+    if (redundant_mode) return send_packet_redundant(data, len, tos);
+    return edtsp_net_send(data, len, tos);
 }
 
 bool send_packet(const void *data, size_t len) {
-    struct sockaddr_in dest_addr;
+    return send_packet_to(NULL, data, len, 0);
+}
+
+/** Send a control packet on one link (probes), signed v2 when authentication is on */
+bool send_packet_on(EDTSPNetIface *iface, const void *data, size_t len) {
+    uint8_t frame[TX_FRAME_MAX];
     
-    memset(&dest_addr, 0, sizeof(dest_addr));
-    dest_addr.sin_family = AF_INET;
-    dest_addr.sin_addr.s_addr = inet_addr(EDTSP_MULTICAST_ADDR);
-    dest_addr.sin_port = htons(EDTSP_PORT);
+    if (edtsp_auth_enabled()) {
+        len = frame_v2(frame, sizeof(frame), data, len, 0);
+        if (!len) return false;
+        data = frame;
+    }
+    return edtsp_net_send_on(iface, data, len, edtsp_tclass_tos(EDTSP_CLASS_CONTROL));
+}
+
+/** Send on the uplink group (sub-masters), signed v2 when authentication is on */
+bool send_uplink(const void *data, size_t len) {
+    uint8_t frame[TX_FRAME_MAX];
     
-    ssize_t sent = sendto(udp_socket, data, len, 0, 
-                         (struct sockaddr*)&dest_addr, sizeof(dest_addr));
+    if (edtsp_auth_enabled()) {
+        len = frame_v2(frame, sizeof(frame), data, len, 0);
+        if (!len) return false;
+        data = frame;
+    }
+    edtsp_tclass_on_tx(EDTSP_CLASS_CONTROL);
+    return edtsp_net_send_uplink(data, len, edtsp_tclass_tos(EDTSP_CLASS_CONTROL));
+}
+
+/** DATA to the assigned ingest node, or to the group while none is assigned or it has timed out here */
+bool send_data(const void *data, size_t len, uint8_t flags) {
+    const EDTSPShardTarget *t = edtsp_shard_target();
     
-    if (sent < 0) {
-        perror("[NETWORK] Send failed");
-        return false;
+    if (!t->id) return send_packet_to(NULL, data, len, flags);
+    if (!edtsp_is_device_active(t->id)) {
+        edtsp_shard_on_fallback();
+        return send_packet_to(NULL, data, len, flags);
     }
     
-    return true;
+    struct sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = htonl(t->addr);
+    dest.sin_port = htons(t->port);
+    return send_packet_to(&dest, data, len, flags);
 }
 
 // ============================================================================
 // PACKET HANDLERS
 // ============================================================================
 
-void handle_discovery(EDTSPDiscoveryPacket *pkt) {
+void handle_discovery(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPDiscoveryPacket *pkt = data;
+    (void)rx;
+    (void)ctx;
+    
     printf("[RX] DISCOVERY from 0x%08X: %s (%s)\n",
            pkt->header.source_id, pkt->device_name,
            edtsp_iface_name(pkt->interface_type));
     
     uint64_t now = get_time_ms();
-    edtsp_update_device(pkt->header.source_id, now, EDTSP_ROLE_UNKNOWN);
+    if (edtsp_update_device(pkt->header.source_id, now, EDTSP_ROLE_UNKNOWN) && !discovery_due_ms) {
+        discovery_due_ms = now + EDTSP_DISCOVERY_REPLY_DELAY_MS;
+    }
+    edtsp_set_device_version(pkt->header.source_id, pkt->version);
+    edtsp_set_device_interface(pkt->header.source_id, pkt->interface_type);
     edtsp_perform_election();
 }
 
-void handle_heartbeat(EDTSPHeartbeatPacket *pkt) {
-    edtsp_parse_heartbeat(pkt);
+void handle_heartbeat(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPHeartbeatPacket *pkt = data;
+    (void)ctx;
     
     printf("[RX] HEARTBEAT from 0x%08X: Role=%s, Uptime=%u ms, Devices=%u\n",
            pkt->header.source_id, edtsp_role_name(pkt->role),
            pkt->uptime_ms, pkt->active_devices);
     
     uint64_t now = get_time_ms();
-    edtsp_update_device(pkt->header.source_id, now, pkt->role);
+    if (edtsp_update_device(pkt->header.source_id, now, pkt->role) && !discovery_due_ms) {
+        discovery_due_ms = now + EDTSP_DISCOVERY_REPLY_DELAY_MS;
+    }
+    // Older nodes advertise no ingest socket
+    if (rx->len >= sizeof(*pkt)) {
+        edtsp_shard_on_ingest(pkt->header.source_id, pkt->ingest_addr, pkt->ingest_port, now);
+    }
     edtsp_perform_election();
 }
 
-void receive_packets(void) {
-    uint8_t buffer[512];
-    struct sockaddr_in sender_addr;
-    socklen_t addr_len = sizeof(sender_addr);
+void handle_handshake(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPHandshakePacket *pkt = data;
+    (void)ctx;
+    
+    // Every step carries the sender's capabilities: keep the index current
+    edtsp_set_device_capabilities(pkt->header.source_id, pkt->capabilities);
+    edtsp_set_device_interface(pkt->header.source_id, pkt->interface_type);
     
-    // Set socket to non-blocking
-    struct timeval tv = {0, 100000}; // 100ms timeout
-    setsockopt(udp_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (pkt->target_id != my_id) return;
     
-    ssize_t bytes = recvfrom(udp_socket, buffer, sizeof(buffer), 0,
-                            (struct sockaddr*)&sender_addr, &addr_len);
+    uint64_t nonce;
+    uint8_t algs;
+    bool session = edtsp_aead_enabled() && edtsp_capdesc_find_session(pkt, rx->len, &nonce, &algs);
     
-    if (bytes < sizeof(EDTSPHeader)) return;
+    if (pkt->handshake_step == EDTSP_HANDSHAKE_SYN_ACK) {
+        // Key of this join: our SYN nonce and the master's
+        if (pkt->header.source_id == join.master_id && join.state == EDTSP_JOIN_SYN_SENT) {
+            if (session) edtsp_aead_install(join.master_id, join.master_id, my_id, join_nonce, nonce, algs);
+            if (edtsp_auth_enabled()) edtsp_auth_reset(join.master_id, rx->frame.seq, rx->rx_us / 1000);
+        }
+        edtsp_join_on_packet(&join, pkt, rx->rx_us);
+    } else if (edtsp_is_master()) {
+        // Not in the device table yet (heartbeat pending): it retries the SYN
+        int slot = edtsp_get_device_slot(pkt->header.source_id);
+        if (slot < 0) return;
+        
+        if (pkt->handshake_step == EDTSP_HANDSHAKE_SYN) {
+            edtsp_capdesc_set(slot, pkt, rx->len);
+            
+            // A join starts a new run: older frames of the source are stale
+            if (edtsp_auth_enabled()) edtsp_auth_reset(pkt->header.source_id, rx->frame.seq, rx->rx_us / 1000);
+            
+            // New join (new slave nonce): new key, installed before the SYN-ACK
+            // names it. A retransmitted SYN keeps the session.
+            const EDTSPAeadSession *s = edtsp_aead_session(pkt->header.source_id);
+            uint8_t alg = session ? edtsp_aead_choose(algs) : 0;
+            if (alg && (!s || s->slave_nonce != nonce)) {
+                edtsp_aead_install(pkt->header.source_id, my_id, pkt->header.source_id,
+                                   nonce, random_nonce(), alg);
+            }
+        }
+        edtsp_hs_on_packet(pkt, rx->rx_us);
+    }
+}
+
+void handle_probe(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPProbePacket *pkt = data;
+    (void)ctx;
     
-    EDTSPHeader *header = (EDTSPHeader*)buffer;
+    if (pkt->target_id != my_id) return;
     
-    // Parse header (convert from network byte order)
-    EDTSPHeader header_copy = *header;
-    if (!edtsp_parse_header(&header_copy)) {
-        return; // Invalid packet
+    if (pkt->kind == EDTSP_PROBE_REQUEST) {
+        // Echo on the link the request arrived on (per-link measurement)
+        EDTSPProbePacket echo;
+        edtsp_build_probe(&echo, my_id, EDTSP_PROBE_ECHO, pkt->interface_type,
+                          pkt->probe_seq, pkt->header.source_id,
+                          pkt->t1_us, rx->rx_us, get_time_us());
+        send_packet_on(rx->iface, &echo, sizeof(echo));
+        return;
+    }
+    
+    if (pkt->kind != EDTSP_PROBE_ECHO) return;
+    
+    for (int i = 0; i < MAX_PENDING_PROBES; i++) {
+        PendingProbe *p = &pending_probes[i];
+        if (!p->in_use || p->seq != pkt->probe_seq || p->peer_id != pkt->header.source_id) continue;
+        
+        EDTSPNetIface *probed = edtsp_net_iface(p->iface_idx);
+        uint32_t rtt = edtsp_rtt_on_echo(p->peer_id, pkt->interface_type,
+                                         p->t1_us, pkt->t2_us, pkt->t3_us, rx->rx_us);
+        p->in_use = false;
+        
+        for (int j = 0; j < MAX_PENDING_PROBES; j++) {
+            if (pending_probes[j].in_use && pending_probes[j].round == p->round) {
+                pending_probes[j].round_answered = true;
+            }
+        }
+        
+        if (edtsp_net_report_probe(probed, true, rtt)) send_discovery();
+        return;
+    }
+}
+
+void handle_sync(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPSyncPacket *pkt = data;
+    (void)ctx;
+    
+    if (pkt->target_id != my_id) return;
+    
+    if (pkt->kind == EDTSP_SYNC_REQUEST) {
+        // Answer in sample-clock domain so the master can map DATA timestamps
+        EDTSPSyncPacket reply;
+        edtsp_build_sync(&reply, my_id, EDTSP_SYNC_REPLY, pkt->sync_seq,
+                         pkt->header.source_id, pkt->t1_us,
+                         rx->rx_us - start_time_us, get_sample_clock_us());
+        send_packet(&reply, sizeof(reply));
+    } else if (pkt->kind == EDTSP_SYNC_REPLY && edtsp_is_master()) {
+        edtsp_clock_on_reply(pkt->header.source_id, pkt->t1_us,
+                             pkt->t2_us, pkt->t3_us, rx->rx_us);
+    }
+}
+
+void handle_data(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPDataPacket *pkt = data;
+    uint64_t master_us;
+    (void)ctx;
+    
+    // data_len is the sender's claim: the bytes must be in this frame, or
+    // the decoders below would read another packet's leftovers
+    if (pkt->data_len > sizeof(pkt->data) || offsetof(EDTSPDataPacket, data) + pkt->data_len > rx->len) {
+        rx_bad_data_len++;
+        return;
+    }
+    
+    // The master ingests DATA sent to the group, an ingest node what its
+    // assigned slaves send to its ingest socket
+    bool sharded = rx->iface && rx->iface == edtsp_net_ingest();
+    bool ingest = sharded || edtsp_is_master();
+    bool zoned = edtsp_zone_id() && edtsp_is_master();
+    
+    if (sharded) edtsp_shard_on_data();
+    if (edtsp_is_master()) {
+        // Keyed on the device table: unjoined or spoofed IDs take no entry
+        edtsp_flow_on_data(edtsp_get_device_slot(pkt->header.source_id));
+        if (zoned) edtsp_zone_agg_frame(edtsp_zone_agg(), (uint16_t)(rx->len - offsetof(EDTSPDataPacket, data)));
+    }
+#ifdef EDTSP_TEST_HOOKS
+    if (ingest && ingest_cost_us) {
+        uint64_t until = get_time_us() + ingest_cost_us;
+        while (get_time_us() < until) {}
+    }
+#endif
+    
+    // Common timebase at ingest: unwrap + offset/drift correction
+    bool synced = edtsp_clock_to_master_us(pkt->header.source_id, pkt->timestamp_ms,
+                                           rx->rx_us, &master_us);
+    
+    // Packed block: delta-decode the samples it carries
+    if (ingest && (rx->frame.flags & EDTSP_FLAG_COMPRESSED)) {
+        int32_t samples[EDTSP_PACK_OUT_LEN];
+        uint16_t interval_ms;
+        int n = edtsp_unpack_on_data(pkt, rx->len, samples, &interval_ms);
+        if (n > 0 && zoned) edtsp_zone_agg_samples(edtsp_zone_agg(), pkt->sensor_id, samples, n);
+        if (n > 0) {
+            printf("[RX] DATA from 0x%08X: Sensor=%u, %d packed samples every %u ms (%d .. %d) in %zu bytes, "
+                   "T=%llu us%s\n", pkt->header.source_id, pkt->sensor_id, n, interval_ms, samples[0],
+                   samples[n - 1], rx->len - offsetof(EDTSPDataPacket, data),
+                   (unsigned long long)master_us, synced ? "" : " (unsynced)");
+        }
+        return;
+    }
+    
+    // Window summary: one record stands for a whole window of samples
+    EDTSPWindowSummary sum;
+    if (ingest && edtsp_summary_on_data(pkt, &sum)) {
+        if (zoned) {
+            edtsp_zone_agg_window(edtsp_zone_agg(), pkt->sensor_id, sum.count, sum.min, sum.max, sum.mean);
+        }
+        printf("[RX] DATA from 0x%08X: Sensor=%u, %u samples min=%d max=%d mean=%d rms=%u, T=%llu us%s\n",
+               pkt->header.source_id, pkt->sensor_id, sum.count, sum.min, sum.max, sum.mean, sum.rms,
+               (unsigned long long)master_us, synced ? "" : " (unsynced)");
+        return;
+    }
+    
+    if (!ingest || pkt->data_len != EDTSP_DEADBAND_RECORD_LEN) {
+        printf("[RX] DATA from 0x%08X: Sensor=%u, Len=%u, T=%llu us%s\n",
+               pkt->header.source_id, pkt->sensor_id, pkt->data_len,
+               (unsigned long long)master_us, synced ? "" : " (unsynced)");
+        return;
+    }
+    
+    // Report by exception: rebuild the samples the slave held back
+    int samples = edtsp_recon_on_data(pkt);
+    if (samples > 0) {
+        printf("[RX] DATA from 0x%08X: Sensor=%u, %d sample(s) rebuilt, T=%llu us%s\n",
+               pkt->header.source_id, pkt->sensor_id, samples,
+               (unsigned long long)master_us, synced ? "" : " (unsynced)");
+    }
+}
+
+void handle_config(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPConfigPacket *pkt = data;
+    (void)ctx;
+    
+    if (pkt->target_id != my_id) return;
+    
+    // Ingest assignment from the current master: no sensor setting
+    if (pkt->sensor_id == EDTSP_CONFIG_NO_SENSOR) {
+        if (rx->len < sizeof(*pkt) || pkt->header.source_id != edtsp_get_master_id()) return;
+        EDTSPShardTarget target = { pkt->ingest_id, pkt->ingest_addr, pkt->ingest_port };
+        if (target.id != edtsp_shard_target()->id) {
+            printf("[RX] CONFIG from 0x%08X: DATA to %s 0x%08X\n", pkt->header.source_id,
+                   target.id ? "ingest node" : "the master", target.id ? target.id : pkt->header.source_id);
+        }
+        edtsp_shard_set_target(&target);
+        return;
+    }
+    if (pkt->sensor_id >= EDTSP_GROUP_MAX_SETTINGS) return;
+    
+    // Older nodes send CONFIG without the report-by-exception / window / pack fields
+    bool report = rx->len >= offsetof(EDTSPConfigPacket, window_ms);
+    bool window = rx->len >= offsetof(EDTSPConfigPacket, pack_samples);
+    bool pack = rx->len >= offsetof(EDTSPConfigPacket, ingest_id);
+    uint16_t deadband = report ? pkt->deadband : 0;
+    uint32_t silence_ms = report ? pkt->max_silence_ms : 0;
+    uint32_t window_ms = window ? pkt->window_ms : 0;
+    uint8_t pack_samples = pack ? pkt->pack_samples : 0;
+    
+    sensor_rate_ms[pkt->sensor_id] = pkt->enable ? pkt->sampling_rate_ms : 0;
+    edtsp_deadband_configure(&sensor_filter[pkt->sensor_id], deadband, silence_ms);
+    edtsp_window_configure(&sensor_window[pkt->sensor_id], window_ms);
+    edtsp_pack_configure(&sensor_packer[pkt->sensor_id], pack_samples);
+    sensor_decimator[pkt->sensor_id].count = 0;
+    
+    printf("[RX] CONFIG from 0x%08X: sensor %u every %u ms, deadband %u, max silence %u ms, window %u ms, "
+           "pack %u\n", pkt->header.source_id, pkt->sensor_id, sensor_rate_ms[pkt->sensor_id], deadband,
+           silence_ms, window_ms, pack_samples);
+}
+
+void handle_actuate(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPActuatePacket *pkt = data;
+    (void)ctx;
+    
+    if (pkt->target_id != my_id) return;
+    
+    if (pkt->kind == EDTSP_ACTUATE_COMMAND) {
+        bool duplicate;
+        uint8_t status = edtsp_actuate_apply(pkt->header.source_id, pkt, &duplicate);
+        
+        // t2/t3 bracket the output write, t1 is echoed for the master's RTT
+        EDTSPActuatePacket ack;
+        edtsp_build_actuate(&ack, my_id, EDTSP_ACTUATE_ACK, pkt->priority, pkt->act_seq,
+                            pkt->header.source_id, pkt->output_id, pkt->channel, status,
+                            pkt->value, pkt->t1_us, rx->rx_us, get_time_us());
+        send_packet(&ack, sizeof(ack));
+        if (use_io_uring) edtsp_uring_flush();
+    } else if (pkt->kind == EDTSP_ACTUATE_ACK) {
+        edtsp_actuate_on_ack(pkt, rx->rx_us);
+    }
+}
+
+void handle_group_config(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPGroupConfigPacket *pkt = data;
+    EDTSPSensorSetting settings[EDTSP_GROUP_MAX_SETTINGS];
+    (void)ctx;
+    
+    if (!edtsp_group_valid(pkt, rx->len)) return;
+    if (!edtsp_group_match(pkt, my_id, my_capabilities())) return;
+    
+    int n = edtsp_group_settings(pkt, settings, EDTSP_GROUP_MAX_SETTINGS);
+    for (int i = 0; i < n; i++) {
+        if (settings[i].sensor_id >= EDTSP_GROUP_MAX_SETTINGS) continue;
+        sensor_rate_ms[settings[i].sensor_id] = settings[i].enable ? settings[i].sampling_rate_ms : 0;
+    }
+    
+    printf("[RX] GROUP_CONFIG #%u from 0x%08X: %d setting(s) applied (%u targets in packet)\n",
+           pkt->config_seq, pkt->header.source_id, n, pkt->target_count);
+}
+
+void handle_credit(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPCreditPacket *pkt = data;
+    uint16_t before = flow.max_fps;
+    (void)rx;
+    (void)ctx;
+    
+    if (edtsp_is_master() || !edtsp_flow_on_credit(&flow, pkt, my_id, (uint32_t)get_time_ms())) return;
+    if (pkt->max_fps == before) return;
+    
+    if (pkt->max_fps == EDTSP_FLOW_UNLIMITED) {
+        printf("[RX] CREDIT #%u from 0x%08X: cap lifted\n", pkt->credit_seq, pkt->header.source_id);
+    } else {
+        printf("[RX] CREDIT #%u from 0x%08X: cap %u frames/s (master queue %u%%)\n",
+               pkt->credit_seq, pkt->header.source_id, pkt->max_fps, pkt->queue_pct);
+    }
+}
+
+/** Record a zone summary heard on the uplink and log it */
+void handle_zone_summary(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    EDTSPZoneSummaryPacket *pkt = data;
+    (void)ctx;
+    
+    // Only the uplink carries summaries
+    if (!rx->iface || rx->iface != edtsp_net_uplink()) return;
+    if (!edtsp_zone_on_summary(pkt->header.source_id, pkt, rx->len, get_time_ms())) return;
+    
+    printf("[RX] ZONE_SUMMARY zone %u from 0x%08X: %u member(s), %u DATA frame(s) in %u ms\n",
+           pkt->zone_id, pkt->header.source_id, pkt->members, pkt->data_frames, pkt->interval_ms);
+}
+
+/** Master of a zone: fold rebuilt report-by-exception samples into the zone aggregate */
+void zone_sample(uint32_t device_id, uint8_t sensor_id, uint32_t timestamp_ms,
+                 int32_t value, bool reported, void *ctx) {
+    (void)device_id;
+    (void)timestamp_ms;
+    (void)reported;
+    (void)ctx;
+    if (edtsp_is_master()) edtsp_zone_agg_samples(edtsp_zone_agg(), sensor_id, &value, 1);
+}
+
+/** Log the first packet of each unhandled type; the rest are only counted */
+void handle_unhandled(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    static bool logged[EDTSP_DISPATCH_TYPES];
+    (void)data;
+    (void)ctx;
+    
+    if (logged[rx->frame.type]) return;
+    logged[rx->frame.type] = true;
+    printf("[RX] Packet type %s (%u) from 0x%08X (not yet handled, counted in stats)\n",
+           edtsp_type_name(rx->frame.type), rx->frame.type, rx->frame.source_id);
+}
+
+void register_handlers(void) {
+    edtsp_dispatch_init();
+    edtsp_dispatch_register(EDTSP_TYPE_DISCOVERY, 0, NULL, handle_discovery, NULL);
+    // Accept HEARTBEAT frames from nodes that predate sharded ingest
+    edtsp_dispatch_register(EDTSP_TYPE_HEARTBEAT, offsetof(EDTSPHeartbeatPacket, ingest_addr), NULL,
+                            handle_heartbeat, NULL);
+    // Accept HANDSHAKE frames from nodes that predate capability descriptors
+    edtsp_dispatch_register(EDTSP_TYPE_HANDSHAKE, offsetof(EDTSPHandshakePacket, desc_len), NULL,
+                            handle_handshake, NULL);
+    edtsp_dispatch_register(EDTSP_TYPE_PROBE, 0, NULL, handle_probe, NULL);
+    edtsp_dispatch_register(EDTSP_TYPE_SYNC, 0, NULL, handle_sync, NULL);
+    edtsp_dispatch_register(EDTSP_TYPE_DATA, 0, NULL, handle_data, NULL);
+    edtsp_dispatch_register(EDTSP_TYPE_ACTUATE, 0, NULL, handle_actuate, NULL);
+    edtsp_dispatch_register(EDTSP_TYPE_GROUP_CONFIG, 0, NULL, handle_group_config, NULL);
+    edtsp_dispatch_register(EDTSP_TYPE_CREDIT, 0, NULL, handle_credit, NULL);
+    edtsp_dispatch_register(EDTSP_TYPE_ZONE_SUMMARY, 0, NULL, handle_zone_summary, NULL);
+    edtsp_dispatch_register(EDTSP_TYPE_CONFIG, offsetof(EDTSPConfigPacket, deadband), NULL,
+                            handle_config, NULL);
+    edtsp_dispatch_set_priority(EDTSP_TYPE_ACTUATE, true); // Ahead of bulk DATA in a batch
+    edtsp_dispatch_set_unhandled(handle_unhandled, NULL);
+}
+
+/**
+ * Validate one datagram and turn it into a dispatch entry
+ * 
+ * @return false if the packet is invalid, our own, replayed, or a redundant copy
+ */
+bool prepare_packet(uint8_t *buffer, size_t bytes, EDTSPNetIface *iface,
+                    uint64_t rx_us, EDTSPRxPacket *rx) {
+    EDTSPFrameInfo *info = &rx->frame;
+    
+    // Validate v1 or v2 header; v2 frames are rebased to a v1 packet view
+    if (!edtsp_decode_frame(buffer, bytes, info)) {
+        return false; // Invalid packet
     }
     
     // Ignore own packets
-    if (header_copy.source_id == my_id) return;
-    
-    // Dispatch by type
-    switch (header_copy.type) {
-        case EDTSP_TYPE_DISCOVERY:
-            if (bytes >= sizeof(EDTSPDiscoveryPacket)) {
-                EDTSPDiscoveryPacket *pkt = (EDTSPDiscoveryPacket*)buffer;
-                pkt->header = header_copy;
-                handle_discovery(pkt);
+    if (info->source_id == my_id) return false;
+    
+    // Still sealed: no key for it (or encryption off here)
+    if (info->flags & EDTSP_FLAG_ENCRYPTED) return false;
+    
+    // Signed frames (tag checked by the caller): the sequence window drops
+    // replays, and the second dual-path copy, before they cost the source
+    // any tokens
+    if (edtsp_auth_enabled() && !edtsp_auth_replay_check(info->source_id, info->seq, rx_us / 1000)) return false;
+    
+    // Per-source token bucket: a flooding node is cut off before any other work
+    if (!edtsp_ratelimit_admit(info->source_id, rx_us)) return false;
+    
+    // Dual-path copies: deliver only the first one. With authentication the
+    // window above has done it; the trailer is not covered by the tag.
+    uint16_t rct_seq;
+    size_t frame_len = (size_t)info->header_len + info->payload_len +
+                       (info->flags & EDTSP_FLAG_AUTHENTICATED ? EDTSP_AUTH_TAG_LEN : 0);
+    if (!edtsp_auth_enabled() && edtsp_parse_trailer(buffer, bytes, frame_len, &rct_seq) &&
+        !edtsp_dedup_accept(info->source_id, rct_seq, rx_us / 1000)) {
+        return false;
+    }
+    
+    rx_frames[info->version >= 2 ? 2 : 1]++;
+    if (info->version >= 2) edtsp_set_device_version(info->source_id, info->version);
+    
+    rx->pkt = buffer + info->offset;
+    rx->len = (uint16_t)(bytes - info->offset);
+    if (info->flags & EDTSP_FLAG_AUTHENTICATED) rx->len -= EDTSP_AUTH_TAG_LEN; // Not part of the packet
+    rx->iface = iface;
+    rx->rx_us = rx_us;
+    rx->arena = &rx_arena;
+    return true;
+}
+
+/** Posted receive buffers of one interface socket (kept across calls) */
+typedef struct {
+    struct mmsghdr msgs[RX_BATCH];
+    struct iovec   iov[RX_BATCH];
+    uint8_t        cmsg[RX_BATCH][CMSG_SPACE(sizeof(struct timespec))];
+    int            posted;
+} RxRing;
+
+static RxRing rx_rings[EDTSP_MAX_IFACES + 1];  // Last: ingest socket
+
+/** Receive ring of an interface, filled from the packet pool on first use */
+RxRing *rx_ring(EDTSPNetIface *iface) {
+    RxRing *ring = &rx_rings[iface == edtsp_net_ingest() ? EDTSP_MAX_IFACES : iface - edtsp_net_iface(0)];
+    if (ring->posted) return ring;
+    
+    for (int i = 0; i < RX_BATCH; i++) {
+        ring->iov[i].iov_base = edtsp_pool_alloc();
+        if (!ring->iov[i].iov_base) break;
+        ring->iov[i].iov_len = EDTSP_POOL_BUF_SIZE;
+        memset(&ring->msgs[i].msg_hdr, 0, sizeof(ring->msgs[i].msg_hdr));
+        ring->msgs[i].msg_hdr.msg_iov = &ring->iov[i];
+        ring->msgs[i].msg_hdr.msg_iovlen = 1;
+        ring->msgs[i].msg_hdr.msg_control = ring->cmsg[i];
+        ring->msgs[i].msg_hdr.msg_controllen = sizeof(ring->cmsg[i]);
+        ring->posted++;
+    }
+    return ring;
+}
+
+void release_rx_rings(void) {
+    for (int r = 0; r <= EDTSP_MAX_IFACES; r++) {
+        for (int i = 0; i < rx_rings[r].posted; i++) edtsp_pool_free(rx_rings[r].iov[i].iov_base);
+        rx_rings[r].posted = 0;
+    }
+}
+
+/** Kernel receive timestamp (SO_TIMESTAMPNS); tv_sec = 0 if absent */
+void rx_timestamp(struct msghdr *msg, struct timespec *ts) {
+    ts->tv_sec = 0;
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(msg); c; c = CMSG_NXTHDR(msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(ts, CMSG_DATA(c), sizeof(*ts));
+        }
+    }
+}
+
+/**
+ * Drain the socket in recvmmsg batches
+ * 
+ * Control packets are dispatched at once, grouped by type. DATA packets
+ * move to the deferred queue (their buffer is swapped for a fresh one)
+ * and are dispatched by serve_data() after the loop's timers.
+ * 
+ * Receive buffers stay posted between calls and per-batch scratch memory
+ * is reset after dispatch, so the receive path does no heap allocation.
+ * At most RX_DRAIN_BATCHES batches are taken per call; the socket stays
+ * readable and the rest is picked up on the next loop iteration.
+ * 
+ * @return Datagrams received
+ */
+int receive_packets(EDTSPNetIface *iface) {
+    static EDTSPRxPacket batch[RX_BATCH];
+    static struct timespec kernel_ts[RX_BATCH];
+    static uint8_t *frames[RX_BATCH];
+    static uint16_t lens[RX_BATCH];
+    static bool authentic[RX_BATCH];
+    RxRing *ring = rx_ring(iface);
+    int total = 0;
+    
+    for (int round = 0; round < RX_DRAIN_BATCHES && ring->posted > 0; round++) {
+        int received = recvmmsg(iface->fd, ring->msgs, (unsigned int)ring->posted, MSG_DONTWAIT, NULL);
+        if (received <= 0) break;
+        
+        uint64_t rx_us = get_time_us();
+        int count = 0;
+        
+        iface->rx_packets += (uint32_t)received;
+        
+        // Tags are checked on the raw frames, decoding rewrites the header.
+        // Sealed payloads of authentic frames are then opened together.
+        if (edtsp_auth_enabled()) {
+            for (int i = 0; i < received; i++) {
+                frames[i] = ring->iov[i].iov_base;
+                lens[i] = (uint16_t)ring->msgs[i].msg_len;
+            }
+            edtsp_auth_verify_batch((const uint8_t *const *)frames, lens, received, authentic);
+            if (edtsp_aead_enabled()) edtsp_aead_open_frames(frames, lens, received, authentic);
+        }
+        
+        for (int i = 0; i < received; i++) {
+            struct msghdr *msg = &ring->msgs[i].msg_hdr;
+            msg->msg_controllen = sizeof(ring->cmsg[i]); // Kernel shrinks it
+            if (edtsp_auth_enabled() && !authentic[i]) continue;
+            size_t bytes = edtsp_auth_enabled() ? lens[i] : ring->msgs[i].msg_len;
+            if (!prepare_packet(ring->iov[i].iov_base, bytes, iface, rx_us, &batch[count])) {
+                continue;
             }
-            break;
             
-        case EDTSP_TYPE_HEARTBEAT:
-            if (bytes >= sizeof(EDTSPHeartbeatPacket)) {
-                EDTSPHeartbeatPacket *pkt = (EDTSPHeartbeatPacket*)buffer;
-                pkt->header = header_copy;
-                handle_heartbeat(pkt);
+            // DATA keeps its buffer in the queue; without a spare one to
+            // post instead it is dispatched with this batch
+            void *spare;
+            if (edtsp_tclass_of(batch[count].frame.type) == EDTSP_CLASS_DATA && (spare = edtsp_pool_alloc())) {
+                if (edtsp_tclass_defer(&batch[count], ring->iov[i].iov_base)) {
+                    ring->iov[i].iov_base = spare;
+                } else {
+                    edtsp_pool_free(spare); // Queue full: dropped
+                }
+                continue;
             }
-            break;
             
-        default:
-            printf("[RX] Packet type %s from 0x%08X (not yet handled)\n",
-                   edtsp_type_name(header_copy.type), header_copy.source_id);
-            break;
+            rx_timestamp(msg, &kernel_ts[count]);
+            count++;
+        }
+        
+        // Receive-to-handler latency: kernel timestamp to dispatch
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        uint64_t dispatch_us = get_time_us();
+        for (int i = 0; i < count; i++) {
+            if (kernel_ts[i].tv_sec) edtsp_busy_record(&kernel_ts[i], &now);
+            edtsp_tclass_on_rx(edtsp_tclass_of(batch[i].frame.type), (uint32_t)(dispatch_us - batch[i].rx_us));
+        }
+        
+        edtsp_dispatch_batch(batch, count);
+        edtsp_arena_reset(&rx_arena);
+        total += received;
+        if (received < ring->posted) break;
+    }
+    return total;
+}
+
+/**
+ * Drain the uplink socket (sub-masters)
+ * 
+ * One summary per zone per second: a plain recv per datagram, dispatched
+ * at once, polled from the main loop in every backend.
+ * 
+ * @return Datagrams received
+ */
+int receive_uplink(void) {
+    static uint8_t buf[EDTSP_POOL_BUF_SIZE] __attribute__((aligned(EDTSP_CACHE_LINE)));
+    EDTSPNetIface *uplink = edtsp_net_uplink();
+    EDTSPRxPacket rx;
+    ssize_t bytes;
+    int total = 0;
+    
+    if (!uplink) return 0;
+    
+    while ((bytes = recv(uplink->fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        uplink->rx_packets++;
+        total++;
+        if (edtsp_auth_enabled() && !edtsp_auth_verify(buf, (size_t)bytes)) continue;
+        if (!prepare_packet(buf, (size_t)bytes, uplink, get_time_us(), &rx)) continue;
+        edtsp_dispatch(&rx);
+        edtsp_arena_reset(&rx_arena);
+    }
+    return total;
+}
+
+// io_uring backend: completions arrive per packet, dispatched per batch
+static EDTSPRxPacket uring_batch[RX_BATCH];
+static int uring_count = 0;
+
+void uring_batch_end(void) {
+    uint64_t dispatch_us = get_time_us();
+    for (int i = 0; i < uring_count; i++) {
+        edtsp_tclass_on_rx(edtsp_tclass_of(uring_batch[i].frame.type),
+                           (uint32_t)(dispatch_us - uring_batch[i].rx_us));
+    }
+    edtsp_dispatch_batch(uring_batch, uring_count);
+    edtsp_arena_reset(&rx_arena);
+    uring_count = 0;
+}
+
+/** Control joins the batch; DATA is copied out of the ring buffer and deferred */
+void uring_recv(EDTSPNetIface *iface, uint8_t *data, size_t len, uint64_t rx_us) {
+    if (uring_count == RX_BATCH) uring_batch_end();
+    
+    EDTSPRxPacket *rx = &uring_batch[uring_count];
+    if (edtsp_auth_enabled() && !edtsp_auth_verify(data, len)) return;
+    if (edtsp_aead_enabled()) {
+        uint16_t len16 = (uint16_t)len;
+        bool opened = true;
+        edtsp_aead_open_frames(&data, &len16, 1, &opened);
+        if (!opened) return;
+        len = len16;
+    }
+    if (!prepare_packet(data, len, iface, rx_us, rx)) return;
+    
+    uint8_t *copy;
+    if (edtsp_tclass_of(rx->frame.type) == EDTSP_CLASS_DATA && len <= EDTSP_POOL_BUF_SIZE &&
+        (copy = edtsp_pool_alloc())) {
+        memcpy(copy, data, len);
+        rx->pkt = copy + (rx->pkt - data);
+        if (!edtsp_tclass_defer(rx, copy)) edtsp_pool_free(copy);
+        return;
+    }
+    uring_count++;
+}
+
+void uring_netlink(void) {
+    if (edtsp_net_handle_netlink()) send_discovery(); // Announce new active interface
+}
+
+/**
+ * Dispatch deferred DATA, oldest first, for up to EDTSP_TCLASS_SLICE_US
+ * 
+ * Called once per loop iteration after the timers; what is left waits for
+ * the next iteration, so control is never held up by more than one slice.
+ * 
+ * @return Packets dispatched
+ */
+int serve_data(void) {
+    uint64_t start_us = get_time_us();
+    uint64_t now_us = start_us;
+    EDTSPRxPacket rx;
+    void *buf;
+    int served = 0;
+    
+    while (now_us - start_us < EDTSP_TCLASS_SLICE_US && edtsp_tclass_next(&rx, &buf)) {
+        edtsp_tclass_on_rx(EDTSP_CLASS_DATA, (uint32_t)(now_us - rx.rx_us));
+        edtsp_dispatch(&rx);
+        edtsp_pool_free(buf);
+        served++;
+        now_us = get_time_us();
+    }
+    if (served) edtsp_arena_reset(&rx_arena);
+    return served;
+}
+
+/** Return the buffers of packets still deferred at shutdown */
+void release_deferred(void) {
+    EDTSPRxPacket rx;
+    void *buf;
+    while (edtsp_tclass_next(&rx, &buf)) edtsp_pool_free(buf);
+}
+
+// ============================================================================
+// LATENCY PROBING
+// ============================================================================
+
+/** Spread probes so each peer is probed once per EDTSP_PROBE_PERIOD_MS */
+uint64_t probe_interval_ms(void) {
+    uint16_t peers = edtsp_get_active_device_count() - 1;
+    uint64_t interval = peers ? EDTSP_PROBE_PERIOD_MS / peers : EDTSP_PROBE_PERIOD_MS;
+    return interval < EDTSP_LINK_PROBE_INTERVAL_MS ? EDTSP_LINK_PROBE_INTERVAL_MS : interval;
+}
+
+/** Probe the next peer (round-robin) on every healthy link */
+void send_probes(uint64_t now_ms) {
+    uint32_t ids[EDTSP_MAX_DEVICES];
+    int n = edtsp_get_active_device_ids(ids, EDTSP_MAX_DEVICES);
+    if (n == 0) return;
+    
+    uint32_t peer = ids[probe_cursor++ % (uint32_t)n];
+    uint16_t round = ++probe_round;
+    uint64_t deadline = now_ms + edtsp_rtt_rto_ms(peer);
+    
+    for (int i = 0; i < edtsp_net_iface_count(); i++) {
+        EDTSPNetIface *iface = edtsp_net_iface(i);
+        if (!iface->healthy) continue;
+        
+        PendingProbe *slot = NULL;
+        for (int j = 0; j < MAX_PENDING_PROBES && !slot; j++) {
+            if (!pending_probes[j].in_use) slot = &pending_probes[j];
+        }
+        if (!slot) return; // Too many outstanding, skip this round
+        
+        EDTSPProbePacket pkt;
+        uint64_t t1 = get_time_us();
+        edtsp_build_probe(&pkt, my_id, EDTSP_PROBE_REQUEST, iface->type,
+                          probe_seq, peer, t1, 0, 0);
+        if (!send_packet_on(iface, &pkt, sizeof(pkt))) continue;
+        
+        slot->in_use = true;
+        slot->round_answered = false;
+        slot->seq = probe_seq++;
+        slot->round = round;
+        slot->peer_id = peer;
+        slot->iface_idx = i;
+        slot->t1_us = t1;
+        slot->deadline_ms = deadline;
+    }
+}
+
+/** Expire unanswered probes: link loss if the peer answered elsewhere */
+void expire_probes(uint64_t now_ms) {
+    for (int i = 0; i < MAX_PENDING_PROBES; i++) {
+        PendingProbe *p = &pending_probes[i];
+        if (!p->in_use || now_ms < p->deadline_ms) continue;
+        
+        p->in_use = false;
+        
+        if (p->round_answered) {
+            if (edtsp_net_report_probe(edtsp_net_iface(p->iface_idx), false, 0)) {
+                send_discovery();
+            }
+            continue;
+        }
+        
+        // Silent on every link: peer loss, counted once per round
+        edtsp_rtt_on_loss(p->peer_id);
+        for (int j = 0; j < MAX_PENDING_PROBES; j++) {
+            if (pending_probes[j].in_use && pending_probes[j].round == p->round) {
+                pending_probes[j].in_use = false;
+            }
+        }
+    }
+}
+
+// ============================================================================
+// CLOCK SYNC (Master)
+// ============================================================================
+
+/** Sync the next slave so each one is refreshed every EDTSP_SYNC_PERIOD_MS */
+uint64_t sync_interval_ms(void) {
+    uint16_t peers = edtsp_get_active_device_count() - 1;
+    return peers ? EDTSP_SYNC_PERIOD_MS / peers : EDTSP_SYNC_PERIOD_MS;
+}
+
+void send_sync_request(void) {
+    uint32_t ids[EDTSP_MAX_DEVICES];
+    int n = edtsp_get_active_device_ids(ids, EDTSP_MAX_DEVICES);
+    if (n == 0 || !edtsp_is_master()) return;
+    
+    // t1 travels in the packet and comes back, no pending state needed
+    EDTSPSyncPacket pkt;
+    edtsp_build_sync(&pkt, my_id, EDTSP_SYNC_REQUEST, sync_seq++,
+                     ids[sync_cursor++ % (uint32_t)n], get_time_us(), 0, 0);
+    send_packet(&pkt, sizeof(pkt));
+}
+
+// ============================================================================
+// ACTUATION
+// ============================================================================
+
+/** Simulated relay bank / PWM channels standing in for GPIO on a PC slave */
+uint8_t sim_output(uint8_t output_id, uint8_t channel, uint32_t value, void *ctx) {
+    (void)ctx;
+    
+    if (channel >= 4) return EDTSP_ACTUATE_STATUS_REJECTED;
+    
+    if (output_id == EDTSP_OUTPUT_RELAY) {
+        if (value) sim_relay |= (uint8_t)(1u << channel);
+        else sim_relay &= (uint8_t)~(1u << channel);
+    } else {
+        if (value > 10000) return EDTSP_ACTUATE_STATUS_REJECTED;
+        sim_pwm[channel] = value;
+    }
+    return EDTSP_ACTUATE_STATUS_OK;
+}
+
+/** Transmit a command (host byte order); urgent ones skip send batching */
+void transmit_actuate(const EDTSPActuatePacket *cmd) {
+    EDTSPActuatePacket pkt;
+    edtsp_build_actuate(&pkt, my_id, EDTSP_ACTUATE_COMMAND, cmd->priority, cmd->act_seq,
+                        cmd->target_id, cmd->output_id, cmd->channel, 0, cmd->value,
+                        cmd->t1_us, 0, 0);
+    send_packet(&pkt, sizeof(pkt));
+    if (use_io_uring && cmd->priority == EDTSP_ACTUATE_PRIO_URGENT) edtsp_uring_flush();
+}
+
+/**
+ * Command an output on a slave (master)
+ * 
+ * @param value Relay: 0 = off, 1 = on; PWM: duty in 0.01 %
+ * @return false if too many commands are outstanding
+ */
+bool send_actuate(uint32_t target, uint8_t output_id, uint8_t channel,
+                  uint32_t value, uint8_t priority) {
+    EDTSPActuatePacket cmd;
+    uint64_t now = get_time_us();
+    
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.kind = EDTSP_ACTUATE_COMMAND;
+    cmd.priority = priority;
+    cmd.act_seq = actuate_seq;
+    cmd.target_id = target;
+    cmd.output_id = output_id;
+    cmd.channel = channel;
+    cmd.value = value;
+    cmd.t1_us = now;
+    if (!edtsp_actuate_track(&cmd, now)) return false;
+    
+    actuate_seq++;
+    transmit_actuate(&cmd);
+    return true;
+}
+
+/** Resend commands whose acknowledgement is overdue */
+void retransmit_actuate(void) {
+    EDTSPActuatePacket due[8];
+    int n = edtsp_actuate_due(get_time_us(), due, 8);
+    
+    for (int i = 0; i < n; i++) transmit_actuate(&due[i]);
+}
+
+/** Test traffic (--actuate): toggle relay channel 0 on each slave in turn */
+void send_actuate_test(void) {
+    uint32_t ids[EDTSP_MAX_DEVICES];
+    int n = edtsp_get_active_device_ids(ids, EDTSP_MAX_DEVICES);
+    if (n == 0 || !edtsp_is_master()) return;
+    
+    uint32_t target = ids[actuate_cursor % (uint32_t)n];
+    send_actuate(target, EDTSP_OUTPUT_RELAY, 0, (actuate_cursor / (uint32_t)n) & 1,
+                 EDTSP_ACTUATE_PRIO_URGENT);
+    actuate_cursor++;
+}
+
+// ============================================================================
+// JOIN HANDSHAKE
+// ============================================================================
+
+/** Outputs (actuate) plus the sensors we describe */
+EDTSPCapabilityMask my_capabilities(void) {
+    return edtsp_actuate_capabilities() | edtsp_capdesc_mask(my_sensors, my_sensor_count);
+}
+
+/**
+ * Handshake send callback: our capabilities on the active interface,
+ * descriptors in SYN, SESSION records in SYN and SYN-ACK with encryption on
+ */
+void send_handshake(uint8_t step, uint32_t target, void *ctx) {
+    EDTSPHandshakePacket pkt;
+    uint8_t tlv[sizeof(pkt.descriptors)];
+    EDTSPNetIface *iface = edtsp_net_active();
+    (void)ctx;
+    
+    edtsp_build_handshake(&pkt, my_id, step, target, my_capabilities(),
+                          iface ? iface->type : EDTSP_IFACE_UNKNOWN);
+    
+    int len = 0;
+    if (step == EDTSP_HANDSHAKE_SYN) {
+        len = edtsp_capdesc_encode(my_sensors, my_sensor_count, tlv, sizeof(tlv));
+        if (len < 0) len = 0;
     }
+    
+    if (edtsp_aead_enabled()) {
+        const EDTSPAeadSession *s = edtsp_aead_session(target);
+        int n = 0;
+        if (step == EDTSP_HANDSHAKE_SYN) {
+            if (join.syns == 0) join_nonce = random_nonce(); // Retransmissions repeat it
+            n = edtsp_capdesc_encode_session(join_nonce, edtsp_aead_offer(), tlv + len, (int)sizeof(tlv) - len);
+        } else if (step == EDTSP_HANDSHAKE_SYN_ACK && s) {
+            n = edtsp_capdesc_encode_session(s->master_nonce, s->key.alg, tlv + len, (int)sizeof(tlv) - len);
+        }
+        if (n > 0) len += n;
+    }
+    send_packet(&pkt, edtsp_capdesc_attach(&pkt, tlv, len));
+}
+
+/** Follow the elected master: slaves (re)join, the master answers joins */
+void run_handshake(void) {
+    uint64_t now = get_time_us();
+    
+    if (edtsp_get_my_role() == EDTSP_ROLE_SLAVE) {
+        edtsp_join_set_master(&join, edtsp_get_master_id(), now);
+        edtsp_join_poll(&join, now);
+    } else {
+        edtsp_join_set_master(&join, 0, now);
+        if (edtsp_is_master()) edtsp_hs_poll(now);
+    }
+}
+
+// ============================================================================
+// GROUP CONFIGURATION (Master)
+// ============================================================================
+
+/**
+ * Send settings to a set of slaves: one packet per EDTSP_GROUP_IDS_PER_PACKET
+ * IDs instead of one CONFIG per slave and sensor
+ * 
+ * @param ids Target IDs (sorted in place); NULL/0 = every slave
+ * @return Packets sent
+ */
+int send_group_config(const EDTSPSensorSetting *settings, int nsettings, uint32_t *ids, int nids) {
+    EDTSPGroupConfigPacket pkt;
+    uint8_t selector = (ids && nids) ? EDTSP_GROUP_IDS : EDTSP_GROUP_ALL;
+    int packets = 0;
+    int done = 0;
+    
+    nids = edtsp_group_sort_ids(ids, nids);
+    do {
+        int used;
+        size_t len = edtsp_group_build(&pkt, my_id, group_seq++, selector, 0, settings, nsettings,
+                                       ids ? ids + done : NULL, nids - done, &used);
+        if (!len) break;
+        send_packet(&pkt, len);
+        done += used;
+        packets++;
+    } while (done < nids);
+    
+    printf("[TX] GROUP_CONFIG: %d setting(s) to %d slave(s) in %d packet(s)\n",
+           nsettings, selector == EDTSP_GROUP_IDS ? nids : edtsp_get_active_device_count() - 1,
+           packets);
+    return packets;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * --configure planner: each slave gets the requested interval raised to its
+ * sensor's native limit (capability descriptors), slaves without that
+ * sensor are left out. One GROUP_CONFIG run per distinct interval; pushed
+ * again whenever the slave set or their descriptors change.
+ */
+void push_configuration(void) {
+    uint32_t ids[EDTSP_MAX_DEVICES];
+    uint64_t plan[EDTSP_MAX_DEVICES];   // interval << 32 | slave ID
+    int planned = 0;
+    
+    if (!configure_enabled || !edtsp_is_master()) return;
+    
+    int n = edtsp_get_active_device_ids(ids, EDTSP_MAX_DEVICES);
+    uint32_t generation = edtsp_capdesc_generation();
+    if (n == configured_slaves && generation == configured_generation) return;
+    
+    configured_slaves = n;
+    configured_generation = generation;
+    
+    for (int i = 0; i < n; i++) {
+        uint16_t ms = configure_setting.sampling_rate_ms;
+        if (configure_setting.enable) {
+            ms = edtsp_capdesc_plan_interval(edtsp_get_device_slot(ids[i]), configure_setting.sensor_id, ms);
+            if (!ms) continue;
+        }
+        plan[planned++] = (uint64_t)ms << 32 | ids[i];
+    }
+    qsort(plan, (size_t)planned, sizeof(plan[0]), cmp_u64);
+    
+    // GROUP_CONFIG settings carry no deadband, window or packing: those go per slave
+    if (configure_report) {
+        for (int i = 0; i < planned; i++) {
+            EDTSPConfigPacket pkt;
+            edtsp_build_config(&pkt, my_id, (uint32_t)plan[i], configure_setting.sensor_id,
+                               (uint16_t)(plan[i] >> 32), configure_setting.enable,
+                               configure_deadband, configure_silence_ms, configure_window_ms,
+                               configure_pack);
+            send_packet(&pkt, sizeof(pkt));
+        }
+        printf("[TX] CONFIG: sensor %u, deadband %u, max silence %u ms, window %u ms, pack %u to %d slave(s)\n",
+               configure_setting.sensor_id, configure_deadband, configure_silence_ms,
+               configure_window_ms, configure_pack, planned);
+        return;
+    }
+    
+    for (int start = 0, end; start < planned; start = end) {
+        EDTSPSensorSetting setting = configure_setting;
+        setting.sampling_rate_ms = (uint16_t)(plan[start] >> 32);
+        for (end = start; end < planned && (plan[end] >> 32) == setting.sampling_rate_ms; end++) {
+            ids[end - start] = (uint32_t)plan[end];
+        }
+        send_group_config(&setting, 1, ids, end - start);
+    }
+}
+
+// ============================================================================
+// SAMPLING (Slave)
+// ============================================================================
+
+/** Simulated slow sensor: a random walk that moves one raw unit now and then */
+int32_t sim_sensor_read(int sensor) {
+    int r = rand() % 16;
+    if (r == 0) sim_value[sensor]++;
+    else if (r == 1) sim_value[sensor]--;
+    return sim_value[sensor];
+}
+
+/**
+ * Sample every configured sensor that is due. A sensor with a window sends
+ * one summary per window, one with packing one block per pack_samples;
+ * otherwise DATA goes out for reportable samples.
+ */
+void sample_sensors(void) {
+    uint64_t now_us = get_sample_clock_us();
+    uint64_t now_ms = now_us / 1000;
+    
+    for (int i = 0; i < EDTSP_GROUP_MAX_SETTINGS; i++) {
+        if (!sensor_rate_ms[i]) {
+            next_sample_ms[i] = 0;
+            continue;
+        }
+        if (now_ms < next_sample_ms[i]) continue;
+        
+        // Keep the grid; skip ahead instead of bursting after a stall. Samples
+        // are stamped with their grid time, so packed blocks stay regular.
+        uint64_t due_ms = next_sample_ms[i] ? next_sample_ms[i] : now_ms;
+        edtsp_tclass_on_late(EDTSP_CLASS_DATA, (uint32_t)(now_us - due_ms * 1000));
+        next_sample_ms[i] = due_ms + sensor_rate_ms[i];
+        if (next_sample_ms[i] <= now_ms) {
+            due_ms = now_ms;
+            next_sample_ms[i] = now_ms + sensor_rate_ms[i];
+        }
+        
+        int32_t value = sim_sensor_read(i);
+        EDTSPDataPacket pkt;
+        uint8_t record[sizeof(pkt.data)];
+        uint8_t len;
+        bool pack = sensor_packer[i].max_samples > 1 && tx_v2(EDTSP_TYPE_DATA);
+        
+        // Over the master's cap: report the average of 2^level samples
+        // (summaries are aggregated already)
+        uint32_t sample_ms = (uint32_t)due_ms;
+        if (!sensor_window[i].window_ms &&
+            !edtsp_decimate(&flow, &sensor_decimator[i], value, sample_ms, &value, &sample_ms)) {
+            continue;
+        }
+        
+        if (sensor_window[i].window_ms) {
+            EDTSPWindowSummary sum;
+            if (!edtsp_window_sample(&sensor_window[i], value, sample_ms, &sum)) continue;
+            len = edtsp_window_record(&sum, record);
+            edtsp_build_data(&pkt, my_id, (uint8_t)i, sum.start_ms, record, len);
+        } else if (pack) {
+            // The block fills the v2 payload, past the 64-byte data field
+            static uint8_t frame[offsetof(EDTSPDataPacket, data) + EDTSP_PACK_BLOCK_MAX];
+            uint32_t start_ms;
+            uint16_t block = edtsp_pack_sample(&sensor_packer[i], value, sample_ms,
+                                               frame + offsetof(EDTSPDataPacket, data), &start_ms);
+            if (!block) continue;
+            edtsp_build_packed_data((EDTSPDataPacket*)frame, my_id, (uint8_t)i, start_ms, block);
+            send_data(frame, offsetof(EDTSPDataPacket, data) + block, EDTSP_PACK_FLAGS);
+            edtsp_flow_on_sent(&flow);
+            continue;
+        } else {
+            if (!edtsp_deadband_sample(&sensor_filter[i], value, sample_ms)) continue;
+            len = edtsp_deadband_record(&sensor_filter[i], value, record);
+            edtsp_build_data(&pkt, my_id, (uint8_t)i, sample_ms, record, len);
+        }
+        send_data(&pkt, offsetof(EDTSPDataPacket, data) + len, 0);
+        edtsp_flow_on_sent(&flow);
+    }
+}
+
+// ============================================================================
+// FLOW CONTROL
+// ============================================================================
+
+/** Master: sample the receive queues and advertise the DATA cap */
+void flow_control(uint64_t now) {
+    uint8_t peak = 0;
+    uint32_t drops = 0;
+    
+    for (int i = 0; i < edtsp_net_iface_count(); i++) {
+        uint8_t pct;
+        uint32_t d;
+        if (!edtsp_net_rx_queue(edtsp_net_iface(i), &pct, &d)) continue;
+        if (pct > peak) peak = pct;
+        drops += d;
+    }
+    
+    // Deferred DATA is the ingest queue proper; its overflow counts as loss
+    uint32_t deferred_pct = edtsp_tclass_backlog() * 100 / EDTSP_TCLASS_QUEUE;
+    if (deferred_pct > peak) peak = (uint8_t)deferred_pct;
+    drops += edtsp_tclass_stats(EDTSP_CLASS_DATA)->dropped;
+    edtsp_flow_on_queue(peak, drops);
+    
+    uint16_t max_fps;
+    uint8_t queue_pct;
+    if (!edtsp_flow_tick((uint32_t)now, &max_fps, &queue_pct)) return;
+    
+    EDTSPCreditPacket pkt;
+    edtsp_build_credit(&pkt, my_id, 0, credit_seq++, max_fps, EDTSP_FLOW_LIFETIME_MS, queue_pct);
+    send_packet(&pkt, sizeof(pkt));
 }
 
 // ============================================================================
@@ -205,7 +1493,7 @@ void send_discovery(void) {
     char hostname[64];
     gethostname(hostname, sizeof(hostname));
     
-    edtsp_build_discovery(&pkt, my_id, EDTSP_IFACE_ETH, hostname);
+    edtsp_build_discovery(&pkt, my_id, edtsp_net_active_type(), hostname);
     send_packet(&pkt, sizeof(pkt));
     
     printf("[TX] DISCOVERY sent\n");
@@ -214,16 +1502,357 @@ void send_discovery(void) {
 void send_heartbeat(void) {
     EDTSPHeartbeatPacket pkt;
     uint32_t uptime = (uint32_t)(get_time_ms() - start_time_ms);
+    uint32_t ingest_addr = 0;
+    uint16_t ingest_port = 0;
     
-    edtsp_build_heartbeat(&pkt, my_id, edtsp_get_my_role(), uptime, edtsp_get_active_device_count());
+    edtsp_net_ingest_addr(&ingest_addr, &ingest_port);
+    edtsp_build_heartbeat(&pkt, my_id, edtsp_get_my_role(), uptime, edtsp_get_active_device_count(),
+                          ingest_addr, ingest_port);
     send_packet(&pkt, sizeof(pkt));
     
     printf("[TX] HEARTBEAT sent: Role=%s\n", edtsp_role_name(edtsp_get_my_role()));
 }
 
+/**
+ * Zones: the zone master holds the uplink and sends the zone summary once
+ * per heartbeat interval; a master that loses the zone election leaves it
+ */
+void zone_tick(uint64_t now) {
+    if (!edtsp_zone_id()) return;
+    
+    // Alone in the zone after a heartbeat timeout: nothing triggers an
+    // election, but the zone still needs its sub-master
+    if (edtsp_get_my_role() == EDTSP_ROLE_UNKNOWN && now - start_time_ms >= EDTSP_HEARTBEAT_TIMEOUT_MS) {
+        edtsp_perform_election();
+    }
+    
+    if (edtsp_is_master() != edtsp_zone_uplink()) {
+        if (edtsp_is_master()) {
+            if (!edtsp_net_open_uplink()) return;
+            edtsp_zone_set_uplink(true, now);
+        } else {
+            edtsp_zone_set_uplink(false, now);
+            edtsp_net_close_uplink();
+            return;
+        }
+    }
+    if (!edtsp_zone_uplink()) return;
+    
+    EDTSPZoneSummaryPacket pkt;
+    size_t len = edtsp_zone_summary(&pkt, now);
+    if (len && send_uplink(&pkt, len)) {
+        printf("[TX] ZONE_SUMMARY sent: zone %u, %u member(s)%s\n", edtsp_zone_id(),
+               edtsp_zone_agg()->members, edtsp_zone_is_top() ? ", TOP MASTER" : "");
+    }
+}
+
+/**
+ * Sharded ingest: an ingest node keeps itself on the ring; the master
+ * assigns every slave and sends the CONFIGs that are due (call every second)
+ */
+void shard_tick(uint64_t now) {
+    uint32_t ids[EDTSP_MAX_DEVICES];
+    uint32_t addr;
+    uint16_t port;
+    int sent = 0;
+    
+    if (edtsp_net_ingest_addr(&addr, &port)) edtsp_shard_on_ingest(my_id, addr, port, now);
+    edtsp_shard_check_timeouts(now);
+    
+    // Sealed DATA can only be opened by the master (session keys)
+    if (!edtsp_is_master() || edtsp_aead_enabled()) return;
+    
+    int n = edtsp_get_active_device_ids(ids, EDTSP_MAX_DEVICES);
+    for (int i = 0; i < n; i++) {
+        EDTSPShardTarget t;
+        if (!edtsp_shard_assign(edtsp_get_device_slot(ids[i]), ids[i], now, &t)) continue;
+        
+        EDTSPConfigPacket pkt;
+        edtsp_build_assign(&pkt, my_id, ids[i], t.id, t.addr, t.port);
+        send_packet(&pkt, sizeof(pkt));
+        sent++;
+    }
+    if (sent) {
+        printf("[TX] CONFIG: %d ingest assignment(s), %d node(s) on the ring\n", sent, edtsp_shard_nodes());
+    }
+}
+
+int setup_event_loop(void) {
+    struct epoll_event ev;
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+        perror("[MAIN] epoll_create1");
+        return -1;
+    }
+    
+    for (int i = 0; i < edtsp_net_iface_count(); i++) {
+        EDTSPNetIface *iface = edtsp_net_iface(i);
+        ev.events = EPOLLIN;
+        ev.data.ptr = iface;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, iface->fd, &ev);
+    }
+    
+    if (edtsp_net_ingest()) {
+        ev.events = EPOLLIN;
+        ev.data.ptr = edtsp_net_ingest();
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, edtsp_net_ingest()->fd, &ev);
+    }
+    
+    // Netlink events are tagged with a NULL pointer
+    if (edtsp_net_netlink_fd() >= 0) {
+        ev.events = EPOLLIN;
+        ev.data.ptr = NULL;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, edtsp_net_netlink_fd(), &ev);
+    }
+    
+    return epoll_fd;
+}
+
+void print_usage(const char *prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  -r, --redundant   Send every packet on two interfaces (PRP style)\n");
+    printf("  -u, --io-uring    io_uring network backend (falls back to epoll)\n");
+    printf("  -b, --busy-poll[=CPU]  Spin on a pinned CPU instead of sleeping (low latency)\n");
+    printf("  -f, --fifo=PRIO   Run the busy-poll loop under SCHED_FIFO\n");
+    printf("  -a, --actuate=HZ  Master: toggle a relay on each slave in turn at HZ (test traffic)\n");
+    printf("  -c, --configure=SENSOR:MS[:DEADBAND[:SILENCE_MS]]\n");
+    printf("                    Master: set a sensor's sampling interval on all slaves, optionally\n");
+    printf("                    reporting only changes > DEADBAND or after SILENCE_MS of silence\n");
+    printf("  -w, --window=MS   Master: with --configure, send one min/max/mean/RMS summary per MS\n");
+    printf("  -p, --pack=N      Master: with --configure, send samples delta-packed, up to N per DATA\n");
+    printf("                    (255 = as many as fit one frame; needs a v2 network)\n");
+    printf("  -s, --sensor=KIND:MIN_MS   Describe a simulated sensor (capability bit, fastest interval)\n");
+#ifdef EDTSP_TEST_HOOKS
+    printf("  -i, --ingest-cost=US  Master: spend US per DATA frame (simulated slow storage)\n");
+#endif
+    printf("  -l, --rate-limit=PPS[:BURST[:STRANGER_PPS]]\n");
+    printf("                    Frames per second accepted from each device (0 = off, default %u:%u:%u)\n",
+           EDTSP_RATELIMIT_DEVICE_PPS, EDTSP_RATELIMIT_DEVICE_BURST, EDTSP_RATELIMIT_STRANGER_PPS);
+    printf("  -k, --auth-key=HEX  Network key (%d hex digits, or EDTSP_AUTH_KEY): sign every frame,\n",
+           2 * EDTSP_AUTH_KEY_LEN);
+    printf("                    drop unsigned, forged and replayed ones\n");
+    printf("  -e, --encrypt[=aes|chacha]  With --auth-key: encrypt DATA to the master under per-join\n");
+    printf("                    session keys (default: AES-128-GCM if the CPU has AES-NI, else ChaCha20)\n");
+    printf("  -z, --zone=N      Join zone N (1-%d): own group and election; the zone master\n",
+           EDTSP_ZONE_MAX_ID);
+    printf("                    sends zone summaries to a top master elected on the uplink\n");
+    printf("  -d, --ingest      Take a share of the DATA: the master assigns slaves to ingest nodes\n");
+    printf("                    by consistent hashing, and they send to this node directly\n");
+    printf("  -h, --help        Show this help\n");
+}
+
+bool parse_args(int argc, char **argv) {
+    static const struct option long_opts[] = {
+        {"redundant", no_argument, NULL, 'r'},
+        {"io-uring",  no_argument, NULL, 'u'},
+        {"busy-poll", optional_argument, NULL, 'b'},
+        {"fifo",      required_argument, NULL, 'f'},
+        {"actuate",   required_argument, NULL, 'a'},
+        {"configure", required_argument, NULL, 'c'},
+        {"window",    required_argument, NULL, 'w'},
+        {"pack",      required_argument, NULL, 'p'},
+        {"sensor",    required_argument, NULL, 's'},
+        {"rate-limit", required_argument, NULL, 'l'},
+        {"ingest-cost", required_argument, NULL, 'i'},
+        {"auth-key",  required_argument, NULL, 'k'},
+        {"encrypt",   optional_argument, NULL, 'e'},
+        {"zone",      required_argument, NULL, 'z'},
+        {"ingest",    no_argument, NULL, 'd'},
+        {"help",      no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    int opt;
+    
+    while ((opt = getopt_long(argc, argv, "rub::f:a:c:w:p:s:l:i:k:e::z:dh", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'r':
+                redundant_mode = true;
+                break;
+            case 'u':
+                use_io_uring = true;
+                break;
+            case 'b':
+                busy_poll.enabled = true;
+                if (optarg) busy_poll.cpu = atoi(optarg);
+                break;
+            case 'f':
+                busy_poll.fifo_prio = atoi(optarg);
+                break;
+            case 'a':
+                actuate_test_hz = (uint32_t)atoi(optarg);
+                break;
+            case 'c': {
+                unsigned sensor, rate, deadband = 0, silence = 0;
+                int fields = sscanf(optarg, "%u:%u:%u:%u", &sensor, &rate, &deadband, &silence);
+                if (fields < 2 || sensor >= EDTSP_GROUP_MAX_SETTINGS || rate > UINT16_MAX ||
+                    deadband > UINT16_MAX) {
+                    fprintf(stderr, "--configure expects SENSOR:MS[:DEADBAND[:SILENCE_MS]] (sensor 0-15)\n");
+                    return false;
+                }
+                configure_report = configure_report || fields > 2;
+                configure_deadband = (uint16_t)deadband;
+                configure_silence_ms = silence;
+                configure_setting.sensor_id = (uint8_t)sensor;
+                configure_setting.enable = rate > 0;
+                configure_setting.sampling_rate_ms = (uint16_t)rate;
+                configure_enabled = true;
+                break;
+            }
+            case 'w':
+                configure_window_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                configure_report = configure_report || configure_window_ms > 0;
+                break;
+            case 'p': {
+                unsigned n = (unsigned)strtoul(optarg, NULL, 10);
+                configure_pack = (uint8_t)(n > EDTSP_PACK_FILL ? EDTSP_PACK_FILL : n);
+                configure_report = configure_report || configure_pack > 1;
+                break;
+            }
+            case 's': {
+                unsigned kind, min_ms;
+                if (sscanf(optarg, "%u:%u", &kind, &min_ms) != 2 || kind > 15 || min_ms > UINT16_MAX ||
+                    my_sensor_count >= EDTSP_CAPDESC_MAX_SENSORS) {
+                    fprintf(stderr, "--sensor expects KIND:MIN_MS (kind 0-15, at most %d sensors)\n",
+                            EDTSP_CAPDESC_MAX_SENSORS);
+                    return false;
+                }
+                EDTSPSensorDesc *d = &my_sensors[my_sensor_count++];
+                d->kind = (uint8_t)kind;
+                d->min_interval_ms = (uint16_t)min_ms;
+                for (int i = 0; i < my_sensor_count - 1; i++) d->instance += my_sensors[i].kind == kind;
+                break;
+            }
+            case 'i':
+#ifdef EDTSP_TEST_HOOKS
+                ingest_cost_us = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+#else
+                fprintf(stderr, "--ingest-cost is a test hook; build with EXTRA_CFLAGS=-DEDTSP_TEST_HOOKS\n");
+                return false;
+#endif
+            case 'l': {
+                unsigned pps, burst = rate_limit.device_burst, stranger = rate_limit.stranger_pps;
+                if (sscanf(optarg, "%u:%u:%u", &pps, &burst, &stranger) < 1) {
+                    fprintf(stderr, "--rate-limit expects PPS[:BURST[:STRANGER_PPS]]\n");
+                    return false;
+                }
+                rate_limit.device_pps = pps;
+                rate_limit.device_burst = burst ? burst : 1;
+                rate_limit.stranger_pps = stranger;
+                break;
+            }
+            case 'k':
+                if (!edtsp_auth_parse_key(optarg, auth_key)) {
+                    fprintf(stderr, "--auth-key expects %d hex digits\n", 2 * EDTSP_AUTH_KEY_LEN);
+                    return false;
+                }
+                auth_keyed = true;
+                break;
+            case 'e':
+                if (!optarg) {
+                    encrypt_algs = EDTSP_AEAD_AES128_GCM | EDTSP_AEAD_CHACHA20_POLY1305;
+                } else if (strcmp(optarg, "aes") == 0) {
+                    encrypt_algs = EDTSP_AEAD_AES128_GCM;
+                } else if (strcmp(optarg, "chacha") == 0) {
+                    encrypt_algs = EDTSP_AEAD_CHACHA20_POLY1305;
+                } else {
+                    fprintf(stderr, "--encrypt expects aes or chacha\n");
+                    return false;
+                }
+                break;
+            case 'z': {
+                unsigned long z = strtoul(optarg, NULL, 10);
+                if (z < 1 || z > EDTSP_ZONE_MAX_ID) {
+                    fprintf(stderr, "--zone expects 1-%d\n", EDTSP_ZONE_MAX_ID);
+                    return false;
+                }
+                zone_opt = (uint16_t)z;
+                break;
+            }
+            case 'd':
+                ingest_opt = true;
+                break;
+            default:
+                print_usage(argv[0]);
+                return false;
+        }
+    }
+    
+    const char *env_key = getenv("EDTSP_AUTH_KEY");
+    if (!auth_keyed && env_key && *env_key) {
+        if (!edtsp_auth_parse_key(env_key, auth_key)) {
+            fprintf(stderr, "EDTSP_AUTH_KEY expects %d hex digits\n", 2 * EDTSP_AUTH_KEY_LEN);
+            return false;
+        }
+        auth_keyed = true;
+    }
+    
+    if (encrypt_algs && !auth_keyed) {
+        fprintf(stderr, "--encrypt derives its keys from the network key: it needs --auth-key\n");
+        return false;
+    }
+    if (encrypt_algs && ingest_opt) {
+        fprintf(stderr, "--ingest cannot open DATA sealed for the master: it excludes --encrypt\n");
+        return false;
+    }
+    if ((encrypt_algs & edtsp_aead_supported()) == 0 && encrypt_algs) {
+        fprintf(stderr, "--encrypt=aes needs a CPU with AES-NI and PCLMULQDQ\n");
+        return false;
+    }
+    
+    if (busy_poll.enabled && use_io_uring) {
+        fprintf(stderr, "--busy-poll spins on the sockets; it cannot be combined with --io-uring\n");
+        return false;
+    }
+    return true;
+}
+
+/** Stats endpoint: dumped on SIGUSR1 (kill -USR1 <pid>) */
+void print_stats(void) {
+    const EDTSPDedupStats *st = edtsp_dedup_stats();
+    
+    printf("\n[STATS] === Node 0x%08X (%s) ===\n", my_id, edtsp_role_name(edtsp_get_my_role()));
+    edtsp_net_print();
+    printf("  Redundancy: %s, accepted=%u duplicates=%u stale=%u resets=%u (%u sources tracked)\n",
+           redundant_mode ? "DUAL-PATH" : "single-path",
+           st->accepted, st->duplicates, st->stale, st->window_resets, st->sources);
+    printf("  Protocol: sending v%u, rx v1=%u v2=%u, DATA with a bad length=%u\n",
+           edtsp_get_min_peer_version() >= 2 ? 2 : 1, rx_frames[1], rx_frames[2], rx_bad_data_len);
+    edtsp_rtt_print();
+    edtsp_clock_print(get_time_us());
+    edtsp_dispatch_print();
+    edtsp_tclass_print();
+    edtsp_actuate_print();
+    edtsp_hs_print(&join);
+    edtsp_index_print();
+    edtsp_capdesc_print();
+    for (int i = 0; i < EDTSP_GROUP_MAX_SETTINGS; i++) {
+        if (sensor_rate_ms[i]) printf("  Sensor %d: sampling every %u ms\n", i, sensor_rate_ms[i]);
+    }
+    edtsp_deadband_print(sensor_filter, EDTSP_GROUP_MAX_SETTINGS);
+    edtsp_recon_print();
+    edtsp_window_print(sensor_window, EDTSP_GROUP_MAX_SETTINGS);
+    edtsp_summary_print();
+    edtsp_pack_print(sensor_packer, EDTSP_GROUP_MAX_SETTINGS);
+    edtsp_unpack_print();
+    edtsp_ratelimit_print();
+    edtsp_auth_print();
+    edtsp_aead_print();
+    edtsp_zone_print();
+    edtsp_shard_print();
+    edtsp_flow_slave_print(&flow);
+    edtsp_flow_print();
+    edtsp_busy_print();
+    if (use_io_uring) edtsp_uring_print();
+    edtsp_pool_print();
+    edtsp_arena_print("rx", &rx_arena);
+    printf("=====================================\n\n");
+}
+
 int main(int argc, char **argv) {
-    (void)argc; // Unused
-    (void)argv; // Unused
+    if (!parse_args(argc, argv)) {
+        return 1;
+    }
     
     printf("========================================\n");
     printf("  EDTSP PC Implementation\n");
@@ -232,19 +1861,72 @@ int main(int argc, char **argv) {
     // Handle signals
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    signal(SIGUSR1, stats_signal_handler);
     
     // Initialize device ID
     my_id = edtsp_get_device_id();
     start_time_ms = get_time_ms();
+    start_time_us = start_time_ms * 1000;
     
-    // Initialize election
+    // Initialize zone, sharding, election and join handshake
+    edtsp_zone_init(zone_opt, my_id);
+    edtsp_shard_init(my_id);
     edtsp_election_init(my_id);
+    edtsp_hs_init(send_handshake, NULL);
+    edtsp_recon_init(zone_opt ? zone_sample : NULL, NULL);
+    edtsp_summary_init();
+    edtsp_unpack_init();
+    edtsp_ratelimit_init(&rate_limit);
+    edtsp_auth_init(auth_keyed ? auth_key : NULL);
+    if (auth_keyed) tx_seq = edtsp_auth_initial_seq(get_time_us());
+    edtsp_aead_init(encrypt_algs != 0, encrypt_algs, my_id);
+    edtsp_tclass_init();
+    edtsp_flow_init();
+    edtsp_flow_slave_init(&flow, (uint32_t)start_time_ms);
+    edtsp_join_init(&join, my_id, send_handshake, NULL);
+    edtsp_dedup_init();
+    register_handlers();
+    
+    // Packet buffers and batch scratch memory: the last heap allocations
+    static uint8_t rx_arena_mem[RX_ARENA_SIZE] __attribute__((aligned(EDTSP_CACHE_LINE)));
+    if (!edtsp_pool_init(RX_POOL_BUFFERS + (use_io_uring ? EDTSP_URING_POOL_BUFFERS : 0))) {
+        fprintf(stderr, "Failed to allocate packet buffers!\n");
+        return 1;
+    }
+    edtsp_arena_init(&rx_arena, rx_arena_mem, sizeof(rx_arena_mem));
+    edtsp_rtt_init();
+    edtsp_clock_init();
+    edtsp_actuate_init();
+    edtsp_actuate_register_output(EDTSP_OUTPUT_RELAY, sim_output, NULL);
+    edtsp_actuate_register_output(EDTSP_OUTPUT_PWM, sim_output, NULL);
     
-    // Setup network
-    if (!setup_udp_socket()) {
+    // Setup network (one socket per physical interface)
+    edtsp_net_set_zone(zone_opt);
+    if (!edtsp_net_open()) {
         fprintf(stderr, "Failed to setup network!\n");
         return 1;
     }
+    if (ingest_opt && !edtsp_net_open_ingest()) {
+        fprintf(stderr, "Failed to open the ingest socket!\n");
+        return 1;
+    }
+    
+    if (use_io_uring && !edtsp_uring_open(uring_recv, uring_batch_end, uring_netlink)) {
+        printf("[MAIN] io_uring unavailable, using epoll\n");
+        use_io_uring = false;
+    }
+    
+    edtsp_busy_enable_timestamps();
+    if (!edtsp_busy_setup(&busy_poll)) {
+        fprintf(stderr, "Failed to enable busy-poll mode!\n");
+        return 1;
+    }
+    
+    int epoll_fd = (use_io_uring || busy_poll.enabled) ? -1 : setup_event_loop();
+    if (!use_io_uring && !busy_poll.enabled && epoll_fd < 0) {
+        fprintf(stderr, "Failed to setup event loop!\n");
+        return 1;
+    }
     
     // Send initial discovery
     send_discovery();
@@ -253,6 +1935,12 @@ int main(int argc, char **argv) {
     uint64_t last_heartbeat = 0;
     uint64_t last_timeout_check = 0;
     uint64_t last_status_print = 0;
+    uint64_t last_link_probe = 0;
+    uint64_t last_latency_probe = 0;
+    uint64_t last_sync = 0;
+    uint64_t last_netlink_check = 0;
+    uint64_t last_actuate_us = 0;
+    uint64_t last_queue_sample = 0;
     
     printf("\n[MAIN] Starting main loop...\n\n");
     
@@ -261,30 +1949,138 @@ int main(int argc, char **argv) {
         
         // Send heartbeat every 1 second
         if (now - last_heartbeat >= EDTSP_HEARTBEAT_INTERVAL_MS) {
+            if (last_heartbeat) {
+                uint64_t due_us = (last_heartbeat + EDTSP_HEARTBEAT_INTERVAL_MS) * 1000;
+                edtsp_tclass_on_late(EDTSP_CLASS_CONTROL, (uint32_t)(get_time_us() - due_us));
+            }
             send_heartbeat();
+            zone_tick(now);
             last_heartbeat = now;
         }
         
         // Check timeouts every 1 second
         if (now - last_timeout_check >= 1000) {
             edtsp_check_timeouts(now);
+            edtsp_zone_check_timeouts(now);
+            shard_tick(now);
             last_timeout_check = now;
         }
         
+        // Probe link health so a degraded primary is left within tens of ms
+        if (now - last_link_probe >= EDTSP_LINK_PROBE_INTERVAL_MS) {
+            if (edtsp_net_probe_links()) send_discovery();
+            last_link_probe = now;
+        }
+        
+        // Latency probes at a low per-peer rate
+        if (now - last_latency_probe >= probe_interval_ms()) {
+            send_probes(now);
+            last_latency_probe = now;
+        }
+        expire_probes(now);
+        
+        // Newcomers learn our version (one batched reply for a join burst)
+        if (discovery_due_ms && now >= discovery_due_ms) {
+            send_discovery();
+            discovery_due_ms = 0;
+        }
+        
+        // Master keeps per-slave clock models fresh
+        if (now - last_sync >= sync_interval_ms()) {
+            send_sync_request();
+            last_sync = now;
+        }
+        
+        // Backpressure: master caps slave DATA rates from its receive queue depth
+        if (now - last_queue_sample >= EDTSP_FLOW_SAMPLE_MS) {
+            if (edtsp_is_master()) flow_control(now);
+            last_queue_sample = now;
+        }
+        if (edtsp_flow_slave_tick(&flow, (uint32_t)now)) {
+            printf("[FLOW] Sending %u frames/s against a cap of %u: averaging %u sample(s)\n",
+                   flow.rate_fps, flow.max_fps, 1u << flow.level);
+        }
+        
+        run_handshake();
+        push_configuration();
+        sample_sensors();
+        
+        // Actuation: overdue commands are resent within a few ms, not at the next probe
+        retransmit_actuate();
+        if (actuate_test_hz && get_time_us() - last_actuate_us >= 1000000 / actuate_test_hz) {
+            send_actuate_test();
+            last_actuate_us = get_time_us();
+        }
+        
+        if (stats_requested) {
+            stats_requested = false;
+            print_stats();
+        }
+        
         // Print status every 5 seconds
         if (now - last_status_print >= 5000) {
             edtsp_print_device_list();
+            edtsp_net_print();
             last_status_print = now;
         }
         
-        // Receive packets
-        receive_packets();
+        // Zone summaries from other sub-masters (uplink)
+        receive_uplink();
+        
+        // Deferred DATA gets one slice, after the timers above
+        serve_data();
+        
+        // Busy-poll: never sleep, netlink is drained with the link probes
+        if (busy_poll.enabled) {
+            int received = 0;
+            for (int i = 0; i < edtsp_net_iface_count(); i++) {
+                received += receive_packets(edtsp_net_iface(i));
+            }
+            if (edtsp_net_ingest()) received += receive_packets(edtsp_net_ingest());
+            if (now != last_netlink_check) {
+                if (edtsp_net_handle_netlink()) send_discovery();
+                last_netlink_check = now;
+            }
+            edtsp_busy_count_loop(received == 0);
+            continue;
+        }
+        
+        // Receive packets (wake at least every link probe interval, every ms
+        // while commands are outstanding so retransmissions are not late)
+        const EDTSPActuateStats *act = edtsp_actuate_stats();
+        int wait_ms = (actuate_test_hz || act->sent != act->acked + act->failed)
+                      ? 1 : EDTSP_LINK_PROBE_INTERVAL_MS;
+        if (edtsp_tclass_backlog()) wait_ms = 0; // Only poll while DATA is waiting
+        if (use_io_uring) {
+            if (edtsp_uring_wait(wait_ms) >= 0) continue;
+            
+            printf("[MAIN] io_uring failed at runtime, switching to epoll\n");
+            edtsp_uring_close();
+            use_io_uring = false;
+            epoll_fd = setup_event_loop();
+            if (epoll_fd < 0) break;
+            continue;
+        }
+        
+        struct epoll_event events[EDTSP_MAX_IFACES + 1];
+        int n = epoll_wait(epoll_fd, events, EDTSP_MAX_IFACES + 1, wait_ms);
+        for (int i = 0; i < n; i++) {
+            EDTSPNetIface *iface = events[i].data.ptr;
+            if (iface) {
+                receive_packets(iface);
+            } else if (edtsp_net_handle_netlink()) {
+                send_discovery(); // Announce new active interface
+            }
+        }
     }
     
     // Cleanup
-    if (udp_socket >= 0) {
-        close(udp_socket);
-    }
+    if (use_io_uring) edtsp_uring_close();
+    if (epoll_fd >= 0) close(epoll_fd);
+    release_rx_rings();
+    release_deferred();
+    edtsp_net_close();
+    edtsp_pool_destroy();
     
     printf("\n[MAIN] Goodbye!\n");
     return 0;
@@ -0,0 +1,522 @@
+/**
+ * @file io_uring_engine.c
+ * @brief EDTSP io_uring Network I/O Backend (PC/Linux)
+ *
+ * Request identity is carried in user_data: the upper 32 bits select the
+ * kind (receive, send, netlink poll), the lower 32 bits the interface or
+ * send slot. Receive buffers are returned to the buffer ring with a single
+ * tail update per completion batch.
+ */
+
+#define _GNU_SOURCE
+
+#include "io_uring_engine.h"
+#include "../../include/edtsp_pool.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+/** Buffer group ID of the receive buffer ring */
+#define URING_BGID 0
+
+/** Completions handled per batch (one dispatch + buffer recycle each) */
+#define URING_CQE_BATCH 32
+
+/** user_data kinds */
+#define URING_RECV    1ull
+#define URING_SEND    2ull
+#define URING_NETLINK 3ull
+#define URING_DATA(kind, idx) ((kind) << 32 | (uint32_t)(idx))
+
+/** Receive index of the ingest socket (after the interface sockets) */
+#define URING_INGEST EDTSP_MAX_IFACES
+
+_Static_assert((EDTSP_URING_RX_BUFFERS & (EDTSP_URING_RX_BUFFERS - 1)) == 0,
+               "buffer ring size must be a power of two");
+
+typedef struct {
+    EDTSPNetIface *iface;   /**< Destination (NULL = slot free) */
+    uint8_t       *buf;     /**< Pool buffer holding the frame */
+    struct iovec   iov;
+    struct msghdr  msg;
+    union {
+        struct cmsghdr align;
+        uint8_t        buf[EDTSP_NET_TOS_CMSG];
+    } control;              /**< Per-packet IP TOS */
+} EDTSPUringTxSlot;
+
+static int ring_fd = -1;
+static bool failed = false;
+
+// Submission queue
+static void *sq_ptr = NULL;
+static size_t sq_size = 0;
+static unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+static struct io_uring_sqe *sqes = NULL;
+static size_t sqes_size = 0;
+static unsigned sq_pending = 0;   // Prepared but not yet submitted
+
+// Completion queue
+static void *cq_ptr = NULL;
+static size_t cq_size = 0;
+static unsigned *cq_head, *cq_tail, *cq_mask;
+static struct io_uring_cqe *cqes = NULL;
+
+// Provided receive buffers
+static struct io_uring_buf_ring *buf_ring = NULL;
+static uint8_t *rx_bufs[EDTSP_URING_RX_BUFFERS];
+static struct msghdr recv_msg;   // Template for multishot recvmsg (no name/control)
+
+// Sends
+static EDTSPUringTxSlot tx_slots[EDTSP_URING_TX_SLOTS];
+static uint32_t tx_free[EDTSP_URING_TX_SLOTS];
+static int tx_free_count = 0;
+
+static EDTSPUringRecvFn recv_cb = NULL;
+static EDTSPUringBatchFn batch_cb = NULL;
+static EDTSPUringNetlinkFn netlink_cb = NULL;
+static EDTSPUringStats stats;
+
+// ============================================================================
+// RING PRIMITIVES
+// ============================================================================
+
+static int uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(unsigned to_submit, unsigned min_complete, unsigned flags,
+                       const void *arg, size_t argsz) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static int uring_register(unsigned opcode, const void *arg, unsigned nr) {
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr);
+}
+
+/** Receive time on the application clock (get_time_us(): wall clock) */
+static uint64_t wall_clock_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/** Submit everything prepared so far without waiting */
+static void submit_pending(void) {
+    if (!sq_pending) return;
+    int ret = uring_enter(sq_pending, 0, 0, NULL, 0);
+    stats.enters++;
+    if (ret > 0) sq_pending -= (unsigned)ret;
+}
+
+/** Get a zeroed SQE (flushes the queue once if it is full) */
+static struct io_uring_sqe *get_sqe(void) {
+    unsigned tail = *sq_tail;
+    
+    if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) > *sq_mask) {
+        submit_pending();
+        if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) > *sq_mask) return NULL;
+    }
+    
+    unsigned idx = tail & *sq_mask;
+    struct io_uring_sqe *sqe = &sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array[idx] = idx;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    sq_pending++;
+    return sqe;
+}
+
+/** Hand receive buffers back to the kernel (one tail update) */
+static void recycle_buffers(const uint16_t *bids, int count) {
+    uint16_t tail = buf_ring->tail;
+    
+    for (int i = 0; i < count; i++) {
+        struct io_uring_buf *b = &buf_ring->bufs[(uint16_t)(tail + i) & (EDTSP_URING_RX_BUFFERS - 1)];
+        b->addr = (uint64_t)(uintptr_t)rx_bufs[bids[i]];
+        b->len = EDTSP_POOL_BUF_SIZE;
+        b->bid = bids[i];
+    }
+    __atomic_store_n(&buf_ring->tail, (uint16_t)(tail + count), __ATOMIC_RELEASE);
+}
+
+// ============================================================================
+// REQUESTS
+// ============================================================================
+
+/** Socket behind a receive index */
+static EDTSPNetIface *recv_iface(int iface_idx) {
+    return iface_idx == URING_INGEST ? edtsp_net_ingest() : edtsp_net_iface(iface_idx);
+}
+
+static bool arm_recv(int iface_idx) {
+    struct io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return false;
+    
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = recv_iface(iface_idx)->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&recv_msg;
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BGID;
+    sqe->user_data = URING_DATA(URING_RECV, iface_idx);
+    return true;
+}
+
+static bool arm_netlink(void) {
+    int fd = edtsp_net_netlink_fd();
+    if (fd < 0) return true;
+    
+    struct io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return false;
+    
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = URING_DATA(URING_NETLINK, 0);
+    return true;
+}
+
+/** Transmit hook: copy into a pool buffer and queue a sendmsg */
+static bool queue_send(EDTSPNetIface *iface, const void *data, size_t len, uint8_t tos) {
+    if (tx_free_count == 0 || len > EDTSP_POOL_BUF_SIZE) {
+        stats.tx_sync++;
+        return false;
+    }
+    
+    struct io_uring_sqe *sqe = get_sqe();
+    if (!sqe) {
+        stats.tx_sync++;
+        return false;
+    }
+    
+    uint32_t slot = tx_free[--tx_free_count];
+    EDTSPUringTxSlot *tx = &tx_slots[slot];
+    
+    memcpy(tx->buf, data, len);
+    tx->iface = iface;
+    tx->iov.iov_base = tx->buf;
+    tx->iov.iov_len = len;
+    tx->msg.msg_control = tos ? tx->control.buf : NULL;
+    tx->msg.msg_controllen = tos ? edtsp_net_tos_cmsg(tx->control.buf, tos) : 0;
+    
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = iface->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&tx->msg;
+    sqe->len = 1;
+    sqe->user_data = URING_DATA(URING_SEND, slot);
+    stats.tx_queued++;
+    return true;
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+static bool map_rings(const struct io_uring_params *p) {
+    sq_size = p->sq_off.array + p->sq_entries * sizeof(unsigned);
+    cq_size = p->cq_off.cqes + p->cq_entries * sizeof(struct io_uring_cqe);
+    if (p->features & IORING_FEAT_SINGLE_MMAP) {
+        if (cq_size > sq_size) sq_size = cq_size;
+        cq_size = sq_size;
+    }
+    
+    sq_ptr = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED) return false;
+    
+    if (p->features & IORING_FEAT_SINGLE_MMAP) {
+        cq_ptr = sq_ptr;
+    } else {
+        cq_ptr = mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED) return false;
+    }
+    
+    sqes_size = p->sq_entries * sizeof(struct io_uring_sqe);
+    sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return false;
+    
+    sq_head = (unsigned*)((uint8_t*)sq_ptr + p->sq_off.head);
+    sq_tail = (unsigned*)((uint8_t*)sq_ptr + p->sq_off.tail);
+    sq_mask = (unsigned*)((uint8_t*)sq_ptr + p->sq_off.ring_mask);
+    sq_array = (unsigned*)((uint8_t*)sq_ptr + p->sq_off.array);
+    cq_head = (unsigned*)((uint8_t*)cq_ptr + p->cq_off.head);
+    cq_tail = (unsigned*)((uint8_t*)cq_ptr + p->cq_off.tail);
+    cq_mask = (unsigned*)((uint8_t*)cq_ptr + p->cq_off.ring_mask);
+    cqes = (struct io_uring_cqe*)((uint8_t*)cq_ptr + p->cq_off.cqes);
+    return true;
+}
+
+static bool setup_buffers(void) {
+    size_t ring_bytes = EDTSP_URING_RX_BUFFERS * sizeof(struct io_uring_buf);
+    
+    buf_ring = mmap(NULL, ring_bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (buf_ring == MAP_FAILED) {
+        buf_ring = NULL;
+        return false;
+    }
+    
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)buf_ring;
+    reg.ring_entries = EDTSP_URING_RX_BUFFERS;
+    reg.bgid = URING_BGID;
+    if (uring_register(IORING_REGISTER_PBUF_RING, &reg, 1) < 0) return false;
+    
+    uint16_t bids[EDTSP_URING_RX_BUFFERS];
+    for (int i = 0; i < EDTSP_URING_RX_BUFFERS; i++) {
+        rx_bufs[i] = edtsp_pool_alloc();
+        if (!rx_bufs[i]) return false;
+        bids[i] = (uint16_t)i;
+    }
+    buf_ring->tail = 0;
+    recycle_buffers(bids, EDTSP_URING_RX_BUFFERS);
+    
+    const struct sockaddr_in *group = edtsp_net_group_addr();
+    for (int i = 0; i < EDTSP_URING_TX_SLOTS; i++) {
+        EDTSPUringTxSlot *tx = &tx_slots[i];
+        tx->buf = edtsp_pool_alloc();
+        if (!tx->buf) return false;
+        memset(&tx->msg, 0, sizeof(tx->msg));
+        tx->msg.msg_name = (void*)group;
+        tx->msg.msg_namelen = sizeof(*group);
+        tx->msg.msg_iov = &tx->iov;
+        tx->msg.msg_iovlen = 1;
+        tx_free[tx_free_count++] = (uint32_t)i;
+    }
+    
+    memset(&recv_msg, 0, sizeof(recv_msg));
+    return true;
+}
+
+bool edtsp_uring_open(EDTSPUringRecvFn on_recv, EDTSPUringBatchFn on_batch,
+                      EDTSPUringNetlinkFn on_netlink) {
+    struct io_uring_params p;
+    
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+    ring_fd = uring_setup(EDTSP_URING_ENTRIES, &p);
+    if (ring_fd < 0 && errno == EINVAL) {
+        memset(&p, 0, sizeof(p)); // Kernel without the task-run hints
+        ring_fd = uring_setup(EDTSP_URING_ENTRIES, &p);
+    }
+    if (ring_fd < 0) {
+        perror("[NETWORK] io_uring_setup");
+        return false;
+    }
+    
+    if (!(p.features & IORING_FEAT_EXT_ARG)) {
+        fprintf(stderr, "[NETWORK] io_uring: kernel lacks timed waits (EXT_ARG)\n");
+        edtsp_uring_close();
+        return false;
+    }
+    
+    if (!map_rings(&p) || !setup_buffers()) {
+        perror("[NETWORK] io_uring setup");
+        edtsp_uring_close();
+        return false;
+    }
+    
+    recv_cb = on_recv;
+    batch_cb = on_batch;
+    netlink_cb = on_netlink;
+    memset(&stats, 0, sizeof(stats));
+    failed = false;
+    
+    for (int i = 0; i < edtsp_net_iface_count(); i++) {
+        if (!arm_recv(i)) {
+            edtsp_uring_close();
+            return false;
+        }
+    }
+    if (edtsp_net_ingest() && !arm_recv(URING_INGEST)) {
+        edtsp_uring_close();
+        return false;
+    }
+    arm_netlink();
+    submit_pending();
+    
+    edtsp_net_set_tx_hook(queue_send);
+    printf("[NETWORK] io_uring backend: %u entries, %d rx buffers, %d tx slots\n",
+           p.sq_entries, EDTSP_URING_RX_BUFFERS, EDTSP_URING_TX_SLOTS);
+    return true;
+}
+
+void edtsp_uring_close(void) {
+    edtsp_net_set_tx_hook(NULL);
+    
+    // Closing the ring cancels outstanding requests before buffers go back
+    if (ring_fd >= 0) close(ring_fd);
+    ring_fd = -1;
+    
+    if (sqes && sqes != MAP_FAILED) munmap(sqes, sqes_size);
+    if (cq_ptr && cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+    if (sq_ptr && sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_size);
+    if (buf_ring) munmap(buf_ring, EDTSP_URING_RX_BUFFERS * sizeof(struct io_uring_buf));
+    sqes = NULL;
+    cq_ptr = NULL;
+    sq_ptr = NULL;
+    buf_ring = NULL;
+    sq_pending = 0;
+    
+    for (int i = 0; i < EDTSP_URING_RX_BUFFERS; i++) {
+        edtsp_pool_free(rx_bufs[i]);
+        rx_bufs[i] = NULL;
+    }
+    for (int i = 0; i < EDTSP_URING_TX_SLOTS; i++) {
+        edtsp_pool_free(tx_slots[i].buf);
+        tx_slots[i].buf = NULL;
+    }
+    tx_free_count = 0;
+}
+
+// ============================================================================
+// COMPLETIONS
+// ============================================================================
+
+static void complete_recv(const struct io_uring_cqe *cqe, uint64_t rx_us,
+                          uint16_t *bids, int *nbids) {
+    int iface_idx = (int)(uint32_t)cqe->user_data;
+    
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = (uint16_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        bids[(*nbids)++] = bid;
+        
+        if (cqe->res > 0) {
+            // Buffer layout: recvmsg_out, name, control, payload
+            uint8_t *buf = rx_bufs[bid];
+            const struct io_uring_recvmsg_out *out = (const struct io_uring_recvmsg_out*)buf;
+            uint8_t *payload = buf + sizeof(*out) + out->namelen + out->controllen;
+            
+            if (out->flags & MSG_TRUNC) {
+                stats.truncated++;
+            } else {
+                EDTSPNetIface *iface = recv_iface(iface_idx);
+                iface->rx_packets++;
+                stats.rx_packets++;
+                recv_cb(iface, payload, out->payloadlen, rx_us);
+            }
+        }
+    }
+    
+    if (cqe->res == -ENOBUFS) stats.rx_nobufs++;
+    if (cqe->res == -EINVAL || cqe->res == -EOPNOTSUPP) {
+        fprintf(stderr, "[NETWORK] io_uring: multishot recvmsg unsupported (%s)\n",
+                strerror(-cqe->res));
+        failed = true;
+        return;
+    }
+    
+    // The kernel ends a multishot request on error or ring exhaustion
+    if (!(cqe->flags & IORING_CQE_F_MORE) && arm_recv(iface_idx)) stats.rearms++;
+}
+
+static void complete_send(const struct io_uring_cqe *cqe) {
+    uint32_t slot = (uint32_t)cqe->user_data;
+    EDTSPUringTxSlot *tx = &tx_slots[slot];
+    
+    if (cqe->res < 0) {
+        stats.tx_errors++;
+        edtsp_net_send_failed(tx->iface, -cqe->res);
+    }
+    tx->iface = NULL;
+    tx_free[tx_free_count++] = slot;
+}
+
+int edtsp_uring_wait(int timeout_ms) {
+    if (failed) return -1;
+    
+    struct __kernel_timespec ts = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_nsec = (long long)(timeout_ms % 1000) * 1000000
+    };
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = (uint64_t)(uintptr_t)&ts;
+    
+    // One syscall: submit queued sends/re-arms and wait for completions
+    unsigned head = *cq_head;
+    if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+        int ret = uring_enter(sq_pending, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                              &arg, sizeof(arg));
+        stats.enters++;
+        if (ret > 0) sq_pending -= (unsigned)ret;
+        if (ret < 0 && errno != ETIME && errno != EINTR && errno != EBUSY) {
+            perror("[NETWORK] io_uring_enter");
+            return 0;
+        }
+    }
+    
+    int processed = 0;
+    uint64_t rx_us = wall_clock_us();
+    
+    for (;;) {
+        unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) break;
+        
+        uint16_t bids[URING_CQE_BATCH];
+        int nbids = 0;
+        int n = 0;
+        bool netlink = false;
+        
+        for (; head != tail && n < URING_CQE_BATCH; head++, n++) {
+            const struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+            
+            switch (cqe->user_data >> 32) {
+                case URING_RECV:
+                    complete_recv(cqe, rx_us, bids, &nbids);
+                    break;
+                case URING_SEND:
+                    complete_send(cqe);
+                    break;
+                case URING_NETLINK:
+                    netlink = true;
+                    if (!(cqe->flags & IORING_CQE_F_MORE) && arm_netlink()) stats.rearms++;
+                    break;
+            }
+        }
+        
+        // Handlers run before the batch's buffers go back to the kernel
+        batch_cb();
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        if (nbids) recycle_buffers(bids, nbids);
+        if (netlink) netlink_cb();
+        
+        stats.cqes += (uint64_t)n;
+        processed += n;
+    }
+    
+    return failed ? -1 : processed;
+}
+
+void edtsp_uring_flush(void) {
+    if (ring_fd >= 0) submit_pending();
+}
+
+const EDTSPUringStats *edtsp_uring_stats(void) {
+    return &stats;
+}
+
+void edtsp_uring_print(void) {
+    uint64_t pkts = stats.rx_packets + stats.tx_queued;
+    
+    printf("  io_uring: enters=%llu cqes=%llu rx=%llu tx=%llu (%.1f pkts/syscall) sync_tx=%llu tx_err=%llu nobufs=%llu rearms=%llu trunc=%llu\n",
+           (unsigned long long)stats.enters, (unsigned long long)stats.cqes,
+           (unsigned long long)stats.rx_packets, (unsigned long long)stats.tx_queued,
+           stats.enters ? (double)pkts / (double)stats.enters : 0.0,
+           (unsigned long long)stats.tx_sync, (unsigned long long)stats.tx_errors,
+           (unsigned long long)stats.rx_nobufs, (unsigned long long)stats.rearms,
+           (unsigned long long)stats.truncated);
+}
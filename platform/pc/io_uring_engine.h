@@ -0,0 +1,87 @@
+/**
+ * @file io_uring_engine.h
+ * @brief EDTSP io_uring Network I/O Backend (PC/Linux)
+ *
+ * Alternative to the epoll + recvmmsg loop. Every interface socket, and
+ * the ingest socket when open, has one multishot recvmsg request drawing
+ * from a provided buffer ring, so the kernel keeps delivering datagrams
+ * without re-submission. Sends are queued as SQEs and submitted together
+ * with the next wait, so a loop iteration costs a single io_uring_enter()
+ * regardless of packet count.
+ *
+ * Uses the raw system calls (no liburing). Requires Linux 6.0+ (multishot
+ * recvmsg); edtsp_uring_open() fails cleanly on older kernels and the
+ * caller falls back to epoll.
+ */
+
+#ifndef EDTSP_IO_URING_ENGINE_H
+#define EDTSP_IO_URING_ENGINE_H
+
+#include "net_iface.h"
+
+/** Submission/completion queue depth */
+#define EDTSP_URING_ENTRIES 256
+
+/** Receive buffers in the provided buffer ring (power of two) */
+#define EDTSP_URING_RX_BUFFERS 256
+
+/** Concurrent in-flight sends */
+#define EDTSP_URING_TX_SLOTS 64
+
+/** Pool buffers the engine takes at open (receive ring + send slots) */
+#define EDTSP_URING_POOL_BUFFERS (EDTSP_URING_RX_BUFFERS + EDTSP_URING_TX_SLOTS)
+
+/** Called for each received datagram (buffer valid until batch_end) */
+typedef void (*EDTSPUringRecvFn)(EDTSPNetIface *iface, uint8_t *data, size_t len, uint64_t rx_us);
+
+/** Called after each completion batch, before its buffers are recycled */
+typedef void (*EDTSPUringBatchFn)(void);
+
+/** Called when the netlink socket is readable */
+typedef void (*EDTSPUringNetlinkFn)(void);
+
+/** Engine counters */
+typedef struct {
+    uint64_t enters;        /**< io_uring_enter() calls (syscalls) */
+    uint64_t cqes;          /**< Completions reaped */
+    uint64_t rx_packets;    /**< Datagrams received */
+    uint64_t tx_queued;     /**< Sends queued as SQEs */
+    uint64_t tx_sync;       /**< Sends done with sendto (no free slot) */
+    uint64_t tx_errors;     /**< Failed send completions */
+    uint64_t rx_nobufs;     /**< Receive stalled: buffer ring empty */
+    uint64_t rearms;        /**< Multishot requests re-submitted */
+    uint64_t truncated;     /**< Datagrams larger than a buffer */
+} EDTSPUringStats;
+
+/**
+ * Set up the ring, register the buffer ring (buffers taken from the
+ * packet pool) and arm receives on every interface and the ingest socket
+ * (open it first)
+ *
+ * @return false if io_uring is unavailable (use epoll instead)
+ */
+bool edtsp_uring_open(EDTSPUringRecvFn on_recv, EDTSPUringBatchFn on_batch,
+                      EDTSPUringNetlinkFn on_netlink);
+
+/** Tear down the ring and return all buffers to the pool */
+void edtsp_uring_close(void);
+
+/**
+ * Submit queued sends, wait for completions and process them
+ *
+ * @param timeout_ms Maximum wait
+ * @return Completions processed, or -1 if the backend failed at runtime
+ *         (unsupported request: the caller should switch to epoll)
+ */
+int edtsp_uring_wait(int timeout_ms);
+
+/** Submit queued sends now instead of with the next wait (urgent traffic) */
+void edtsp_uring_flush(void);
+
+/** Get counters */
+const EDTSPUringStats *edtsp_uring_stats(void);
+
+/** Print counters (for the stats endpoint) */
+void edtsp_uring_print(void);
+
+#endif // EDTSP_IO_URING_ENGINE_H
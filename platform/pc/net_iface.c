@@ -0,0 +1,631 @@
+/**
+ * @file net_iface.c
+ * @brief EDTSP Multi-Homed Network Interface Management (PC/Linux)
+ *
+ * Opens one multicast socket per physical interface (IP_MULTICAST_IF +
+ * SO_BINDTODEVICE) and keeps the transmit path on the best-priority
+ * healthy link. Link health is tracked from three sources so that a
+ * degraded primary is abandoned within tens of milliseconds instead of
+ * after a heartbeat timeout:
+ * - netlink link/address events (immediate)
+ * - carrier polling every EDTSP_LINK_PROBE_INTERVAL_MS (backup)
+ * - send errors on the active interface (immediate, with retry)
+ */
+
+#include "net_iface.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <ifaddrs.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+
+/** Time an interface stays unhealthy after a send failure (milliseconds) */
+#define EDTSP_LINK_ERROR_HOLDOFF_MS 100
+
+static EDTSPNetIface ifaces[EDTSP_MAX_IFACES];
+static uint64_t error_holdoff_until[EDTSP_MAX_IFACES];
+static int iface_count = 0;
+static int active_idx = -1;
+static int netlink_fd = -1;
+static struct sockaddr_in group_addr;
+static EDTSPNetTxHook tx_hook = NULL;
+static uint16_t zone_id = 0;
+static EDTSPNetIface uplink = { .fd = -1 };
+static struct sockaddr_in uplink_addr;
+static EDTSPNetIface ingest = { .fd = -1 };
+static uint16_t ingest_port;
+
+// ============================================================================
+// UTILITIES
+// ============================================================================
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/**
+ * Classify interface by kernel metadata and naming convention
+ *
+ * WiFi devices expose /sys/class/net/<name>/wireless; cellular modems
+ * use wwan/rmnet/ccmni style names. Everything else is treated as wired.
+ */
+static EDTSPInterfaceType classify_iface(const char *name) {
+    char path[64];
+    struct stat st;
+    
+    snprintf(path, sizeof(path), "/sys/class/net/%s/wireless", name);
+    if (stat(path, &st) == 0 || strncmp(name, "wl", 2) == 0) {
+        return EDTSP_IFACE_WIFI;
+    }
+    if (strncmp(name, "wwan", 4) == 0 || strncmp(name, "rmnet", 5) == 0 ||
+        strncmp(name, "ccmni", 5) == 0 || strncmp(name, "ww", 2) == 0) {
+        return EDTSP_IFACE_5G;
+    }
+    return EDTSP_IFACE_ETH;
+}
+
+static int find_iface_by_index(int ifindex) {
+    for (int i = 0; i < iface_count; i++) {
+        if (ifaces[i].ifindex == ifindex) return i;
+    }
+    return -1;
+}
+
+/** Selection rank: clean links first, then by interface priority */
+static int link_rank(const EDTSPNetIface *iface) {
+    return (iface->degraded ? 100 : 0) + edtsp_iface_priority(iface->type);
+}
+
+/**
+ * Re-select the transmit interface (lowest rank wins)
+ *
+ * @return true if the selection changed
+ */
+static bool select_active(void) {
+    int best = -1;
+    
+    for (int i = 0; i < iface_count; i++) {
+        if (!ifaces[i].healthy) continue;
+        if (best < 0 || link_rank(&ifaces[i]) < link_rank(&ifaces[best])) {
+            best = i;
+        }
+    }
+    
+    if (best == active_idx) return false;
+    
+    if (best < 0) {
+        printf("[NETWORK] WARNING: No healthy interface left (was %s)\n",
+               ifaces[active_idx].name);
+    } else if (active_idx < 0) {
+        printf("[NETWORK] Active interface: %s (%s)\n",
+               ifaces[best].name, edtsp_iface_name(ifaces[best].type));
+    } else {
+        printf("[NETWORK] *** LINK SWITCH: %s (%s) → %s (%s) ***\n",
+               ifaces[active_idx].name, edtsp_iface_name(ifaces[active_idx].type),
+               ifaces[best].name, edtsp_iface_name(ifaces[best].type));
+    }
+    active_idx = best;
+    return true;
+}
+
+static void set_health(int idx, bool healthy, const char *reason) {
+    if (ifaces[idx].healthy == healthy) return;
+    ifaces[idx].healthy = healthy;
+    printf("[NETWORK] Link %s %s (%s)\n", ifaces[idx].name,
+           healthy ? "UP" : "DOWN", reason);
+}
+
+// ============================================================================
+// SOCKET SETUP
+// ============================================================================
+
+static int open_iface_socket(EDTSPNetIface *iface, const struct sockaddr_in *group) {
+    struct sockaddr_in addr;
+    struct ip_mreqn mreq;
+    int reuse = 1;
+    int off = 0;
+    
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        perror("[NETWORK] Failed to create socket");
+        return -1;
+    }
+    
+    // Allow address reuse (for multiple instances and per-interface sockets)
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0) {
+        perror("[NETWORK] Failed to set SO_REUSEADDR");
+    }
+    
+    if (iface->ifindex > 0) {
+        // Pin socket to the device (needs CAP_NET_RAW; membership filtering
+        // below still isolates interfaces without it)
+        iface->bound_to_device =
+            setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, iface->name,
+                       strlen(iface->name) + 1) == 0;
+        
+        // Only deliver groups joined on this socket's interface
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &off, sizeof(off));
+    }
+    
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = group->sin_port;
+    
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("[NETWORK] Failed to bind socket");
+        close(fd);
+        return -1;
+    }
+    
+    // Join multicast group on this interface
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.imr_multiaddr = group->sin_addr;
+    mreq.imr_address = iface->addr;
+    mreq.imr_ifindex = iface->ifindex;
+    
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        fprintf(stderr, "[NETWORK] Failed to join multicast group on %s: %s\n",
+                iface->name, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    
+    // Route outgoing multicast through this interface
+    if (iface->ifindex > 0 &&
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &mreq, sizeof(mreq)) < 0) {
+        perror("[NETWORK] Failed to set IP_MULTICAST_IF");
+    }
+    
+    return fd;
+}
+
+static void open_netlink(void) {
+    struct sockaddr_nl nl;
+    
+    netlink_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK, NETLINK_ROUTE);
+    if (netlink_fd < 0) return;
+    
+    memset(&nl, 0, sizeof(nl));
+    nl.nl_family = AF_NETLINK;
+    nl.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+    
+    if (bind(netlink_fd, (struct sockaddr*)&nl, sizeof(nl)) < 0) {
+        perror("[NETWORK] Netlink unavailable, using carrier polling only");
+        close(netlink_fd);
+        netlink_fd = -1;
+    }
+}
+
+void edtsp_net_set_zone(uint16_t zone) {
+    zone_id = zone;
+}
+
+bool edtsp_net_open(void) {
+    struct ifaddrs *ifa_list = NULL;
+    
+    memset(&group_addr, 0, sizeof(group_addr));
+    group_addr.sin_family = AF_INET;
+    if (zone_id) {
+        group_addr.sin_addr.s_addr = htonl((239u << 24) | (255u << 16) | ((1u + zone_id / 256) << 8) |
+                                           (zone_id % 256));
+        group_addr.sin_port = htons(EDTSP_PORT + zone_id);
+    } else {
+        group_addr.sin_addr.s_addr = inet_addr(EDTSP_MULTICAST_ADDR);
+        group_addr.sin_port = htons(EDTSP_PORT);
+    }
+    
+    iface_count = 0;
+    active_idx = -1;
+    
+    if (getifaddrs(&ifa_list) == 0) {
+        for (struct ifaddrs *ifa = ifa_list; ifa; ifa = ifa->ifa_next) {
+            if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET) continue;
+            if (ifa->ifa_flags & IFF_LOOPBACK) continue;
+            if (!(ifa->ifa_flags & IFF_MULTICAST)) continue;
+            if (iface_count >= EDTSP_MAX_IFACES) break;
+            
+            // One socket per interface (skip secondary addresses)
+            int ifindex = (int)if_nametoindex(ifa->ifa_name);
+            if (ifindex == 0 || find_iface_by_index(ifindex) >= 0) continue;
+            
+            EDTSPNetIface *iface = &ifaces[iface_count];
+            memset(iface, 0, sizeof(*iface));
+            strncpy(iface->name, ifa->ifa_name, sizeof(iface->name) - 1);
+            iface->ifindex = ifindex;
+            iface->addr = ((struct sockaddr_in*)ifa->ifa_addr)->sin_addr;
+            iface->type = classify_iface(iface->name);
+            iface->healthy = (ifa->ifa_flags & IFF_UP) && (ifa->ifa_flags & IFF_RUNNING);
+            
+            iface->fd = open_iface_socket(iface, &group_addr);
+            if (iface->fd < 0) continue;
+            
+            printf("[NETWORK] Interface %s: %s, addr %s%s\n",
+                   iface->name, edtsp_iface_name(iface->type),
+                   inet_ntoa(iface->addr),
+                   iface->bound_to_device ? ", bound" : "");
+            iface_count++;
+        }
+        freeifaddrs(ifa_list);
+    }
+    
+    if (iface_count == 0) {
+        // Fallback: single socket on INADDR_ANY (loopback-only hosts)
+        EDTSPNetIface *iface = &ifaces[0];
+        memset(iface, 0, sizeof(*iface));
+        strncpy(iface->name, "any", sizeof(iface->name) - 1);
+        iface->addr.s_addr = INADDR_ANY;
+        iface->type = EDTSP_IFACE_UNKNOWN;
+        iface->healthy = true;
+        iface->fd = open_iface_socket(iface, &group_addr);
+        if (iface->fd < 0) return false;
+        iface_count = 1;
+    }
+    
+    open_netlink();
+    select_active();
+    
+    printf("[NETWORK] Listening on %s:%d%s (%d interface%s)\n",
+           inet_ntoa(group_addr.sin_addr), ntohs(group_addr.sin_port), zone_id ? ", zone" : "",
+           iface_count, iface_count == 1 ? "" : "s");
+    return true;
+}
+
+bool edtsp_net_open_uplink(void) {
+    if (uplink.fd >= 0) return true;
+    
+    EDTSPNetIface *via = edtsp_net_active() ? edtsp_net_active() : edtsp_net_iface(0);
+    if (!via) return false;
+    
+    memset(&uplink_addr, 0, sizeof(uplink_addr));
+    uplink_addr.sin_family = AF_INET;
+    uplink_addr.sin_addr.s_addr = inet_addr(EDTSP_ZONE_UPLINK_ADDR);
+    uplink_addr.sin_port = htons(EDTSP_ZONE_UPLINK_PORT);
+    
+    memset(&uplink, 0, sizeof(uplink));
+    memcpy(uplink.name, via->name, sizeof(uplink.name));
+    uplink.ifindex = via->ifindex;
+    uplink.addr = via->addr;
+    uplink.type = via->type;
+    uplink.healthy = true;
+    uplink.fd = open_iface_socket(&uplink, &uplink_addr);
+    if (uplink.fd < 0) return false;
+    
+    printf("[NETWORK] Uplink %s:%d on %s\n", EDTSP_ZONE_UPLINK_ADDR, EDTSP_ZONE_UPLINK_PORT, uplink.name);
+    return true;
+}
+
+void edtsp_net_close_uplink(void) {
+    if (uplink.fd >= 0) close(uplink.fd);
+    uplink.fd = -1;
+}
+
+EDTSPNetIface *edtsp_net_uplink(void) {
+    return uplink.fd >= 0 ? &uplink : NULL;
+}
+
+bool edtsp_net_open_ingest(void) {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    
+    if (ingest.fd >= 0) return true;
+    
+    memset(&ingest, 0, sizeof(ingest));
+    strncpy(ingest.name, "ingest", sizeof(ingest.name) - 1);
+    ingest.healthy = true;
+    ingest.fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (ingest.fd < 0) {
+        perror("[NETWORK] Failed to create ingest socket");
+        return false;
+    }
+    
+    // Port 0: the kernel picks a free one, so ingest nodes can share a host
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    if (bind(ingest.fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        getsockname(ingest.fd, (struct sockaddr*)&addr, &addr_len) < 0) {
+        perror("[NETWORK] Failed to bind ingest socket");
+        close(ingest.fd);
+        ingest.fd = -1;
+        return false;
+    }
+    ingest_port = ntohs(addr.sin_port);
+    
+    printf("[NETWORK] Ingest socket on port %u\n", ingest_port);
+    return true;
+}
+
+EDTSPNetIface *edtsp_net_ingest(void) {
+    return ingest.fd >= 0 ? &ingest : NULL;
+}
+
+bool edtsp_net_ingest_addr(uint32_t *addr, uint16_t *port) {
+    EDTSPNetIface *via = edtsp_net_active();
+    if (ingest.fd < 0 || !via) return false;
+    
+    // The fallback socket has no address of its own: loopback-only host
+    *addr = via->addr.s_addr != INADDR_ANY ? ntohl(via->addr.s_addr) : INADDR_LOOPBACK;
+    *port = ingest_port;
+    return true;
+}
+
+void edtsp_net_close(void) {
+    edtsp_net_close_uplink();
+    if (ingest.fd >= 0) close(ingest.fd);
+    ingest.fd = -1;
+    for (int i = 0; i < iface_count; i++) {
+        if (ifaces[i].fd >= 0) close(ifaces[i].fd);
+        ifaces[i].fd = -1;
+    }
+    if (netlink_fd >= 0) close(netlink_fd);
+    netlink_fd = -1;
+    iface_count = 0;
+    active_idx = -1;
+}
+
+// ============================================================================
+// ACCESSORS
+// ============================================================================
+
+int edtsp_net_iface_count(void) {
+    return iface_count;
+}
+
+EDTSPNetIface *edtsp_net_iface(int idx) {
+    if (idx < 0 || idx >= iface_count) return NULL;
+    return &ifaces[idx];
+}
+
+EDTSPNetIface *edtsp_net_active(void) {
+    return active_idx >= 0 ? &ifaces[active_idx] : NULL;
+}
+
+EDTSPNetIface *edtsp_net_standby(void) {
+    int best = -1;
+    
+    for (int i = 0; i < iface_count; i++) {
+        if (i == active_idx || !ifaces[i].healthy) continue;
+        if (best < 0 || link_rank(&ifaces[i]) < link_rank(&ifaces[best])) {
+            best = i;
+        }
+    }
+    return best >= 0 ? &ifaces[best] : NULL;
+}
+
+EDTSPInterfaceType edtsp_net_active_type(void) {
+    return active_idx >= 0 ? ifaces[active_idx].type : EDTSP_IFACE_UNKNOWN;
+}
+
+int edtsp_net_netlink_fd(void) {
+    return netlink_fd;
+}
+
+// ============================================================================
+// LINK HEALTH
+// ============================================================================
+
+bool edtsp_net_handle_netlink(void) {
+    uint8_t buf[8192];
+    ssize_t len;
+    
+    if (netlink_fd < 0) return false;
+    
+    while ((len = recv(netlink_fd, buf, sizeof(buf), 0)) > 0) {
+        for (struct nlmsghdr *nh = (struct nlmsghdr*)buf; NLMSG_OK(nh, (size_t)len);
+             nh = NLMSG_NEXT(nh, len)) {
+            if (nh->nlmsg_type == RTM_NEWLINK || nh->nlmsg_type == RTM_DELLINK) {
+                struct ifinfomsg *ifi = NLMSG_DATA(nh);
+                int idx = find_iface_by_index(ifi->ifi_index);
+                if (idx < 0) continue;
+                
+                bool up = nh->nlmsg_type == RTM_NEWLINK &&
+                          (ifi->ifi_flags & IFF_UP) && (ifi->ifi_flags & IFF_RUNNING);
+                if (!up || monotonic_ms() >= error_holdoff_until[idx]) {
+                    set_health(idx, up, "netlink");
+                }
+            } else if (nh->nlmsg_type == RTM_DELADDR) {
+                struct ifaddrmsg *ifa = NLMSG_DATA(nh);
+                int idx = find_iface_by_index((int)ifa->ifa_index);
+                if (idx >= 0) set_health(idx, false, "address removed");
+            }
+        }
+    }
+    
+    return select_active();
+}
+
+bool edtsp_net_probe_links(void) {
+    uint64_t now = monotonic_ms();
+    
+    for (int i = 0; i < iface_count; i++) {
+        struct ifreq ifr;
+        
+        if (ifaces[i].ifindex == 0) continue; // INADDR_ANY fallback
+        if (now < error_holdoff_until[i]) continue;
+        
+        memset(&ifr, 0, sizeof(ifr));
+        strncpy(ifr.ifr_name, ifaces[i].name, sizeof(ifr.ifr_name) - 1);
+        if (ioctl(ifaces[i].fd, SIOCGIFFLAGS, &ifr) < 0) {
+            set_health(i, false, "interface gone");
+            continue;
+        }
+        
+        bool up = (ifr.ifr_flags & IFF_UP) && (ifr.ifr_flags & IFF_RUNNING);
+        set_health(i, up, "carrier");
+    }
+    
+    return select_active();
+}
+
+bool edtsp_net_report_probe(EDTSPNetIface *iface, bool answered, uint32_t rtt_us) {
+    if (!iface) return false;
+    
+    if (answered) {
+        iface->probe_loss_streak = 0;
+        iface->srtt_us = iface->srtt_us ? iface->srtt_us + ((int32_t)(rtt_us - iface->srtt_us)) / 8
+                                        : rtt_us;
+    } else {
+        iface->probe_loss_streak++;
+    }
+    
+    bool degraded = iface->probe_loss_streak >= EDTSP_LINK_MAX_PROBE_LOSS ||
+                    iface->srtt_us > EDTSP_LINK_DEGRADED_RTT_US;
+    if (degraded != iface->degraded) {
+        iface->degraded = degraded;
+        printf("[NETWORK] Link %s %s (srtt=%u us, lost=%u)\n", iface->name,
+               degraded ? "DEGRADED" : "RECOVERED", iface->srtt_us, iface->probe_loss_streak);
+    }
+    
+    return select_active();
+}
+
+// ============================================================================
+// TRANSMIT
+// ============================================================================
+
+/** Errors that indicate the link itself (not the packet) is broken */
+static bool is_link_error(int err) {
+    return err == ENETDOWN || err == ENETUNREACH || err == EHOSTUNREACH ||
+           err == ENODEV || err == ENXIO || err == EADDRNOTAVAIL;
+}
+
+void edtsp_net_send_failed(EDTSPNetIface *iface, int err) {
+    iface->tx_errors++;
+    if (iface == &uplink) {
+        fprintf(stderr, "[NETWORK] Uplink send failed: %s\n", strerror(err));
+    } else if (is_link_error(err)) {
+        int idx = (int)(iface - ifaces);
+        error_holdoff_until[idx] = monotonic_ms() + EDTSP_LINK_ERROR_HOLDOFF_MS;
+        set_health(idx, false, strerror(err));
+    } else {
+        fprintf(stderr, "[NETWORK] Send failed: %s\n", strerror(err));
+    }
+}
+
+size_t edtsp_net_tos_cmsg(void *buf, uint8_t tos) {
+    struct cmsghdr *c = buf;
+    int value = tos;
+    
+    memset(buf, 0, EDTSP_NET_TOS_CMSG);
+    c->cmsg_level = IPPROTO_IP;
+    c->cmsg_type = IP_TOS;
+    c->cmsg_len = CMSG_LEN(sizeof(value));
+    memcpy(CMSG_DATA(c), &value, sizeof(value));
+    return EDTSP_NET_TOS_CMSG;
+}
+
+static bool send_to(EDTSPNetIface *iface, const struct sockaddr_in *dest, const void *data,
+                    size_t len, uint8_t tos) {
+    // TOS per packet: one socket carries every traffic class
+    union {
+        struct cmsghdr align;
+        uint8_t        buf[EDTSP_NET_TOS_CMSG];
+    } control;
+    struct iovec iov = { .iov_base = (void*)data, .iov_len = len };
+    struct msghdr msg = {
+        .msg_name = (void*)dest,
+        .msg_namelen = sizeof(*dest),
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+    };
+    if (tos) {
+        msg.msg_control = control.buf;
+        msg.msg_controllen = edtsp_net_tos_cmsg(control.buf, tos);
+    }
+    
+    ssize_t sent = sendmsg(iface->fd, &msg, 0);
+    if (sent < 0) {
+        edtsp_net_send_failed(iface, errno);
+        return false;
+    }
+    
+    iface->tx_packets++;
+    return true;
+}
+
+bool edtsp_net_send_on(EDTSPNetIface *iface, const void *data, size_t len, uint8_t tos) {
+    if (!iface || iface->fd < 0) return false;
+    
+    // Queued for asynchronous transmission (errors arrive later)
+    if (tx_hook && tx_hook(iface, data, len, tos)) {
+        iface->tx_packets++;
+        return true;
+    }
+    return send_to(iface, &group_addr, data, len, tos);
+}
+
+bool edtsp_net_send_unicast(const struct sockaddr_in *dest, const void *data, size_t len, uint8_t tos) {
+    EDTSPNetIface *iface = edtsp_net_active();
+    if (!iface) return false;
+    return send_to(iface, dest, data, len, tos);
+}
+
+bool edtsp_net_send_uplink(const void *data, size_t len, uint8_t tos) {
+    if (uplink.fd < 0) return false;
+    return send_to(&uplink, &uplink_addr, data, len, tos);
+}
+
+void edtsp_net_set_tx_hook(EDTSPNetTxHook hook) {
+    tx_hook = hook;
+}
+
+const struct sockaddr_in *edtsp_net_group_addr(void) {
+    return &group_addr;
+}
+
+bool edtsp_net_send(const void *data, size_t len, uint8_t tos) {
+    // Each failure marks one interface unhealthy, so this terminates
+    for (int attempt = 0; attempt < iface_count; attempt++) {
+        EDTSPNetIface *iface = edtsp_net_active();
+        if (!iface) return false;
+        
+        if (edtsp_net_send_on(iface, data, len, tos)) return true;
+        if (iface->healthy) return false; // Not a link failure
+        select_active();
+    }
+    return false;
+}
+
+bool edtsp_net_rx_queue(const EDTSPNetIface *iface, uint8_t *fill_pct, uint32_t *drops) {
+    uint32_t mem[SK_MEMINFO_VARS];
+    socklen_t len = sizeof(mem);
+    
+    if (getsockopt(iface->fd, SOL_SOCKET, SO_MEMINFO, mem, &len) < 0 ||
+        len < sizeof(mem) || !mem[SK_MEMINFO_RCVBUF]) {
+        return false;
+    }
+    
+    uint64_t pct = (uint64_t)mem[SK_MEMINFO_RMEM_ALLOC] * 100 / mem[SK_MEMINFO_RCVBUF];
+    *fill_pct = (uint8_t)(pct > 100 ? 100 : pct);
+    *drops = mem[SK_MEMINFO_DROPS];
+    return true;
+}
+
+void edtsp_net_print(void) {
+    for (int i = 0; i < iface_count; i++) {
+        printf("  Iface %-8s %-8s %-8s tx=%u err=%u rx=%u srtt=%uus%s\n",
+               ifaces[i].name, edtsp_iface_name(ifaces[i].type),
+               !ifaces[i].healthy ? "DOWN" : ifaces[i].degraded ? "DEGRADED" : "UP",
+               ifaces[i].tx_packets, ifaces[i].tx_errors, ifaces[i].rx_packets,
+               ifaces[i].srtt_us,
+               i == active_idx ? " [ACTIVE]" : "");
+    }
+    if (uplink.fd >= 0) {
+        printf("  Uplink %-7s %s:%d tx=%u err=%u rx=%u\n", uplink.name, EDTSP_ZONE_UPLINK_ADDR,
+               EDTSP_ZONE_UPLINK_PORT, uplink.tx_packets, uplink.tx_errors, uplink.rx_packets);
+    }
+    if (ingest.fd >= 0) {
+        printf("  Ingest socket port %u rx=%u\n", ingest_port, ingest.rx_packets);
+    }
+}
@@ -0,0 +1,215 @@
+/**
+ * @file net_iface.h
+ * @brief EDTSP Multi-Homed Network Interface Management (PC/Linux)
+ *
+ * One multicast socket per physical interface, continuous link health
+ * probing and priority-based selection of the transmit interface
+ * (Ethernet > WiFi > 5G).
+ */
+
+#ifndef EDTSP_NET_IFACE_H
+#define EDTSP_NET_IFACE_H
+
+#include "../../include/protocol.h"
+#include <stddef.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/** Maximum number of physical interfaces handled */
+#define EDTSP_MAX_IFACES 8
+
+/** Link health probe interval (milliseconds) */
+#define EDTSP_LINK_PROBE_INTERVAL_MS 10
+
+/** Consecutive unanswered latency probes before a link is degraded */
+#define EDTSP_LINK_MAX_PROBE_LOSS 3
+
+/** Smoothed probe RTT above which a link is degraded (microseconds) */
+#define EDTSP_LINK_DEGRADED_RTT_US 100000
+
+/** Per-interface state */
+typedef struct {
+    char               name[IF_NAMESIZE];  /**< Kernel interface name (e.g. eth0) */
+    int                ifindex;            /**< Kernel interface index */
+    struct in_addr     addr;               /**< Primary IPv4 address */
+    EDTSPInterfaceType type;               /**< Classified interface type */
+    int                fd;                 /**< Multicast socket bound to this interface */
+    bool               bound_to_device;    /**< SO_BINDTODEVICE succeeded */
+    bool               healthy;            /**< Carrier up and no send failure */
+    bool               degraded;           /**< Probes lost or RTT too high */
+    uint32_t           srtt_us;            /**< Smoothed probe RTT on this link */
+    uint32_t           probe_loss_streak;  /**< Consecutive unanswered probes */
+    uint32_t           tx_packets;         /**< Packets sent on this interface */
+    uint32_t           tx_errors;          /**< Send failures on this interface */
+    uint32_t           rx_packets;         /**< Packets received on this interface */
+} EDTSPNetIface;
+
+/**
+ * Select the zone group and port (see protocol.h) before edtsp_net_open
+ *
+ * @param zone 1..EDTSP_ZONE_MAX_ID, 0 = EDTSP_MULTICAST_ADDR:EDTSP_PORT
+ */
+void edtsp_net_set_zone(uint16_t zone);
+
+/**
+ * Discover interfaces and open one multicast socket per interface
+ *
+ * Falls back to a single INADDR_ANY socket if no multicast-capable
+ * non-loopback interface is found.
+ *
+ * @return true if at least one socket is usable
+ */
+bool edtsp_net_open(void);
+
+/** Close all sockets */
+void edtsp_net_close(void);
+
+/** Number of opened interfaces */
+int edtsp_net_iface_count(void);
+
+/** Access interface by index (NULL if out of range) */
+EDTSPNetIface *edtsp_net_iface(int idx);
+
+/** Currently selected transmit interface (NULL if none healthy) */
+EDTSPNetIface *edtsp_net_active(void);
+
+/** Best healthy interface other than the active one (NULL if none) */
+EDTSPNetIface *edtsp_net_standby(void);
+
+/** Type of the currently selected transmit interface */
+EDTSPInterfaceType edtsp_net_active_type(void);
+
+/**
+ * Netlink socket delivering link/address change events
+ *
+ * @return fd to poll for readability, or -1 if unavailable
+ */
+int edtsp_net_netlink_fd(void);
+
+/**
+ * Drain pending netlink events and re-probe affected links
+ *
+ * @return true if the active transmit interface changed
+ */
+bool edtsp_net_handle_netlink(void);
+
+/**
+ * Probe carrier state of all interfaces (call every
+ * EDTSP_LINK_PROBE_INTERVAL_MS)
+ *
+ * @return true if the active transmit interface changed
+ */
+bool edtsp_net_probe_links(void);
+
+/**
+ * Send a packet to the multicast group on the best healthy interface
+ *
+ * On a link-level send error the interface is marked unhealthy and the
+ * packet is retried immediately on the next best interface.
+ *
+ * @param tos IP TOS byte (DSCP << 2) of this packet, 0 = socket default
+ * @return true if the packet was sent on some interface
+ */
+bool edtsp_net_send(const void *data, size_t len, uint8_t tos);
+
+/**
+ * Feed a latency probe result into link selection
+ * 
+ * A healthy but degraded link is only used when no clean link exists.
+ * 
+ * @param answered false if the probe timed out while the peer answered
+ *                 on another link
+ * @return true if the active transmit interface changed
+ */
+bool edtsp_net_report_probe(EDTSPNetIface *iface, bool answered, uint32_t rtt_us);
+
+/** Send a packet on a specific interface (no failover) */
+bool edtsp_net_send_on(EDTSPNetIface *iface, const void *data, size_t len, uint8_t tos);
+
+/**
+ * Asynchronous transmit hook
+ * 
+ * @return true if the packet was queued, false to send it synchronously
+ */
+typedef bool (*EDTSPNetTxHook)(EDTSPNetIface *iface, const void *data, size_t len, uint8_t tos);
+
+/** Control buffer size for edtsp_net_tos_cmsg() */
+#define EDTSP_NET_TOS_CMSG CMSG_SPACE(sizeof(int))
+
+/**
+ * Ancillary data carrying a per-packet IP TOS (IP_TOS control message)
+ *
+ * @param buf At least EDTSP_NET_TOS_CMSG bytes, suitably aligned
+ * @return Control length to put in msg_controllen
+ */
+size_t edtsp_net_tos_cmsg(void *buf, uint8_t tos);
+
+/** Route sends through an asynchronous backend (NULL = sendto) */
+void edtsp_net_set_tx_hook(EDTSPNetTxHook hook);
+
+/**
+ * Report a send error (sendto or asynchronous completion)
+ * 
+ * Link-level errors mark the interface unhealthy for a short holdoff.
+ */
+void edtsp_net_send_failed(EDTSPNetIface *iface, int err);
+
+/**
+ * Receive queue of an interface socket (SO_MEMINFO)
+ *
+ * @param fill_pct Socket memory queued, percent of the receive buffer
+ * @param drops    Datagrams dropped on a full buffer since the socket opened
+ * @return false if the kernel does not report socket memory
+ */
+bool edtsp_net_rx_queue(const EDTSPNetIface *iface, uint8_t *fill_pct, uint32_t *drops);
+
+/**
+ * Open the uplink socket (EDTSP_ZONE_UPLINK_ADDR) on the active interface
+ *
+ * Sub-masters only; summaries are low rate, so the uplink has a single
+ * socket with no failover and is drained with edtsp_net_uplink()->fd.
+ *
+ * @return true if open
+ */
+bool edtsp_net_open_uplink(void);
+
+/** Close the uplink socket (no longer a sub-master) */
+void edtsp_net_close_uplink(void);
+
+/** Uplink socket state (NULL while closed) */
+EDTSPNetIface *edtsp_net_uplink(void);
+
+/** Send a packet to the uplink group */
+bool edtsp_net_send_uplink(const void *data, size_t len, uint8_t tos);
+
+/**
+ * Open the unicast ingest socket (ingest nodes, see edtsp_shard.h)
+ *
+ * Bound to any address on a port the kernel picks, so several ingest
+ * nodes can run on one host. Slaves learn the port from our HEARTBEAT.
+ *
+ * @return true if open
+ */
+bool edtsp_net_open_ingest(void);
+
+/** Ingest socket state (NULL while closed) */
+EDTSPNetIface *edtsp_net_ingest(void);
+
+/**
+ * Address (active interface, host byte order) and port of the ingest socket
+ *
+ * @return false if the socket is closed or no interface is up
+ */
+bool edtsp_net_ingest_addr(uint32_t *addr, uint16_t *port);
+
+/** Send a packet by unicast on the active interface (sharded DATA, no failover) */
+bool edtsp_net_send_unicast(const struct sockaddr_in *dest, const void *data, size_t len, uint8_t tos);
+
+/** Multicast group destination address */
+const struct sockaddr_in *edtsp_net_group_addr(void);
+
+/** Print interface table (for status output) */
+void edtsp_net_print(void);
+
+#endif // EDTSP_NET_IFACE_H
@@ -0,0 +1,201 @@
+/**
+ * @file edtsp_actuate.c
+ * @brief EDTSP Actuator Command Path (relay / PWM outputs)
+ *
+ * The master's RTO follows the command round trip (4 x SRTT, floored at
+ * EDTSP_ACTUATE_RTO_MIN_US), so a lost command on a LAN is repeated
+ * within a few milliseconds instead of the 200 ms probe RTO.
+ */
+
+#include "../include/edtsp_actuate.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    EDTSPOutputFn fn;
+    void *ctx;
+} EDTSPOutputSlot;
+
+typedef struct {
+    bool               used;
+    uint8_t            tries;      /**< Transmissions so far */
+    uint64_t           first_us;   /**< First transmission (latency reference) */
+    uint64_t           last_us;    /**< Latest transmission */
+    EDTSPActuatePacket cmd;        /**< Host byte order copy */
+} EDTSPPendingCommand;
+
+static EDTSPOutputSlot outputs[EDTSP_ACTUATE_OUTPUTS];
+static EDTSPPendingCommand pending[EDTSP_ACTUATE_PENDING];
+static EDTSPActuateStats stats;
+
+// Slave retransmission filter: last sequences applied for the current master
+static uint32_t history_master = 0;
+static uint16_t history_seq[EDTSP_ACTUATE_HISTORY];
+static uint8_t history_status[EDTSP_ACTUATE_HISTORY];
+static uint8_t history_count = 0;
+static uint8_t history_next = 0;
+
+void edtsp_actuate_init(void) {
+    memset(outputs, 0, sizeof(outputs));
+    memset(pending, 0, sizeof(pending));
+    memset(&stats, 0, sizeof(stats));
+    edtsp_hist_init(&stats.rtt_us);
+    edtsp_hist_init(&stats.apply_us);
+    history_master = 0;
+    history_count = 0;
+    history_next = 0;
+}
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+bool edtsp_actuate_register_output(uint8_t output_id, EDTSPOutputFn fn, void *ctx) {
+    if (output_id >= EDTSP_ACTUATE_OUTPUTS || !fn) return false;
+    
+    outputs[output_id].fn = fn;
+    outputs[output_id].ctx = ctx;
+    return true;
+}
+
+EDTSPCapabilityMask edtsp_actuate_capabilities(void) {
+    EDTSPCapabilityMask mask = 0;
+    
+    for (int i = 0; i < EDTSP_ACTUATE_OUTPUTS; i++) {
+        if (outputs[i].fn) mask |= (EDTSPCapabilityMask)(1u << i);
+    }
+    return mask;
+}
+
+uint8_t edtsp_actuate_apply(uint32_t master_id, const EDTSPActuatePacket *cmd, bool *duplicate) {
+    *duplicate = false;
+
+    // A new master starts a new sequence space
+    if (master_id != history_master) {
+        history_master = master_id;
+        history_count = 0;
+        history_next = 0;
+    }
+    
+    for (uint8_t i = 0; i < history_count; i++) {
+        if (history_seq[i] == cmd->act_seq) {
+            *duplicate = true;
+            stats.duplicates++;
+            return history_status[i];
+        }
+    }
+    
+    uint8_t status = EDTSP_ACTUATE_STATUS_NO_OUTPUT;
+    if (cmd->output_id < EDTSP_ACTUATE_OUTPUTS && outputs[cmd->output_id].fn) {
+        const EDTSPOutputSlot *out = &outputs[cmd->output_id];
+        status = out->fn(cmd->output_id, cmd->channel, cmd->value, out->ctx);
+        stats.applied++;
+    }
+    
+    history_seq[history_next] = cmd->act_seq;
+    history_status[history_next] = status;
+    history_next = (uint8_t)((history_next + 1) % EDTSP_ACTUATE_HISTORY);
+    if (history_count < EDTSP_ACTUATE_HISTORY) history_count++;
+    return status;
+}
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+static uint64_t rto_us(uint8_t priority) {
+    uint64_t rto = (uint64_t)stats.srtt_us * 4;
+    uint64_t floor = priority == EDTSP_ACTUATE_PRIO_URGENT ? EDTSP_ACTUATE_RTO_MIN_US / 2
+                                                           : EDTSP_ACTUATE_RTO_MIN_US;
+    return rto > floor ? rto : floor;
+}
+
+bool edtsp_actuate_track(const EDTSPActuatePacket *cmd, uint64_t now_us) {
+    for (int i = 0; i < EDTSP_ACTUATE_PENDING; i++) {
+        EDTSPPendingCommand *p = &pending[i];
+        if (p->used) continue;
+        
+        p->used = true;
+        p->tries = 1;
+        p->first_us = now_us;
+        p->last_us = now_us;
+        p->cmd = *cmd;
+        stats.sent++;
+        return true;
+    }
+    return false;
+}
+
+bool edtsp_actuate_on_ack(const EDTSPActuatePacket *ack, uint64_t now_us) {
+    for (int i = 0; i < EDTSP_ACTUATE_PENDING; i++) {
+        EDTSPPendingCommand *p = &pending[i];
+        if (!p->used || p->cmd.act_seq != ack->act_seq ||
+            p->cmd.target_id != ack->header.source_id) {
+            continue;
+        }
+        
+        // Round trip of the transmission that was answered (t1 is echoed)
+        uint32_t rtt = (uint32_t)(now_us - ack->t1_us);
+        edtsp_hist_record(&stats.rtt_us, rtt);
+        if (ack->t3_us >= ack->t2_us) {
+            edtsp_hist_record(&stats.apply_us, (uint32_t)(ack->t3_us - ack->t2_us));
+        }
+        
+        // RFC 6298 style smoothing (gain 1/8)
+        if (stats.srtt_us == 0) {
+            stats.srtt_us = rtt;
+        } else {
+            stats.srtt_us = (uint32_t)(((uint64_t)stats.srtt_us * 7 + rtt) / 8);
+        }
+        
+        stats.acked++;
+        if (ack->status != EDTSP_ACTUATE_STATUS_OK) stats.nacked++;
+        p->used = false;
+        return true;
+    }
+    return false;
+}
+
+int edtsp_actuate_due(uint64_t now_us, EDTSPActuatePacket *out, int max) {
+    int n = 0;
+    
+    for (int i = 0; i < EDTSP_ACTUATE_PENDING && n < max; i++) {
+        EDTSPPendingCommand *p = &pending[i];
+        if (!p->used || now_us - p->last_us < rto_us(p->cmd.priority)) continue;
+        
+        if (p->tries >= EDTSP_ACTUATE_MAX_TRIES) {
+            stats.failed++;
+            p->used = false;
+            continue;
+        }
+        
+        p->tries++;
+        p->last_us = now_us;
+        p->cmd.t1_us = now_us;
+        out[n++] = p->cmd;
+        stats.retransmits++;
+    }
+    return n;
+}
+
+const EDTSPActuateStats *edtsp_actuate_stats(void) {
+    return &stats;
+}
+
+void edtsp_actuate_print(void) {
+    if (!stats.sent && !stats.applied && !stats.duplicates) return;
+    
+    printf("[STATS] === Actuation ===\n");
+    if (stats.sent) {
+        printf("  Commands: sent=%u acked=%u nacked=%u retransmits=%u failed=%u\n",
+               stats.sent, stats.acked, stats.nacked, stats.retransmits, stats.failed);
+        printf("  Round trip (us): srtt=%u p50=%u p90=%u p99=%u max=%u\n", stats.srtt_us,
+               edtsp_hist_percentile(&stats.rtt_us, 50), edtsp_hist_percentile(&stats.rtt_us, 90),
+               edtsp_hist_percentile(&stats.rtt_us, 99), stats.rtt_us.max);
+        printf("  Slave apply (us): p50=%u p99=%u\n",
+               edtsp_hist_percentile(&stats.apply_us, 50), edtsp_hist_percentile(&stats.apply_us, 99));
+    }
+    if (stats.applied || stats.duplicates) {
+        printf("  Outputs: applied=%u retransmissions ignored=%u\n", stats.applied, stats.duplicates);
+    }
+}
@@ -0,0 +1,991 @@
+/**
+ * @file edtsp_aead.c
+ * @brief EDTSP Payload Encryption (AEAD with per-session keys)
+ *
+ * AES-128-GCM follows the Intel AES-NI / PCLMULQDQ white papers: CTR
+ * blocks with AESENC, GHASH as carry-less multiplication on byte-reflected
+ * blocks, eight blocks per reduction with precomputed powers of H. Those
+ * functions are compiled for the instructions with a target attribute and
+ * only called when the CPU reports them, so the build needs no -maes.
+ * ChaCha20-Poly1305 is RFC 8439: ChaCha20 on 4x32-bit compiler vectors
+ * (one block per lane), Poly1305 in 26-bit limbs.
+ *
+ * A batch runs over a job list of (message, block) pairs, lanes filled
+ * across message boundaries. The first pass computes each message's first
+ * block (GCM tag mask, Poly1305 key) and its first EARLY_BYTES of
+ * keystream, which covers a whole DATA frame; tags are checked before
+ * anything is decrypted. Only longer messages need a second pass.
+ *
+ * The session table is open addressing on the peer ID; a forgotten peer's
+ * entry is removed with backward-shift deletion, as in the join table.
+ */
+
+#include "../include/edtsp_aead.h"
+#include "../include/edtsp_auth.h"
+#include "../include/edtsp_tclass.h"
+#include <stdio.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define AEAD_X86 1
+#include <immintrin.h>
+#define AEAD_TARGET __attribute__((target("aes,pclmul,ssse3")))
+#endif
+
+typedef uint32_t ChaVec __attribute__((vector_size(16)));
+typedef uint8_t ByteVec __attribute__((vector_size(16)));
+
+#define CHACHA_LANES 4
+#define AES_LANES 8
+#define GHASH_GROUP 8
+
+/** Data keystream computed in the first pass, with the tag block */
+#define EARLY_BYTES 64
+#define SCRATCH (32 + EARLY_BYTES)
+
+/** Keystream job: block `block` of message `msg` (block 0 = tag mask / Poly1305 key) */
+typedef struct {
+    uint16_t msg;
+    uint16_t block;
+} Job;
+
+static bool enabled;
+static uint8_t allowed;
+static uint32_t self;
+static EDTSPAeadSession sessions[EDTSP_AEAD_SESSIONS];
+static EDTSPAeadStats stats;
+
+static inline uint32_t load_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline void store_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/** 16 bytes at tail_mask + 16 - r keep the first r bytes of a chunk */
+static const uint8_t tail_mask[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/**
+ * XOR keystream into text, 16 bytes at a time. The text is followed by
+ * its tag (or room for it), so the last chunk is read and written whole,
+ * masked to leave those bytes alone; no byte loop to mispredict on.
+ */
+static inline void xor_text(uint8_t *data, const uint8_t *ks, size_t len) {
+    for (size_t i = 0; i < len; i += 16) {
+        ByteVec d, k, keep;
+        memcpy(&d, data + i, 16);
+        memcpy(&k, ks + i, 16);
+        memcpy(&keep, tail_mask + 16 - (len - i < 16 ? len - i : 16), 16);
+        d ^= k & keep;
+        memcpy(data + i, &d, 16);
+    }
+}
+
+/** Constant-time tag comparison */
+static bool tag_equal(const uint8_t *a, const uint8_t *b) {
+    uint8_t diff = 0;
+    for (int i = 0; i < EDTSP_AEAD_TAG_LEN; i++) diff |= (uint8_t)(a[i] ^ b[i]);
+    return diff == 0;
+}
+
+// ============================================================================
+// CHACHA20-POLY1305
+// ============================================================================
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define QUARTER(a, b, c, d) do {                                        \
+        a += b; d ^= a; d = ROTL32(d, 16);                              \
+        c += d; b ^= c; b = ROTL32(b, 12);                              \
+        a += b; d ^= a; d = ROTL32(d, 8);                               \
+        c += d; b ^= c; b = ROTL32(b, 7);                               \
+    } while (0)
+
+/** Up to four ChaCha20 blocks, one per lane (unused lanes compute garbage) */
+static void chacha_lanes(const EDTSPAeadMsg *msgs, const Job *jobs, int n, uint8_t out[CHACHA_LANES][64]) {
+    union { ChaVec v[16]; uint32_t w[16][CHACHA_LANES]; } in;
+    
+    for (int l = 0; l < CHACHA_LANES; l++) {
+        const Job *j = &jobs[l < n ? l : 0];
+        const EDTSPAeadMsg *m = &msgs[j->msg];
+        in.w[0][l] = 0x61707865;
+        in.w[1][l] = 0x3320646e;
+        in.w[2][l] = 0x79622d32;
+        in.w[3][l] = 0x6b206574;
+        for (int i = 0; i < 8; i++) in.w[4 + i][l] = load_le32(m->key->key + 4 * i);
+        in.w[12][l] = j->block;
+        in.w[13][l] = load_le32(m->key->nonce_fixed);
+        in.w[14][l] = load_le32(m->key->nonce_fixed + 4);
+        in.w[15][l] = (m->seq >> 24) | ((m->seq >> 8) & 0xFF00) | ((m->seq << 8) & 0xFF0000) | (m->seq << 24);
+    }
+    
+    ChaVec x[16];
+    memcpy(x, in.v, sizeof(x));
+    for (int round = 0; round < 10; round++) {
+        QUARTER(x[0], x[4], x[8], x[12]);
+        QUARTER(x[1], x[5], x[9], x[13]);
+        QUARTER(x[2], x[6], x[10], x[14]);
+        QUARTER(x[3], x[7], x[11], x[15]);
+        QUARTER(x[0], x[5], x[10], x[15]);
+        QUARTER(x[1], x[6], x[11], x[12]);
+        QUARTER(x[2], x[7], x[8], x[13]);
+        QUARTER(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; i++) in.v[i] += x[i];
+    
+    for (int l = 0; l < n; l++) {
+        for (int i = 0; i < 16; i++) store_le32(out[l] + 4 * i, in.w[i][l]);
+    }
+}
+
+typedef struct {
+    uint32_t r[5], s[4], h[5];
+} Poly1305;
+
+static void poly_init(Poly1305 *p, const uint8_t key[32]) {
+    p->r[0] = load_le32(key) & 0x3ffffff;
+    p->r[1] = (load_le32(key + 3) >> 2) & 0x3ffff03;
+    p->r[2] = (load_le32(key + 6) >> 4) & 0x3ffc0ff;
+    p->r[3] = (load_le32(key + 9) >> 6) & 0x3f03fff;
+    p->r[4] = (load_le32(key + 12) >> 8) & 0x00fffff;
+    for (int i = 0; i < 4; i++) p->s[i] = p->r[i + 1] * 5;
+    memset(p->h, 0, sizeof(p->h));
+}
+
+/** One 16-byte block (AEAD input is always padded to full blocks) */
+static void poly_block(Poly1305 *p, const uint8_t *m) {
+    const uint32_t *r = p->r, *s = p->s;
+    uint32_t *h = p->h;
+    
+    h[0] += load_le32(m) & 0x3ffffff;
+    h[1] += (load_le32(m + 3) >> 2) & 0x3ffffff;
+    h[2] += (load_le32(m + 6) >> 4) & 0x3ffffff;
+    h[3] += (load_le32(m + 9) >> 6) & 0x3ffffff;
+    h[4] += (load_le32(m + 12) >> 8) | (1u << 24);
+    
+    uint64_t d0 = (uint64_t)h[0] * r[0] + (uint64_t)h[1] * s[3] + (uint64_t)h[2] * s[2] +
+                  (uint64_t)h[3] * s[1] + (uint64_t)h[4] * s[0];
+    uint64_t d1 = (uint64_t)h[0] * r[1] + (uint64_t)h[1] * r[0] + (uint64_t)h[2] * s[3] +
+                  (uint64_t)h[3] * s[2] + (uint64_t)h[4] * s[1];
+    uint64_t d2 = (uint64_t)h[0] * r[2] + (uint64_t)h[1] * r[1] + (uint64_t)h[2] * r[0] +
+                  (uint64_t)h[3] * s[3] + (uint64_t)h[4] * s[2];
+    uint64_t d3 = (uint64_t)h[0] * r[3] + (uint64_t)h[1] * r[2] + (uint64_t)h[2] * r[1] +
+                  (uint64_t)h[3] * r[0] + (uint64_t)h[4] * s[3];
+    uint64_t d4 = (uint64_t)h[0] * r[4] + (uint64_t)h[1] * r[3] + (uint64_t)h[2] * r[2] +
+                  (uint64_t)h[3] * r[1] + (uint64_t)h[4] * r[0];
+    
+    uint32_t c = (uint32_t)(d0 >> 26); h[0] = (uint32_t)d0 & 0x3ffffff;
+    d1 += c; c = (uint32_t)(d1 >> 26); h[1] = (uint32_t)d1 & 0x3ffffff;
+    d2 += c; c = (uint32_t)(d2 >> 26); h[2] = (uint32_t)d2 & 0x3ffffff;
+    d3 += c; c = (uint32_t)(d3 >> 26); h[3] = (uint32_t)d3 & 0x3ffffff;
+    d4 += c; c = (uint32_t)(d4 >> 26); h[4] = (uint32_t)d4 & 0x3ffffff;
+    h[0] += c * 5; c = h[0] >> 26; h[0] &= 0x3ffffff;
+    h[1] += c;
+}
+
+/** Zero-padded blocks of data */
+static void poly_padded(Poly1305 *p, const uint8_t *data, size_t len) {
+    for (; len >= 16; data += 16, len -= 16) poly_block(p, data);
+    if (!len) return;
+    
+    uint8_t last[16] = {0};
+    memcpy(last, data, len);
+    poly_block(p, last);
+}
+
+static void poly_finish(Poly1305 *p, const uint8_t key[32], uint8_t tag[16]) {
+    uint32_t *h = p->h;
+    uint32_t c, g[5];
+    
+    c = h[1] >> 26; h[1] &= 0x3ffffff;
+    h[2] += c; c = h[2] >> 26; h[2] &= 0x3ffffff;
+    h[3] += c; c = h[3] >> 26; h[3] &= 0x3ffffff;
+    h[4] += c; c = h[4] >> 26; h[4] &= 0x3ffffff;
+    h[0] += c * 5; c = h[0] >> 26; h[0] &= 0x3ffffff;
+    h[1] += c;
+    
+    // h - p = h + 5 - 2^130: keep it if that did not go negative
+    g[0] = h[0] + 5; c = g[0] >> 26; g[0] &= 0x3ffffff;
+    g[1] = h[1] + c; c = g[1] >> 26; g[1] &= 0x3ffffff;
+    g[2] = h[2] + c; c = g[2] >> 26; g[2] &= 0x3ffffff;
+    g[3] = h[3] + c; c = g[3] >> 26; g[3] &= 0x3ffffff;
+    g[4] = h[4] + c - (1u << 26);
+    uint32_t keep_g = (g[4] >> 31) - 1;
+    for (int i = 0; i < 5; i++) h[i] = (h[i] & ~keep_g) | (g[i] & keep_g);
+    
+    uint32_t w0 = h[0] | h[1] << 26;
+    uint32_t w1 = h[1] >> 6 | h[2] << 20;
+    uint32_t w2 = h[2] >> 12 | h[3] << 14;
+    uint32_t w3 = h[3] >> 18 | h[4] << 8;
+    
+    uint64_t f = (uint64_t)w0 + load_le32(key + 16);
+    store_le32(tag, (uint32_t)f);
+    f = (uint64_t)w1 + load_le32(key + 20) + (f >> 32);
+    store_le32(tag + 4, (uint32_t)f);
+    f = (uint64_t)w2 + load_le32(key + 24) + (f >> 32);
+    store_le32(tag + 8, (uint32_t)f);
+    f = (uint64_t)w3 + load_le32(key + 28) + (f >> 32);
+    store_le32(tag + 12, (uint32_t)f);
+}
+
+/** RFC 8439 tag over AAD and ciphertext */
+static void chacha_tag(const EDTSPAeadMsg *m, const uint8_t poly_key[32], uint8_t tag[16]) {
+    Poly1305 p;
+    uint8_t lengths[16];
+    
+    poly_init(&p, poly_key);
+    poly_padded(&p, m->aad, m->aad_len);
+    poly_padded(&p, m->data, m->len);
+    store_le32(lengths, (uint32_t)m->aad_len);
+    store_le32(lengths + 4, 0);
+    store_le32(lengths + 8, (uint32_t)m->len);
+    store_le32(lengths + 12, 0);
+    poly_block(&p, lengths);
+    poly_finish(&p, poly_key, tag);
+}
+
+// ============================================================================
+// AES-128-GCM (AES-NI, PCLMULQDQ)
+// ============================================================================
+
+#ifdef AEAD_X86
+AEAD_TARGET static inline __m128i expand_step(__m128i k, __m128i assist) {
+    assist = _mm_shuffle_epi32(assist, 0xff);
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+    return _mm_xor_si128(k, assist);
+}
+
+#define EXPAND(i, rcon) do {                                                \
+        k = expand_step(k, _mm_aeskeygenassist_si128(k, rcon));             \
+        _mm_storeu_si128((__m128i*)rk[i], k);                               \
+    } while (0)
+
+AEAD_TARGET static void aes_expand(const uint8_t *key, uint8_t rk[11][16]) {
+    __m128i k = _mm_loadu_si128((const __m128i*)key);
+    
+    _mm_storeu_si128((__m128i*)rk[0], k);
+    EXPAND(1, 0x01);
+    EXPAND(2, 0x02);
+    EXPAND(3, 0x04);
+    EXPAND(4, 0x08);
+    EXPAND(5, 0x10);
+    EXPAND(6, 0x20);
+    EXPAND(7, 0x40);
+    EXPAND(8, 0x80);
+    EXPAND(9, 0x1b);
+    EXPAND(10, 0x36);
+}
+
+/**
+ * Encrypt AES_LANES blocks in place, each under its own key, rounds
+ * interleaved (a fixed lane count keeps the blocks in registers)
+ */
+AEAD_TARGET static inline void aes_lanes(__m128i *b, const EDTSPAeadKey *const *keys) {
+#pragma GCC unroll 8
+    for (int i = 0; i < AES_LANES; i++) {
+        b[i] = _mm_xor_si128(b[i], _mm_loadu_si128((const __m128i*)keys[i]->round_keys[0]));
+    }
+    for (int r = 1; r < 10; r++) {
+#pragma GCC unroll 8
+        for (int i = 0; i < AES_LANES; i++) {
+            b[i] = _mm_aesenc_si128(b[i], _mm_loadu_si128((const __m128i*)keys[i]->round_keys[r]));
+        }
+    }
+#pragma GCC unroll 8
+    for (int i = 0; i < AES_LANES; i++) {
+        b[i] = _mm_aesenclast_si128(b[i], _mm_loadu_si128((const __m128i*)keys[i]->round_keys[10]));
+    }
+}
+
+AEAD_TARGET static inline __m128i bswap128(__m128i x) {
+    return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+/**
+ * Unreduced 256-bit carry-less product of byte-reflected operands, added
+ * to lo/mid/hi. Karatsuba: mid collects (a1^a0)(b1^b0), which gf_reduce
+ * turns into the middle term by adding lo and hi.
+ */
+AEAD_TARGET static inline void clmul_acc(__m128i a, __m128i b, __m128i *lo, __m128i *mid, __m128i *hi) {
+    __m128i a_fold = _mm_xor_si128(a, _mm_srli_si128(a, 8));
+    __m128i b_fold = _mm_xor_si128(b, _mm_srli_si128(b, 8));
+    
+    *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+    *mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(a_fold, b_fold, 0x00));
+    *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+}
+
+/** x^128 + x^7 + x^2 + x + 1, reflected: the constant of both folds below */
+#define GHASH_POLY _mm_set_epi64x((long long)0xC200000000000000ULL, 1)
+
+/**
+ * Reduce a (sum of) product(s) into GF(2^128). One operand of each product
+ * is a stored power of H, which carries an extra factor x (gcm_set_key):
+ * the reflected product needs no one-bit shift, and the 256 bits fold
+ * down in two carry-less multiplies by the polynomial.
+ */
+AEAD_TARGET static __m128i gf_reduce(__m128i lo, __m128i mid, __m128i hi) {
+    mid = _mm_xor_si128(mid, _mm_xor_si128(lo, hi));
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+    
+    lo = _mm_xor_si128(_mm_shuffle_epi32(lo, 0x4E), _mm_clmulepi64_si128(GHASH_POLY, lo, 0x01));
+    lo = _mm_xor_si128(_mm_shuffle_epi32(lo, 0x4E), _mm_clmulepi64_si128(GHASH_POLY, lo, 0x01));
+    return _mm_xor_si128(hi, lo);
+}
+
+AEAD_TARGET static __m128i gfmul(__m128i a, __m128i b) {
+    __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+    
+    clmul_acc(a, b, &lo, &mid, &hi);
+    return gf_reduce(lo, mid, hi);
+}
+
+/** pshufb indices that move the last r bytes of a 16-byte load to the front: load at 16 - r */
+static const uint8_t tail_shuffle[32] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80
+};
+
+/** Block b of a zero-padded byte string, byte-reflected */
+AEAD_TARGET static inline __m128i ghash_load(const uint8_t *data, size_t len, size_t b) {
+    size_t left = len - 16 * b;
+    __m128i x;
+    
+    if (left >= 16) {
+        x = _mm_loadu_si128((const __m128i*)(data + 16 * b));
+    } else if (len >= 16) {
+        // Short last block: the 16 bytes ending with the string, shifted down
+        x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + len - 16)),
+                             _mm_loadu_si128((const __m128i*)(tail_shuffle + 16 - left)));
+    } else {
+        uint8_t last[16] = {0};
+        memcpy(last, data, len);
+        x = _mm_loadu_si128((const __m128i*)last);
+    }
+    return bswap128(x);
+}
+
+/** Block b of a message's text, zero-padded: the tag behind it makes a whole load safe */
+AEAD_TARGET static inline __m128i text_load(const uint8_t *data, size_t len, size_t b) {
+    size_t left = len - 16 * b;
+    __m128i keep = _mm_loadu_si128((const __m128i*)(tail_mask + 16 - (left < 16 ? left : 16)));
+    
+    return bswap128(_mm_and_si128(_mm_loadu_si128((const __m128i*)(data + 16 * b)), keep));
+}
+
+/**
+ * GHASH state. Blocks are folded in groups of up to GHASH_GROUP: block j
+ * of a group of n is multiplied by H^(n-j) as it comes, and the group is
+ * reduced once. A DATA frame (header, payload, lengths) is one group.
+ */
+typedef struct {
+    const EDTSPAeadKey *key;
+    __m128i y, lo, mid, hi;
+    size_t  left;       // Blocks still to come
+    size_t  group;      // Of these, in the current group
+} Ghash;
+
+AEAD_TARGET static inline void ghash_block(Ghash *g, __m128i x) {
+    if (!g->group) {
+        g->group = g->left < GHASH_GROUP ? g->left : GHASH_GROUP;
+        g->lo = g->mid = g->hi = _mm_setzero_si128();
+        x = _mm_xor_si128(x, g->y);
+    }
+    g->left--;
+    g->group--;
+    clmul_acc(x, _mm_loadu_si128((const __m128i*)g->key->ghash_pow[g->group]), &g->lo, &g->mid, &g->hi);
+    if (!g->group) g->y = gf_reduce(g->lo, g->mid, g->hi);
+}
+
+/** GCM tag: GHASH over AAD, ciphertext and lengths, masked with E(J0) */
+AEAD_TARGET static void gcm_tag(const EDTSPAeadMsg *m, const uint8_t mask[16], uint8_t tag[16]) {
+    size_t aad_blocks = (m->aad_len + 15) / 16;
+    size_t text_blocks = (m->len + 15) / 16;
+    __m128i zero = _mm_setzero_si128();
+    Ghash g = { m->key, zero, zero, zero, zero, aad_blocks + text_blocks + 1, 0 };
+    
+    for (size_t b = 0; b < aad_blocks; b++) ghash_block(&g, ghash_load(m->aad, m->aad_len, b));
+    for (size_t b = 0; b < text_blocks; b++) ghash_block(&g, text_load(m->data, m->len, b));
+    ghash_block(&g, _mm_set_epi64x((long long)m->aad_len * 8, (long long)m->len * 8));
+    _mm_storeu_si128((__m128i*)tag, _mm_xor_si128(bswap128(g.y), _mm_loadu_si128((const __m128i*)mask)));
+}
+
+/** Counter block of block b of a message (CTR value b + 1): nonce (fixed part, seq) and counter, big-endian */
+AEAD_TARGET static inline __m128i counter_block(const EDTSPAeadMsg *m, uint32_t b) {
+    return _mm_set_epi32((int)__builtin_bswap32(b + 1), (int)__builtin_bswap32(m->seq),
+                         (int)load_le32(m->key->nonce_fixed + 4), (int)load_le32(m->key->nonce_fixed));
+}
+
+/** Up to AES_LANES counter blocks (unused lanes repeat the last job) */
+AEAD_TARGET static void gcm_lanes(const EDTSPAeadMsg *msgs, const Job *jobs, int n, uint8_t out[AES_LANES][16]) {
+    __m128i b[AES_LANES];
+    const EDTSPAeadKey *keys[AES_LANES];
+    
+    for (int l = 0; l < AES_LANES; l++) {
+        const Job *job = &jobs[l < n ? l : n - 1];
+        b[l] = counter_block(&msgs[job->msg], job->block);
+        keys[l] = msgs[job->msg].key;
+    }
+    aes_lanes(b, keys);
+    for (int l = 0; l < n; l++) _mm_storeu_si128((__m128i*)out[l], b[l]);
+}
+
+/** A message for gcm_short: 16 bytes of AAD (a v2 header) and 1-32 bytes of text */
+static inline bool gcm_is_short(const EDTSPAeadMsg *m) {
+    return m->key->alg == EDTSP_AEAD_AES128_GCM && m->aad_len == 16 && m->len - 1 < 32;
+}
+
+/** sel ? a : b, per bit */
+AEAD_TARGET static inline __m128i select128(__m128i sel, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(sel, a), _mm_andnot_si128(sel, b));
+}
+
+/**
+ * Seal or open short messages (gcm_is_short), as most DATA frames are,
+ * without job lists or scratch rows
+ *
+ * Each message takes E(J0) and two counter blocks, which share the round
+ * key loads. GHASH always folds four blocks: [A, T0, T1, L], or
+ * [0, A, T0, L] for one text block (a leading zero block leaves GHASH
+ * unchanged). The text is followed by its tag, so both chunks are read and
+ * written whole and masked; with one block the second chunk aliases the
+ * first and is masked to nothing. Nothing branches on the text length.
+ */
+AEAD_TARGET static void gcm_short(const EDTSPAeadMsg *msgs, const uint8_t *idx, int n, bool *ok, bool seal) {
+    for (int k = 0; k < n; k++) {
+        const EDTSPAeadMsg *m = &msgs[idx[k]];
+        const __m128i *rk = (const __m128i*)m->key->round_keys;
+        __m128i ks[3];
+        
+        // The three blocks share each round key load
+        for (uint32_t b = 0; b < 3; b++) ks[b] = _mm_xor_si128(counter_block(m, b), _mm_loadu_si128(rk));
+        for (int r = 1; r < 10; r++) {
+            __m128i key = _mm_loadu_si128(rk + r);
+            for (int b = 0; b < 3; b++) ks[b] = _mm_aesenc_si128(ks[b], key);
+        }
+        for (int b = 0; b < 3; b++) ks[b] = _mm_aesenclast_si128(ks[b], _mm_loadu_si128(rk + 10));
+        
+        const uint8_t (*pow)[16] = m->key->ghash_pow;
+        bool two = m->len > 16;
+        uint8_t *second = m->data + (two ? 16 : 0);
+        __m128i keep0 = _mm_loadu_si128((const __m128i*)(tail_mask + 16 - (two ? 16 : m->len)));
+        __m128i keep1 = _mm_loadu_si128((const __m128i*)(tail_mask + 16 - (two ? m->len - 16 : 0)));
+        __m128i in0 = _mm_loadu_si128((const __m128i*)m->data);
+        __m128i in1 = _mm_loadu_si128((const __m128i*)second);
+        __m128i out0 = _mm_xor_si128(in0, _mm_and_si128(ks[1], keep0));
+        __m128i out1 = _mm_xor_si128(in1, _mm_and_si128(ks[2], keep1));
+        
+        // GHASH over the ciphertext
+        __m128i sel = _mm_set1_epi32(-(int)two);
+        __m128i a = bswap128(_mm_loadu_si128((const __m128i*)m->aad));
+        __m128i t0 = bswap128(_mm_and_si128(seal ? out0 : in0, keep0));
+        __m128i t1 = bswap128(_mm_and_si128(seal ? out1 : in1, keep1));
+        __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+        clmul_acc(_mm_and_si128(sel, a), _mm_loadu_si128((const __m128i*)pow[3]), &lo, &mid, &hi);
+        clmul_acc(select128(sel, t0, a), _mm_loadu_si128((const __m128i*)pow[2]), &lo, &mid, &hi);
+        clmul_acc(select128(sel, t1, t0), _mm_loadu_si128((const __m128i*)pow[1]), &lo, &mid, &hi);
+        clmul_acc(_mm_set_epi64x(16 * 8, (long long)m->len * 8), _mm_loadu_si128((const __m128i*)pow[0]),
+                  &lo, &mid, &hi);
+        __m128i tag = _mm_xor_si128(bswap128(gf_reduce(lo, mid, hi)), ks[0]);
+        
+        if (!seal) {
+            // All 16 bytes compared, no early exit
+            __m128i same = _mm_cmpeq_epi8(tag, _mm_loadu_si128((const __m128i*)(m->data + m->len)));
+            ok[idx[k]] = _mm_movemask_epi8(same) == 0xFFFF;
+            if (!ok[idx[k]]) continue;
+        }
+        _mm_storeu_si128((__m128i*)second, out1);
+        _mm_storeu_si128((__m128i*)m->data, out0);
+        if (seal) {
+            _mm_storeu_si128((__m128i*)(m->data + m->len), tag);
+            if (ok) ok[idx[k]] = true;
+        }
+    }
+}
+
+AEAD_TARGET static void gcm_set_key(EDTSPAeadKey *k) {
+    const EDTSPAeadKey *keys[AES_LANES];
+    __m128i b[AES_LANES];
+    
+    aes_expand(k->key, k->round_keys);
+    for (int i = 0; i < AES_LANES; i++) {
+        keys[i] = k;
+        b[i] = _mm_setzero_si128();
+    }
+    aes_lanes(b, keys);
+    __m128i h = bswap128(b[0]);
+    
+    // H·x: shift the reflected value left one bit, reduce what falls out
+    __m128i carry = _mm_srli_epi64(h, 63);
+    __m128i top = _mm_shuffle_epi32(_mm_srai_epi32(h, 31), 0xFF);
+    h = _mm_or_si128(_mm_slli_epi64(h, 1), _mm_slli_si128(carry, 8));
+    h = _mm_xor_si128(h, _mm_and_si128(top, GHASH_POLY));
+    
+    __m128i pow = h;
+    for (int i = 0; i < GHASH_GROUP; i++) {
+        _mm_storeu_si128((__m128i*)k->ghash_pow[i], pow);
+        pow = gfmul(pow, h);
+    }
+}
+#endif
+
+// ============================================================================
+// AEAD
+// ============================================================================
+
+uint8_t edtsp_aead_supported(void) {
+    uint8_t algs = EDTSP_AEAD_CHACHA20_POLY1305;
+#ifdef AEAD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3")) {
+        algs |= EDTSP_AEAD_AES128_GCM;
+    }
+#endif
+    return algs;
+}
+
+const char *edtsp_aead_name(uint8_t alg) {
+    switch (alg) {
+        case EDTSP_AEAD_CHACHA20_POLY1305: return "ChaCha20-Poly1305";
+        case EDTSP_AEAD_AES128_GCM:        return "AES-128-GCM";
+        default:                           return "none";
+    }
+}
+
+void edtsp_aead_set_key(EDTSPAeadKey *k, EDTSPAeadAlg alg, const uint8_t key[EDTSP_AEAD_KEY_LEN]) {
+    memset(k, 0, sizeof(*k));
+    k->alg = (uint8_t)alg;
+    memcpy(k->key, key, EDTSP_AEAD_KEY_LEN);
+#ifdef AEAD_X86
+    if (alg == EDTSP_AEAD_AES128_GCM) gcm_set_key(k);
+#endif
+}
+
+/** Block size of an algorithm's keystream */
+static inline size_t block_size(uint8_t alg) {
+    return alg == EDTSP_AEAD_AES128_GCM ? 16 : 64;
+}
+
+/**
+ * Run keystream jobs of one algorithm, lanes filled across messages
+ *
+ * Block 0 and the first EARLY_BYTES of data keystream go to the message's
+ * scratch row; later data blocks are XORed into the message.
+ */
+static void run_jobs(uint8_t alg, const EDTSPAeadMsg *msgs, const Job *jobs, int n, uint8_t (*scratch)[SCRATCH]) {
+    size_t bs = block_size(alg);
+    int lanes = alg == EDTSP_AEAD_AES128_GCM ? AES_LANES : CHACHA_LANES;
+    uint8_t out[AES_LANES > CHACHA_LANES ? AES_LANES : CHACHA_LANES][64];
+    
+    for (int j = 0; j < n; j += lanes) {
+        int count = n - j < lanes ? n - j : lanes;
+#ifdef AEAD_X86
+        if (alg == EDTSP_AEAD_AES128_GCM) gcm_lanes(msgs, jobs + j, count, (uint8_t (*)[16])out);
+        else
+#endif
+        chacha_lanes(msgs, jobs + j, count, out);
+        
+        for (int l = 0; l < count; l++) {
+            const Job *job = &jobs[j + l];
+            const uint8_t *ks = alg == EDTSP_AEAD_AES128_GCM ? out[0] + 16 * l : out[l];
+            if (job->block == 0) {
+                memcpy(scratch[job->msg], ks, 32);
+                continue;
+            }
+            
+            // Constant sizes: the copies compile to a few moves, not memcpy calls
+            size_t off = (job->block - 1) * bs;
+            if (off < EARLY_BYTES) {
+                if (bs == 16) memcpy(scratch[job->msg] + 32 + off, ks, 16);
+                else memcpy(scratch[job->msg] + 32 + off, ks, 64);
+                continue;
+            }
+            const EDTSPAeadMsg *m = &msgs[job->msg];
+            xor_text(m->data + off, ks, m->len - off < bs ? m->len - off : bs);
+        }
+    }
+}
+
+static void compute_tag(const EDTSPAeadMsg *m, const uint8_t first[32], uint8_t tag[16]) {
+#ifdef AEAD_X86
+    if (m->key->alg == EDTSP_AEAD_AES128_GCM) {
+        gcm_tag(m, first, tag);
+        return;
+    }
+#endif
+    chacha_tag(m, first, tag);
+}
+
+/**
+ * Seal or open up to EDTSP_AEAD_BATCH messages
+ *
+ * Both passes run per algorithm so that each job list feeds one kind of
+ * lane. Frames fit in the first pass; the second only runs for messages
+ * longer than EARLY_BYTES. Short AES-GCM messages, which are most DATA
+ * frames, skip the job lists and go through gcm_short.
+ */
+static void process(const EDTSPAeadMsg *msgs, int n, bool *ok, bool seal) {
+    static Job jobs[EDTSP_AEAD_BATCH * 8];
+    static const uint8_t algs[2] = { EDTSP_AEAD_AES128_GCM, EDTSP_AEAD_CHACHA20_POLY1305 };
+    const int max_jobs = (int)(sizeof(jobs) / sizeof(jobs[0]));
+    uint8_t scratch[EDTSP_AEAD_BATCH][SCRATCH];
+    uint8_t route[EDTSP_AEAD_BATCH];        // Algorithm of each message's job-list passes, 0 = none
+    uint8_t tag[16];
+    
+    if (!seal) memset(ok, 0, (size_t)n * sizeof(ok[0]));
+    for (int i = 0; i < n; i++) route[i] = msgs[i].key->alg;
+#ifdef AEAD_X86
+    uint8_t shorts[EDTSP_AEAD_BATCH];
+    int short_count = 0;
+    
+    for (int i = 0; i < n; i++) {
+        if (!gcm_is_short(&msgs[i])) continue;
+        route[i] = 0;
+        shorts[short_count++] = (uint8_t)i;
+    }
+    if (short_count) gcm_short(msgs, shorts, short_count, ok, seal);
+#endif
+    
+    for (int a = 0; a < 2; a++) {
+        uint8_t alg = algs[a];
+        size_t bs = block_size(alg);
+        size_t late = EARLY_BYTES / bs + 1;     // First block of the second pass
+        bool long_msgs = false;
+        int count = 0;
+        
+        for (int i = 0; i < n; i++) {
+            if (route[i] != alg) continue;
+            // Fixed stores, the count advanced by the message's blocks: no
+            // loop exit that varies with the frame length to mispredict
+            size_t early = msgs[i].len < EARLY_BYTES ? msgs[i].len : EARLY_BYTES;
+            for (size_t b = 0; b <= EARLY_BYTES / bs; b++) jobs[count + b] = (Job){ (uint16_t)i, (uint16_t)b };
+            count += (int)((early + bs - 1) / bs) + 1;
+            long_msgs = long_msgs || msgs[i].len > EARLY_BYTES;
+        }
+        if (!count) continue;
+        run_jobs(alg, msgs, jobs, count, scratch);
+        
+        // Tags are checked on the ciphertext, before anything is decrypted
+        for (int i = 0; i < n; i++) {
+            const EDTSPAeadMsg *m = &msgs[i];
+            if (route[i] != alg) continue;
+            if (!seal) {
+                compute_tag(m, scratch[i], tag);
+                ok[i] = tag_equal(tag, m->data + m->len);
+                if (!ok[i]) continue;
+            }
+            
+            xor_text(m->data, scratch[i] + 32, m->len < EARLY_BYTES ? m->len : EARLY_BYTES);
+        }
+        
+        // Rest of long messages, resumed across job-list rounds
+        int i = 0;
+        size_t next = late;
+        while (long_msgs && i < n) {
+            count = 0;
+            for (; i < n && count < max_jobs; i++, next = late) {
+                const EDTSPAeadMsg *m = &msgs[i];
+                if (route[i] != alg || (!seal && !ok[i])) continue;
+                
+                size_t blocks = (m->len + bs - 1) / bs;
+                for (; next <= blocks && count < max_jobs; next++) jobs[count++] = (Job){ (uint16_t)i, (uint16_t)next };
+                if (next <= blocks) break;   // Job list full: resume this message
+            }
+            run_jobs(alg, msgs, jobs, count, scratch);
+        }
+        
+        if (!seal) continue;
+        for (int k = 0; k < n; k++) {
+            if (route[k] != alg) continue;
+            compute_tag(&msgs[k], scratch[k], msgs[k].data + msgs[k].len);
+            if (ok) ok[k] = true;
+        }
+    }
+}
+
+void edtsp_aead_seal(const EDTSPAeadKey *k, uint32_t seq, const uint8_t *aad, size_t aad_len,
+                     uint8_t *data, size_t len) {
+    EDTSPAeadMsg m = { k, seq, aad, aad_len, data, len };
+    process(&m, 1, NULL, true);
+}
+
+bool edtsp_aead_open(const EDTSPAeadKey *k, uint32_t seq, const uint8_t *aad, size_t aad_len,
+                     uint8_t *data, size_t len) {
+    EDTSPAeadMsg m = { k, seq, aad, aad_len, data, len };
+    bool ok = false;
+    
+    process(&m, 1, &ok, false);
+    return ok;
+}
+
+void edtsp_aead_open_batch(const EDTSPAeadMsg *msgs, int n, bool *ok) {
+    for (int i = 0; i < n; i += EDTSP_AEAD_BATCH) {
+        process(msgs + i, n - i < EDTSP_AEAD_BATCH ? n - i : EDTSP_AEAD_BATCH, ok + i, false);
+    }
+}
+
+// ============================================================================
+// SESSIONS
+// ============================================================================
+
+void edtsp_aead_init(bool on, uint8_t algs, uint32_t self_id) {
+    enabled = on;
+    self = self_id;
+    allowed = algs & edtsp_aead_supported();
+    memset(sessions, 0, sizeof(sessions));
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool edtsp_aead_enabled(void) {
+    return enabled;
+}
+
+uint8_t edtsp_aead_offer(void) {
+    return enabled ? allowed : 0;
+}
+
+uint8_t edtsp_aead_choose(uint8_t offered) {
+    uint8_t common = offered & allowed;
+    
+    if (!enabled) return 0;
+    if (common & EDTSP_AEAD_AES128_GCM) return EDTSP_AEAD_AES128_GCM;
+    return common & EDTSP_AEAD_CHACHA20_POLY1305;
+}
+
+static inline uint32_t home_slot(uint32_t peer_id) {
+    return (peer_id * 2654435761u) & (EDTSP_AEAD_SESSIONS - 1);
+}
+
+static EDTSPAeadSession *lookup(uint32_t peer_id, bool create) {
+    uint32_t i = home_slot(peer_id);
+    
+    for (int n = 0; n < EDTSP_AEAD_SESSIONS; n++, i = (i + 1) & (EDTSP_AEAD_SESSIONS - 1)) {
+        EDTSPAeadSession *s = &sessions[i];
+        if (!s->used) {
+            if (!create) return NULL;
+            s->used = true;
+            s->peer_id = peer_id;
+            return s;
+        }
+        if (s->peer_id == peer_id) return s;
+    }
+    return NULL;
+}
+
+static void remove_session(EDTSPAeadSession *s) {
+    uint32_t hole = (uint32_t)(s - sessions);
+    
+    // Backward shift: pull later entries of the probe run into the hole.
+    // Vacated slots are freed as it goes, so a full table ends the run.
+    uint32_t i = (hole + 1) & (EDTSP_AEAD_SESSIONS - 1);
+    sessions[hole].used = false;
+    while (sessions[i].used) {
+        uint32_t home = home_slot(sessions[i].peer_id);
+        if (((i - home) & (EDTSP_AEAD_SESSIONS - 1)) >= ((i - hole) & (EDTSP_AEAD_SESSIONS - 1))) {
+            sessions[hole] = sessions[i];
+            hole = i;
+            sessions[hole].used = false;
+        }
+        i = (i + 1) & (EDTSP_AEAD_SESSIONS - 1);
+    }
+    
+    // The freed slot's key is overwritten or zeroed here
+    memset(&sessions[hole], 0, sizeof(sessions[hole]));
+}
+
+/** Session key: SipHash-2-4 under the network key, one 64-bit word per counter value */
+static void derive(uint8_t key[EDTSP_AEAD_KEY_LEN], uint32_t master_id, uint32_t slave_id,
+                   uint64_t slave_nonce, uint64_t master_nonce, uint8_t alg) {
+    uint8_t in[34] = { 'E', 'D', 'T', 'S', 'P', '-', 'S', 'K' };
+    
+    store_le32(in + 9, master_id);
+    store_le32(in + 13, slave_id);
+    store_le32(in + 17, (uint32_t)slave_nonce);
+    store_le32(in + 21, (uint32_t)(slave_nonce >> 32));
+    store_le32(in + 25, (uint32_t)master_nonce);
+    store_le32(in + 29, (uint32_t)(master_nonce >> 32));
+    in[33] = alg;
+    for (int i = 0; i < EDTSP_AEAD_KEY_LEN / 8; i++) {
+        in[8] = (uint8_t)i;
+        uint64_t word = edtsp_auth_mac(in, sizeof(in));
+        store_le32(key + 8 * i, (uint32_t)word);
+        store_le32(key + 8 * i + 4, (uint32_t)(word >> 32));
+    }
+}
+
+const EDTSPAeadSession *edtsp_aead_install(uint32_t peer_id, uint32_t master_id, uint32_t slave_id,
+                                           uint64_t slave_nonce, uint64_t master_nonce, uint8_t alg) {
+    if (!(alg & allowed) || (alg != EDTSP_AEAD_AES128_GCM && alg != EDTSP_AEAD_CHACHA20_POLY1305)) {
+        return NULL;
+    }
+    
+    EDTSPAeadSession *s = lookup(peer_id, true);
+    if (!s) return NULL;
+    if (s->key.alg == alg && s->slave_nonce == slave_nonce && s->master_nonce == master_nonce) return s;
+    
+    uint8_t key[EDTSP_AEAD_KEY_LEN];
+    derive(key, master_id, slave_id, slave_nonce, master_nonce, alg);
+    edtsp_aead_set_key(&s->key, (EDTSPAeadAlg)alg, key);
+    memset(key, 0, sizeof(key));
+    s->slave_nonce = slave_nonce;
+    s->master_nonce = master_nonce;
+    s->sealing = false;
+    stats.sessions++;
+    return s;
+}
+
+const EDTSPAeadSession *edtsp_aead_session(uint32_t peer_id) {
+    EDTSPAeadSession *s = lookup(peer_id, false);
+    return s && s->key.alg ? s : NULL;
+}
+
+void edtsp_aead_forget(uint32_t peer_id) {
+    EDTSPAeadSession *s = lookup(peer_id, false);
+    if (s) remove_session(s);
+}
+
+size_t edtsp_aead_seal_frame(uint8_t *frame, size_t len, uint32_t peer_id) {
+    EDTSPAeadSession *s = lookup(peer_id, false);
+    uint32_t seq = (uint32_t)frame[12] << 24 | (uint32_t)frame[13] << 16 | (uint32_t)frame[14] << 8 | frame[15];
+    uint8_t header_len = frame[offsetof(EDTSPHeaderV2, header_len)];
+    
+    if (!s || !s->key.alg || len < header_len) {
+        stats.held++;
+        return 0;
+    }
+    
+    // Nonces must not repeat under a key: stop before the sequence wraps
+    if (!s->sealing) {
+        s->sealing = true;
+        s->first_seq = seq;
+    } else if (seq - s->first_seq >= EDTSP_AEAD_MAX_FRAMES) {
+        stats.held++;
+        return 0;
+    }
+    
+    size_t text = len - header_len;
+    uint16_t payload_len = (uint16_t)(text + EDTSP_AEAD_TAG_LEN);
+    frame[offsetof(EDTSPHeaderV2, flags)] |= EDTSP_FLAG_ENCRYPTED;
+    frame[offsetof(EDTSPHeaderV2, payload_len)] = (uint8_t)(payload_len >> 8);
+    frame[offsetof(EDTSPHeaderV2, payload_len) + 1] = (uint8_t)payload_len;
+    edtsp_aead_seal(&s->key, seq, frame, header_len, frame + header_len, text);
+    stats.sealed++;
+    return len + EDTSP_AEAD_TAG_LEN;
+}
+
+/**
+ * Move the n bytes behind an AEAD tag over it, a word at a time: usually
+ * just the 8-byte authentication tag, too short for a memmove call to pay
+ */
+static void cut_tag(uint8_t *tag, size_t n) {
+    for (; n >= 8; n -= 8, tag += 8) {
+        uint64_t word;
+        memcpy(&word, tag + EDTSP_AEAD_TAG_LEN, 8);
+        memcpy(tag, &word, 8);
+    }
+    for (; n; n--, tag++) tag[0] = tag[EDTSP_AEAD_TAG_LEN];
+}
+
+void edtsp_aead_open_frames(uint8_t *const *frames, uint16_t *lens, int n, bool *ok) {
+    EDTSPAeadMsg msgs[EDTSP_AEAD_BATCH];
+    int idx[EDTSP_AEAD_BATCH];
+    bool opened[EDTSP_AEAD_BATCH];
+    
+    for (int start = 0; start < n; start += EDTSP_AEAD_BATCH) {
+        int end = n - start < EDTSP_AEAD_BATCH ? n : start + EDTSP_AEAD_BATCH;
+        int count = 0;
+        
+        for (int i = start; i < end; i++) {
+            const uint8_t *f = frames[i];
+            if (!ok[i]) continue;
+            if (lens[i] < sizeof(EDTSPHeaderV2) || (uint16_t)(f[0] << 8 | f[1]) != EDTSP_MAGIC_V2) {
+                // v1: passes unless it is DATA-class
+                if (enabled && lens[i] >= sizeof(EDTSPHeader) &&
+                    edtsp_tclass_of(f[offsetof(EDTSPHeader, type)]) == EDTSP_CLASS_DATA) {
+                    ok[i] = false;
+                    stats.plaintext++;
+                }
+                continue;
+            }
+            
+            uint8_t flags = f[offsetof(EDTSPHeaderV2, flags)];
+            if (!(flags & EDTSP_FLAG_ENCRYPTED)) {
+                if (enabled && edtsp_tclass_of(f[offsetof(EDTSPHeaderV2, type)]) == EDTSP_CLASS_DATA) {
+                    ok[i] = false;
+                    stats.plaintext++;
+                }
+                continue;
+            }
+            
+            uint32_t source = (uint32_t)f[4] << 24 | (uint32_t)f[5] << 16 | (uint32_t)f[6] << 8 | f[7];
+            if (source == self) continue;   // Own frame looped back: dropped later
+            uint8_t header_len = f[offsetof(EDTSPHeaderV2, header_len)];
+            uint16_t payload_len = (uint16_t)(f[8] << 8 | f[9]);
+            const EDTSPAeadSession *s = enabled ? edtsp_aead_session(source) : NULL;
+            if (!s || header_len < sizeof(EDTSPHeaderV2) || payload_len < EDTSP_AEAD_TAG_LEN ||
+                (size_t)header_len + payload_len > lens[i]) {
+                ok[i] = false;
+                stats.no_session++;
+                continue;
+            }
+            
+            EDTSPAeadMsg *m = &msgs[count];
+            m->key = &s->key;
+            m->seq = (uint32_t)f[12] << 24 | (uint32_t)f[13] << 16 | (uint32_t)f[14] << 8 | f[15];
+            m->aad = f;
+            m->aad_len = header_len;
+            m->data = frames[i] + header_len;
+            m->len = payload_len - EDTSP_AEAD_TAG_LEN;
+            idx[count++] = i;
+        }
+        if (!count) continue;
+        
+        edtsp_aead_open_batch(msgs, count, opened);
+        for (int k = 0; k < count; k++) {
+            int i = idx[k];
+            if (!opened[k]) {
+                ok[i] = false;
+                stats.bad_tag++;
+                continue;
+            }
+            
+            // Plaintext frame: cut the AEAD tag out, move what follows
+            // (authentication tag, redundancy trailer) up behind the text
+            uint8_t *f = frames[i];
+            uint8_t *tag = msgs[k].data + msgs[k].len;
+            uint16_t payload_len = (uint16_t)msgs[k].len;
+            cut_tag(tag, (size_t)(f + lens[i] - tag) - EDTSP_AEAD_TAG_LEN);
+            lens[i] -= EDTSP_AEAD_TAG_LEN;
+            f[offsetof(EDTSPHeaderV2, flags)] &= (uint8_t)~EDTSP_FLAG_ENCRYPTED;
+            f[offsetof(EDTSPHeaderV2, payload_len)] = (uint8_t)(payload_len >> 8);
+            f[offsetof(EDTSPHeaderV2, payload_len) + 1] = (uint8_t)payload_len;
+            stats.opened++;
+        }
+    }
+}
+
+const EDTSPAeadStats *edtsp_aead_stats(void) {
+    return &stats;
+}
+
+void edtsp_aead_print(void) {
+    if (!enabled) return;
+    
+    printf("[STATS] === Encryption ===\n");
+    printf("  Offering %s%s%s; %u session key(s) installed\n",
+           allowed & EDTSP_AEAD_AES128_GCM ? "AES-128-GCM" : "",
+           allowed == (EDTSP_AEAD_AES128_GCM | EDTSP_AEAD_CHACHA20_POLY1305) ? ", " : "",
+           allowed & EDTSP_AEAD_CHACHA20_POLY1305 ? "ChaCha20-Poly1305" : "", stats.sessions);
+    printf("  sealed=%u opened=%u held=%u\n", stats.sealed, stats.opened, stats.held);
+    printf("  Dropped: bad tag=%u no session=%u plaintext DATA=%u\n",
+           stats.bad_tag, stats.no_session, stats.plaintext);
+}
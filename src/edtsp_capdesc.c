@@ -0,0 +1,295 @@
+/**
+ * @file edtsp_capdesc.c
+ * @brief EDTSP Capability Descriptors (TLV, exchanged in the join SYN)
+ *
+ * Interning: a decoded set is sorted by (kind, instance), hashed and
+ * compared against the live sets; devices hold a one-byte reference. The
+ * per-kind planning limit is folded once per set, so planning a fleet
+ * costs one array read per device.
+ */
+
+#include "../include/edtsp_capdesc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t            hash;
+    uint16_t            refs;       // 0 = free
+    uint8_t             count;
+    EDTSPCapabilityMask mask;
+    uint16_t            limit_ms[16];   // Per kind: slowest native interval
+    EDTSPSensorDesc     desc[EDTSP_CAPDESC_MAX_SENSORS];
+} CapDescSet;
+
+static CapDescSet sets[EDTSP_CAPDESC_SETS];
+static uint8_t slot_set[EDTSP_MAX_DEVICES];   // Set index + 1, 0 = none
+static uint32_t generation;
+static EDTSPCapDescStats stats;
+
+static const char *const unit_names[] = {
+    "-", "C", "%RH", "Pa", "m", "lx", "g", "dps", "uT", "A", "V", "ppm", "deg"
+};
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+int edtsp_capdesc_encode(const EDTSPSensorDesc *desc, int n, uint8_t *out, int max) {
+    int pos = 0;
+    
+    for (int i = 0; i < n; i++) {
+        if (pos + 2 + EDTSP_CAPDESC_SENSOR_LEN > max) return -1;
+        
+        const EDTSPSensorDesc *d = &desc[i];
+        out[pos++] = EDTSP_CAPDESC_SENSOR;
+        out[pos++] = EDTSP_CAPDESC_SENSOR_LEN;
+        out[pos++] = d->kind;
+        out[pos++] = d->instance;
+        out[pos++] = d->unit;
+        out[pos++] = (uint8_t)d->scale;
+        out[pos++] = (uint8_t)((uint16_t)d->range_min >> 8);
+        out[pos++] = (uint8_t)d->range_min;
+        out[pos++] = (uint8_t)((uint16_t)d->range_max >> 8);
+        out[pos++] = (uint8_t)d->range_max;
+        out[pos++] = (uint8_t)(d->min_interval_ms >> 8);
+        out[pos++] = (uint8_t)d->min_interval_ms;
+    }
+    return pos;
+}
+
+size_t edtsp_capdesc_attach(EDTSPHandshakePacket *pkt, const uint8_t *tlv, int len) {
+    size_t frame_len = offsetof(EDTSPHandshakePacket, descriptors) + (size_t)len;
+    
+    if (len < 0 || len > (int)sizeof(pkt->descriptors)) return 0;
+    
+    memcpy(pkt->descriptors, tlv, (size_t)len);
+    pkt->desc_len = (uint8_t)len;
+    pkt->header.payload_len = (uint8_t)(frame_len - sizeof(EDTSPHeader));
+    return frame_len;
+}
+
+EDTSPCapabilityMask edtsp_capdesc_mask(const EDTSPSensorDesc *desc, int n) {
+    EDTSPCapabilityMask mask = 0;
+    
+    for (int i = 0; i < n; i++) {
+        if (desc[i].kind < 16) mask |= (EDTSPCapabilityMask)(1u << desc[i].kind);
+    }
+    return mask;
+}
+
+int edtsp_capdesc_encode_session(uint64_t nonce, uint8_t algs, uint8_t *out, int max) {
+    if (2 + EDTSP_CAPDESC_SESSION_LEN > max) return -1;
+    
+    out[0] = EDTSP_CAPDESC_SESSION;
+    out[1] = EDTSP_CAPDESC_SESSION_LEN;
+    for (int i = 0; i < 8; i++) out[2 + i] = (uint8_t)(nonce >> (56 - 8 * i));
+    out[10] = algs;
+    return 2 + EDTSP_CAPDESC_SESSION_LEN;
+}
+
+bool edtsp_capdesc_find_session(const EDTSPHandshakePacket *pkt, size_t len, uint64_t *nonce, uint8_t *algs) {
+    size_t start = offsetof(EDTSPHandshakePacket, descriptors);
+    if (len <= start || pkt->desc_len > len - start) return false;
+    
+    const uint8_t *tlv = pkt->descriptors;
+    for (int pos = 0; pos + 2 <= pkt->desc_len; pos += 2 + tlv[pos + 1]) {
+        if (tlv[pos] != EDTSP_CAPDESC_SESSION) continue;
+        if (tlv[pos + 1] < EDTSP_CAPDESC_SESSION_LEN || pos + 2 + tlv[pos + 1] > pkt->desc_len) return false;
+        
+        *nonce = 0;
+        for (int i = 0; i < 8; i++) *nonce = *nonce << 8 | tlv[pos + 2 + i];
+        *algs = tlv[pos + 10];
+        return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+int edtsp_capdesc_decode(const uint8_t *tlv, int len, EDTSPSensorDesc *out, int max) {
+    int pos = 0;
+    int n = 0;
+    
+    while (pos < len) {
+        if (pos + 2 > len) return -1;
+        uint8_t type = tlv[pos];
+        uint8_t vlen = tlv[pos + 1];
+        const uint8_t *v = tlv + pos + 2;
+        pos += 2 + vlen;
+        if (pos > len) return -1;
+        
+        if (type != EDTSP_CAPDESC_SENSOR || n >= max) continue;
+        if (vlen < 1) return -1;
+        
+        // Fields past the record's length stay 0
+        uint8_t value[EDTSP_CAPDESC_SENSOR_LEN] = {0};
+        memcpy(value, v, vlen < sizeof(value) ? vlen : sizeof(value));
+        
+        EDTSPSensorDesc *d = &out[n++];
+        d->kind = value[0];
+        d->instance = value[1];
+        d->unit = value[2];
+        d->scale = (int8_t)value[3];
+        d->range_min = (int16_t)((value[4] << 8) | value[5]);
+        d->range_max = (int16_t)((value[6] << 8) | value[7]);
+        d->min_interval_ms = (uint16_t)((value[8] << 8) | value[9]);
+    }
+    return n;
+}
+
+void edtsp_capdesc_init(void) {
+    memset(sets, 0, sizeof(sets));
+    memset(slot_set, 0, sizeof(slot_set));
+    memset(&stats, 0, sizeof(stats));
+    generation = 0;
+}
+
+static int cmp_desc(const void *a, const void *b) {
+    const EDTSPSensorDesc *x = a, *y = b;
+    if (x->kind != y->kind) return x->kind - y->kind;
+    return x->instance - y->instance;
+}
+
+static uint32_t hash_desc(const EDTSPSensorDesc *desc, int n) {
+    const uint8_t *p = (const uint8_t*)desc;
+    uint32_t h = 2166136261u;
+    
+    // FNV-1a: the struct has no padding, decode fills every field
+    for (size_t i = 0; i < (size_t)n * sizeof(*desc); i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+/** @return Set index + 1, 0 if the table is full */
+static uint8_t intern(EDTSPSensorDesc *desc, int n) {
+    int free_idx = -1;
+    
+    qsort(desc, (size_t)n, sizeof(*desc), cmp_desc);
+    uint32_t h = hash_desc(desc, n);
+    
+    for (int i = 0; i < EDTSP_CAPDESC_SETS; i++) {
+        CapDescSet *s = &sets[i];
+        if (!s->refs) {
+            if (free_idx < 0) free_idx = i;
+            continue;
+        }
+        if (s->hash == h && s->count == n && !memcmp(s->desc, desc, (size_t)n * sizeof(*desc))) {
+            s->refs++;
+            stats.shared++;
+            return (uint8_t)(i + 1);
+        }
+    }
+    
+    if (free_idx < 0) {
+        stats.table_full++;
+        return 0;
+    }
+    
+    CapDescSet *s = &sets[free_idx];
+    memset(s, 0, sizeof(*s));
+    s->hash = h;
+    s->refs = 1;
+    s->count = (uint8_t)n;
+    memcpy(s->desc, desc, (size_t)n * sizeof(*desc));
+    s->mask = edtsp_capdesc_mask(desc, n);
+    for (int i = 0; i < n; i++) {
+        uint8_t k = desc[i].kind;
+        if (k < 16 && desc[i].min_interval_ms > s->limit_ms[k]) s->limit_ms[k] = desc[i].min_interval_ms;
+    }
+    stats.interned++;
+    return (uint8_t)(free_idx + 1);
+}
+
+bool edtsp_capdesc_set(int slot, const EDTSPHandshakePacket *pkt, size_t len) {
+    EDTSPSensorDesc desc[EDTSP_CAPDESC_MAX_SENSORS];
+    uint8_t set = 0;
+    
+    if (slot < 0 || slot >= EDTSP_MAX_DEVICES) return false;
+    
+    size_t start = offsetof(EDTSPHandshakePacket, descriptors);
+    int dlen = (len > start) ? pkt->desc_len : 0;
+    if ((size_t)dlen > len - start || dlen > (int)sizeof(pkt->descriptors)) {
+        stats.malformed++;
+        return false;
+    }
+    
+    if (dlen) {
+        stats.received++;
+        int n = edtsp_capdesc_decode(pkt->descriptors, dlen, desc, EDTSP_CAPDESC_MAX_SENSORS);
+        if (n < 0) {
+            stats.malformed++;
+            return false;
+        }
+        if (n > 0) set = intern(desc, n);
+    }
+    
+    // Release the old set after interning: an unchanged SYN keeps its set alive
+    uint8_t old = slot_set[slot];
+    if (old) sets[old - 1].refs--;
+    slot_set[slot] = set;
+    if (old == set) return false;
+    
+    generation++;
+    return true;
+}
+
+const EDTSPSensorDesc *edtsp_capdesc_get(int slot, int *count) {
+    if (slot < 0 || slot >= EDTSP_MAX_DEVICES || !slot_set[slot]) {
+        *count = 0;
+        return NULL;
+    }
+    
+    const CapDescSet *s = &sets[slot_set[slot] - 1];
+    *count = s->count;
+    return s->desc;
+}
+
+uint16_t edtsp_capdesc_plan_interval(int slot, uint8_t kind, uint16_t requested_ms) {
+    if (slot < 0 || slot >= EDTSP_MAX_DEVICES || !slot_set[slot] || kind >= 16) return requested_ms;
+    
+    const CapDescSet *s = &sets[slot_set[slot] - 1];
+    if (!(s->mask & (1u << kind))) {
+        stats.plans_skipped++;
+        return 0;
+    }
+    if (requested_ms >= s->limit_ms[kind]) return requested_ms;
+    
+    stats.plans_clamped++;
+    return s->limit_ms[kind];
+}
+
+uint32_t edtsp_capdesc_generation(void) {
+    return generation;
+}
+
+const EDTSPCapDescStats *edtsp_capdesc_stats(void) {
+    return &stats;
+}
+
+void edtsp_capdesc_print(void) {
+    int devices = 0;
+    
+    for (int i = 0; i < EDTSP_MAX_DEVICES; i++) devices += slot_set[i] != 0;
+    if (!stats.received && !devices) return;
+    
+    printf("[STATS] === Capability Descriptors ===\n");
+    printf("  Devices: %d, sets interned=%u shared=%u table_full=%u malformed=%u\n",
+           devices, stats.interned, stats.shared, stats.table_full, stats.malformed);
+    printf("  Planner: clamped=%u skipped=%u\n", stats.plans_clamped, stats.plans_skipped);
+    
+    for (int i = 0; i < EDTSP_CAPDESC_SETS; i++) {
+        const CapDescSet *s = &sets[i];
+        if (!s->refs) continue;
+        
+        printf("  Set %d (%u device(s), mask 0x%04X):", i, s->refs, s->mask);
+        for (int d = 0; d < s->count; d++) {
+            const EDTSPSensorDesc *x = &s->desc[d];
+            const char *unit = x->unit < sizeof(unit_names) / sizeof(unit_names[0]) ? unit_names[x->unit] : "?";
+            printf(" [%u.%u %d..%d e%d %s >=%ums]", x->kind, x->instance, x->range_min, x->range_max,
+                   x->scale, unit, x->min_interval_ms);
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,145 @@
+/**
+ * @file edtsp_clocksync.c
+ * @brief EDTSP Master-Driven Clock Synchronization
+ * 
+ * NTP-style exchange: offset = ((t2 - t1) + (t3 - t4)) / 2, error bounded
+ * by RTT/2. The lowest-RTT exchange of the last EDTSP_SYNC_FILTER_LEN is
+ * used as the anchor; drift comes from the slope between anchors at least
+ * EDTSP_SYNC_DRIFT_SPAN_US apart. Ingest conversion is a hash lookup, a
+ * 32-bit unwrap and one Q32 multiply.
+ */
+
+#include "../include/edtsp_clocksync.h"
+#include <stdio.h>
+#include <string.h>
+
+#define MODEL_HASH_SIZE 512
+
+/** Drift estimates beyond this are treated as clock steps (ppb) */
+#define MAX_DRIFT_PPB 1000000
+
+static EDTSPClockModel models[EDTSP_MAX_DEVICES];
+static uint16_t model_slot[MODEL_HASH_SIZE];   // 0 = empty, else index + 1
+static int model_count = 0;
+
+void edtsp_clock_init(void) {
+    memset(models, 0, sizeof(models));
+    memset(model_slot, 0, sizeof(model_slot));
+    model_count = 0;
+}
+
+static EDTSPClockModel *find_model(uint32_t slave_id, bool create) {
+    uint32_t idx = (slave_id * 2654435769u) >> (32 - 9);
+    
+    for (uint32_t probe = 0; probe < MODEL_HASH_SIZE; probe++) {
+        uint16_t *slot = &model_slot[(idx + probe) & (MODEL_HASH_SIZE - 1)];
+        
+        if (*slot == 0) {
+            if (!create || model_count >= EDTSP_MAX_DEVICES) return NULL;
+            EDTSPClockModel *m = &models[model_count];
+            *slot = (uint16_t)(++model_count);
+            m->slave_id = slave_id;
+            return m;
+        }
+        if (models[*slot - 1].slave_id == slave_id) return &models[*slot - 1];
+    }
+    return NULL;
+}
+
+void edtsp_clock_on_reply(uint32_t slave_id, uint64_t t1_us, uint64_t t2_us,
+                          uint64_t t3_us, uint64_t t4_us) {
+    EDTSPClockModel *m = find_model(slave_id, true);
+    if (!m) return;
+    
+    int64_t rtt = (int64_t)(t4_us - t1_us) - (int64_t)(t3_us - t2_us);
+    if (rtt < 0) rtt = 0;
+    
+    // Store exchange: midpoint on master clock, slave - master offset
+    int w = (int)(m->exchanges % EDTSP_SYNC_FILTER_LEN);
+    m->win_master_us[w] = t1_us + (t4_us - t1_us) / 2;
+    m->win_offset_us[w] = ((int64_t)(t2_us - t1_us) + (int64_t)(t3_us - t4_us)) / 2;
+    m->win_rtt_us[w] = rtt > UINT32_MAX ? UINT32_MAX : (uint32_t)rtt;
+    m->exchanges++;
+    
+    // Clock filter: lowest RTT in window has the tightest offset bound
+    int n = m->exchanges < EDTSP_SYNC_FILTER_LEN ? (int)m->exchanges : EDTSP_SYNC_FILTER_LEN;
+    int best = 0;
+    for (int i = 1; i < n; i++) {
+        if (m->win_rtt_us[i] < m->win_rtt_us[best]) best = i;
+    }
+    uint64_t anchor_master = m->win_master_us[best];
+    int64_t anchor_offset = m->win_offset_us[best];
+    
+    // Drift: slope between well-separated anchors, smoothed
+    if (!m->synced) {
+        m->drift_anchor_master_us = anchor_master;
+        m->drift_anchor_offset_us = anchor_offset;
+    } else if (anchor_master > m->drift_anchor_master_us + EDTSP_SYNC_DRIFT_SPAN_US) {
+        int64_t span = (int64_t)(anchor_master - m->drift_anchor_master_us);
+        int64_t ppb = (anchor_offset - m->drift_anchor_offset_us) * 1000000000LL / span;
+        
+        if (ppb > -MAX_DRIFT_PPB && ppb < MAX_DRIFT_PPB) {
+            m->drift_ppb = m->drift_ppb ? m->drift_ppb + (ppb - m->drift_ppb) / 4 : ppb;
+            m->drift_q32 = (m->drift_ppb * 4294967296LL) / 1000000000LL;
+        }
+        m->drift_anchor_master_us = anchor_master;
+        m->drift_anchor_offset_us = anchor_offset;
+    }
+    
+    m->ref_master_us = anchor_master;
+    m->ref_slave_us = (uint64_t)((int64_t)anchor_master + anchor_offset);
+    m->last_rtt_us = m->win_rtt_us[best];
+    m->synced = true;
+}
+
+/** Pick the 64-bit value with low 32 bits = v that is closest to ref */
+static uint64_t unwrap32(uint32_t v, uint64_t ref) {
+    uint64_t candidate = (ref & ~0xFFFFFFFFull) | v;
+    
+    if (candidate > ref + 0x80000000ull && candidate >= 0x100000000ull) {
+        candidate -= 0x100000000ull;
+    } else if (candidate + 0x80000000ull < ref) {
+        candidate += 0x100000000ull;
+    }
+    return candidate;
+}
+
+bool edtsp_clock_to_master_us(uint32_t slave_id, uint32_t timestamp_ms,
+                              uint64_t now_master_us, uint64_t *out_us) {
+    const EDTSPClockModel *m = find_model(slave_id, false);
+    
+    if (!m || !m->synced) {
+        if (out_us) *out_us = now_master_us;
+        return false;
+    }
+    
+    // Slave clock right now, to unwrap the 49-day millisecond counter
+    int64_t since_ref = (int64_t)(now_master_us - m->ref_master_us);
+    int64_t slave_now_us = (int64_t)m->ref_slave_us + since_ref + ((since_ref * m->drift_q32) >> 32);
+    uint64_t slave_ms = unwrap32(timestamp_ms, (uint64_t)slave_now_us / 1000);
+    
+    // Map slave time onto master time: d / (1 + drift) ~= d - d * drift
+    int64_t d = (int64_t)(slave_ms * 1000) - (int64_t)m->ref_slave_us;
+    if (out_us) *out_us = (uint64_t)((int64_t)m->ref_master_us + d - ((d * m->drift_q32) >> 32));
+    return true;
+}
+
+const EDTSPClockModel *edtsp_clock_model(uint32_t slave_id) {
+    return find_model(slave_id, false);
+}
+
+void edtsp_clock_print(uint64_t now_master_us) {
+    printf("[STATS] === Clock Sync ===\n");
+    printf("  %-10s %14s %10s %8s %9s\n", "Slave", "Offset(us)", "Drift(ppb)", "RTT(us)", "Exchanges");
+    
+    for (int i = 0; i < model_count; i++) {
+        const EDTSPClockModel *m = &models[i];
+        if (!m->synced) continue;
+        
+        // Offset extrapolated to now
+        int64_t since_ref = (int64_t)(now_master_us - m->ref_master_us);
+        int64_t offset = (int64_t)(m->ref_slave_us - m->ref_master_us) + ((since_ref * m->drift_q32) >> 32);
+        printf("  0x%08X %14lld %10lld %8u %9u\n", m->slave_id,
+               (long long)offset, (long long)m->drift_ppb, m->last_rtt_us, m->exchanges);
+    }
+}
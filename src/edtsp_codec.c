@@ -0,0 +1,46 @@
+/**
+ * @file edtsp_codec.c
+ * @brief EDTSP Codec Dispatch Table
+ * 
+ * GENERATED by tools/codegen/edtsp_codegen.py from tools/codegen/edtsp.schema - do not edit.
+ */
+
+#include "../include/protocol.h"
+#include <stddef.h>
+
+static void encode_discovery(void *pkt) { edtsp_encode_discovery((EDTSPDiscoveryPacket*)pkt); }
+static void decode_discovery(void *pkt) { edtsp_decode_discovery((EDTSPDiscoveryPacket*)pkt); }
+static void encode_heartbeat(void *pkt) { edtsp_encode_heartbeat((EDTSPHeartbeatPacket*)pkt); }
+static void decode_heartbeat(void *pkt) { edtsp_decode_heartbeat((EDTSPHeartbeatPacket*)pkt); }
+static void encode_handshake(void *pkt) { edtsp_encode_handshake((EDTSPHandshakePacket*)pkt); }
+static void decode_handshake(void *pkt) { edtsp_decode_handshake((EDTSPHandshakePacket*)pkt); }
+static void encode_config(void *pkt) { edtsp_encode_config((EDTSPConfigPacket*)pkt); }
+static void decode_config(void *pkt) { edtsp_decode_config((EDTSPConfigPacket*)pkt); }
+static void encode_data(void *pkt) { edtsp_encode_data((EDTSPDataPacket*)pkt); }
+static void decode_data(void *pkt) { edtsp_decode_data((EDTSPDataPacket*)pkt); }
+static void encode_probe(void *pkt) { edtsp_encode_probe((EDTSPProbePacket*)pkt); }
+static void decode_probe(void *pkt) { edtsp_decode_probe((EDTSPProbePacket*)pkt); }
+static void encode_sync(void *pkt) { edtsp_encode_sync((EDTSPSyncPacket*)pkt); }
+static void decode_sync(void *pkt) { edtsp_decode_sync((EDTSPSyncPacket*)pkt); }
+static void encode_actuate(void *pkt) { edtsp_encode_actuate((EDTSPActuatePacket*)pkt); }
+static void decode_actuate(void *pkt) { edtsp_decode_actuate((EDTSPActuatePacket*)pkt); }
+static void encode_group_config(void *pkt) { edtsp_encode_group_config((EDTSPGroupConfigPacket*)pkt); }
+static void decode_group_config(void *pkt) { edtsp_decode_group_config((EDTSPGroupConfigPacket*)pkt); }
+static void encode_credit(void *pkt) { edtsp_encode_credit((EDTSPCreditPacket*)pkt); }
+static void decode_credit(void *pkt) { edtsp_decode_credit((EDTSPCreditPacket*)pkt); }
+static void encode_zone_summary(void *pkt) { edtsp_encode_zone_summary((EDTSPZoneSummaryPacket*)pkt); }
+static void decode_zone_summary(void *pkt) { edtsp_decode_zone_summary((EDTSPZoneSummaryPacket*)pkt); }
+
+const EDTSPCodec edtsp_codecs[EDTSP_TYPE_MAX + 1] = {
+    [EDTSP_TYPE_DISCOVERY]    = { "DISCOVERY", sizeof(EDTSPDiscoveryPacket), sizeof(EDTSPDiscoveryPacket), encode_discovery, decode_discovery },
+    [EDTSP_TYPE_HEARTBEAT]    = { "HEARTBEAT", sizeof(EDTSPHeartbeatPacket), sizeof(EDTSPHeartbeatPacket), encode_heartbeat, decode_heartbeat },
+    [EDTSP_TYPE_HANDSHAKE]    = { "HANDSHAKE", sizeof(EDTSPHandshakePacket), offsetof(EDTSPHandshakePacket, descriptors), encode_handshake, decode_handshake },
+    [EDTSP_TYPE_CONFIG]       = { "CONFIG", sizeof(EDTSPConfigPacket), sizeof(EDTSPConfigPacket), encode_config, decode_config },
+    [EDTSP_TYPE_DATA]         = { "DATA", sizeof(EDTSPDataPacket), offsetof(EDTSPDataPacket, data), encode_data, decode_data },
+    [EDTSP_TYPE_PROBE]        = { "PROBE", sizeof(EDTSPProbePacket), sizeof(EDTSPProbePacket), encode_probe, decode_probe },
+    [EDTSP_TYPE_SYNC]         = { "SYNC", sizeof(EDTSPSyncPacket), sizeof(EDTSPSyncPacket), encode_sync, decode_sync },
+    [EDTSP_TYPE_ACTUATE]      = { "ACTUATE", sizeof(EDTSPActuatePacket), sizeof(EDTSPActuatePacket), encode_actuate, decode_actuate },
+    [EDTSP_TYPE_GROUP_CONFIG] = { "GROUP_CONFIG", sizeof(EDTSPGroupConfigPacket), offsetof(EDTSPGroupConfigPacket, body), encode_group_config, decode_group_config },
+    [EDTSP_TYPE_CREDIT]       = { "CREDIT", sizeof(EDTSPCreditPacket), sizeof(EDTSPCreditPacket), encode_credit, decode_credit },
+    [EDTSP_TYPE_ZONE_SUMMARY] = { "ZONE_SUMMARY", sizeof(EDTSPZoneSummaryPacket), offsetof(EDTSPZoneSummaryPacket, body), encode_zone_summary, decode_zone_summary },
+};
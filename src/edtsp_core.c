@@ -6,6 +6,8 @@
  */
 
 #include "../include/protocol.h"
+#include "../include/edtsp_shard.h"
+#include <stddef.h>
 #include <string.h>
 #include <arpa/inet.h> // For htons/htonl (use platform-specific on embedded)
 
@@ -67,7 +69,8 @@ void edtsp_build_discovery(EDTSPDiscoveryPacket *pkt, uint32_t source_id,
 }
 
 void edtsp_build_heartbeat(EDTSPHeartbeatPacket *pkt, uint32_t source_id,
-                          uint8_t role, uint32_t uptime_ms, uint8_t active_devices) {
+                          uint8_t role, uint32_t uptime_ms, uint16_t active_devices,
+                          uint32_t ingest_addr, uint16_t ingest_port) {
     if (!pkt) return;
     
     memset(pkt, 0, sizeof(EDTSPHeartbeatPacket));
@@ -75,8 +78,11 @@ void edtsp_build_heartbeat(EDTSPHeartbeatPacket *pkt, uint32_t source_id,
                       sizeof(EDTSPHeartbeatPacket) - sizeof(EDTSPHeader));
     
     pkt->role = role;
-    pkt->uptime_ms = EDTSP_HTONL(uptime_ms);
-    pkt->active_devices = active_devices;
+    pkt->uptime_ms = uptime_ms;
+    pkt->active_devices = active_devices > UINT8_MAX ? UINT8_MAX : (uint8_t)active_devices;  // 8-bit on the wire
+    pkt->ingest_addr = ingest_addr;
+    pkt->ingest_port = ingest_port;
+    edtsp_encode_heartbeat(pkt);
 }
 
 void edtsp_build_handshake(EDTSPHandshakePacket *pkt, uint32_t source_id,
@@ -84,29 +90,55 @@ void edtsp_build_handshake(EDTSPHandshakePacket *pkt, uint32_t source_id,
                           EDTSPCapabilityMask caps, uint8_t iface_type) {
     if (!pkt) return;
     
+    // No descriptors: edtsp_capdesc_attach() appends them to a SYN
     memset(pkt, 0, sizeof(EDTSPHandshakePacket));
     edtsp_init_header(&pkt->header, EDTSP_TYPE_HANDSHAKE, source_id,
-                      sizeof(EDTSPHandshakePacket) - sizeof(EDTSPHeader));
+                      offsetof(EDTSPHandshakePacket, descriptors) - sizeof(EDTSPHeader));
     
     pkt->handshake_step = step;
-    pkt->target_id = EDTSP_HTONL(target_id);
-    pkt->capabilities = EDTSP_HTONS(caps);
+    pkt->target_id = target_id;
+    pkt->capabilities = caps;
     pkt->interface_type = iface_type;
+    edtsp_encode_handshake(pkt);
 }
 
 void edtsp_build_config(EDTSPConfigPacket *pkt, uint32_t source_id,
                        uint32_t target_id, uint8_t sensor_id,
-                       uint16_t sampling_rate_ms, uint8_t enable) {
+                       uint16_t sampling_rate_ms, uint8_t enable,
+                       uint16_t deadband, uint32_t max_silence_ms,
+                       uint32_t window_ms, uint8_t pack_samples) {
     if (!pkt) return;
     
     memset(pkt, 0, sizeof(EDTSPConfigPacket));
     edtsp_init_header(&pkt->header, EDTSP_TYPE_CONFIG, source_id,
                       sizeof(EDTSPConfigPacket) - sizeof(EDTSPHeader));
     
-    pkt->target_id = EDTSP_HTONL(target_id);
+    pkt->target_id = target_id;
     pkt->sensor_id = sensor_id;
-    pkt->sampling_rate_ms = EDTSP_HTONS(sampling_rate_ms);
+    pkt->sampling_rate_ms = sampling_rate_ms;
     pkt->enable = enable;
+    pkt->deadband = deadband;
+    pkt->max_silence_ms = max_silence_ms;
+    pkt->window_ms = window_ms;
+    pkt->pack_samples = pack_samples;
+    edtsp_encode_config(pkt);
+}
+
+void edtsp_build_assign(EDTSPConfigPacket *pkt, uint32_t source_id, uint32_t target_id,
+                        uint32_t ingest_id, uint32_t ingest_addr, uint16_t ingest_port) {
+    if (!pkt) return;
+    
+    // A CONFIG that sets no sensor, only where the slave's DATA goes
+    memset(pkt, 0, sizeof(EDTSPConfigPacket));
+    edtsp_init_header(&pkt->header, EDTSP_TYPE_CONFIG, source_id,
+                      sizeof(EDTSPConfigPacket) - sizeof(EDTSPHeader));
+    
+    pkt->target_id = target_id;
+    pkt->sensor_id = EDTSP_CONFIG_NO_SENSOR;
+    pkt->ingest_id = ingest_id;
+    pkt->ingest_addr = ingest_addr;
+    pkt->ingest_port = ingest_port;
+    edtsp_encode_config(pkt);
 }
 
 void edtsp_build_data(EDTSPDataPacket *pkt, uint32_t source_id,
@@ -114,20 +146,119 @@ void edtsp_build_data(EDTSPDataPacket *pkt, uint32_t source_id,
                      const uint8_t *data, uint8_t data_len) {
     if (!pkt || !data || data_len > 64) return;
     
+    // Send offsetof(EDTSPDataPacket, data) + data_len bytes
     memset(pkt, 0, sizeof(EDTSPDataPacket));
     edtsp_init_header(&pkt->header, EDTSP_TYPE_DATA, source_id,
-                      sizeof(EDTSPDataPacket) - sizeof(EDTSPHeader));
+                      offsetof(EDTSPDataPacket, data) + data_len - sizeof(EDTSPHeader));
     
     pkt->sensor_id = sensor_id;
-    pkt->timestamp_ms = EDTSP_HTONL(timestamp_ms);
+    pkt->timestamp_ms = timestamp_ms;
     pkt->data_len = data_len;
     memcpy(pkt->data, data, data_len);
+    edtsp_encode_data(pkt);
+}
+
+void edtsp_build_packed_data(EDTSPDataPacket *pkt, uint32_t source_id, uint8_t sensor_id,
+                             uint32_t timestamp_ms, uint16_t block_len) {
+    if (!pkt) return;
+    
+    // The block is already in place at data and may run past it: only the
+    // fields before it are written. Sent as v2 only, so the v1 length just
+    // saturates; data_len 0 means "to the end of the payload".
+    size_t payload_len = offsetof(EDTSPDataPacket, data) - sizeof(EDTSPHeader) + block_len;
+    edtsp_init_header(&pkt->header, EDTSP_TYPE_DATA, source_id,
+                      payload_len > EDTSP_MAX_PAYLOAD ? EDTSP_MAX_PAYLOAD : (uint8_t)payload_len);
+    
+    pkt->sensor_id = sensor_id;
+    pkt->timestamp_ms = timestamp_ms;
+    pkt->data_len = 0;
+    edtsp_encode_data(pkt);
+}
+
+void edtsp_build_probe(EDTSPProbePacket *pkt, uint32_t source_id,
+                      uint8_t kind, uint8_t iface_type, uint16_t probe_seq,
+                      uint32_t target_id, uint64_t t1_us, uint64_t t2_us, uint64_t t3_us) {
+    if (!pkt) return;
+    
+    memset(pkt, 0, sizeof(EDTSPProbePacket));
+    edtsp_init_header(&pkt->header, EDTSP_TYPE_PROBE, source_id,
+                      sizeof(EDTSPProbePacket) - sizeof(EDTSPHeader));
+    
+    pkt->kind = kind;
+    pkt->interface_type = iface_type;
+    pkt->probe_seq = probe_seq;
+    pkt->target_id = target_id;
+    pkt->t1_us = t1_us;
+    pkt->t2_us = t2_us;
+    pkt->t3_us = t3_us;
+    edtsp_encode_probe(pkt);
+}
+
+void edtsp_build_sync(EDTSPSyncPacket *pkt, uint32_t source_id,
+                     uint8_t kind, uint16_t sync_seq, uint32_t target_id,
+                     uint64_t t1_us, uint64_t t2_us, uint64_t t3_us) {
+    if (!pkt) return;
+    
+    memset(pkt, 0, sizeof(EDTSPSyncPacket));
+    edtsp_init_header(&pkt->header, EDTSP_TYPE_SYNC, source_id,
+                      sizeof(EDTSPSyncPacket) - sizeof(EDTSPHeader));
+    
+    pkt->kind = kind;
+    pkt->sync_seq = sync_seq;
+    pkt->target_id = target_id;
+    pkt->t1_us = t1_us;
+    pkt->t2_us = t2_us;
+    pkt->t3_us = t3_us;
+    edtsp_encode_sync(pkt);
+}
+
+void edtsp_build_actuate(EDTSPActuatePacket *pkt, uint32_t source_id,
+                        uint8_t kind, uint8_t priority, uint16_t act_seq, uint32_t target_id,
+                        uint8_t output_id, uint8_t channel, uint8_t status, uint32_t value,
+                        uint64_t t1_us, uint64_t t2_us, uint64_t t3_us) {
+    if (!pkt) return;
+    
+    memset(pkt, 0, sizeof(EDTSPActuatePacket));
+    edtsp_init_header(&pkt->header, EDTSP_TYPE_ACTUATE, source_id,
+                      sizeof(EDTSPActuatePacket) - sizeof(EDTSPHeader));
+    
+    pkt->kind = kind;
+    pkt->priority = priority;
+    pkt->act_seq = act_seq;
+    pkt->target_id = target_id;
+    pkt->output_id = output_id;
+    pkt->channel = channel;
+    pkt->status = status;
+    pkt->value = value;
+    pkt->t1_us = t1_us;
+    pkt->t2_us = t2_us;
+    pkt->t3_us = t3_us;
+    edtsp_encode_actuate(pkt);
+}
+
+void edtsp_build_credit(EDTSPCreditPacket *pkt, uint32_t source_id, uint32_t target_id,
+                        uint16_t credit_seq, uint16_t max_fps, uint16_t lifetime_ms,
+                        uint8_t queue_pct) {
+    if (!pkt) return;
+    
+    memset(pkt, 0, sizeof(EDTSPCreditPacket));
+    edtsp_init_header(&pkt->header, EDTSP_TYPE_CREDIT, source_id,
+                      sizeof(EDTSPCreditPacket) - sizeof(EDTSPHeader));
+    
+    pkt->target_id = target_id;
+    pkt->credit_seq = credit_seq;
+    pkt->max_fps = max_fps;
+    pkt->lifetime_ms = lifetime_ms;
+    pkt->queue_pct = queue_pct;
+    edtsp_encode_credit(pkt);
 }
 
 // ============================================================================
 // PACKET PARSERS (convert from network byte order)
 // ============================================================================
 
+// Payload decoders are generated per type: edtsp_decode_*() in edtsp_packets.h
+
 bool edtsp_parse_header(EDTSPHeader *header) {
     if (!header) return false;
     
@@ -139,24 +270,119 @@ bool edtsp_parse_header(EDTSPHeader *header) {
     return edtsp_header_valid(header);
 }
 
-void edtsp_parse_heartbeat(EDTSPHeartbeatPacket *pkt) {
-    if (!pkt) return;
-    pkt->uptime_ms = EDTSP_NTOHL(pkt->uptime_ms);
+// ============================================================================
+// PROTOCOL v2 FRAMING
+// ============================================================================
+
+void edtsp_init_header_v2(EDTSPHeaderV2 *header, uint8_t type, uint32_t source_id,
+                          uint8_t flags, uint16_t payload_len, uint32_t seq) {
+    if (!header) return;
+    
+    header->magic = EDTSP_HTONS(EDTSP_MAGIC_V2);
+    header->type = type;
+    header->flags = flags;
+    header->source_id = EDTSP_HTONL(source_id);
+    header->payload_len = EDTSP_HTONS(payload_len);
+    header->version = 2;
+    header->header_len = sizeof(EDTSPHeaderV2);
+    header->seq = EDTSP_HTONL(seq);
 }
 
-void edtsp_parse_handshake(EDTSPHandshakePacket *pkt) {
-    if (!pkt) return;
-    pkt->target_id = EDTSP_NTOHL(pkt->target_id);
-    pkt->capabilities = EDTSP_NTOHS(pkt->capabilities);
+size_t edtsp_reframe_v2(uint8_t *out, size_t out_size, const void *v1_pkt, size_t v1_len,
+                        uint8_t flags, uint32_t seq) {
+    const EDTSPHeader *v1 = (const EDTSPHeader*)v1_pkt;
+    
+    if (!out || !v1_pkt || v1_len < sizeof(EDTSPHeader)) return 0;
+    
+    size_t payload_len = v1_len - sizeof(EDTSPHeader);
+    if (sizeof(EDTSPHeaderV2) + payload_len > out_size) return 0;
+    
+    // v1 builders already wrote source_id in network order
+    EDTSPHeaderV2 header;
+    edtsp_init_header_v2(&header, v1->type, EDTSP_NTOHL(v1->source_id), flags,
+                         (uint16_t)payload_len, seq);
+    
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), (const uint8_t*)v1_pkt + sizeof(EDTSPHeader), payload_len);
+    return sizeof(header) + payload_len;
 }
 
-void edtsp_parse_config(EDTSPConfigPacket *pkt) {
-    if (!pkt) return;
-    pkt->target_id = EDTSP_NTOHL(pkt->target_id);
-    pkt->sampling_rate_ms = EDTSP_NTOHS(pkt->sampling_rate_ms);
+bool edtsp_decode_frame(uint8_t *buf, size_t len, EDTSPFrameInfo *info) {
+    if (!buf || !info || len < sizeof(EDTSPHeader)) return false;
+    
+    uint16_t magic = (uint16_t)((buf[0] << 8) | buf[1]);
+    
+    if (magic == EDTSP_MAGIC) {
+        EDTSPHeader *header = (EDTSPHeader*)buf;
+        if (!edtsp_parse_header(header)) return false;
+        
+        info->version = 1;
+        info->type = header->type;
+        info->flags = 0;
+        info->header_len = sizeof(EDTSPHeader);
+        info->source_id = header->source_id;
+        info->seq = 0;
+        info->payload_len = header->payload_len;
+        info->offset = 0;
+        return true;
+    }
+    
+    if (magic != EDTSP_MAGIC_V2 || len < sizeof(EDTSPHeaderV2)) return false;
+    
+    EDTSPHeaderV2 v2;
+    memcpy(&v2, buf, sizeof(v2));
+    
+    uint16_t payload_len = EDTSP_NTOHS(v2.payload_len);
+    if (v2.header_len < sizeof(EDTSPHeaderV2)) return false;
+    if ((size_t)v2.header_len + payload_len > len) return false;
+    if (v2.type < EDTSP_TYPE_DISCOVERY) return false;
+    
+    info->version = v2.version;
+    info->type = v2.type;
+    info->flags = v2.flags;
+    info->header_len = v2.header_len;
+    info->source_id = EDTSP_NTOHL(v2.source_id);
+    info->seq = EDTSP_NTOHL(v2.seq);
+    info->payload_len = payload_len;
+    info->offset = (uint16_t)(v2.header_len - sizeof(EDTSPHeader));
+    
+    // Rebase: host-order v1 header directly before the payload, so the
+    // packed v1 packet structs can be used on v2 frames without copying.
+    // Its 8-bit length saturates; longer payloads go by info->payload_len.
+    EDTSPHeader *view = (EDTSPHeader*)(buf + info->offset);
+    view->magic = EDTSP_MAGIC;
+    view->type = info->type;
+    view->source_id = info->source_id;
+    view->payload_len = payload_len > EDTSP_MAX_PAYLOAD ? EDTSP_MAX_PAYLOAD : (uint8_t)payload_len;
+    return true;
 }
 
-void edtsp_parse_data(EDTSPDataPacket *pkt) {
-    if (!pkt) return;
-    pkt->timestamp_ms = EDTSP_NTOHL(pkt->timestamp_ms);
+// ============================================================================
+// REDUNDANCY TRAILER (dual-path transmission)
+// ============================================================================
+
+size_t edtsp_append_trailer(uint8_t *buf, size_t frame_len, uint16_t seq, uint8_t path) {
+    if (!buf) return frame_len;
+    
+    EDTSPRedundancyTrailer rct;
+    rct.seq = EDTSP_HTONS(seq);
+    rct.path_size = EDTSP_HTONS((uint16_t)(((path & 0x0F) << 12) | (frame_len & 0x0FFF)));
+    rct.suffix = EDTSP_HTONS(EDTSP_RCT_SUFFIX);
+    
+    memcpy(buf + frame_len, &rct, sizeof(rct));
+    return frame_len + sizeof(rct);
+}
+
+bool edtsp_parse_trailer(const uint8_t *buf, size_t len, size_t frame_len, uint16_t *seq) {
+    EDTSPRedundancyTrailer rct;
+    
+    // Trailer sits directly behind header + payload
+    if (!buf || len != frame_len + sizeof(rct)) return false;
+    
+    memcpy(&rct, buf + frame_len, sizeof(rct));
+    if (EDTSP_NTOHS(rct.suffix) != EDTSP_RCT_SUFFIX) return false;
+    if ((EDTSP_NTOHS(rct.path_size) & 0x0FFF) != (frame_len & 0x0FFF)) return false;
+    
+    if (seq) *seq = EDTSP_NTOHS(rct.seq);
+    return true;
 }
@@ -0,0 +1,177 @@
+/**
+ * @file edtsp_deadband.c
+ * @brief EDTSP Report-by-Exception (deadband / deadline filtering)
+ *
+ * Master streams: open addressing on (device ID, sensor) with linear
+ * probing. Streams are never removed; a restarted slave is detected by
+ * its sequence or clock going backwards and resynchronized in place.
+ */
+
+#include "../include/edtsp_deadband.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Bytes of one report on the wire */
+#define RECORD_FRAME_LEN (offsetof(EDTSPDataPacket, data) + EDTSP_DEADBAND_RECORD_LEN)
+
+typedef struct {
+    uint32_t device_id;
+    uint8_t  sensor_id;
+    bool     used;
+    bool     primed;        // A report was received
+    uint16_t seq;           // Last report
+    uint32_t timestamp_ms;
+    int32_t  value;
+} ReconStream;
+
+static ReconStream streams[EDTSP_RECON_STREAMS];
+static EDTSPReconSensorStats sensor_stats[16];
+static EDTSPSampleFn sample_fn;
+static void *sample_ctx;
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+void edtsp_deadband_configure(EDTSPDeadband *db, uint16_t deadband, uint32_t max_silence_ms) {
+    db->deadband = deadband;
+    db->max_silence_ms = max_silence_ms;
+    db->reported = false;
+}
+
+bool edtsp_deadband_sample(EDTSPDeadband *db, int32_t value, uint32_t now_ms) {
+    db->seq++;
+    db->samples++;
+    
+    if (db->reported) {
+        int64_t delta = (int64_t)value - db->last_value;
+        if (delta < 0) delta = -delta;
+        
+        bool moved = delta > db->deadband || db->deadband == 0;
+        bool overdue = db->max_silence_ms && now_ms - db->last_ms >= db->max_silence_ms;
+        if (!moved && !overdue) return false;
+        if (!moved) db->deadline_sent++;
+    }
+    
+    db->reported = true;
+    db->last_value = value;
+    db->last_ms = now_ms;
+    db->sent++;
+    return true;
+}
+
+uint8_t edtsp_deadband_record(const EDTSPDeadband *db, int32_t value, uint8_t *out) {
+    uint32_t v = (uint32_t)value;
+    
+    out[0] = (uint8_t)(v >> 24);
+    out[1] = (uint8_t)(v >> 16);
+    out[2] = (uint8_t)(v >> 8);
+    out[3] = (uint8_t)v;
+    out[4] = (uint8_t)(db->seq >> 8);
+    out[5] = (uint8_t)db->seq;
+    return EDTSP_DEADBAND_RECORD_LEN;
+}
+
+void edtsp_deadband_print(const EDTSPDeadband *filters, int count) {
+    bool header = false;
+    
+    for (int i = 0; i < count; i++) {
+        const EDTSPDeadband *db = &filters[i];
+        if (!db->samples) continue;
+        
+        if (!header) printf("[STATS] === Report by Exception (slave) ===\n");
+        header = true;
+        uint32_t saved = db->samples - db->sent;
+        printf("  Sensor %d: deadband=%u silence=%u ms, %u samples, %u sent (%u deadline), "
+               "%.1f%% suppressed, %lu bytes saved\n", i, db->deadband, db->max_silence_ms,
+               db->samples, db->sent, db->deadline_sent, 100.0 * saved / db->samples,
+               (unsigned long)saved * RECORD_FRAME_LEN);
+    }
+}
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+void edtsp_recon_init(EDTSPSampleFn fn, void *ctx) {
+    memset(streams, 0, sizeof(streams));
+    memset(sensor_stats, 0, sizeof(sensor_stats));
+    sample_fn = fn;
+    sample_ctx = ctx;
+}
+
+static ReconStream *find_stream(uint32_t device_id, uint8_t sensor_id) {
+    uint32_t i = ((device_id ^ (uint32_t)sensor_id << 28) * 2654435761u) & (EDTSP_RECON_STREAMS - 1);
+    
+    for (int n = 0; n < EDTSP_RECON_STREAMS; n++, i = (i + 1) & (EDTSP_RECON_STREAMS - 1)) {
+        ReconStream *s = &streams[i];
+        if (!s->used) {
+            s->used = true;
+            s->device_id = device_id;
+            s->sensor_id = sensor_id;
+            return s;
+        }
+        if (s->device_id == device_id && s->sensor_id == sensor_id) return s;
+    }
+    return NULL;
+}
+
+int edtsp_recon_on_data(const EDTSPDataPacket *pkt) {
+    if (pkt->data_len != EDTSP_DEADBAND_RECORD_LEN || pkt->sensor_id >= 16) return -1;
+    
+    const uint8_t *d = pkt->data;
+    int32_t value = (int32_t)((uint32_t)d[0] << 24 | (uint32_t)d[1] << 16 | (uint32_t)d[2] << 8 | d[3]);
+    uint16_t seq = (uint16_t)(d[4] << 8 | d[5]);
+    uint32_t device = pkt->header.source_id;
+    EDTSPReconSensorStats *st = &sensor_stats[pkt->sensor_id];
+    int emitted = 0;
+    
+    ReconStream *s = find_stream(device, pkt->sensor_id);
+    if (!s) return -1;
+    
+    uint16_t gap = (uint16_t)(seq - s->seq);
+    if (s->primed && gap == 0) return 0; // Duplicate
+    
+    st->reports++;
+    if (s->primed && (gap >= 0x8000 || pkt->timestamp_ms < s->timestamp_ms)) {
+        st->resyncs++;
+    } else if (s->primed) {
+        // Suppressed samples held at the last reported value
+        uint32_t span = pkt->timestamp_ms - s->timestamp_ms;
+        for (uint16_t k = 1; k < gap; k++) {
+            uint32_t t = s->timestamp_ms + (uint32_t)((uint64_t)span * k / gap);
+            if (sample_fn) sample_fn(device, pkt->sensor_id, t, s->value, false, sample_ctx);
+            emitted++;
+        }
+    }
+    
+    if (sample_fn) sample_fn(device, pkt->sensor_id, pkt->timestamp_ms, value, true, sample_ctx);
+    emitted++;
+    st->samples += (uint32_t)emitted;
+    
+    s->primed = true;
+    s->seq = seq;
+    s->timestamp_ms = pkt->timestamp_ms;
+    s->value = value;
+    return emitted;
+}
+
+const EDTSPReconSensorStats *edtsp_recon_stats(uint8_t sensor_id) {
+    return &sensor_stats[sensor_id & 15];
+}
+
+void edtsp_recon_print(void) {
+    bool header = false;
+    
+    for (int i = 0; i < 16; i++) {
+        const EDTSPReconSensorStats *st = &sensor_stats[i];
+        if (!st->reports) continue;
+        
+        if (!header) printf("[STATS] === Report by Exception (master) ===\n");
+        header = true;
+        printf("  Sensor %d: %u reports -> %u samples rebuilt (%u resyncs), "
+               "%lu of %lu bytes (%.1f%% saved)\n", i, st->reports, st->samples, st->resyncs,
+               (unsigned long)st->reports * RECORD_FRAME_LEN, (unsigned long)st->samples * RECORD_FRAME_LEN,
+               st->samples ? 100.0 * (st->samples - st->reports) / st->samples : 0.0);
+    }
+}
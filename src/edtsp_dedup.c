@@ -0,0 +1,156 @@
+/**
+ * @file edtsp_dedup.c
+ * @brief EDTSP Duplicate Elimination for Dual-Path Transmission
+ * 
+ * Each source owns a 64-bit bitmap anchored at the highest sequence seen:
+ * bit i set means (highest - i) was already delivered. Newer sequences
+ * shift the window, older ones test a single bit. Sources are located
+ * through an open-addressing hash table, so the whole check is O(1).
+ * Entries are freed with backward-shift deletion when the device times
+ * out, and windows idle for EDTSP_DEDUP_IDLE_MS are reused for new
+ * sources. With the table full of live sources, frames pass unchecked.
+ */
+
+#include "../include/edtsp_dedup.h"
+#include <string.h>
+
+typedef struct {
+    uint32_t source_id;    /**< Owning source */
+    bool     used;
+    uint16_t highest_seq;  /**< Highest sequence number delivered */
+    uint64_t window;       /**< Bit i: (highest_seq - i) delivered */
+    uint64_t advanced_ms;  /**< Last time highest_seq moved forward */
+} EDTSPDedupEntry;
+
+_Static_assert(EDTSP_DEDUP_TABLE_SIZE == (1 << 9), "hash shift assumes 512 slots");
+
+static EDTSPDedupEntry table[EDTSP_DEDUP_TABLE_SIZE];
+static EDTSPDedupStats stats;
+
+void edtsp_dedup_init(void) {
+    memset(table, 0, sizeof(table));
+    memset(&stats, 0, sizeof(stats));
+}
+
+static inline uint32_t home_slot(uint32_t source_id) {
+    // Fibonacci hashing spreads random IDs well
+    return (source_id * 2654435769u) >> (32 - 9);
+}
+
+/**
+ * Entry of a source; with create, a new one or an idle one reclaimed
+ * (*fresh set)
+ */
+static EDTSPDedupEntry *lookup(uint32_t source_id, bool create, uint64_t now_ms, bool *fresh) {
+    uint32_t i = home_slot(source_id);
+    EDTSPDedupEntry *idle = NULL;
+    
+    for (uint32_t probe = 0; probe < EDTSP_DEDUP_TABLE_SIZE; probe++, i = (i + 1) & (EDTSP_DEDUP_TABLE_SIZE - 1)) {
+        EDTSPDedupEntry *e = &table[i];
+        if (!e->used) {
+            if (!create) return NULL;
+            if (idle) break;
+            e->used = true;
+            e->source_id = source_id;
+            stats.sources++;
+            *fresh = true;
+            return e;
+        }
+        if (e->source_id == source_id) return e;
+        if (!idle && now_ms - e->advanced_ms >= EDTSP_DEDUP_IDLE_MS) idle = e;
+    }
+    
+    // Still on the probe run of its old source, so lookups of others stay valid
+    if (!create || !idle) return NULL;
+    idle->source_id = source_id;
+    *fresh = true;
+    return idle;
+}
+
+static void remove_entry(EDTSPDedupEntry *e) {
+    uint32_t hole = (uint32_t)(e - table);
+    
+    // Backward shift: pull later entries of the probe run into the hole.
+    // Vacated slots are freed as it goes, so a full table ends the run.
+    uint32_t i = (hole + 1) & (EDTSP_DEDUP_TABLE_SIZE - 1);
+    table[hole].used = false;
+    while (table[i].used) {
+        uint32_t home = home_slot(table[i].source_id);
+        if (((i - home) & (EDTSP_DEDUP_TABLE_SIZE - 1)) >= ((i - hole) & (EDTSP_DEDUP_TABLE_SIZE - 1))) {
+            table[hole] = table[i];
+            hole = i;
+            table[hole].used = false;
+        }
+        i = (i + 1) & (EDTSP_DEDUP_TABLE_SIZE - 1);
+    }
+    memset(&table[hole], 0, sizeof(table[hole]));
+    stats.sources--;
+}
+
+bool edtsp_dedup_accept(uint32_t source_id, uint16_t seq, uint64_t now_ms) {
+    bool fresh = false;
+    EDTSPDedupEntry *e = lookup(source_id, true, now_ms, &fresh);
+    
+    if (!e) {
+        // Table full of live sources: fail open rather than drop traffic
+        stats.accepted++;
+        return true;
+    }
+    
+    if (fresh) {
+        e->highest_seq = seq;
+        e->window = 1;
+        e->advanced_ms = now_ms;
+        stats.accepted++;
+        return true;
+    }
+    
+    // Signed distance handles 16-bit wraparound
+    int16_t delta = (int16_t)(uint16_t)(seq - e->highest_seq);
+    
+    if (delta > 0) {
+        e->window = (delta >= EDTSP_DEDUP_WINDOW) ? 1 : (e->window << delta) | 1;
+        e->highest_seq = seq;
+        e->advanced_ms = now_ms;
+        stats.accepted++;
+        return true;
+    }
+    
+    uint16_t age = (uint16_t)(-delta);
+    if (age >= EDTSP_DEDUP_WINDOW) {
+        // Far behind the window. While the source keeps sending new
+        // sequences this is a lagging path: rewinding would deliver the
+        // copies after it a second time. A source quiet for a while has
+        // restarted and begun again from 0.
+        if (now_ms - e->advanced_ms < EDTSP_DEDUP_RESTART_MS) {
+            stats.stale++;
+            return false;
+        }
+        e->highest_seq = seq;
+        e->window = 1;
+        e->advanced_ms = now_ms;
+        stats.window_resets++;
+        stats.accepted++;
+        return true;
+    }
+    
+    uint64_t bit = (uint64_t)1 << age;
+    if (e->window & bit) {
+        stats.duplicates++;
+        return false;
+    }
+    
+    e->window |= bit;
+    stats.accepted++;
+    return true;
+}
+
+void edtsp_dedup_forget(uint32_t source_id) {
+    bool fresh;
+    EDTSPDedupEntry *e = lookup(source_id, false, 0, &fresh);
+    if (e) remove_entry(e);
+}
+
+const EDTSPDedupStats *edtsp_dedup_stats(void) {
+    return &stats;
+}
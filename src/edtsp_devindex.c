@@ -0,0 +1,143 @@
+/**
+ * @file edtsp_devindex.c
+ * @brief EDTSP Capability / Interface Device Index (master)
+ *
+ * Plain bitsets rather than roaring bitmaps: the device table has
+ * EDTSP_INDEX_SLOTS dense slots (256 = one 32-byte vector per set), so
+ * there is nothing for run/array containers to compress.
+ */
+
+#include "../include/edtsp_devindex.h"
+#include <stdio.h>
+#include <string.h>
+
+static EDTSPBitset active_set;
+static EDTSPBitset cap_sets[EDTSP_INDEX_CAPS];
+static EDTSPBitset iface_sets[EDTSP_INDEX_IFACES];
+
+static uint32_t slot_id[EDTSP_INDEX_SLOTS];
+static EDTSPCapabilityMask slot_caps[EDTSP_INDEX_SLOTS];
+static uint8_t slot_iface[EDTSP_INDEX_SLOTS];
+
+static const char *const cap_names[EDTSP_INDEX_CAPS] = {
+    "temperature", "humidity", "pressure", "distance", "light", "motion", "gps", "accel",
+    "gyro", "magnet", "current", "voltage", "gas", "smoke", "relay", "pwm"
+};
+
+static inline void bit_set(EDTSPBitset *set, int slot, bool on) {
+    uint64_t bit = 1ull << (slot & 63);
+    if (on) set->w[slot >> 6] |= bit;
+    else set->w[slot >> 6] &= ~bit;
+}
+
+#if defined(__GNUC__)
+typedef uint64_t EDTSPWordVec __attribute__((vector_size(32)));
+
+/** out = a AND every set in sets (one 256-bit vector per step) */
+static void intersect(EDTSPBitset *out, const EDTSPBitset *a, const EDTSPBitset **sets, int nsets) {
+    for (int i = 0; i < EDTSP_INDEX_WORDS; i += 4) {
+        EDTSPWordVec acc = *(const EDTSPWordVec*)&a->w[i];
+        for (int s = 0; s < nsets; s++) acc &= *(const EDTSPWordVec*)&sets[s]->w[i];
+        *(EDTSPWordVec*)&out->w[i] = acc;
+    }
+}
+#else
+static void intersect(EDTSPBitset *out, const EDTSPBitset *a, const EDTSPBitset **sets, int nsets) {
+    for (int i = 0; i < EDTSP_INDEX_WORDS; i++) {
+        uint64_t acc = a->w[i];
+        for (int s = 0; s < nsets; s++) acc &= sets[s]->w[i];
+        out->w[i] = acc;
+    }
+}
+#endif
+
+void edtsp_index_init(void) {
+    memset(&active_set, 0, sizeof(active_set));
+    memset(cap_sets, 0, sizeof(cap_sets));
+    memset(iface_sets, 0, sizeof(iface_sets));
+    memset(slot_id, 0, sizeof(slot_id));
+    memset(slot_caps, 0, sizeof(slot_caps));
+    memset(slot_iface, 0, sizeof(slot_iface));
+}
+
+void edtsp_index_set_active(int slot, uint32_t device_id, bool active) {
+    if (slot < 0 || slot >= EDTSP_INDEX_SLOTS) return;
+    
+    slot_id[slot] = device_id;
+    bit_set(&active_set, slot, active);
+}
+
+void edtsp_index_set_capabilities(int slot, EDTSPCapabilityMask caps) {
+    if (slot < 0 || slot >= EDTSP_INDEX_SLOTS) return;
+    
+    // Only bits that changed touch their sets
+    EDTSPCapabilityMask changed = slot_caps[slot] ^ caps;
+    for (int b = 0; changed; b++, changed >>= 1) {
+        if (changed & 1) bit_set(&cap_sets[b], slot, (caps >> b) & 1);
+    }
+    slot_caps[slot] = caps;
+}
+
+void edtsp_index_set_interface(int slot, uint8_t iface_type) {
+    if (slot < 0 || slot >= EDTSP_INDEX_SLOTS || iface_type >= EDTSP_INDEX_IFACES) return;
+    
+    bit_set(&iface_sets[slot_iface[slot]], slot, false);
+    bit_set(&iface_sets[iface_type], slot, true);
+    slot_iface[slot] = iface_type;
+}
+
+int edtsp_index_select(EDTSPCapabilityMask caps, uint8_t iface_type, EDTSPBitset *out) {
+    const EDTSPBitset *sets[EDTSP_INDEX_CAPS + 1];
+    int nsets = 0;
+    
+    for (int b = 0; b < EDTSP_INDEX_CAPS; b++) {
+        if (caps & (1u << b)) sets[nsets++] = &cap_sets[b];
+    }
+    if (iface_type < EDTSP_INDEX_IFACES) sets[nsets++] = &iface_sets[iface_type];
+    
+    intersect(out, &active_set, sets, nsets);
+    return edtsp_index_count(out);
+}
+
+int edtsp_index_ids(const EDTSPBitset *set, uint32_t *ids, int max) {
+    int n = 0;
+    
+    for (int i = 0; i < EDTSP_INDEX_WORDS && n < max; i++) {
+        uint64_t word = set->w[i];
+        while (word && n < max) {
+            int slot = i * 64 + __builtin_ctzll(word);
+            ids[n++] = slot_id[slot];
+            word &= word - 1;
+        }
+    }
+    return n;
+}
+
+int edtsp_index_count(const EDTSPBitset *set) {
+    int n = 0;
+    
+    for (int i = 0; i < EDTSP_INDEX_WORDS; i++) n += __builtin_popcountll(set->w[i]);
+    return n;
+}
+
+void edtsp_index_print(void) {
+    EDTSPBitset set;
+    int active = edtsp_index_count(&active_set);
+    
+    printf("[STATS] === Device Index ===\n");
+    printf("  Active: %d", active);
+    for (uint8_t t = 0; t < EDTSP_INDEX_IFACES; t++) {
+        int n = edtsp_index_select(0, t, &set);
+        if (n) printf(", %s=%d", edtsp_iface_name(t), n);
+    }
+    printf("\n");
+    
+    bool any = false;
+    for (int b = 0; b < EDTSP_INDEX_CAPS; b++) {
+        int n = edtsp_index_select((EDTSPCapabilityMask)(1u << b), EDTSP_INDEX_ANY_IFACE, &set);
+        if (!n) continue;
+        printf("%s%s=%d", any ? ", " : "  Capabilities: ", cap_names[b], n);
+        any = true;
+    }
+    if (any) printf("\n");
+}
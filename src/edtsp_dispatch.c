@@ -0,0 +1,164 @@
+/**
+ * @file edtsp_dispatch.c
+ * @brief EDTSP Table-Driven Packet Dispatch
+ *
+ * The registry has a slot for every type byte, so a lookup is a single
+ * indexed load. Unregistered slots point at a counting handler and a
+ * no-op decoder; the only branch on the hot path is the length check.
+ */
+
+#include "../include/edtsp_dispatch.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    uint16_t       min_len;   /**< Minimum frame length (header included) */
+    EDTSPDecodeFn  decode;    /**< Payload decoder (never NULL) */
+    EDTSPHandlerFn handler;   /**< Callback (never NULL) */
+    void          *ctx;       /**< Handler context */
+    bool           priority;  /**< Dispatched first in a batch */
+} EDTSPDispatchEntry;
+
+static EDTSPDispatchEntry registry[EDTSP_DISPATCH_TYPES];
+static EDTSPDispatchStats stats[EDTSP_DISPATCH_TYPES];
+static EDTSPHandlerFn unhandled_handler = NULL;
+static void *unhandled_ctx = NULL;
+
+static void decode_none(void *pkt) {
+    (void)pkt;
+}
+
+static void handle_unregistered(void *pkt, const EDTSPRxPacket *rx, void *ctx) {
+    (void)ctx;
+    stats[rx->frame.type].unhandled++;
+    if (unhandled_handler) unhandled_handler(pkt, rx, unhandled_ctx);
+}
+
+void edtsp_dispatch_init(void) {
+    for (int t = 0; t < EDTSP_DISPATCH_TYPES; t++) {
+        registry[t].min_len = sizeof(EDTSPHeader);
+        registry[t].decode = decode_none;
+        registry[t].handler = handle_unregistered;
+        registry[t].ctx = NULL;
+        registry[t].priority = false;
+    }
+    memset(stats, 0, sizeof(stats));
+    unhandled_handler = NULL;
+    unhandled_ctx = NULL;
+}
+
+bool edtsp_dispatch_register(uint8_t type, uint16_t min_len, EDTSPDecodeFn decode,
+                             EDTSPHandlerFn handler, void *ctx) {
+    if (type == 0 || !handler) return false;
+    
+    // Built-in types default to the generated codec
+    if (type <= EDTSP_TYPE_MAX) {
+        if (!min_len) min_len = edtsp_codecs[type].min_len;
+        if (!decode) decode = edtsp_codecs[type].decode;
+    }
+    
+    registry[type].min_len = min_len ? min_len : sizeof(EDTSPHeader);
+    registry[type].decode = decode ? decode : decode_none;
+    registry[type].handler = handler;
+    registry[type].ctx = ctx;
+    return true;
+}
+
+void edtsp_dispatch_set_priority(uint8_t type, bool priority) {
+    registry[type].priority = priority;
+}
+
+void edtsp_dispatch_set_unhandled(EDTSPHandlerFn handler, void *ctx) {
+    unhandled_handler = handler;
+    unhandled_ctx = ctx;
+}
+
+static inline void dispatch_one(EDTSPRxPacket *rx, const EDTSPDispatchEntry *e) {
+    if (rx->len < e->min_len) {
+        stats[rx->frame.type].too_short++;
+        return;
+    }
+    
+    e->decode(rx->pkt);
+    e->handler(rx->pkt, rx, e->ctx);
+    stats[rx->frame.type].dispatched++;
+}
+
+void edtsp_dispatch(EDTSPRxPacket *rx) {
+    dispatch_one(rx, &registry[rx->frame.type]);
+}
+
+void edtsp_dispatch_batch(EDTSPRxPacket *rx, int count) {
+    uint8_t run[EDTSP_DISPATCH_TYPES];
+    uint8_t types[EDTSP_DISPATCH_BATCH];
+    uint8_t urgent[EDTSP_DISPATCH_BATCH];
+    uint8_t start[EDTSP_DISPATCH_BATCH + 1];
+    EDTSPRxPacket *order[EDTSP_DISPATCH_BATCH];
+    int ntypes = 0;
+    int nurgent = 0;
+    
+    if (count > EDTSP_DISPATCH_BATCH) count = EDTSP_DISPATCH_BATCH;
+    if (count <= 0) return;
+    
+    // Stable counting sort over the types present in this batch only
+    memset(run, 0, sizeof(run));
+    for (int i = 0; i < count; i++) {
+        uint8_t t = rx[i].frame.type;
+        if (run[t]++ == 0) {
+            if (registry[t].priority) {
+                urgent[nurgent++] = t;
+            } else {
+                types[ntypes++] = t;
+            }
+        }
+    }
+    
+    // Priority types lead the run order
+    if (nurgent) {
+        memmove(types + nurgent, types, (size_t)ntypes);
+        memcpy(types, urgent, (size_t)nurgent);
+        ntypes += nurgent;
+    }
+    
+    uint8_t offset = 0;
+    for (int j = 0; j < ntypes; j++) {
+        start[j] = offset;
+        offset += run[types[j]];
+        run[types[j]] = start[j];
+    }
+    start[ntypes] = offset;
+    
+    for (int i = 0; i < count; i++) {
+        order[run[rx[i].frame.type]++] = &rx[i];
+    }
+    
+    // One contiguous run per handler: the entry is loaded once per run
+    for (int j = 0; j < ntypes; j++) {
+        const EDTSPDispatchEntry *e = &registry[types[j]];
+        for (int k = start[j]; k < start[j + 1]; k++) {
+            dispatch_one(order[k], e);
+        }
+    }
+}
+
+const EDTSPDispatchStats *edtsp_dispatch_stats(uint8_t type) {
+    return &stats[type];
+}
+
+void edtsp_dispatch_print(void) {
+    printf("[STATS] === Dispatch ===\n");
+    printf("  %-12s %10s %9s %9s\n", "Type", "Handled", "TooShort", "Unhandled");
+    for (int t = 1; t < EDTSP_DISPATCH_TYPES; t++) {
+        const EDTSPDispatchStats *s = &stats[t];
+        if (!s->dispatched && !s->too_short && !s->unhandled) continue;
+        
+        char name[16];
+        if (t <= EDTSP_TYPE_MAX) {
+            snprintf(name, sizeof(name), "%s", edtsp_type_name((uint8_t)t));
+        } else {
+            snprintf(name, sizeof(name), "type %d", t);
+        }
+        printf("  %-12s %10u %9u %9u\n", name, s->dispatched - s->unhandled,
+               s->too_short, s->unhandled);
+    }
+}
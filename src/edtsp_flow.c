@@ -0,0 +1,288 @@
+/**
+ * @file edtsp_flow.c
+ * @brief EDTSP Credit-Based Flow Control (master -> slaves backpressure)
+ *
+ * Master: AIMD on the total frame budget, driven by the sampled queue
+ * fill, then water-filling over the per-slave rates of the last period
+ * for the common cap. Slave rates are counted per device-table slot, so
+ * only joined slaves take an entry; a slave silent for IDLE_PERIODS loses
+ * it until its next DATA.
+ */
+
+#include "../include/edtsp_flow.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Calm periods, with the cap no longer binding, before it is lifted */
+#define LIFT_PERIODS 10
+
+/** CREDIT repeats announcing a lifted cap */
+#define LIFT_REPEATS 3
+
+/** Periods at rate 0 before a slave's entry is dropped */
+#define IDLE_PERIODS 10
+
+typedef struct {
+    bool     used;
+    uint8_t  idle;          // Periods at rate 0
+    uint32_t frames;        // This period
+    uint32_t rate_fps;      // Last period
+} FlowSlave;
+
+static FlowSlave slaves[EDTSP_FLOW_SLAVES];
+static EDTSPFlowStats stats;
+static uint32_t period_start_ms;
+static uint8_t  period_peak_pct;
+static uint32_t drops_total;
+static bool     drops_new;
+static bool     limiting;
+static uint32_t budget_fps;
+static uint16_t cap_fps = EDTSP_FLOW_UNLIMITED;
+static uint32_t served_fps;
+static int      calm_periods;
+static int      lift_repeats;
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+void edtsp_flow_slave_init(EDTSPFlowSlave *f, uint32_t now_ms) {
+    memset(f, 0, sizeof(*f));
+    f->max_fps = EDTSP_FLOW_UNLIMITED;
+    f->period_start_ms = now_ms;
+}
+
+bool edtsp_flow_on_credit(EDTSPFlowSlave *f, const EDTSPCreditPacket *pkt, uint32_t my_id, uint32_t now_ms) {
+    if (pkt->target_id && pkt->target_id != my_id) return false;
+    
+    f->max_fps = pkt->max_fps ? pkt->max_fps : 1;
+    f->expires_ms = now_ms + (pkt->lifetime_ms ? pkt->lifetime_ms : EDTSP_FLOW_LIFETIME_MS);
+    f->credits++;
+    return true;
+}
+
+void edtsp_flow_on_sent(EDTSPFlowSlave *f) {
+    f->frames++;
+}
+
+bool edtsp_flow_slave_tick(EDTSPFlowSlave *f, uint32_t now_ms) {
+    if (f->max_fps != EDTSP_FLOW_UNLIMITED && (int32_t)(now_ms - f->expires_ms) >= 0) {
+        f->max_fps = EDTSP_FLOW_UNLIMITED;   // Master gone or overload over
+    }
+    
+    uint32_t elapsed = now_ms - f->period_start_ms;
+    if (elapsed < EDTSP_FLOW_RATE_MS) return false;
+    
+    f->rate_fps = (uint32_t)((uint64_t)f->frames * 1000 / elapsed);
+    f->frames = 0;
+    f->period_start_ms = now_ms;
+    
+    // Each level halves the frame rate: jump straight to the one that fits,
+    // come back one level per period
+    uint8_t level = f->level;
+    if (f->max_fps != EDTSP_FLOW_UNLIMITED && f->rate_fps > f->max_fps) {
+        for (uint32_t r = f->rate_fps; r > f->max_fps && level < EDTSP_FLOW_MAX_LEVEL; r >>= 1) level++;
+    } else if (level && (f->max_fps == EDTSP_FLOW_UNLIMITED || f->rate_fps * 2 <= f->max_fps)) {
+        level--;
+    }
+    if (level == f->level) return false;
+    
+    f->level = level;
+    f->level_changes++;
+    if (level > f->max_level) f->max_level = level;
+    return true;
+}
+
+bool edtsp_decimate(EDTSPFlowSlave *f, EDTSPDecimator *d, int32_t value, uint32_t now_ms,
+                    int32_t *out, uint32_t *out_ms) {
+    uint16_t n = (uint16_t)(1u << f->level);
+    
+    if (!d->count) {
+        d->sum = 0;
+        d->first_ms = now_ms;
+    }
+    d->sum += value;
+    if (++d->count < n) return false;
+    
+    // A level lowered mid-group closes it early
+    int64_t half = d->count / 2;
+    *out = (int32_t)((d->sum >= 0 ? d->sum + half : d->sum - half) / d->count);
+    *out_ms = d->first_ms;
+    f->merged += d->count - 1u;
+    d->count = 0;
+    return true;
+}
+
+void edtsp_flow_slave_print(const EDTSPFlowSlave *f) {
+    if (!f->credits) return;
+    
+    printf("[STATS] === Flow Control (slave) ===\n");
+    if (f->max_fps == EDTSP_FLOW_UNLIMITED) {
+        printf("  Cap: none");
+    } else {
+        printf("  Cap: %u frames/s", f->max_fps);
+    }
+    printf(", sending %u frames/s, averaging %u sample(s) (deepest %u, %u changes)\n",
+           f->rate_fps, 1u << f->level, 1u << f->max_level, f->level_changes);
+    printf("  %u CREDIT(s) applied, %u samples folded into averages\n", f->credits, f->merged);
+}
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+void edtsp_flow_init(void) {
+    memset(slaves, 0, sizeof(slaves));
+    memset(&stats, 0, sizeof(stats));
+    period_start_ms = 0;
+    period_peak_pct = 0;
+    drops_total = 0;
+    drops_new = false;
+    limiting = false;
+    budget_fps = 0;
+    cap_fps = EDTSP_FLOW_UNLIMITED;
+    served_fps = 0;
+    calm_periods = 0;
+    lift_repeats = 0;
+}
+
+void edtsp_flow_on_data(int slot) {
+    if (slot < 0 || slot >= EDTSP_FLOW_SLAVES) return;
+    
+    FlowSlave *s = &slaves[slot];
+    if (!s->used) {
+        s->used = true;
+        stats.slaves++;
+    }
+    s->frames++;
+}
+
+void edtsp_flow_on_queue(uint8_t fill_pct, uint32_t drops) {
+    if (fill_pct > period_peak_pct) period_peak_pct = fill_pct;
+    if (fill_pct > stats.peak_pct) stats.peak_pct = fill_pct;
+    if (drops != drops_total) {
+        if (drops > drops_total) stats.kernel_drops += drops - drops_total;
+        drops_new = drops > drops_total;
+        drops_total = drops;
+    }
+}
+
+static int cmp_rate(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Max-min fair cap: slaves under it keep their rate, the rest share what
+ * is left equally. Rates sorted ascending; returns the largest rate plus
+ * the spare budget when everyone fits.
+ */
+static uint32_t water_level(uint32_t *rates, int n, uint32_t budget) {
+    qsort(rates, (size_t)n, sizeof(rates[0]), cmp_rate);
+    
+    for (int i = 0; i < n; i++) {
+        uint32_t share = budget / (uint32_t)(n - i);
+        if (rates[i] > share) return share;
+        budget -= rates[i];
+    }
+    return (n ? rates[n - 1] : 0) + budget;
+}
+
+bool edtsp_flow_tick(uint32_t now_ms, uint16_t *max_fps, uint8_t *queue_pct) {
+    static uint32_t rates[EDTSP_FLOW_SLAVES];
+    
+    if (!period_start_ms) period_start_ms = now_ms;
+    uint32_t elapsed = now_ms - period_start_ms;
+    if (elapsed < EDTSP_FLOW_PERIOD_MS) return false;
+    
+    period_start_ms = now_ms;
+    stats.periods++;
+    
+    // Rates served over the period
+    int n = 0;
+    served_fps = 0;
+    for (int i = 0; i < EDTSP_FLOW_SLAVES; i++) {
+        FlowSlave *s = &slaves[i];
+        if (!s->used) continue;
+        s->rate_fps = (uint32_t)((uint64_t)s->frames * 1000 / elapsed);
+        s->frames = 0;
+        if (!s->rate_fps) {
+            if (++s->idle >= IDLE_PERIODS) {
+                memset(s, 0, sizeof(*s));
+                stats.slaves--;
+                stats.evicted++;
+            }
+            continue;
+        }
+        s->idle = 0;
+        rates[n++] = s->rate_fps;
+        served_fps += s->rate_fps;
+    }
+    
+    // AIMD on the total: cut to 3/4 of what was served, probe up by 1/8
+    bool congested = period_peak_pct >= EDTSP_FLOW_HIGH_PCT || drops_new;
+    if (congested) {
+        uint32_t base = limiting && budget_fps < served_fps ? budget_fps : served_fps;
+        budget_fps = base * 3 / 4;
+        if (budget_fps < (uint32_t)n) budget_fps = (uint32_t)n;
+        limiting = true;
+        calm_periods = 0;
+        stats.congested++;
+    } else if (limiting && period_peak_pct < EDTSP_FLOW_LOW_PCT) {
+        // No further than twice what slaves use: room to step down a level
+        budget_fps += budget_fps / 8 > 1 ? budget_fps / 8 : 1;
+        if (budget_fps > 2 * served_fps + (uint32_t)n) budget_fps = 2 * served_fps + (uint32_t)n;
+        calm_periods++;
+    }
+    
+    bool send = false;
+    if (limiting) {
+        uint32_t level = water_level(rates, n, budget_fps);
+        uint32_t top = n ? rates[n - 1] : 0;
+        
+        // Lift once the cap has stopped binding for a while: every slave
+        // could double its rate and still fit
+        if (calm_periods >= LIFT_PERIODS && level >= 2 * top) {
+            limiting = false;
+            lift_repeats = LIFT_REPEATS;
+            cap_fps = EDTSP_FLOW_UNLIMITED;
+        } else {
+            cap_fps = (uint16_t)(level < 1 ? 1 : level >= EDTSP_FLOW_UNLIMITED ? EDTSP_FLOW_UNLIMITED - 1 : level);
+            stats.limited++;
+            send = true;
+        }
+    }
+    if (!limiting && lift_repeats > 0) {
+        lift_repeats--;
+        send = true;
+    }
+    
+    *max_fps = cap_fps;
+    *queue_pct = period_peak_pct;
+    period_peak_pct = 0;
+    drops_new = false;
+    if (send) stats.credits++;
+    return send;
+}
+
+const EDTSPFlowStats *edtsp_flow_stats(void) {
+    return &stats;
+}
+
+void edtsp_flow_print(void) {
+    if (!stats.congested) return;
+    
+    printf("[STATS] === Flow Control (master) ===\n");
+    if (limiting) {
+        printf("  Budget %u frames/s, cap %u frames/s per slave, serving %u frames/s\n",
+               budget_fps, cap_fps, served_fps);
+    } else {
+        printf("  No cap in force, serving %u frames/s\n", served_fps);
+    }
+    printf("  %u slave(s) tracked, %u dropped after %u idle periods\n", stats.slaves, stats.evicted,
+           IDLE_PERIODS);
+    printf("  %u periods: %u congested, %u capped; %u CREDIT(s) sent, queue peak %u%%, "
+           "%u kernel drops\n", stats.periods, stats.congested, stats.limited, stats.credits,
+           stats.peak_pct, stats.kernel_drops);
+}
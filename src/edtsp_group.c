@@ -0,0 +1,147 @@
+/**
+ * @file edtsp_group.c
+ * @brief EDTSP Group-Addressed Configuration (GROUP_CONFIG)
+ *
+ * A sorted list was chosen over a bloom filter: at 60 IDs per packet the
+ * binary search is at most 6 probes, and a false positive would apply a
+ * configuration to a slave that was never meant to receive it.
+ */
+
+#include "../include/edtsp_group.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Body fields are big-endian byte sequences (unaligned, endian-independent)
+static inline uint32_t body_id(const uint8_t *body, int offset, int index) {
+    const uint8_t *p = body + offset + index * EDTSP_GROUP_ID_SIZE;
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static int compare_ids(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+int edtsp_group_sort_ids(uint32_t *ids, int n) {
+    if (n <= 1) return n;
+    
+    qsort(ids, (size_t)n, sizeof(ids[0]), compare_ids);
+    
+    int unique = 1;
+    for (int i = 1; i < n; i++) {
+        if (ids[i] != ids[unique - 1]) ids[unique++] = ids[i];
+    }
+    return unique;
+}
+
+size_t edtsp_group_build(EDTSPGroupConfigPacket *pkt, uint32_t source_id, uint16_t config_seq,
+                         uint8_t selector, EDTSPCapabilityMask caps,
+                         const EDTSPSensorSetting *settings, int nsettings,
+                         const uint32_t *ids, int nids, int *consumed) {
+    *consumed = 0;
+    if (nsettings < 0 || nsettings > EDTSP_GROUP_MAX_SETTINGS) return 0;
+    if (nsettings * EDTSP_GROUP_SETTING_SIZE > EDTSP_GROUP_BODY_MAX) return 0;
+    
+    memset(pkt, 0, offsetof(EDTSPGroupConfigPacket, body));
+    uint8_t *b = pkt->body;
+    int pos = 0;
+    
+    for (int i = 0; i < nsettings; i++) {
+        b[pos++] = settings[i].sensor_id;
+        b[pos++] = settings[i].enable;
+        b[pos++] = (uint8_t)(settings[i].sampling_rate_ms >> 8);
+        b[pos++] = (uint8_t)settings[i].sampling_rate_ms;
+    }
+    
+    int count = 0;
+    if (selector == EDTSP_GROUP_IDS) {
+        count = EDTSP_GROUP_IDS_PER_PACKET(nsettings);
+        if (count > nids) count = nids;
+        for (int i = 0; i < count; i++) {
+            b[pos++] = (uint8_t)(ids[i] >> 24);
+            b[pos++] = (uint8_t)(ids[i] >> 16);
+            b[pos++] = (uint8_t)(ids[i] >> 8);
+            b[pos++] = (uint8_t)ids[i];
+        }
+    }
+    
+    size_t frame_len = offsetof(EDTSPGroupConfigPacket, body) + (size_t)pos;
+    pkt->header.magic = EDTSP_WIRE16(EDTSP_MAGIC);
+    pkt->header.type = EDTSP_TYPE_GROUP_CONFIG;
+    pkt->header.source_id = EDTSP_WIRE32(source_id);
+    pkt->header.payload_len = (uint8_t)(frame_len - sizeof(EDTSPHeader));
+    
+    pkt->selector = selector;
+    pkt->setting_count = (uint8_t)nsettings;
+    pkt->config_seq = config_seq;
+    pkt->capabilities = selector == EDTSP_GROUP_CAPS ? caps : 0;
+    pkt->target_count = (uint16_t)count;
+    pkt->body_len = (uint8_t)pos;
+    edtsp_encode_group_config(pkt);
+    
+    *consumed = count;
+    return frame_len;
+}
+
+int edtsp_group_packets_needed(int nsettings, int nids) {
+    int per_packet = EDTSP_GROUP_IDS_PER_PACKET(nsettings);
+    if (per_packet <= 0) return 0;
+    return nids ? (nids + per_packet - 1) / per_packet : 1;
+}
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+bool edtsp_group_valid(const EDTSPGroupConfigPacket *pkt, size_t len) {
+    if (len < offsetof(EDTSPGroupConfigPacket, body) + pkt->body_len) return false;
+    if (pkt->body_len > EDTSP_GROUP_BODY_MAX) return false;
+    
+    int needed = pkt->setting_count * EDTSP_GROUP_SETTING_SIZE +
+                 pkt->target_count * EDTSP_GROUP_ID_SIZE;
+    return needed <= pkt->body_len && pkt->selector <= EDTSP_GROUP_CAPS;
+}
+
+bool edtsp_group_match(const EDTSPGroupConfigPacket *pkt, uint32_t device_id,
+                       EDTSPCapabilityMask capabilities) {
+    switch (pkt->selector) {
+        case EDTSP_GROUP_ALL:
+            return true;
+        case EDTSP_GROUP_CAPS:
+            return (capabilities & pkt->capabilities) == pkt->capabilities;
+        case EDTSP_GROUP_IDS:
+            break;
+        default:
+            return false;
+    }
+    
+    int offset = pkt->setting_count * EDTSP_GROUP_SETTING_SIZE;
+    int lo = 0;
+    int hi = (int)pkt->target_count - 1;
+    
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        uint32_t id = body_id(pkt->body, offset, mid);
+        if (id == device_id) return true;
+        if (id < device_id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return false;
+}
+
+int edtsp_group_settings(const EDTSPGroupConfigPacket *pkt, EDTSPSensorSetting *out, int max) {
+    int n = pkt->setting_count < max ? pkt->setting_count : max;
+    
+    for (int i = 0; i < n; i++) {
+        const uint8_t *p = pkt->body + i * EDTSP_GROUP_SETTING_SIZE;
+        out[i].sensor_id = p[0];
+        out[i].enable = p[1];
+        out[i].sampling_rate_ms = (uint16_t)((p[2] << 8) | p[3]);
+    }
+    return n;
+}
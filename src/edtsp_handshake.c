@@ -0,0 +1,246 @@
+/**
+ * @file edtsp_handshake.c
+ * @brief EDTSP 3-Way Join Handshake (SYN / SYN-ACK / ACK)
+ *
+ * Master join table: open addressing with linear probing on a
+ * multiplicative hash of the device ID, backward-shift deletion (no
+ * tombstones). A SYN costs one or two probes at any fleet size.
+ */
+
+#include "../include/edtsp_handshake.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef enum {
+    HS_FREE = 0,
+    HS_SYN_RCVD,       // SYN-ACK sent, waiting for ACK
+    HS_ESTABLISHED
+} HsState;
+
+typedef struct {
+    uint32_t device_id;
+    uint8_t  state;
+    uint8_t  tries;        // SYN-ACK transmissions
+    uint64_t first_us;     // First SYN received
+    uint64_t due_us;       // Next SYN-ACK retransmission
+} HsEntry;
+
+static HsEntry table[EDTSP_HS_TABLE];
+static EDTSPHandshakeStats stats;
+static EDTSPHandshakeSendFn master_send;
+static void *master_ctx;
+
+static uint32_t xorshift(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+void edtsp_join_init(EDTSPJoin *join, uint32_t seed, EDTSPHandshakeSendFn send, void *ctx) {
+    memset(join, 0, sizeof(*join));
+    join->rng = seed ? seed : 0x9E3779B9;
+    join->send = send;
+    join->ctx = ctx;
+}
+
+void edtsp_join_set_master(EDTSPJoin *join, uint32_t master_id, uint64_t now_us) {
+    if (master_id == join->master_id && join->state != EDTSP_JOIN_IDLE) return;
+    
+    join->master_id = master_id;
+    join->syns = 0;
+    if (!master_id) {
+        join->state = EDTSP_JOIN_IDLE;
+        return;
+    }
+    
+    // Spread a power-up wave so the master's socket buffer is not flooded
+    join->state = EDTSP_JOIN_WAIT;
+    join->start_us = now_us;
+    join->due_us = now_us + xorshift(&join->rng) % EDTSP_HS_JITTER_US;
+    join->rto_us = EDTSP_HS_RTO_US;
+}
+
+void edtsp_join_on_packet(EDTSPJoin *join, const EDTSPHandshakePacket *pkt, uint64_t now_us) {
+    if (pkt->handshake_step != EDTSP_HANDSHAKE_SYN_ACK) return;
+    if (pkt->header.source_id != join->master_id || join->state == EDTSP_JOIN_IDLE) return;
+    
+    // Also answers a retransmitted SYN-ACK: our previous ACK was lost
+    join->send(EDTSP_HANDSHAKE_ACK, join->master_id, join->ctx);
+    join->master_caps = pkt->capabilities;
+    
+    if (join->state != EDTSP_JOIN_ESTABLISHED) {
+        join->state = EDTSP_JOIN_ESTABLISHED;
+        join->join_us = (uint32_t)(now_us - join->start_us);
+    }
+}
+
+void edtsp_join_poll(EDTSPJoin *join, uint64_t now_us) {
+    if (join->state != EDTSP_JOIN_WAIT && join->state != EDTSP_JOIN_SYN_SENT) return;
+    if (now_us < join->due_us) return;
+    
+    join->send(EDTSP_HANDSHAKE_SYN, join->master_id, join->ctx);
+    join->syns++;
+    
+    // Backoff with jitter: retransmissions of a wave stay spread out
+    uint32_t rto = join->state == EDTSP_JOIN_WAIT ? EDTSP_HS_RTO_US : join->rto_us * 2;
+    if (rto > EDTSP_HS_RTO_MAX_US) rto = EDTSP_HS_RTO_MAX_US;
+    join->rto_us = rto;
+    join->due_us = now_us + rto - rto / 4 + xorshift(&join->rng) % (rto / 2);
+    join->state = EDTSP_JOIN_SYN_SENT;
+}
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+static inline uint32_t home_slot(uint32_t device_id) {
+    return (device_id * 2654435761u) & (EDTSP_HS_TABLE - 1);
+}
+
+static HsEntry *lookup(uint32_t device_id, bool create) {
+    uint32_t i = home_slot(device_id);
+    
+    for (int n = 0; n < EDTSP_HS_TABLE; n++, i = (i + 1) & (EDTSP_HS_TABLE - 1)) {
+        if (table[i].state == HS_FREE) {
+            if (!create) return NULL;
+            table[i].device_id = device_id;
+            return &table[i];
+        }
+        if (table[i].device_id == device_id) return &table[i];
+    }
+    return NULL;
+}
+
+static void remove_entry(HsEntry *e) {
+    uint32_t hole = (uint32_t)(e - table);
+    
+    // Backward shift: pull later entries of the probe run into the hole.
+    // Vacated slots are freed as it goes, so a full table ends the run.
+    uint32_t i = (hole + 1) & (EDTSP_HS_TABLE - 1);
+    table[hole].state = HS_FREE;
+    while (table[i].state != HS_FREE) {
+        uint32_t home = home_slot(table[i].device_id);
+        if (((i - home) & (EDTSP_HS_TABLE - 1)) >= ((i - hole) & (EDTSP_HS_TABLE - 1))) {
+            table[hole] = table[i];
+            hole = i;
+            table[hole].state = HS_FREE;
+        }
+        i = (i + 1) & (EDTSP_HS_TABLE - 1);
+    }
+    memset(&table[hole], 0, sizeof(table[hole]));
+}
+
+void edtsp_hs_init(EDTSPHandshakeSendFn send, void *ctx) {
+    memset(table, 0, sizeof(table));
+    memset(&stats, 0, sizeof(stats));
+    edtsp_hist_init(&stats.join_us);
+    master_send = send;
+    master_ctx = ctx;
+}
+
+void edtsp_hs_on_packet(const EDTSPHandshakePacket *pkt, uint64_t now_us) {
+    uint32_t slave = pkt->header.source_id;
+    
+    if (pkt->handshake_step == EDTSP_HANDSHAKE_SYN) {
+        stats.syns++;
+        HsEntry *e = lookup(slave, true);
+        if (!e) return; // Table full: the slave retries
+        
+        if (e->state == HS_SYN_RCVD) {
+            stats.duplicate_syns++;
+        } else {
+            // New join, or a restarted slave re-joining
+            if (e->state == HS_ESTABLISHED) stats.peers--;
+            e->state = HS_SYN_RCVD;
+            e->first_us = now_us;
+            e->tries = 0;
+            stats.in_progress++;
+        }
+        
+        // Answer at once: joins proceed in parallel, never queued
+        master_send(EDTSP_HANDSHAKE_SYN_ACK, slave, master_ctx);
+        e->tries++;
+        e->due_us = now_us + ((uint64_t)EDTSP_HS_RTO_US << (e->tries - 1));
+        return;
+    }
+    
+    if (pkt->handshake_step != EDTSP_HANDSHAKE_ACK) return;
+    
+    HsEntry *e = lookup(slave, false);
+    if (!e || e->state != HS_SYN_RCVD) return; // Duplicate ACK
+    
+    e->state = HS_ESTABLISHED;
+    stats.in_progress--;
+    stats.established++;
+    stats.peers++;
+    edtsp_hist_record(&stats.join_us, (uint32_t)(now_us - e->first_us));
+}
+
+void edtsp_hs_poll(uint64_t now_us) {
+    int budget = EDTSP_HS_BURST;
+    
+    if (!stats.in_progress) return;
+    
+    for (int i = 0; i < EDTSP_HS_TABLE && budget > 0; i++) {
+        HsEntry *e = &table[i];
+        if (e->state != HS_SYN_RCVD || now_us < e->due_us) continue;
+        
+        if (e->tries >= EDTSP_HS_MAX_TRIES) {
+            stats.expired++;
+            stats.in_progress--;
+            remove_entry(e);
+            i--; // Backward shift may have moved an entry into this slot
+            continue;
+        }
+        
+        master_send(EDTSP_HANDSHAKE_SYN_ACK, e->device_id, master_ctx);
+        stats.synack_retx++;
+        e->tries++;
+        e->due_us = now_us + ((uint64_t)EDTSP_HS_RTO_US << (e->tries - 1));
+        budget--;
+    }
+}
+
+void edtsp_hs_forget(uint32_t device_id) {
+    HsEntry *e = lookup(device_id, false);
+    if (!e) return;
+    
+    if (e->state == HS_SYN_RCVD) stats.in_progress--;
+    if (e->state == HS_ESTABLISHED) stats.peers--;
+    remove_entry(e);
+}
+
+bool edtsp_hs_established(uint32_t device_id) {
+    HsEntry *e = lookup(device_id, false);
+    return e && e->state == HS_ESTABLISHED;
+}
+
+const EDTSPHandshakeStats *edtsp_hs_stats(void) {
+    return &stats;
+}
+
+void edtsp_hs_print(const EDTSPJoin *join) {
+    static const char *const join_names[] = { "idle", "waiting", "SYN sent", "established" };
+    
+    printf("[STATS] === Handshake ===\n");
+    if (stats.syns) {
+        printf("  Master: peers=%u in_progress=%u established=%u syns=%u dup_syns=%u "
+               "synack_retx=%u expired=%u\n", stats.peers, stats.in_progress, stats.established,
+               stats.syns, stats.duplicate_syns, stats.synack_retx, stats.expired);
+        printf("  Join time (us): p50=%u p99=%u max=%u\n",
+               edtsp_hist_percentile(&stats.join_us, 50),
+               edtsp_hist_percentile(&stats.join_us, 99), stats.join_us.max);
+    }
+    if (join && join->master_id) {
+        printf("  Joiner: %s with 0x%08X, SYNs=%u", join_names[join->state],
+               join->master_id, join->syns);
+        if (join->state == EDTSP_JOIN_ESTABLISHED) printf(", joined in %u us", join->join_us);
+        printf("\n");
+    }
+}
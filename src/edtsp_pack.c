@@ -0,0 +1,262 @@
+/**
+ * @file edtsp_pack.c
+ * @brief EDTSP Packed Sample Blocks (delta + zigzag + bit-packing)
+ *
+ * Layout: delta k goes to lane k % 4 at lane bit (k / 4) x width. Each
+ * lane is a stream of 32-bit little-endian words and the four streams are
+ * interleaved word by word, so one 16-byte load holds the same word of
+ * every lane and deltas 4r .. 4r+3 come out of it with the same shift.
+ * Trailing bytes that hold no delta bits are not sent.
+ */
+
+#include "../include/edtsp_pack.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Framing of one DATA frame on the wire (v2 header + DATA fields) */
+#define FRAME_LEN (sizeof(EDTSPHeaderV2) + offsetof(EDTSPDataPacket, data) - sizeof(EDTSPHeader))
+
+/** DATA frame bytes of one unpacked sample (4-byte value) */
+#define SAMPLE_FRAME_LEN (FRAME_LEN + 4)
+
+/** Block capacity */
+#define BLOCK_MAX ((int)EDTSP_PACK_BLOCK_MAX)
+
+#if !defined(EDTSP_PACK_SCALAR) && defined(__GNUC__) && defined(__has_builtin) && \
+    defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#if __has_builtin(__builtin_shufflevector)
+#define PACK_SIMD 1
+typedef uint32_t EDTSPLaneVec __attribute__((vector_size(16)));
+#endif
+#endif
+
+static EDTSPPackStats sensor_stats[16];
+
+/** Delta bytes of n deltas at width bits: up to the last byte holding delta bits */
+static int packed_len(int n, int width) {
+    int end = 0;
+    
+    for (int l = 0; l < 4 && l < n; l++) {
+        int bits = ((n - 1 - l) / 4 + 1) * width;
+        if (!bits) continue;
+        int last = bits - 1;
+        int e = 16 * (last >> 5) + 4 * l + ((last & 31) >> 3) + 1;
+        if (e > end) end = e;
+    }
+    return end;
+}
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+void edtsp_pack_configure(EDTSPPacker *p, uint8_t pack_samples) {
+    p->max_samples = pack_samples == EDTSP_PACK_FILL ? EDTSP_PACK_MAX_SAMPLES : pack_samples;
+    p->count = 0;
+}
+
+static void open_block(EDTSPPacker *p, int32_t value, uint32_t now_ms) {
+    p->count = 1;
+    p->width = 0;
+    p->first = value;
+    p->prev = value;
+    p->start_ms = now_ms;
+    p->last_ms = now_ms;
+    p->interval_ms = 0;
+}
+
+static uint16_t finish_block(EDTSPPacker *p, uint8_t *out, uint32_t *start_ms) {
+    int n = p->count - 1;
+    int len = EDTSP_PACK_HEADER_LEN + packed_len(n, p->width);
+    uint32_t words[4 * (BLOCK_MAX / 16 + 1)] = {0};    // Interleaved: word i of lane l at 4i + l
+    
+    out[0] = (uint8_t)((uint32_t)p->first >> 24);
+    out[1] = (uint8_t)((uint32_t)p->first >> 16);
+    out[2] = (uint8_t)((uint32_t)p->first >> 8);
+    out[3] = (uint8_t)p->first;
+    out[4] = (uint8_t)(p->count >> 8);
+    out[5] = (uint8_t)p->count;
+    out[6] = p->width;
+    out[7] = (uint8_t)(p->interval_ms >> 8);
+    out[8] = (uint8_t)p->interval_ms;
+    
+    for (int k = 0; k < n; k++) {
+        int pos = (k >> 2) * p->width;
+        int i = 4 * (pos >> 5) + (k & 3);
+        uint64_t v = (uint64_t)p->zz[k] << (pos & 31);
+        words[i] |= (uint32_t)v;
+        if (v >> 32) words[i + 4] |= (uint32_t)(v >> 32);
+    }
+    for (int b = 0; b < len - EDTSP_PACK_HEADER_LEN; b++) {
+        out[EDTSP_PACK_HEADER_LEN + b] = (uint8_t)(words[b >> 2] >> (8 * (b & 3)));
+    }
+    
+    *start_ms = p->start_ms;
+    p->samples += p->count;
+    p->blocks++;
+    p->bytes += (uint32_t)len;
+    p->count = 0;
+    return (uint16_t)len;
+}
+
+uint16_t edtsp_pack_sample(EDTSPPacker *p, int32_t value, uint32_t now_ms, uint8_t *out, uint32_t *start_ms) {
+    if (!p->count) {
+        open_block(p, value, now_ms);
+        return 0;
+    }
+    
+    // The second sample fixes the block's sampling interval
+    uint32_t interval = now_ms - p->last_ms;
+    bool on_grid = p->count == 1 ? interval > 0 && interval <= UINT16_MAX : interval == p->interval_ms;
+    
+    uint32_t delta = (uint32_t)value - (uint32_t)p->prev;
+    uint32_t zz = (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+    uint8_t width = p->width;
+    while (width < 32 && (zz >> width)) width++;
+    
+    if (!on_grid || EDTSP_PACK_HEADER_LEN + packed_len(p->count, width) > BLOCK_MAX) {
+        uint16_t len = finish_block(p, out, start_ms);
+        open_block(p, value, now_ms);
+        return len;
+    }
+    
+    if (p->count == 1) p->interval_ms = interval;
+    p->zz[p->count - 1] = zz;
+    p->width = width;
+    p->prev = value;
+    p->last_ms = now_ms;
+    if (++p->count < p->max_samples) return 0;
+    
+    return finish_block(p, out, start_ms);
+}
+
+uint16_t edtsp_pack_flush(EDTSPPacker *p, uint8_t *out, uint32_t *start_ms) {
+    return p->count ? finish_block(p, out, start_ms) : 0;
+}
+
+void edtsp_pack_print(const EDTSPPacker *packers, int count) {
+    bool header = false;
+    
+    for (int i = 0; i < count; i++) {
+        const EDTSPPacker *p = &packers[i];
+        if (!p->blocks) continue;
+        
+        if (!header) printf("[STATS] === Packed Samples (slave) ===\n");
+        header = true;
+        unsigned long framed = (unsigned long)p->blocks * FRAME_LEN + p->bytes;
+        printf("  Sensor %d: up to %u per block, %u samples in %u blocks, %.1f bits/sample, "
+               "%lu of %lu bytes\n", i, p->max_samples, p->samples, p->blocks,
+               8.0 * p->bytes / p->samples, framed, (unsigned long)p->samples * SAMPLE_FRAME_LEN);
+    }
+}
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+int edtsp_unpack(const uint8_t *data, int len, int32_t *out, uint16_t *interval_ms) {
+    // Lanes past the last delta read zero padding, never past the buffer
+    uint32_t words[4 * (BLOCK_MAX / 16 + 2)];
+    
+    if (len < EDTSP_PACK_HEADER_LEN || len > BLOCK_MAX) return -1;
+    
+    int count = data[4] << 8 | data[5];
+    int width = data[6];
+    int n = count - 1;
+    if (!count || count > EDTSP_PACK_MAX_SAMPLES || width > 32) return -1;
+    if (len != EDTSP_PACK_HEADER_LEN + packed_len(n, width)) return -1;
+    
+    uint32_t first = (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | data[3];
+    uint32_t mask = width == 32 ? 0xFFFFFFFFu : (1u << width) - 1;
+    if (interval_ms) *interval_ms = (uint16_t)(data[7] << 8 | data[8]);
+    out[0] = (int32_t)first;
+    
+    size_t bytes = (size_t)(len - EDTSP_PACK_HEADER_LEN);
+    
+#ifdef PACK_SIMD
+    const EDTSPLaneVec zero = {0, 0, 0, 0};
+    const EDTSPLaneVec one = {1, 1, 1, 1};
+    const EDTSPLaneVec vmask = {mask, mask, mask, mask};
+    EDTSPLaneVec carry = {first, first, first, first};
+    memset((uint8_t*)words + (bytes & ~(size_t)15), 0, sizeof(words) - (bytes & ~(size_t)15));
+    memcpy(words, data + EDTSP_PACK_HEADER_LEN, bytes);
+    
+    for (int k = 0, pos = 0; k < n; k += 4, pos += width) {
+        EDTSPLaneVec lo, hi;
+        int s = pos & 31;
+        memcpy(&lo, &words[4 * (pos >> 5)], sizeof(lo));
+        memcpy(&hi, &words[4 * (pos >> 5) + 4], sizeof(hi));
+        
+        // Branch-free straddle: (hi << 1) << (31 - s) is 0 when s = 0
+        EDTSPLaneVec z = ((lo >> s) | ((hi << 1) << (31 - s))) & vmask;
+        
+        // Zigzag, then inclusive prefix sum across the four lanes
+        EDTSPLaneVec d = (z >> 1) ^ -(z & one);
+        d += __builtin_shufflevector(d, zero, 4, 0, 1, 2);
+        d += __builtin_shufflevector(d, zero, 4, 4, 0, 1);
+        d += carry;
+        memcpy(&out[1 + k], &d, sizeof(d));     // Up to 3 past the last sample (EDTSP_PACK_OUT_LEN)
+        carry = __builtin_shufflevector(d, d, 3, 3, 3, 3);
+    }
+#else
+    const uint8_t *b = data + EDTSP_PACK_HEADER_LEN;
+    memset(words, 0, sizeof(words));
+    for (size_t i = 0; i < bytes; i++) words[i >> 2] |= (uint32_t)b[i] << (8 * (i & 3));
+    
+    uint32_t v = first;
+    for (int k = 0; k < n; k++) {
+        int pos = (k >> 2) * width;
+        int i = 4 * (pos >> 5) + (k & 3);
+        uint64_t w = words[i] | (uint64_t)words[i + 4] << 32;
+        uint32_t z = (uint32_t)(w >> (pos & 31)) & mask;
+        v += (z >> 1) ^ (0u - (z & 1));
+        out[k + 1] = (int32_t)v;
+    }
+#endif
+    return count;
+}
+
+void edtsp_unpack_init(void) {
+    memset(sensor_stats, 0, sizeof(sensor_stats));
+}
+
+int edtsp_unpack_on_data(const EDTSPDataPacket *pkt, size_t len, int32_t *out, uint16_t *interval_ms) {
+    if (pkt->sensor_id >= 16 || len < offsetof(EDTSPDataPacket, data)) return -1;
+    
+    // The block runs past the 64-byte data field to the end of the frame
+    const uint8_t *block = (const uint8_t*)pkt + offsetof(EDTSPDataPacket, data);
+    int bytes = (int)(len - offsetof(EDTSPDataPacket, data));
+    EDTSPPackStats *st = &sensor_stats[pkt->sensor_id];
+    int n = edtsp_unpack(block, bytes, out, interval_ms);
+    if (n < 0) {
+        st->malformed++;
+        return -1;
+    }
+    
+    st->blocks++;
+    st->samples += (uint32_t)n;
+    st->bytes += (uint32_t)bytes;
+    return n;
+}
+
+const EDTSPPackStats *edtsp_unpack_stats(uint8_t sensor_id) {
+    return &sensor_stats[sensor_id & 15];
+}
+
+void edtsp_unpack_print(void) {
+    bool header = false;
+    
+    for (int i = 0; i < 16; i++) {
+        const EDTSPPackStats *st = &sensor_stats[i];
+        if (!st->blocks && !st->malformed) continue;
+        
+        if (!header) printf("[STATS] === Packed Samples (master) ===\n");
+        header = true;
+        unsigned long framed = (unsigned long)st->blocks * FRAME_LEN + st->bytes;
+        unsigned long raw = (unsigned long)st->samples * SAMPLE_FRAME_LEN;
+        printf("  Sensor %d: %u blocks, %u samples, %.1f bits/sample (%u malformed), "
+               "%lu of %lu bytes (%.1f%% saved)\n", i, st->blocks, st->samples,
+               st->samples ? 8.0 * st->bytes / st->samples : 0.0, st->malformed, framed, raw,
+               raw > framed ? 100.0 * (raw - framed) / raw : 0.0);
+    }
+}
@@ -0,0 +1,256 @@
+/**
+ * @file edtsp_pool.c
+ * @brief EDTSP Packet Buffer Pool and Batch Arena
+ *
+ * Buffers are addressed by index. The shared free list is a Treiber stack
+ * whose head packs a 32-bit ABA tag with index + 1 (0 = empty) into one
+ * 64-bit word, so push and pop are a single compare-and-swap. Threads
+ * mostly hit their private cache and touch the shared stack only when it
+ * runs empty or full, moving half a cache at a time.
+ */
+
+#include "../include/edtsp_pool.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POOL_MOVE (EDTSP_POOL_THREAD_CACHE / 2)
+
+typedef struct {
+    _Alignas(EDTSP_CACHE_LINE) uint32_t count;   /**< Cached buffers */
+    uint32_t idx[EDTSP_POOL_THREAD_CACHE];        /**< Cached buffer indices */
+    _Atomic uint64_t allocs;                      /**< Single writer: owning thread */
+    _Atomic uint64_t frees;
+    _Atomic uint64_t refills;
+    _Atomic uint64_t spills;
+    _Atomic uint64_t exhausted;
+} EDTSPPoolThread;
+
+static uint8_t *pool_mem = NULL;              // Buffers, then the next[] links
+static _Atomic uint32_t *pool_next = NULL;    // Shared stack links (index + 1)
+static uint32_t pool_capacity = 0;
+static _Atomic uint64_t pool_head = 0;        // tag << 32 | (index + 1)
+static uint32_t pool_heap_allocs = 0;
+
+static EDTSPPoolThread threads[EDTSP_POOL_MAX_THREADS];
+static _Atomic uint32_t thread_count = 0;
+static _Thread_local EDTSPPoolThread *self = NULL;
+
+// Threads beyond EDTSP_POOL_MAX_THREADS bypass the cache (shared counters)
+static EDTSPPoolThread uncached;
+
+static inline void bump(EDTSPPoolThread *tc, _Atomic uint64_t *counter) {
+    if (tc == &uncached) {
+        atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+        return;
+    }
+    // Owning thread is the only writer: no locked instruction needed
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+}
+
+static EDTSPPoolThread *thread_cache(void) {
+    if (!self) {
+        uint32_t slot = atomic_fetch_add(&thread_count, 1);
+        self = slot < EDTSP_POOL_MAX_THREADS ? &threads[slot] : &uncached;
+    }
+    return self;
+}
+
+// ============================================================================
+// SHARED STACK
+// ============================================================================
+
+/** Push a chain first..last (already linked through pool_next) */
+static void stack_push(uint32_t first, uint32_t last) {
+    uint64_t head = atomic_load_explicit(&pool_head, memory_order_relaxed);
+    uint64_t next;
+    
+    do {
+        atomic_store_explicit(&pool_next[last], (uint32_t)head, memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | (first + 1);
+    } while (!atomic_compare_exchange_weak_explicit(&pool_head, &head, next,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+/** Pop one index, or return false if the stack is empty */
+static bool stack_pop(uint32_t *idx) {
+    uint64_t head = atomic_load_explicit(&pool_head, memory_order_acquire);
+    uint64_t next;
+    
+    do {
+        uint32_t top = (uint32_t)head;
+        if (top == 0) return false;
+        uint32_t below = atomic_load_explicit(&pool_next[top - 1], memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | below;
+    } while (!atomic_compare_exchange_weak_explicit(&pool_head, &head, next,
+                                                    memory_order_acquire,
+                                                    memory_order_acquire));
+
+    *idx = (uint32_t)head - 1;
+    return true;
+}
+
+// ============================================================================
+// POOL
+// ============================================================================
+
+bool edtsp_pool_init(uint32_t count) {
+    if (pool_mem || count == 0) return false;
+    
+    size_t buf_bytes = (size_t)count * EDTSP_POOL_BUF_SIZE;
+    size_t link_bytes = ((size_t)count * sizeof(*pool_next) + EDTSP_CACHE_LINE - 1) &
+                        ~(size_t)(EDTSP_CACHE_LINE - 1);
+    
+    pool_mem = aligned_alloc(EDTSP_CACHE_LINE, buf_bytes + link_bytes);
+    if (!pool_mem) return false;
+    pool_heap_allocs++;
+    
+    pool_next = (_Atomic uint32_t*)(pool_mem + buf_bytes);
+    pool_capacity = count;
+    
+    // Link every buffer into the shared stack, lowest index on top
+    for (uint32_t i = 0; i < count; i++) {
+        atomic_init(&pool_next[i], i + 1 < count ? i + 2 : 0);
+    }
+    atomic_store(&pool_head, 1);
+    
+    for (int t = 0; t < EDTSP_POOL_MAX_THREADS; t++) threads[t].count = 0;
+    return true;
+}
+
+void edtsp_pool_destroy(void) {
+    free(pool_mem);
+    pool_mem = NULL;
+    pool_next = NULL;
+    pool_capacity = 0;
+    atomic_store(&pool_head, 0);
+    for (int t = 0; t < EDTSP_POOL_MAX_THREADS; t++) threads[t].count = 0;
+}
+
+void *edtsp_pool_alloc(void) {
+    EDTSPPoolThread *tc = thread_cache();
+    uint32_t idx;
+    
+    if (tc == &uncached) {
+        if (!stack_pop(&idx)) {
+            bump(tc, &tc->exhausted);
+            return NULL;
+        }
+    } else {
+        if (tc->count == 0) {
+            // Refill half a cache from the shared stack
+            while (tc->count < POOL_MOVE && stack_pop(&tc->idx[tc->count])) tc->count++;
+            bump(tc, &tc->refills);
+            if (tc->count == 0) {
+                bump(tc, &tc->exhausted);
+                return NULL;
+            }
+        }
+        idx = tc->idx[--tc->count];
+    }
+    
+    bump(tc, &tc->allocs);
+    return pool_mem + (size_t)idx * EDTSP_POOL_BUF_SIZE;
+}
+
+void edtsp_pool_free(void *buf) {
+    if (!buf) return;
+    
+    EDTSPPoolThread *tc = thread_cache();
+    uint32_t idx = (uint32_t)(((uint8_t*)buf - pool_mem) / EDTSP_POOL_BUF_SIZE);
+    
+    bump(tc, &tc->frees);
+    if (tc == &uncached) {
+        stack_push(idx, idx);
+        return;
+    }
+    
+    if (tc->count == EDTSP_POOL_THREAD_CACHE) {
+        // Spill the older half as one chain (single CAS)
+        for (uint32_t i = 0; i + 1 < POOL_MOVE; i++) {
+            atomic_store_explicit(&pool_next[tc->idx[i]], tc->idx[i + 1] + 1, memory_order_relaxed);
+        }
+        stack_push(tc->idx[0], tc->idx[POOL_MOVE - 1]);
+        memmove(tc->idx, tc->idx + POOL_MOVE, (tc->count - POOL_MOVE) * sizeof(tc->idx[0]));
+        tc->count -= POOL_MOVE;
+        bump(tc, &tc->spills);
+    }
+    tc->idx[tc->count++] = idx;
+}
+
+void edtsp_pool_thread_flush(void) {
+    EDTSPPoolThread *tc = self;
+    if (!tc || tc == &uncached || tc->count == 0) return;
+    
+    for (uint32_t i = 0; i + 1 < tc->count; i++) {
+        atomic_store_explicit(&pool_next[tc->idx[i]], tc->idx[i + 1] + 1, memory_order_relaxed);
+    }
+    stack_push(tc->idx[0], tc->idx[tc->count - 1]);
+    tc->count = 0;
+}
+
+void edtsp_pool_stats(EDTSPPoolStats *out) {
+    uint32_t n = atomic_load(&thread_count);
+    if (n > EDTSP_POOL_MAX_THREADS) n = EDTSP_POOL_MAX_THREADS;
+    
+    memset(out, 0, sizeof(*out));
+    for (uint32_t t = 0; t <= n; t++) {
+        EDTSPPoolThread *tc = t < n ? &threads[t] : &uncached;
+        out->allocs += atomic_load_explicit(&tc->allocs, memory_order_relaxed);
+        out->frees += atomic_load_explicit(&tc->frees, memory_order_relaxed);
+        out->refills += atomic_load_explicit(&tc->refills, memory_order_relaxed);
+        out->spills += atomic_load_explicit(&tc->spills, memory_order_relaxed);
+        out->exhausted += atomic_load_explicit(&tc->exhausted, memory_order_relaxed);
+    }
+    out->capacity = pool_capacity;
+    out->in_use = (uint32_t)(out->allocs - out->frees);
+    out->heap_allocs = pool_heap_allocs;
+}
+
+void edtsp_pool_print(void) {
+    EDTSPPoolStats st;
+    edtsp_pool_stats(&st);
+    
+    printf("  Buffer pool: %u/%u in use, allocs=%llu frees=%llu refills=%llu spills=%llu exhausted=%llu, heap allocs=%u\n",
+           st.in_use, st.capacity,
+           (unsigned long long)st.allocs, (unsigned long long)st.frees,
+           (unsigned long long)st.refills, (unsigned long long)st.spills,
+           (unsigned long long)st.exhausted, st.heap_allocs);
+}
+
+// ============================================================================
+// BATCH ARENA
+// ============================================================================
+
+void edtsp_arena_init(EDTSPArena *arena, void *mem, size_t size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->base = mem;
+    arena->size = size;
+}
+
+void *edtsp_arena_alloc(EDTSPArena *arena, size_t size, size_t align) {
+    if (align == 0) align = 8;
+    
+    // Align the address, not the offset: the backing memory may be unaligned
+    uintptr_t addr = (uintptr_t)(arena->base + arena->used);
+    size_t pad = (size_t)(-addr & (align - 1));
+    
+    if (arena->used + pad + size > arena->size) {
+        arena->overflows++;
+        return NULL;
+    }
+    
+    arena->used += pad + size;
+    arena->allocs++;
+    return (void*)(addr + pad);
+}
+
+void edtsp_arena_print(const char *name, const EDTSPArena *arena) {
+    printf("  Arena %s: peak %zu/%zu bytes, allocs=%llu batches=%llu overflows=%llu\n",
+           name, arena->peak, arena->size,
+           (unsigned long long)arena->allocs, (unsigned long long)arena->resets,
+           (unsigned long long)arena->overflows);
+}
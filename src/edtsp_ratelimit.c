@@ -0,0 +1,184 @@
+/**
+ * @file edtsp_ratelimit.c
+ * @brief EDTSP Per-Source Rate Limiting (receive path)
+ *
+ * Tokens are counted in millionths of a frame, so a refill is one multiply
+ * of the elapsed microseconds by the rate: no division on the hot path.
+ * Lookup is open addressing on the source ID with a bounded probe; an
+ * unknown source idle for EDTSP_RATELIMIT_IDLE_US can be overwritten in
+ * place, which keeps every other probe chain intact.
+ */
+
+#include "../include/edtsp_ratelimit.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Tokens per frame */
+#define TOKEN 1000000ULL
+
+/** Longest refill interval considered (bucket is full long before) */
+#define MAX_ELAPSED_US 100000000ULL
+
+typedef struct {
+    uint32_t source_id;
+    bool     used;
+    bool     known;
+    uint64_t last_us;
+    uint64_t tokens;
+    uint32_t passed;
+    uint32_t dropped;
+    uint32_t sampled;
+    uint32_t excess;        // Over-limit frames since the last sampled one
+} RateBucket;
+
+static RateBucket buckets[EDTSP_RATELIMIT_SOURCES];
+static RateBucket overflow_bucket;
+static EDTSPRateLimitConfig config;
+static EDTSPRateLimitStats stats;
+static uint64_t last_now_us;
+
+void edtsp_ratelimit_init(const EDTSPRateLimitConfig *cfg) {
+    static const EDTSPRateLimitConfig defaults = {
+        EDTSP_RATELIMIT_DEVICE_PPS, EDTSP_RATELIMIT_DEVICE_BURST,
+        EDTSP_RATELIMIT_STRANGER_PPS, EDTSP_RATELIMIT_STRANGER_BURST,
+        EDTSP_RATELIMIT_SAMPLE_EVERY
+    };
+    
+    config = cfg ? *cfg : defaults;
+    memset(buckets, 0, sizeof(buckets));
+    memset(&overflow_bucket, 0, sizeof(overflow_bucket));
+    memset(&stats, 0, sizeof(stats));
+}
+
+static uint32_t home_slot(uint32_t source_id) {
+    uint32_t h = source_id * 2654435761u;
+    return (h ^ h >> 16) & (EDTSP_RATELIMIT_SOURCES - 1);
+}
+
+/** Bucket of a source; with create, claims a free or idle stranger slot */
+static RateBucket *find_bucket(uint32_t source_id, bool create, uint64_t now_us) {
+    uint32_t i = home_slot(source_id);
+    RateBucket *spare = NULL;
+    
+    for (int n = 0; n < EDTSP_RATELIMIT_PROBE; n++, i = (i + 1) & (EDTSP_RATELIMIT_SOURCES - 1)) {
+        RateBucket *b = &buckets[i];
+        if (!b->used) {
+            if (!spare) spare = b;
+            break;
+        }
+        if (b->source_id == source_id) return b;
+        if (!spare && !b->known && now_us - b->last_us > EDTSP_RATELIMIT_IDLE_US) spare = b;
+    }
+    if (!create || !spare) return NULL;
+    
+    if (!spare->used) stats.sources++;
+    memset(spare, 0, sizeof(*spare));
+    spare->used = true;
+    spare->source_id = source_id;
+    spare->last_us = now_us;
+    spare->tokens = (uint64_t)config.stranger_burst * TOKEN;
+    return spare;
+}
+
+void edtsp_ratelimit_set_known(uint32_t source_id, bool known) {
+    RateBucket *b = find_bucket(source_id, known, last_now_us);
+    if (!b || b->known == known) return;
+    
+    // A joining device starts with a full device burst
+    b->known = known;
+    if (known) b->tokens = (uint64_t)config.device_burst * TOKEN;
+}
+
+bool edtsp_ratelimit_admit(uint32_t source_id, uint64_t now_us) {
+    RateBucket *b = find_bucket(source_id, true, now_us);
+    last_now_us = now_us;
+    if (!b) {
+        b = &overflow_bucket;
+        stats.overflow++;
+    }
+    
+    uint32_t pps = b->known ? config.device_pps : config.stranger_pps;
+    uint64_t cap = (uint64_t)(b->known ? config.device_burst : config.stranger_burst) * TOKEN;
+    if (!pps) {
+        b->passed++;
+        stats.passed++;
+        return true;
+    }
+    
+    // Refill; a clock step backwards just skips it
+    uint64_t elapsed = now_us - b->last_us;
+    if (now_us >= b->last_us) {
+        if (elapsed > MAX_ELAPSED_US) elapsed = MAX_ELAPSED_US;
+        b->tokens += elapsed * pps;
+        if (b->tokens > cap) b->tokens = cap;
+    }
+    b->last_us = now_us;
+    
+    if (b->tokens >= TOKEN) {
+        b->tokens -= TOKEN;
+        b->passed++;
+        stats.passed++;
+        return true;
+    }
+    
+    if (config.sample_every && ++b->excess >= config.sample_every) {
+        b->excess = 0;
+        b->sampled++;
+        stats.sampled++;
+        return true;
+    }
+    b->dropped++;
+    stats.dropped++;
+    return false;
+}
+
+bool edtsp_ratelimit_source(uint32_t source_id, EDTSPRateSource *out) {
+    const RateBucket *b = find_bucket(source_id, false, last_now_us);
+    if (!b) return false;
+    
+    out->source_id = b->source_id;
+    out->known = b->known;
+    out->passed = b->passed;
+    out->dropped = b->dropped;
+    out->sampled = b->sampled;
+    return true;
+}
+
+const EDTSPRateLimitStats *edtsp_ratelimit_stats(void) {
+    return &stats;
+}
+
+void edtsp_ratelimit_print(void) {
+    const RateBucket *top[8];
+    int count = 0;
+    
+    printf("[STATS] === Rate Limiting ===\n");
+    printf("  Limits: device %u/s burst %u, stranger %u/s burst %u, sample 1/%u\n",
+           config.device_pps, config.device_burst, config.stranger_pps, config.stranger_burst,
+           config.sample_every);
+    printf("  Frames: passed=%u dropped=%u sampled=%u (%u sources, %u via overflow bucket)\n",
+           stats.passed, stats.dropped, stats.sampled, stats.sources, stats.overflow);
+    
+    // Worst offenders by drops, insertion into a short sorted list
+    for (int i = 0; i < EDTSP_RATELIMIT_SOURCES; i++) {
+        const RateBucket *b = &buckets[i];
+        if (!b->used || !b->dropped) continue;
+        
+        int j = count < 8 ? count++ : 8;
+        if (j == 8 && b->dropped <= top[7]->dropped) continue;
+        if (j == 8) j = 7;
+        while (j > 0 && top[j - 1]->dropped < b->dropped) {
+            top[j] = top[j - 1];
+            j--;
+        }
+        top[j] = b;
+    }
+    for (int i = 0; i < count; i++) {
+        printf("  Source 0x%08X (%s): passed=%u dropped=%u sampled=%u\n", top[i]->source_id,
+               top[i]->known ? "device" : "stranger", top[i]->passed, top[i]->dropped, top[i]->sampled);
+    }
+    if (overflow_bucket.dropped) {
+        printf("  Overflow bucket: passed=%u dropped=%u sampled=%u\n",
+               overflow_bucket.passed, overflow_bucket.dropped, overflow_bucket.sampled);
+    }
+}
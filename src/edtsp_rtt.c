@@ -0,0 +1,150 @@
+/**
+ * @file edtsp_rtt.c
+ * @brief EDTSP Round-Trip and One-Way Latency Tracking
+ * 
+ * One-way latency needs the peer clock offset. Each exchange yields an
+ * NTP-style offset estimate whose error is bounded by RTT/2, so the
+ * offset from the lowest-RTT exchange of the last EDTSP_RTT_FILTER_LEN
+ * is used (NTP clock filter) to split round trips into outbound/return
+ * legs. The window lets the minimum age out, so drift or a clock step
+ * is picked up within that many exchanges.
+ */
+
+#include "../include/edtsp_rtt.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PEER_HASH_SIZE 512
+
+static EDTSPPeerLatency peers[EDTSP_MAX_DEVICES];
+static uint16_t peer_slot[PEER_HASH_SIZE];   // 0 = empty, else index + 1
+static int peer_count = 0;
+static uint32_t iface_srtt[EDTSP_IFACE_SLOTS];
+
+void edtsp_rtt_init(void) {
+    memset(peers, 0, sizeof(peers));
+    memset(peer_slot, 0, sizeof(peer_slot));
+    memset(iface_srtt, 0, sizeof(iface_srtt));
+    peer_count = 0;
+}
+
+static EDTSPPeerLatency *find_peer(uint32_t peer_id, bool create) {
+    uint32_t idx = (peer_id * 2654435769u) >> (32 - 9);
+    
+    for (uint32_t probe = 0; probe < PEER_HASH_SIZE; probe++) {
+        uint16_t *slot = &peer_slot[(idx + probe) & (PEER_HASH_SIZE - 1)];
+        
+        if (*slot == 0) {
+            if (!create || peer_count >= EDTSP_MAX_DEVICES) return NULL;
+            EDTSPPeerLatency *p = &peers[peer_count];
+            *slot = (uint16_t)(++peer_count);
+            p->peer_id = peer_id;
+            p->min_rtt_us = UINT32_MAX;
+            edtsp_hist_init(&p->rtt_hist);
+            edtsp_hist_init(&p->owd_hist);
+            return p;
+        }
+        if (peers[*slot - 1].peer_id == peer_id) return &peers[*slot - 1];
+    }
+    return NULL;
+}
+
+/** RFC 6298: SRTT += (R - SRTT)/8, RTTVAR += (|SRTT - R| - RTTVAR)/4 */
+static void smooth(uint32_t *srtt, uint32_t *rttvar, uint32_t rtt) {
+    if (*srtt == 0) {
+        *srtt = rtt;
+        if (rttvar) *rttvar = rtt / 2;
+        return;
+    }
+    
+    int64_t err = (int64_t)rtt - (int64_t)*srtt;
+    if (rttvar) {
+        int64_t abs_err = err < 0 ? -err : err;
+        *rttvar = (uint32_t)((int64_t)*rttvar + (abs_err - (int64_t)*rttvar) / 4);
+    }
+    *srtt = (uint32_t)((int64_t)*srtt + err / 8);
+}
+
+uint32_t edtsp_rtt_on_echo(uint32_t peer_id, uint8_t iface,
+                           uint64_t t1_us, uint64_t t2_us, uint64_t t3_us, uint64_t t4_us) {
+    EDTSPPeerLatency *p = find_peer(peer_id, true);
+    
+    // Subtract the peer's turnaround; clamp clock glitches to zero
+    int64_t rtt = (int64_t)(t4_us - t1_us) - (int64_t)(t3_us - t2_us);
+    if (rtt < 0) rtt = 0;
+    if (rtt > UINT32_MAX) rtt = UINT32_MAX;
+    uint32_t rtt_us = (uint32_t)rtt;
+    
+    if (iface < EDTSP_IFACE_SLOTS) smooth(&iface_srtt[iface], NULL, rtt_us);
+    if (!p) return rtt_us;
+    
+    smooth(&p->srtt_us, &p->rttvar_us, rtt_us);
+    if (iface < EDTSP_IFACE_SLOTS) smooth(&p->iface_srtt_us[iface], NULL, rtt_us);
+    
+    // Clock filter: trust the offset from the tightest recent exchange
+    int w = (int)(p->samples % EDTSP_RTT_FILTER_LEN);
+    p->win_rtt_us[w] = rtt_us;
+    p->win_offset_us[w] = ((int64_t)(t2_us - t1_us) + (int64_t)(t3_us - t4_us)) / 2;
+    
+    int n = p->samples < EDTSP_RTT_FILTER_LEN ? (int)p->samples + 1 : EDTSP_RTT_FILTER_LEN;
+    int best = 0;
+    for (int i = 1; i < n; i++) {
+        if (p->win_rtt_us[i] < p->win_rtt_us[best]) best = i;
+    }
+    p->min_rtt_us = p->win_rtt_us[best];
+    p->offset_us = p->win_offset_us[best];
+    
+    int64_t owd = (int64_t)(t2_us - t1_us) - p->offset_us;
+    if (owd < 0) owd = 0;
+    if (owd > rtt_us) owd = rtt_us;
+    
+    edtsp_hist_record(&p->rtt_hist, rtt_us);
+    edtsp_hist_record(&p->owd_hist, (uint32_t)owd);
+    p->samples++;
+    return rtt_us;
+}
+
+void edtsp_rtt_on_loss(uint32_t peer_id) {
+    EDTSPPeerLatency *p = find_peer(peer_id, true);
+    if (p) p->losses++;
+}
+
+const EDTSPPeerLatency *edtsp_rtt_peer(uint32_t peer_id) {
+    return find_peer(peer_id, false);
+}
+
+uint32_t edtsp_rtt_rto_ms(uint32_t peer_id) {
+    const EDTSPPeerLatency *p = find_peer(peer_id, false);
+    if (!p || p->samples == 0) return EDTSP_RTO_INITIAL_MS;
+    
+    uint32_t rto_ms = (p->srtt_us + 4 * p->rttvar_us + 999) / 1000;
+    return rto_ms < EDTSP_RTO_MIN_MS ? EDTSP_RTO_MIN_MS : rto_ms;
+}
+
+uint32_t edtsp_rtt_iface_srtt_us(uint8_t iface) {
+    return iface < EDTSP_IFACE_SLOTS ? iface_srtt[iface] : 0;
+}
+
+void edtsp_rtt_print(void) {
+    printf("[STATS] === Latency (us) ===\n");
+    printf("  %-10s %7s %7s %7s %7s %7s %7s %7s %6s %5s\n", "Peer", "SRTT", "RTTVAR",
+           "p50", "p90", "p99", "min", "OWDp50", "Probes", "Lost");
+    
+    for (int i = 0; i < peer_count; i++) {
+        const EDTSPPeerLatency *p = &peers[i];
+        printf("  0x%08X %7u %7u %7u %7u %7u %7u %7u %6u %5u\n", p->peer_id,
+               p->srtt_us, p->rttvar_us,
+               edtsp_hist_percentile(&p->rtt_hist, 50),
+               edtsp_hist_percentile(&p->rtt_hist, 90),
+               edtsp_hist_percentile(&p->rtt_hist, 99),
+               p->samples ? p->min_rtt_us : 0,
+               edtsp_hist_percentile(&p->owd_hist, 50),
+               p->samples, p->losses);
+    }
+    
+    for (int t = EDTSP_IFACE_ETH; t < EDTSP_IFACE_SLOTS; t++) {
+        if (iface_srtt[t]) {
+            printf("  %-10s SRTT=%u\n", edtsp_iface_name((uint8_t)t), iface_srtt[t]);
+        }
+    }
+}
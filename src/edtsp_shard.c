@@ -0,0 +1,260 @@
+/**
+ * @file edtsp_shard.c
+ * @brief EDTSP Sharded Ingest (consistent hashing over ingest nodes)
+ *
+ * The ring is rebuilt only when the node set changes; a lookup is one
+ * binary search over at most EDTSP_SHARD_POINTS sorted hashes. The
+ * master's assignments are indexed by device table slot, like the
+ * capability descriptors, so a tick over every slave does no searching.
+ */
+
+#include "../include/edtsp_shard.h"
+#include "../include/edtsp_hash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t id;
+    uint32_t addr;
+    uint16_t port;
+    uint64_t last_ms;
+} IngestNode;
+
+typedef struct {
+    uint32_t slave;              /**< Slot holder the record belongs to, 0 = none */
+    EDTSPShardTarget target;     /**< Last sent */
+    uint64_t sent_ms;
+} Assignment;
+
+static uint32_t my_id;
+static IngestNode nodes[EDTSP_SHARD_MAX_NODES];
+static int node_count;
+static EDTSPShardRing ring;
+static Assignment assigned[EDTSP_MAX_DEVICES];
+static EDTSPShardTarget my_target;
+static EDTSPShardStats stats;
+
+uint32_t edtsp_shard_hash(uint32_t device_id) {
+    return edtsp_hash_mix32(device_id);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+void edtsp_shard_ring_build(EDTSPShardRing *r, const uint32_t *ids, int n) {
+    static uint64_t points[EDTSP_SHARD_POINTS];   // hash << 32 | node index
+    
+    if (n > EDTSP_SHARD_MAX_NODES) n = EDTSP_SHARD_MAX_NODES;
+    if (n < 0) n = 0;
+    
+    // Sorted IDs: the same set gives the same ring on every master
+    memcpy(r->ids, ids, (size_t)n * sizeof(ids[0]));
+    qsort(r->ids, (size_t)n, sizeof(r->ids[0]), cmp_u32);
+    r->nodes = n;
+    r->points = 0;
+    
+    for (int i = 0; i < n; i++) {
+        uint32_t seed = edtsp_shard_hash(r->ids[i]);
+        for (uint32_t v = 0; v < EDTSP_SHARD_VNODES; v++) {
+            uint32_t h = edtsp_shard_hash(seed + v * 0x9E3779B9u);
+            points[r->points++] = (uint64_t)h << 32 | (uint32_t)i;
+        }
+    }
+    qsort(points, (size_t)r->points, sizeof(points[0]), cmp_u64);
+    
+    for (int i = 0; i < r->points; i++) {
+        r->hash[i] = (uint32_t)(points[i] >> 32);
+        r->owner[i] = (uint8_t)points[i];
+    }
+}
+
+uint32_t edtsp_shard_ring_lookup(const EDTSPShardRing *r, uint32_t device_id) {
+    if (!r->points) return 0;
+    
+    // First point at or after the key, wrapping past the top. Halving
+    // without a data-dependent branch: random keys defeat the predictor.
+    uint32_t key = edtsp_shard_hash(device_id);
+    int lo = 0;
+    for (int n = r->points; n > 1; n -= n / 2) {
+        lo = r->hash[lo + n / 2 - 1] < key ? lo + n / 2 : lo;
+    }
+    lo += r->hash[lo] < key;
+    if (lo == r->points) lo = 0;
+    return r->ids[r->owner[lo]];
+}
+
+// ============================================================================
+// MASTER (assignment)
+// ============================================================================
+
+static int find_node(uint32_t device_id) {
+    for (int i = 0; i < node_count; i++) {
+        if (nodes[i].id == device_id) return i;
+    }
+    return -1;
+}
+
+static void rebuild(void) {
+    uint32_t ids[EDTSP_SHARD_MAX_NODES];
+    for (int i = 0; i < node_count; i++) ids[i] = nodes[i].id;
+    edtsp_shard_ring_build(&ring, ids, node_count);
+    stats.ring_changes++;
+    stats.last_moved = 0;
+}
+
+void edtsp_shard_init(uint32_t self_id) {
+    my_id = self_id;
+    node_count = 0;
+    memset(&ring, 0, sizeof(ring));
+    memset(assigned, 0, sizeof(assigned));
+    memset(&my_target, 0, sizeof(my_target));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void edtsp_shard_on_ingest(uint32_t device_id, uint32_t addr, uint16_t port, uint64_t now_ms) {
+    int i = find_node(device_id);
+    
+    if (!port) {
+        // Stopped ingesting (restarted without --ingest)
+        if (i < 0) return;
+        nodes[i] = nodes[--node_count];
+        printf("[SHARD] Ingest node 0x%08X left (%d node(s))\n", device_id, node_count);
+        rebuild();
+        return;
+    }
+    
+    if (i < 0) {
+        if (node_count == EDTSP_SHARD_MAX_NODES) return;
+        i = node_count++;
+        nodes[i].id = device_id;
+        nodes[i].addr = addr;
+        nodes[i].port = port;
+        nodes[i].last_ms = now_ms;
+        printf("[SHARD] Ingest node 0x%08X at %u.%u.%u.%u:%u joined (%d node(s))\n", device_id,
+               addr >> 24, (addr >> 16) & 0xFF, (addr >> 8) & 0xFF, addr & 0xFF, port, node_count);
+        rebuild();
+        return;
+    }
+    
+    // A new address only needs fresh CONFIGs, not a new ring
+    nodes[i].addr = addr;
+    nodes[i].port = port;
+    nodes[i].last_ms = now_ms;
+}
+
+void edtsp_shard_check_timeouts(uint64_t now_ms) {
+    bool changed = false;
+    
+    for (int i = 0; i < node_count; i++) {
+        if (nodes[i].id == my_id || now_ms - nodes[i].last_ms <= EDTSP_HEARTBEAT_TIMEOUT_MS) continue;
+        printf("[SHARD] Ingest node 0x%08X timed out (%d node(s) left)\n", nodes[i].id, node_count - 1);
+        nodes[i--] = nodes[--node_count];
+        changed = true;
+    }
+    if (changed) rebuild();
+}
+
+int edtsp_shard_nodes(void) {
+    return node_count;
+}
+
+bool edtsp_shard_assign(int slot, uint32_t slave_id, uint64_t now_ms, EDTSPShardTarget *target) {
+    if (slot < 0 || slot >= EDTSP_MAX_DEVICES) return false;
+    
+    Assignment *a = &assigned[slot];
+    memset(target, 0, sizeof(*target));
+    
+    // Ingest nodes keep their own DATA with the master
+    int n = find_node(slave_id) < 0 ? find_node(edtsp_shard_ring_lookup(&ring, slave_id)) : -1;
+    if (n >= 0) {
+        target->id = nodes[n].id;
+        target->addr = nodes[n].addr;
+        target->port = nodes[n].port;
+    }
+    
+    // New slot holder: it sends to the master until told otherwise
+    bool fresh = a->slave != slave_id;
+    if (fresh) {
+        memset(a, 0, sizeof(*a));
+        a->slave = slave_id;
+    }
+    
+    bool same = a->target.id == target->id && a->target.addr == target->addr &&
+                a->target.port == target->port;
+    if (same && (!target->id || now_ms - a->sent_ms < EDTSP_SHARD_REFRESH_MS)) return false;
+    
+    if (!fresh && a->target.id != target->id) {
+        stats.moved++;
+        stats.last_moved++;
+    }
+    a->target = *target;
+    a->sent_ms = now_ms;
+    stats.configs++;
+    return true;
+}
+
+// ============================================================================
+// SLAVE / INGEST NODE
+// ============================================================================
+
+void edtsp_shard_set_target(const EDTSPShardTarget *target) {
+    my_target = *target;
+}
+
+const EDTSPShardTarget *edtsp_shard_target(void) {
+    return &my_target;
+}
+
+void edtsp_shard_on_fallback(void) {
+    stats.fallbacks++;
+}
+
+void edtsp_shard_on_data(void) {
+    stats.ingested++;
+}
+
+const EDTSPShardStats *edtsp_shard_stats(void) {
+    return &stats;
+}
+
+void edtsp_shard_print(void) {
+    if (!node_count && !my_target.id && !stats.ingested && !stats.configs) return;
+    
+    printf("[STATS] === Sharded Ingest ===\n");
+    if (my_target.id) {
+        uint32_t a = my_target.addr;
+        printf("  DATA to ingest node 0x%08X at %u.%u.%u.%u:%u, %u frame(s) to the group while it was gone\n",
+               my_target.id, a >> 24, (a >> 16) & 0xFF, (a >> 8) & 0xFF, a & 0xFF, my_target.port,
+               stats.fallbacks);
+    }
+    if (stats.ingested) printf("  Ingested %u DATA frame(s) on the ingest socket\n", stats.ingested);
+    
+    printf("  Ring: %d node(s) x %d points, %u change(s); %u CONFIG(s) sent, %u slave move(s), "
+           "%u by the last change\n", node_count, EDTSP_SHARD_VNODES, stats.ring_changes, stats.configs,
+           stats.moved, stats.last_moved);
+    
+    // Arc owned by each point: from the previous point up to it
+    uint64_t share[EDTSP_SHARD_MAX_NODES] = {0};
+    for (int i = 0; i < ring.points; i++) {
+        uint32_t prev = ring.hash[i ? i - 1 : ring.points - 1];
+        share[ring.owner[i]] += (uint32_t)(ring.hash[i] - prev);
+    }
+    for (int i = 0; i < ring.nodes; i++) {
+        int n = find_node(ring.ids[i]);
+        int slaves = 0;
+        for (int s = 0; s < EDTSP_MAX_DEVICES; s++) {
+            slaves += assigned[s].slave && assigned[s].target.id == ring.ids[i];
+        }
+        printf("  Node 0x%08X: %4.1f%% of the ring, %d slave(s) assigned%s\n", ring.ids[i],
+               100.0 * (double)share[i] / 4294967296.0, slaves,
+               n >= 0 && nodes[n].id == my_id ? " (this node)" : "");
+    }
+}
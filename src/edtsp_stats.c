@@ -0,0 +1,68 @@
+/**
+ * @file edtsp_stats.c
+ * @brief EDTSP Statistics Primitives
+ * 
+ * Bucket index = (exponent, top EDTSP_HIST_SUB_BITS mantissa bits), so
+ * recording is a count-leading-zeros and two shifts.
+ */
+
+#include "../include/edtsp_stats.h"
+#include <string.h>
+
+void edtsp_hist_init(EDTSPHistogram *h) {
+    if (!h) return;
+    memset(h, 0, sizeof(*h));
+    h->min = UINT32_MAX;
+}
+
+static uint32_t bucket_index(uint32_t v) {
+    if (v < (1u << EDTSP_HIST_SUB_BITS)) return v;
+    
+    uint32_t exp = 31 - (uint32_t)__builtin_clz(v);
+    uint32_t sub = (v >> (exp - EDTSP_HIST_SUB_BITS)) & ((1u << EDTSP_HIST_SUB_BITS) - 1);
+    return ((exp - EDTSP_HIST_SUB_BITS + 1) << EDTSP_HIST_SUB_BITS) | sub;
+}
+
+static uint32_t bucket_upper(uint32_t idx) {
+    if (idx < (1u << EDTSP_HIST_SUB_BITS)) return idx;
+    
+    uint32_t exp = (idx >> EDTSP_HIST_SUB_BITS) + EDTSP_HIST_SUB_BITS - 1;
+    uint32_t sub = idx & ((1u << EDTSP_HIST_SUB_BITS) - 1);
+    uint64_t base = ((uint64_t)((1u << EDTSP_HIST_SUB_BITS) | sub)) << (exp - EDTSP_HIST_SUB_BITS);
+    uint64_t upper = base + ((uint64_t)1 << (exp - EDTSP_HIST_SUB_BITS)) - 1;
+    return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+}
+
+void edtsp_hist_record(EDTSPHistogram *h, uint32_t value) {
+    if (!h) return;
+    
+    if (h->total >= EDTSP_HIST_DECAY_AT) {
+        h->total = 0;
+        for (int i = 0; i < EDTSP_HIST_BUCKETS; i++) {
+            h->counts[i] >>= 1;
+            h->total += h->counts[i];
+        }
+    }
+    
+    h->counts[bucket_index(value)]++;
+    h->total++;
+    if (value < h->min) h->min = value;
+    if (value > h->max) h->max = value;
+}
+
+uint32_t edtsp_hist_percentile(const EDTSPHistogram *h, double pct) {
+    if (!h || h->total == 0) return 0;
+    
+    uint64_t rank = (uint64_t)((pct / 100.0) * h->total + 0.5);
+    if (rank == 0) rank = 1;
+    
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < EDTSP_HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint32_t v = bucket_upper(i);
+            return v > h->max ? h->max : v;
+        }
+    }
+    return h->max;
+}
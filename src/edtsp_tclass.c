@@ -0,0 +1,124 @@
+/**
+ * @file edtsp_tclass.c
+ * @brief EDTSP Traffic Classes (control ahead of data)
+ *
+ * The class of a type is one indexed load. The DATA queue is a ring of
+ * dispatch entries plus the buffer each one points into; the producer is
+ * the receive path and the consumer the event loop, on the same thread.
+ */
+
+#include "../include/edtsp_tclass.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    EDTSPRxPacket rx;
+    void         *buf;
+} DeferredPacket;
+
+static uint8_t class_of[EDTSP_DISPATCH_TYPES];
+static DeferredPacket queue[EDTSP_TCLASS_QUEUE];
+static uint32_t head;       // Next to serve
+static uint32_t tail;       // Next free
+static EDTSPClassStats stats[EDTSP_CLASS_COUNT];
+
+void edtsp_tclass_init(void) {
+    static const uint8_t control[] = {
+        EDTSP_TYPE_DISCOVERY, EDTSP_TYPE_HEARTBEAT, EDTSP_TYPE_HANDSHAKE, EDTSP_TYPE_CONFIG,
+        EDTSP_TYPE_GROUP_CONFIG, EDTSP_TYPE_PROBE, EDTSP_TYPE_SYNC, EDTSP_TYPE_ACTUATE,
+        EDTSP_TYPE_CREDIT, EDTSP_TYPE_ZONE_SUMMARY
+    };
+    
+    memset(class_of, EDTSP_CLASS_DATA, sizeof(class_of));
+    for (size_t i = 0; i < sizeof(control); i++) class_of[control[i]] = EDTSP_CLASS_CONTROL;
+    
+    head = tail = 0;
+    memset(stats, 0, sizeof(stats));
+    for (int c = 0; c < EDTSP_CLASS_COUNT; c++) {
+        edtsp_hist_init(&stats[c].wait_us);
+        edtsp_hist_init(&stats[c].late_us);
+    }
+}
+
+void edtsp_tclass_set(uint8_t type, EDTSPTrafficClass cls) {
+    class_of[type] = (uint8_t)cls;
+}
+
+EDTSPTrafficClass edtsp_tclass_of(uint8_t type) {
+    return (EDTSPTrafficClass)class_of[type];
+}
+
+uint8_t edtsp_tclass_tos(EDTSPTrafficClass cls) {
+    return (uint8_t)((cls == EDTSP_CLASS_CONTROL ? EDTSP_DSCP_CONTROL : EDTSP_DSCP_DATA) << 2);
+}
+
+bool edtsp_tclass_defer(const EDTSPRxPacket *rx, void *buf) {
+    EDTSPClassStats *s = &stats[EDTSP_CLASS_DATA];
+    uint32_t depth = tail - head;
+    
+    if (depth == EDTSP_TCLASS_QUEUE) {
+        s->dropped++;
+        return false;
+    }
+    
+    DeferredPacket *d = &queue[tail++ & (EDTSP_TCLASS_QUEUE - 1)];
+    d->rx = *rx;
+    d->buf = buf;
+    if (depth + 1 > s->peak_depth) s->peak_depth = depth + 1;
+    return true;
+}
+
+bool edtsp_tclass_next(EDTSPRxPacket *rx, void **buf) {
+    if (head == tail) return false;
+    
+    const DeferredPacket *d = &queue[head++ & (EDTSP_TCLASS_QUEUE - 1)];
+    *rx = d->rx;
+    *buf = d->buf;
+    return true;
+}
+
+uint32_t edtsp_tclass_backlog(void) {
+    return tail - head;
+}
+
+void edtsp_tclass_on_rx(EDTSPTrafficClass cls, uint32_t wait_us) {
+    stats[cls].rx++;
+    edtsp_hist_record(&stats[cls].wait_us, wait_us);
+}
+
+void edtsp_tclass_on_tx(EDTSPTrafficClass cls) {
+    stats[cls].tx++;
+}
+
+void edtsp_tclass_on_late(EDTSPTrafficClass cls, uint32_t late_us) {
+    edtsp_hist_record(&stats[cls].late_us, late_us);
+}
+
+const EDTSPClassStats *edtsp_tclass_stats(EDTSPTrafficClass cls) {
+    return &stats[cls];
+}
+
+void edtsp_tclass_print(void) {
+    static const char *names[EDTSP_CLASS_COUNT] = { "Control", "Data" };
+    
+    printf("[STATS] === Traffic Classes ===\n");
+    for (int c = 0; c < EDTSP_CLASS_COUNT; c++) {
+        const EDTSPClassStats *s = &stats[c];
+        printf("  %-7s DSCP %2u: rx=%u tx=%u", names[c], edtsp_tclass_tos((EDTSPTrafficClass)c) >> 2,
+               s->rx, s->tx);
+        if (c == EDTSP_CLASS_DATA) {
+            printf(" queued now=%u peak=%u dropped=%u", edtsp_tclass_backlog(), s->peak_depth, s->dropped);
+        }
+        printf("\n");
+        if (s->wait_us.total) {
+            printf("          Rx wait (us): p50=%u p99=%u max=%u\n",
+                   edtsp_hist_percentile(&s->wait_us, 50), edtsp_hist_percentile(&s->wait_us, 99),
+                   s->wait_us.max);
+        }
+        if (s->late_us.total) {
+            printf("          Tx late (us): p50=%u p99=%u max=%u\n",
+                   edtsp_hist_percentile(&s->late_us, 50), edtsp_hist_percentile(&s->late_us, 99),
+                   s->late_us.max);
+        }
+    }
+}
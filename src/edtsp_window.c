@@ -0,0 +1,168 @@
+/**
+ * @file edtsp_window.c
+ * @brief EDTSP Windowed Aggregation (slave-side summaries)
+ *
+ * The per-sample path touches only the EDTSPWindow fields; the divisions
+ * and the square root happen in close_window, once per window.
+ */
+
+#include "../include/edtsp_window.h"
+#include <stdio.h>
+#include <string.h>
+
+/** Bytes on the wire: one summary vs one raw sample (DATA + 4-byte value) */
+#define SUMMARY_FRAME_LEN (offsetof(EDTSPDataPacket, data) + EDTSP_WINDOW_RECORD_LEN)
+#define SAMPLE_FRAME_LEN  (offsetof(EDTSPDataPacket, data) + 4)
+
+static EDTSPSummaryStats sensor_stats[16];
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// ============================================================================
+// SLAVE
+// ============================================================================
+
+void edtsp_window_configure(EDTSPWindow *w, uint32_t window_ms) {
+    w->window_ms = window_ms;
+    w->count = 0;
+}
+
+/** Bitwise integer square root (floor), no FPU needed */
+static uint32_t isqrt64(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = 1ull << 62;
+    
+    while (bit > x) bit >>= 2;
+    while (bit) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+static void close_window(EDTSPWindow *w, EDTSPWindowSummary *out) {
+    int64_t half = w->count / 2;
+    
+    out->start_ms = w->start_ms;
+    out->count = w->count;
+    out->min = w->min;
+    out->max = w->max;
+    out->mean = (int32_t)((w->sum >= 0 ? w->sum + half : w->sum - half) / w->count);
+    out->rms = isqrt64(w->sum_sq / w->count);
+    w->windows++;
+}
+
+bool edtsp_window_sample(EDTSPWindow *w, int32_t value, uint32_t now_ms, EDTSPWindowSummary *out) {
+    bool closed = false;
+    
+    w->samples++;
+    
+    // Close on time, or before the count would wrap
+    if (w->count && (now_ms - w->start_ms >= w->window_ms || w->count == UINT16_MAX)) {
+        close_window(w, out);
+        w->count = 0;
+        closed = true;
+    }
+    
+    if (!w->count) {
+        w->start_ms = now_ms;
+        w->min = value;
+        w->max = value;
+        w->sum = 0;
+        w->sum_sq = 0;
+    }
+    
+    if (value < w->min) w->min = value;
+    if (value > w->max) w->max = value;
+    w->sum += value;
+    w->sum_sq += (uint64_t)((int64_t)value * value);
+    w->count++;
+    return closed;
+}
+
+uint8_t edtsp_window_record(const EDTSPWindowSummary *s, uint8_t *out) {
+    put_u32(out, (uint32_t)s->min);
+    put_u32(out + 4, (uint32_t)s->max);
+    put_u32(out + 8, (uint32_t)s->mean);
+    put_u32(out + 12, s->rms);
+    out[16] = (uint8_t)(s->count >> 8);
+    out[17] = (uint8_t)s->count;
+    return EDTSP_WINDOW_RECORD_LEN;
+}
+
+void edtsp_window_print(const EDTSPWindow *windows, int count) {
+    bool header = false;
+    
+    for (int i = 0; i < count; i++) {
+        const EDTSPWindow *w = &windows[i];
+        if (!w->windows) continue;
+        
+        if (!header) printf("[STATS] === Window Aggregation (slave) ===\n");
+        header = true;
+        unsigned long raw = (unsigned long)w->samples * SAMPLE_FRAME_LEN;
+        unsigned long sent = (unsigned long)w->windows * SUMMARY_FRAME_LEN;
+        printf("  Sensor %d: window=%u ms, %u samples, %u summaries, %lu of %lu bytes (%.1f%% saved)\n",
+               i, w->window_ms, w->samples, w->windows, sent, raw,
+               raw > sent ? 100.0 * (raw - sent) / raw : 0.0);
+    }
+}
+
+// ============================================================================
+// MASTER
+// ============================================================================
+
+void edtsp_summary_init(void) {
+    memset(sensor_stats, 0, sizeof(sensor_stats));
+}
+
+bool edtsp_summary_on_data(const EDTSPDataPacket *pkt, EDTSPWindowSummary *out) {
+    if (pkt->data_len != EDTSP_WINDOW_RECORD_LEN || pkt->sensor_id >= 16) return false;
+    
+    const uint8_t *d = pkt->data;
+    out->start_ms = pkt->timestamp_ms;
+    out->min = (int32_t)get_u32(d);
+    out->max = (int32_t)get_u32(d + 4);
+    out->mean = (int32_t)get_u32(d + 8);
+    out->rms = get_u32(d + 12);
+    out->count = (uint16_t)(d[16] << 8 | d[17]);
+    if (!out->count || out->min > out->max) return false;
+    
+    EDTSPSummaryStats *st = &sensor_stats[pkt->sensor_id];
+    st->summaries++;
+    st->samples += out->count;
+    return true;
+}
+
+const EDTSPSummaryStats *edtsp_summary_stats(uint8_t sensor_id) {
+    return &sensor_stats[sensor_id & 15];
+}
+
+void edtsp_summary_print(void) {
+    bool header = false;
+    
+    for (int i = 0; i < 16; i++) {
+        const EDTSPSummaryStats *st = &sensor_stats[i];
+        if (!st->summaries) continue;
+        
+        if (!header) printf("[STATS] === Window Aggregation (master) ===\n");
+        header = true;
+        unsigned long raw = (unsigned long)st->samples * SAMPLE_FRAME_LEN;
+        unsigned long sent = (unsigned long)st->summaries * SUMMARY_FRAME_LEN;
+        printf("  Sensor %d: %u summaries covering %u samples, %lu of %lu bytes (%.1f%% saved)\n",
+               i, st->summaries, st->samples, sent, raw, raw > sent ? 100.0 * (raw - sent) / raw : 0.0);
+    }
+}
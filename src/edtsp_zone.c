@@ -0,0 +1,360 @@
+/**
+ * @file edtsp_zone.c
+ * @brief EDTSP Hierarchical Zones (sub-masters and a top master)
+ *
+ * Zone IDs are small and dense, so the top tier indexes its table by
+ * zone directly: a summary costs one bounds check and no lookup. The
+ * top election only reruns when the set of sub-masters changes (new
+ * zone, handover, timeout), not for every refresh.
+ */
+
+#include "../include/edtsp_zone.h"
+#include "../include/edtsp_hash.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint16_t my_zone;
+static uint32_t my_id;
+static EDTSPZoneAgg local;
+static bool uplink_up;
+static uint32_t top_id;
+static EDTSPZoneEntry zones[EDTSP_ZONE_MAX_ID + 1];
+static EDTSPZoneStats stats;
+
+uint32_t edtsp_zone_member_hash(uint32_t device_id) {
+    return edtsp_hash_mix32(device_id);
+}
+
+static inline int16_t clamp16(int32_t v) {
+    return (int16_t)(v > INT16_MAX ? INT16_MAX : v < INT16_MIN ? INT16_MIN : v);
+}
+
+static void fold(EDTSPZoneSensorAgg *s, uint32_t count, int32_t min, int32_t max, int64_t sum) {
+    if (!count) return;
+    if (!s->samples || min < s->min) s->min = min;
+    if (!s->samples || max > s->max) s->max = max;
+    s->samples += count;
+    s->sum += sum;
+}
+
+// ============================================================================
+// SUB-MASTER (aggregation)
+// ============================================================================
+
+void edtsp_zone_agg_reset(EDTSPZoneAgg *a, uint64_t now_ms) {
+    memset(a, 0, sizeof(*a));
+    a->start_ms = now_ms;
+}
+
+void edtsp_zone_agg_member(EDTSPZoneAgg *a, uint32_t device_id, bool joined) {
+    a->digest ^= edtsp_zone_member_hash(device_id);
+    if (joined) {
+        a->members++;
+        a->joins++;
+    } else {
+        if (a->members) a->members--;
+        a->leaves++;
+    }
+}
+
+void edtsp_zone_agg_frame(EDTSPZoneAgg *a, uint16_t payload_bytes) {
+    a->frames++;
+    a->bytes += payload_bytes;
+}
+
+void edtsp_zone_agg_samples(EDTSPZoneAgg *a, uint8_t sensor, const int32_t *values, int n) {
+    if (sensor >= EDTSP_ZONE_SENSORS || n <= 0) return;
+    
+    int32_t min = values[0], max = values[0];
+    int64_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        if (values[i] < min) min = values[i];
+        if (values[i] > max) max = values[i];
+        sum += values[i];
+    }
+    fold(&a->sensors[sensor], (uint32_t)n, min, max, sum);
+    a->sensor_mask |= (uint16_t)(1u << sensor);
+}
+
+void edtsp_zone_agg_window(EDTSPZoneAgg *a, uint8_t sensor, uint32_t count,
+                           int32_t min, int32_t max, int32_t mean) {
+    if (sensor >= EDTSP_ZONE_SENSORS || !count) return;
+    
+    fold(&a->sensors[sensor], count, min, max, (int64_t)mean * count);
+    a->sensor_mask |= (uint16_t)(1u << sensor);
+}
+
+static inline void put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void put32(uint8_t *p, uint32_t v) {
+    put16(p, (uint16_t)(v >> 16));
+    put16(p + 2, (uint16_t)v);
+}
+
+size_t edtsp_zone_agg_build(EDTSPZoneAgg *a, EDTSPZoneSummaryPacket *pkt, uint32_t source_id,
+                            uint16_t zone, uint8_t role, uint64_t now_ms) {
+    memset(pkt, 0, offsetof(EDTSPZoneSummaryPacket, body));
+    int pos = 0;
+    int count = 0;
+    
+    for (int s = 0; s < EDTSP_ZONE_SENSORS; s++) {
+        if (!(a->sensor_mask & (1u << s))) continue;
+        const EDTSPZoneSensorAgg *agg = &a->sensors[s];
+        int64_t mean = agg->sum >= 0 ? (agg->sum + agg->samples / 2) / agg->samples
+                                     : (agg->sum - agg->samples / 2) / agg->samples;
+        uint8_t *r = pkt->body + pos;
+        r[0] = (uint8_t)s;
+        put32(r + 1, agg->samples);
+        put16(r + 5, (uint16_t)clamp16(agg->min));
+        put16(r + 7, (uint16_t)clamp16(agg->max));
+        put16(r + 9, (uint16_t)clamp16((int32_t)mean));
+        pos += EDTSP_ZONE_RECORD_SIZE;
+        count++;
+    }
+    
+    size_t frame_len = offsetof(EDTSPZoneSummaryPacket, body) + (size_t)pos;
+    pkt->header.magic = EDTSP_WIRE16(EDTSP_MAGIC);
+    pkt->header.type = EDTSP_TYPE_ZONE_SUMMARY;
+    pkt->header.source_id = EDTSP_WIRE32(source_id);
+    pkt->header.payload_len = (uint8_t)(frame_len - sizeof(EDTSPHeader));
+    
+    pkt->zone_id = zone;
+    pkt->role = role;
+    pkt->sensor_count = (uint8_t)count;
+    pkt->members = a->members;
+    pkt->joins = a->joins;
+    pkt->leaves = a->leaves;
+    pkt->member_digest = a->digest;
+    pkt->interval_ms = (uint32_t)(now_ms - a->start_ms);
+    pkt->data_frames = a->frames;
+    pkt->data_bytes = a->bytes;
+    pkt->body_len = (uint8_t)pos;
+    edtsp_encode_zone_summary(pkt);
+    
+    // Next interval: membership carries over
+    a->joins = a->leaves = 0;
+    a->frames = a->bytes = 0;
+    a->sensor_mask = 0;
+    memset(a->sensors, 0, sizeof(a->sensors));
+    a->start_ms = now_ms;
+    return frame_len;
+}
+
+// ============================================================================
+// NODE
+// ============================================================================
+
+void edtsp_zone_init(uint16_t zone, uint32_t self_id) {
+    my_zone = zone;
+    my_id = self_id;
+    edtsp_zone_agg_reset(&local, 0);
+    edtsp_zone_agg_member(&local, self_id, true);
+    local.joins = 0;
+    uplink_up = false;
+    top_id = 0;
+    memset(zones, 0, sizeof(zones));
+    memset(&stats, 0, sizeof(stats));
+}
+
+uint16_t edtsp_zone_id(void) {
+    return my_zone;
+}
+
+EDTSPZoneAgg *edtsp_zone_agg(void) {
+    return &local;
+}
+
+void edtsp_zone_on_member(uint32_t device_id, bool joined) {
+    if (my_zone) edtsp_zone_agg_member(&local, device_id, joined);
+}
+
+// ============================================================================
+// TOP TIER (uplink)
+// ============================================================================
+
+/** Highest SourceID among live sub-masters, self included while on the uplink */
+static void elect(void) {
+    uint32_t top = uplink_up ? my_id : 0;
+    
+    for (int z = 1; z <= EDTSP_ZONE_MAX_ID; z++) {
+        if (zones[z].active && zones[z].sub_master > top) top = zones[z].sub_master;
+    }
+    if (top == top_id) return;
+    
+    if (top) {
+        printf("[ZONE] *** TOP MASTER: 0x%08X%s ***\n", top, top == my_id ? " (this node)" : "");
+    }
+    top_id = top;
+    stats.top_changes++;
+}
+
+void edtsp_zone_set_uplink(bool up, uint64_t now_ms) {
+    if (up == uplink_up) return;
+    
+    uplink_up = up;
+    memset(zones, 0, sizeof(zones));
+    local.start_ms = now_ms;
+    printf("[ZONE] %s the uplink for zone %u\n", up ? "Sub-master: joined" : "Left", my_zone);
+    elect();
+}
+
+bool edtsp_zone_uplink(void) {
+    return uplink_up;
+}
+
+bool edtsp_zone_summary_valid(const EDTSPZoneSummaryPacket *pkt, size_t len) {
+    if (len < offsetof(EDTSPZoneSummaryPacket, body) + pkt->body_len) return false;
+    if (pkt->body_len > EDTSP_ZONE_BODY_MAX) return false;
+    if (pkt->sensor_count * EDTSP_ZONE_RECORD_SIZE > pkt->body_len) return false;
+    return pkt->zone_id >= 1 && pkt->zone_id <= EDTSP_ZONE_MAX_ID;
+}
+
+static inline uint32_t get32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline int16_t get16(const uint8_t *p) {
+    return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+bool edtsp_zone_on_summary(uint32_t source_id, const EDTSPZoneSummaryPacket *pkt, size_t len,
+                           uint64_t now_ms) {
+    if (!uplink_up || !edtsp_zone_summary_valid(pkt, len)) {
+        stats.rejected++;
+        return false;
+    }
+    
+    EDTSPZoneEntry *e = &zones[pkt->zone_id];
+    bool reelect = !e->active;
+    
+    if (e->sub_master != source_id) {
+        // Zone election rule: a higher ID wins at once, a lower one only
+        // takes over from a holder that has gone quiet
+        if (e->active && source_id < e->sub_master && now_ms - e->last_ms <= EDTSP_ZONE_HANDOVER_MS) {
+            stats.rejected++;
+            return false;
+        }
+        if (e->sub_master) {
+            e->handovers++;
+            printf("[ZONE] Zone %u handed over: 0x%08X -> 0x%08X\n",
+                   pkt->zone_id, e->sub_master, source_id);
+        }
+        e->sub_master = source_id;
+        reelect = true;
+    }
+    
+    if (e->summaries && (pkt->joins || pkt->leaves || pkt->member_digest != e->digest)) {
+        e->membership_changes++;
+    }
+    e->active = true;
+    e->last_ms = now_ms;
+    e->members = pkt->members;
+    e->digest = pkt->member_digest;
+    e->frames_per_s = pkt->interval_ms ? (uint32_t)((uint64_t)pkt->data_frames * 1000 / pkt->interval_ms) : 0;
+    e->frames += pkt->data_frames;
+    e->bytes += pkt->data_bytes;
+    e->summaries++;
+    
+    stats.summaries++;
+    stats.frames += pkt->data_frames;
+    stats.bytes += pkt->data_bytes;
+    for (int i = 0; i < pkt->sensor_count; i++) {
+        const uint8_t *r = pkt->body + i * EDTSP_ZONE_RECORD_SIZE;
+        uint32_t samples = get32(r + 1);
+        if (r[0] >= EDTSP_ZONE_SENSORS || !samples) continue;
+        fold(&stats.sensors[r[0]], samples, get16(r + 5), get16(r + 7), (int64_t)get16(r + 9) * samples);
+    }
+    
+    if (reelect) elect();
+    return true;
+}
+
+size_t edtsp_zone_summary(EDTSPZoneSummaryPacket *pkt, uint64_t now_ms) {
+    if (!uplink_up) return 0;
+    
+    size_t len = edtsp_zone_agg_build(&local, pkt, my_id, my_zone,
+                                      top_id == my_id ? EDTSP_ROLE_MASTER : EDTSP_ROLE_SLAVE, now_ms);
+    
+    EDTSPZoneSummaryPacket own;
+    memcpy(&own, pkt, len);
+    edtsp_decode_zone_summary(&own);
+    edtsp_zone_on_summary(my_id, &own, len, now_ms);
+    return len;
+}
+
+void edtsp_zone_check_timeouts(uint64_t now_ms) {
+    bool changed = false;
+    
+    for (int z = 1; z <= EDTSP_ZONE_MAX_ID; z++) {
+        EDTSPZoneEntry *e = &zones[z];
+        if (!e->active || now_ms - e->last_ms <= EDTSP_HEARTBEAT_TIMEOUT_MS) continue;
+        
+        printf("[ZONE] Zone %u silent: sub-master 0x%08X timed out\n", z, e->sub_master);
+        e->active = false;
+        changed = true;
+    }
+    if (changed) elect();
+}
+
+uint32_t edtsp_zone_top_id(void) {
+    return top_id;
+}
+
+bool edtsp_zone_is_top(void) {
+    return uplink_up && top_id == my_id;
+}
+
+const EDTSPZoneEntry *edtsp_zone_entry(uint16_t zone) {
+    if (zone < 1 || zone > EDTSP_ZONE_MAX_ID) return NULL;
+    return &zones[zone];
+}
+
+const EDTSPZoneStats *edtsp_zone_stats(void) {
+    stats.zones = 0;
+    stats.members = 0;
+    stats.frames_per_s = 0;
+    for (int z = 1; z <= EDTSP_ZONE_MAX_ID; z++) {
+        if (!zones[z].active) continue;
+        stats.zones++;
+        stats.members += zones[z].members;
+        stats.frames_per_s += zones[z].frames_per_s;
+    }
+    return &stats;
+}
+
+void edtsp_zone_print(void) {
+    if (!my_zone) return;
+    
+    const EDTSPZoneStats *st = edtsp_zone_stats();
+    printf("[STATS] === Zones ===\n");
+    printf("  Zone %u: %u member(s), digest 0x%08X; %s\n", my_zone, local.members, local.digest,
+           !uplink_up ? "not on the uplink" : edtsp_zone_is_top() ? "sub-master, TOP MASTER"
+                                                                  : "sub-master");
+    if (!uplink_up) return;
+    
+    printf("  Top master 0x%08X: %u zone(s), %u device(s), %u DATA frames/s "
+           "(%u summaries, %u rejected, %u top change(s))\n", top_id, st->zones, st->members,
+           st->frames_per_s, st->summaries, st->rejected, st->top_changes);
+    
+    int shown = 0;
+    for (int z = 1; z <= EDTSP_ZONE_MAX_ID; z++) {
+        const EDTSPZoneEntry *e = &zones[z];
+        if (!e->active) continue;
+        if (shown++ == 16) {
+            printf("  ... %u more zone(s)\n", st->zones - 16);
+            break;
+        }
+        printf("  Zone %d: sub-master 0x%08X, %u member(s), %u frames/s, "
+               "%u membership change(s), %u handover(s)\n", z, e->sub_master, e->members,
+               e->frames_per_s, e->membership_changes, e->handovers);
+    }
+    for (int s = 0; s < EDTSP_ZONE_SENSORS; s++) {
+        const EDTSPZoneSensorAgg *agg = &st->sensors[s];
+        if (!agg->samples) continue;
+        printf("  Sensor %d: %u samples, min=%d max=%d mean=%lld\n", s, agg->samples, agg->min,
+               agg->max, (long long)(agg->sum / agg->samples));
+    }
+}
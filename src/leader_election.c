@@ -6,6 +6,15 @@
  */
 
 #include "../include/protocol.h"
+#include "../include/edtsp_rtt.h"
+#include "../include/edtsp_devindex.h"
+#include "../include/edtsp_handshake.h"
+#include "../include/edtsp_capdesc.h"
+#include "../include/edtsp_ratelimit.h"
+#include "../include/edtsp_aead.h"
+#include "../include/edtsp_auth.h"
+#include "../include/edtsp_dedup.h"
+#include "../include/edtsp_zone.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -17,13 +26,17 @@ typedef struct {
     uint32_t device_id;           /**< Device unique ID */
     uint64_t last_heartbeat_ms;   /**< Last received heartbeat timestamp */
     uint8_t  role;                /**< Current role (Master/Slave) */
+    uint8_t  version;             /**< Highest protocol version announced (0 = unknown) */
     bool     active;              /**< Is device active? */
 } EDTSPDeviceInfo;
 
 static EDTSPDeviceInfo device_list[EDTSP_MAX_DEVICES];
-static uint8_t device_count = 0;
+static uint16_t device_count = 0;
 static uint32_t my_device_id = 0;
 static uint8_t my_role = EDTSP_ROLE_UNKNOWN;
+static uint32_t master_id = 0;
+static uint8_t min_version = EDTSP_VERSION;
+static bool min_version_dirty = false;
 
 // Forward declaration
 void edtsp_perform_election(void);
@@ -37,6 +50,9 @@ void edtsp_election_init(uint32_t device_id) {
     device_count = 0;
     memset(device_list, 0, sizeof(device_list));
     my_role = EDTSP_ROLE_UNKNOWN;
+    master_id = 0;
+    edtsp_index_init();
+    edtsp_capdesc_init();
 }
 
 // ============================================================================
@@ -52,23 +68,87 @@ static int find_device_index(uint32_t device_id) {
     return -1;
 }
 
-void edtsp_update_device(uint32_t device_id, uint64_t timestamp_ms, uint8_t role) {
+/**
+ * Record liveness of a device
+ * 
+ * @return true if the device is new or came back from timeout
+ */
+bool edtsp_update_device(uint32_t device_id, uint64_t timestamp_ms, uint8_t role) {
     int idx = find_device_index(device_id);
+    bool joined = false;
     
     if (idx == -1) {
         // New device
         if (device_count >= EDTSP_MAX_DEVICES) {
             printf("[ELECTION] WARNING: Device list full!\n");
-            return;
+            return false;
         }
         idx = device_count++;
         device_list[idx].device_id = device_id;
         printf("[ELECTION] New device discovered: ID=0x%08X\n", device_id);
     }
     
+    if (!device_list[idx].active) {
+        joined = true;
+        min_version_dirty = true;
+        edtsp_index_set_active(idx, device_id, true);
+        edtsp_ratelimit_set_known(device_id, true);
+        edtsp_zone_on_member(device_id, true);
+    }
+    
     device_list[idx].last_heartbeat_ms = timestamp_ms;
     device_list[idx].role = role;
     device_list[idx].active = true;
+    return joined;
+}
+
+void edtsp_set_device_version(uint32_t device_id, uint8_t version) {
+    int idx = find_device_index(device_id);
+    if (idx == -1 || device_list[idx].version == version) return;
+    
+    device_list[idx].version = version;
+    min_version_dirty = true;
+}
+
+/** Capabilities reported in a HANDSHAKE (capability index) */
+void edtsp_set_device_capabilities(uint32_t device_id, EDTSPCapabilityMask caps) {
+    int idx = find_device_index(device_id);
+    if (idx != -1) edtsp_index_set_capabilities(idx, caps);
+}
+
+/** Device table slot (device index, capability descriptors); -1 if unknown */
+int edtsp_get_device_slot(uint32_t device_id) {
+    return find_device_index(device_id);
+}
+
+/** True while a device is heard from (slots outlive timeouts) */
+bool edtsp_is_device_active(uint32_t device_id) {
+    int idx = find_device_index(device_id);
+    return idx != -1 && device_list[idx].active;
+}
+
+/** Interface announced in a DISCOVERY (interface index) */
+void edtsp_set_device_interface(uint32_t device_id, uint8_t iface_type) {
+    int idx = find_device_index(device_id);
+    if (idx != -1) edtsp_index_set_interface(idx, iface_type);
+}
+
+/**
+ * Protocol version every active peer can decode (cached)
+ * 
+ * Peers that never announced a version count as v1.
+ */
+uint8_t edtsp_get_min_peer_version(void) {
+    if (!min_version_dirty) return min_version;
+    
+    min_version = EDTSP_VERSION;
+    for (int i = 0; i < device_count; i++) {
+        if (!device_list[i].active) continue;
+        uint8_t v = device_list[i].version ? device_list[i].version : 1;
+        if (v < min_version) min_version = v;
+    }
+    min_version_dirty = false;
+    return min_version;
 }
 
 void edtsp_check_timeouts(uint64_t current_time_ms) {
@@ -77,12 +157,24 @@ void edtsp_check_timeouts(uint64_t current_time_ms) {
     for (int i = 0; i < device_count; i++) {
         if (!device_list[i].active) continue;
         
+        // Slow links (high RTT/jitter) get proportionally more slack
+        uint64_t timeout = 3 * EDTSP_HEARTBEAT_INTERVAL_MS + edtsp_rtt_rto_ms(device_list[i].device_id);
+        if (timeout < EDTSP_HEARTBEAT_TIMEOUT_MS) timeout = EDTSP_HEARTBEAT_TIMEOUT_MS;
+        
         uint64_t elapsed = current_time_ms - device_list[i].last_heartbeat_ms;
-        if (elapsed > EDTSP_HEARTBEAT_TIMEOUT_MS) {
+        if (elapsed > timeout) {
             printf("[ELECTION] Device timeout: ID=0x%08X (last seen %lu ms ago)\n",
                    device_list[i].device_id, elapsed);
             device_list[i].active = false;
+            edtsp_index_set_active(i, device_list[i].device_id, false);
+            edtsp_ratelimit_set_known(device_list[i].device_id, false);
+            edtsp_hs_forget(device_list[i].device_id);
+            edtsp_aead_forget(device_list[i].device_id);
+            edtsp_auth_forget(device_list[i].device_id);
+            edtsp_dedup_forget(device_list[i].device_id);
+            edtsp_zone_on_member(device_list[i].device_id, false);
             topology_changed = true;
+            min_version_dirty = true;
         }
     }
     
@@ -113,6 +205,8 @@ void edtsp_perform_election(void) {
         }
     }
     
+    master_id = highest_id;
+    
     // Determine new role
     if (highest_id == my_device_id) {
         my_role = EDTSP_ROLE_MASTER;
@@ -132,14 +226,27 @@ EDTSPRole edtsp_get_my_role(void) {
     return my_role;
 }
 
-uint8_t edtsp_get_active_device_count(void) {
-    uint8_t count = 1; // Include self
+uint16_t edtsp_get_active_device_count(void) {
+    uint16_t count = 1; // Include self
     for (int i = 0; i < device_count; i++) {
         if (device_list[i].active) count++;
     }
     return count;
 }
 
+int edtsp_get_active_device_ids(uint32_t *ids, int max) {
+    int n = 0;
+    for (int i = 0; i < device_count && n < max; i++) {
+        if (device_list[i].active) ids[n++] = device_list[i].device_id;
+    }
+    return n;
+}
+
+/** Current master (own ID when master) */
+uint32_t edtsp_get_master_id(void) {
+    return master_id;
+}
+
 bool edtsp_is_master(void) {
     return my_role == EDTSP_ROLE_MASTER;
 }
@@ -0,0 +1,2153 @@
+/**
+ * @file edtsp_bench.c
+ * @brief EDTSP Micro-Benchmarks
+ * 
+ * Measures the per-packet cost of protocol hot paths in isolation
+ * (no sockets). Usage: edtsp_bench [name]   (no name = run all)
+ * Exits non-zero if a known-answer check fails.
+ */
+
+#include "../../include/protocol.h"
+#include "../../include/edtsp_dedup.h"
+#include "../../include/edtsp_clocksync.h"
+#include "../../include/edtsp_dispatch.h"
+#include "../../include/edtsp_pool.h"
+#include "../../include/edtsp_group.h"
+#include "../../include/edtsp_devindex.h"
+#include "../../include/edtsp_handshake.h"
+#include "../../include/edtsp_capdesc.h"
+#include "../../include/edtsp_deadband.h"
+#include "../../include/edtsp_window.h"
+#include "../../include/edtsp_pack.h"
+#include "../../include/edtsp_ratelimit.h"
+#include "../../include/edtsp_flow.h"
+#include "../../include/edtsp_auth.h"
+#include "../../include/edtsp_aead.h"
+#include "../../include/edtsp_zone.h"
+#include "../../include/edtsp_shard.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// From edtsp_core.c
+extern void edtsp_build_handshake(EDTSPHandshakePacket *pkt, uint32_t source_id, uint8_t step, uint32_t target_id, EDTSPCapabilityMask caps, uint8_t iface_type);
+extern void edtsp_build_heartbeat(EDTSPHeartbeatPacket *pkt, uint32_t source_id, uint8_t role, uint32_t uptime_ms, uint16_t active_devices, uint32_t ingest_addr, uint16_t ingest_port);
+extern void edtsp_build_data(EDTSPDataPacket *pkt, uint32_t source_id, uint8_t sensor_id, uint32_t timestamp_ms, const uint8_t *data, uint8_t data_len);
+extern size_t edtsp_reframe_v2(uint8_t *out, size_t out_size, const void *v1_pkt, size_t v1_len, uint8_t flags, uint32_t seq);
+extern bool edtsp_decode_frame(uint8_t *buf, size_t len, EDTSPFrameInfo *info);
+
+// ============================================================================
+// UTILITIES
+// ============================================================================
+
+/** Optional second argument (e.g. a trace file for `pack`) */
+static const char *bench_arg;
+
+/** Known-answer checks that failed (exit status) */
+static int failed_checks;
+
+/** Count a known-answer check; returns its verdict for the report line */
+static const char *check(bool ok) {
+    if (!ok) failed_checks++;
+    return ok ? "OK" : "FAIL";
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/** xorshift32 - deterministic, cheap pseudo-random source */
+static uint32_t bench_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static void report(const char *name, uint64_t ops, uint64_t elapsed_ns) {
+    printf("  %-32s %10.1f ns/op %12.0f ops/s\n", name,
+           (double)elapsed_ns / (double)ops,
+           (double)ops * 1e9 / (double)elapsed_ns);
+}
+
+// ============================================================================
+// DUPLICATE ELIMINATION
+// ============================================================================
+
+/**
+ * Dual-path dedup: every sequence arrives twice (path A then B), with
+ * occasional reordering of neighbouring packets, from 256 sources.
+ */
+static void bench_dedup(void) {
+    enum { SOURCES = 256, PACKETS = 4000000 };
+    static uint32_t ids[SOURCES];
+    static uint16_t seqs[SOURCES];
+    uint32_t rng = 0x12345678;
+    uint32_t delivered = 0;
+    
+    printf("[BENCH] dedup (%d sources, every packet duplicated)\n", SOURCES);
+    
+    for (int i = 0; i < SOURCES; i++) {
+        ids[i] = bench_rand(&rng) | 1;
+        seqs[i] = (uint16_t)bench_rand(&rng);
+    }
+    
+    edtsp_dedup_init();
+    
+    uint64_t start = now_ns();
+    for (int i = 0; i < PACKETS; i += 2) {
+        uint32_t r = bench_rand(&rng);
+        int src = (int)(r % SOURCES);
+        uint16_t seq = seqs[src]++;
+        
+        // 1 in 16: a late copy of the previous packet shows up
+        if ((r & 0xF0000) == 0) {
+            delivered += edtsp_dedup_accept(ids[src], (uint16_t)(seq - 1), 0);
+        }
+        delivered += edtsp_dedup_accept(ids[src], seq, 0);
+        delivered += edtsp_dedup_accept(ids[src], seq, 0);
+    }
+    uint64_t elapsed = now_ns() - start;
+    
+    const EDTSPDedupStats *st = edtsp_dedup_stats();
+    report("edtsp_dedup_accept", st->accepted + st->duplicates, elapsed);
+    printf("  delivered=%u duplicates=%u resets=%u\n",
+           delivered, st->duplicates, st->window_resets);
+    
+    // Path B lags path A by 100 frames (more than the window): its copies
+    // are stale, or plain duplicates once A stops, and none may rewind the
+    // window. Then the source goes quiet and restarts from 0.
+    enum { LAG = 100, FRAMES = 10000 };
+    const uint32_t src = 0xB0B0B0B1;
+    uint32_t once = 0;
+    edtsp_dedup_init();
+    for (uint32_t i = 0; i < FRAMES + LAG; i++) {
+        uint64_t ms = i;   // One frame per millisecond
+        if (i < FRAMES) once += edtsp_dedup_accept(src, (uint16_t)i, ms);
+        if (i >= LAG) once += edtsp_dedup_accept(src, (uint16_t)(i - LAG), ms);
+    }
+    uint32_t stale = st->stale, dups = st->duplicates;
+    bool lag_ok = once == FRAMES && stale + dups == FRAMES;
+    uint64_t quiet = FRAMES + LAG + EDTSP_DEDUP_RESTART_MS;
+    bool restart_ok = edtsp_dedup_accept(src, 0, quiet) && edtsp_dedup_accept(src, 1, quiet) &&
+                      !edtsp_dedup_accept(src, 0, quiet) && st->window_resets == 1;
+    printf("  path B %d frames behind: %u of %d delivered once, %u stale, %u duplicates %s; "
+           "restart after %d ms quiet %s\n", LAG, once, FRAMES, stale, dups,
+           lag_ok ? "OK" : "FAIL", EDTSP_DEDUP_RESTART_MS, restart_ok ? "OK" : "FAIL");
+    
+    // Source 0 has a window. A full table passes new sources unchecked;
+    // a timed-out device's window is freed without breaking the probe runs
+    // through it, and an idle window goes to a new source.
+    edtsp_dedup_init();
+    bool zero_ok = edtsp_dedup_accept(0, 7, 0) && !edtsp_dedup_accept(0, 7, 0);
+    for (uint32_t id = 1; id < EDTSP_DEDUP_TABLE_SIZE; id++) edtsp_dedup_accept(id, 1, 0);
+    bool open_ok = st->sources == EDTSP_DEDUP_TABLE_SIZE && edtsp_dedup_accept(0xF00D, 1, 0) &&
+                   edtsp_dedup_accept(0xF00D, 1, 0);
+    edtsp_dedup_forget(0);
+    bool kept = st->sources == EDTSP_DEDUP_TABLE_SIZE - 1;
+    for (uint32_t id = 1; id < EDTSP_DEDUP_TABLE_SIZE; id++) kept &= !edtsp_dedup_accept(id, 1, 0);
+    bool reused = edtsp_dedup_accept(0xF00D, 1, 0) && edtsp_dedup_accept(0xBEEF, 1, EDTSP_DEDUP_IDLE_MS) &&
+                  !edtsp_dedup_accept(0xBEEF, 1, EDTSP_DEDUP_IDLE_MS) && st->sources == EDTSP_DEDUP_TABLE_SIZE;
+    printf("  source 0 %s, full table fails open %s, timed-out window freed %s, idle window reused %s\n",
+           check(zero_ok), check(open_ok), check(kept), check(reused));
+}
+
+// ============================================================================
+// CLOCK SYNC
+// ============================================================================
+
+/**
+ * Simulated slave: +50 ppm drift, large offset, millisecond counter about
+ * to wrap. Ten minutes of exchanges every 4 s with jittery RTT, then
+ * ingest conversion cost and accuracy.
+ */
+static void bench_clocksync(void) {
+    enum { SAMPLES = 4000000 };
+    const uint32_t slave = 0xC0FFEE01;
+    const double drift = 50e-6;
+    const uint64_t master_start = 1700000000000000ull;
+    const uint64_t slave_start = 0xFFFFF000ull * 1000;   // ms counter wraps in ~68 min
+    uint32_t rng = 0xBADC0DE;
+    
+    printf("[BENCH] clocksync (+50 ppm slave, 32-bit ms wrap)\n");
+    
+    edtsp_clock_init();
+    
+    uint64_t m = master_start;
+    for (int i = 0; i < 150; i++, m += 4000000) {
+        uint64_t fwd = 200 + bench_rand(&rng) % 800;
+        uint64_t rev = 200 + bench_rand(&rng) % 800;
+        uint64_t t2_master = m + fwd;
+        uint64_t t3_master = t2_master + 50;
+        uint64_t t2 = slave_start + (uint64_t)((double)(t2_master - master_start) * (1.0 + drift));
+        uint64_t t3 = slave_start + (uint64_t)((double)(t3_master - master_start) * (1.0 + drift));
+        edtsp_clock_on_reply(slave, m, t2, t3, t3_master + rev);
+    }
+    
+    // Samples taken in the last 20 s, delivered "now"
+    uint64_t now = m;
+    int64_t max_err = 0;
+    volatile uint64_t sink = 0;
+    
+    uint64_t start = now_ns();
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t taken = now - (bench_rand(&rng) % 20000) * 1000;
+        uint64_t slave_us = slave_start + (uint64_t)((double)(taken - master_start) * (1.0 + drift));
+        uint64_t out;
+        edtsp_clock_to_master_us(slave, (uint32_t)(slave_us / 1000), now, &out);
+        sink += out;
+        
+        int64_t err = (int64_t)(out - taken);
+        if (err < 0) err = -err;
+        if (err > max_err) max_err = err;
+    }
+    uint64_t elapsed = now_ns() - start;
+    
+    const EDTSPClockModel *model = edtsp_clock_model(slave);
+    report("edtsp_clock_to_master_us (+sim)", SAMPLES, elapsed);
+    printf("  drift estimate=%lld ppb (true 50000), max error=%lld us (ms input)\n",
+           (long long)model->drift_ppb, (long long)max_err);
+}
+
+// ============================================================================
+// GENERATED CODECS
+// ============================================================================
+
+/**
+ * Mixed-type burst (HEARTBEAT/PROBE/SYNC/DATA) decoded through the
+ * dispatch table and encoded back, as a receive + forward path would.
+ */
+static void bench_codec(void) {
+    enum { BURST = 1024, ROUNDS = 4000 };
+    static uint8_t frames[BURST][sizeof(EDTSPDataPacket)];
+    static uint8_t types[BURST];
+    uint32_t rng = 0xC0DEC0DE;
+    
+    printf("[BENCH] codec (generated per-type decode/encode, %d-packet bursts)\n", BURST);
+    
+    for (int i = 0; i < BURST; i++) {
+        uint32_t r = bench_rand(&rng);
+        memset(frames[i], 0, sizeof(frames[i]));
+        switch (r % 4) {
+            case 0: {
+                EDTSPHeartbeatPacket *pkt = (EDTSPHeartbeatPacket*)frames[i];
+                pkt->uptime_ms = r;
+                types[i] = EDTSP_TYPE_HEARTBEAT;
+                break;
+            }
+            case 1: {
+                EDTSPProbePacket *pkt = (EDTSPProbePacket*)frames[i];
+                pkt->probe_seq = (uint16_t)r;
+                pkt->target_id = r;
+                pkt->t1_us = (uint64_t)r << 20;
+                types[i] = EDTSP_TYPE_PROBE;
+                break;
+            }
+            case 2: {
+                EDTSPSyncPacket *pkt = (EDTSPSyncPacket*)frames[i];
+                pkt->sync_seq = (uint16_t)r;
+                pkt->t2_us = (uint64_t)r << 12;
+                types[i] = EDTSP_TYPE_SYNC;
+                break;
+            }
+            default: {
+                EDTSPDataPacket *pkt = (EDTSPDataPacket*)frames[i];
+                pkt->timestamp_ms = r;
+                types[i] = EDTSP_TYPE_DATA;
+                break;
+            }
+        }
+        edtsp_codecs[types[i]].encode(frames[i]);
+    }
+    
+    uint64_t start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < BURST; i++) edtsp_codecs[types[i]].decode(frames[i]);
+        for (int i = 0; i < BURST; i++) edtsp_codecs[types[i]].encode(frames[i]);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("table decode+encode (mixed)", (uint64_t)BURST * ROUNDS, elapsed);
+    
+    // Specialized inline codec, no indirection (single type)
+    EDTSPProbePacket *probes = (EDTSPProbePacket*)frames;
+    size_t count = sizeof(frames) / sizeof(EDTSPProbePacket);
+    
+    start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < count; i++) edtsp_decode_probe(&probes[i]);
+        for (size_t i = 0; i < count; i++) edtsp_encode_probe(&probes[i]);
+    }
+    elapsed = now_ns() - start;
+    report("edtsp_decode/encode_probe", (uint64_t)count * ROUNDS, elapsed);
+}
+
+// ============================================================================
+// DISPATCH
+// ============================================================================
+
+static volatile uint64_t dispatch_sink;
+
+static void bench_handler(void *pkt, const EDTSPRxPacket *rx, void *ctx) {
+    (void)ctx;
+    dispatch_sink += ((const uint8_t*)pkt)[sizeof(EDTSPHeader)] + rx->len;
+}
+
+/**
+ * 64-packet batches with randomly interleaved types (a fresh pattern per
+ * batch): per-packet dispatch in arrival order vs. batch dispatch grouped
+ * by type.
+ */
+static void bench_dispatch(void) {
+    enum { POOL = 64, ROUNDS = 1000 };
+    static uint8_t frames[EDTSP_DISPATCH_BATCH][sizeof(EDTSPDataPacket)];
+    static EDTSPRxPacket batches[POOL][EDTSP_DISPATCH_BATCH];
+    static const uint8_t mix[] = { EDTSP_TYPE_HEARTBEAT, EDTSP_TYPE_PROBE,
+                                   EDTSP_TYPE_SYNC, EDTSP_TYPE_DATA, EDTSP_TYPE_DISCOVERY };
+    uint32_t rng = 0xD15FA7C4;
+    uint64_t ops = (uint64_t)POOL * EDTSP_DISPATCH_BATCH * ROUNDS;
+    
+    printf("[BENCH] dispatch (%d-packet batches, 5 interleaved types)\n", EDTSP_DISPATCH_BATCH);
+    
+    edtsp_dispatch_init();
+    for (size_t i = 0; i < sizeof(mix); i++) {
+        edtsp_dispatch_register(mix[i], 0, NULL, bench_handler, NULL);
+    }
+    
+    for (int b = 0; b < POOL; b++) {
+        for (int i = 0; i < EDTSP_DISPATCH_BATCH; i++) {
+            EDTSPRxPacket *rx = &batches[b][i];
+            memset(rx, 0, sizeof(*rx));
+            rx->pkt = frames[i];
+            rx->len = sizeof(frames[i]);
+            rx->frame.type = mix[bench_rand(&rng) % sizeof(mix)];
+        }
+    }
+    
+    uint64_t start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int b = 0; b < POOL; b++) {
+            for (int i = 0; i < EDTSP_DISPATCH_BATCH; i++) edtsp_dispatch(&batches[b][i]);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("edtsp_dispatch (arrival order)", ops, elapsed);
+    
+    start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int b = 0; b < POOL; b++) edtsp_dispatch_batch(batches[b], EDTSP_DISPATCH_BATCH);
+    }
+    elapsed = now_ns() - start;
+    report("edtsp_dispatch_batch (grouped)", ops, elapsed);
+}
+
+// ============================================================================
+// BUFFER POOL
+// ============================================================================
+
+enum { POOL_BATCH = 32, POOL_ROUNDS = 200000, POOL_THREADS = 4 };
+
+static volatile uintptr_t pool_sink;
+
+/** One receive batch: take POOL_BATCH buffers, touch them, give them back */
+static void *pool_worker(void *arg) {
+    void *bufs[POOL_BATCH];
+    (void)arg;
+    
+    for (int round = 0; round < POOL_ROUNDS; round++) {
+        for (int i = 0; i < POOL_BATCH; i++) {
+            bufs[i] = edtsp_pool_alloc();
+            ((uint8_t*)bufs[i])[0] = (uint8_t)i;
+        }
+        for (int i = 0; i < POOL_BATCH; i++) edtsp_pool_free(bufs[i]);
+    }
+    edtsp_pool_thread_flush();
+    return NULL;
+}
+
+/**
+ * Receive-batch pattern (32 buffers out, 32 back) through malloc/free,
+ * the pool from one thread and from 4 threads sharing it; plus the
+ * per-batch arena.
+ */
+static void bench_pool(void) {
+    void *bufs[POOL_BATCH];
+    uint64_t ops = (uint64_t)POOL_BATCH * POOL_ROUNDS;
+    
+    printf("[BENCH] pool (%d-buffer batches, alloc + free per op)\n", POOL_BATCH);
+    
+    uint64_t start = now_ns();
+    for (int round = 0; round < POOL_ROUNDS; round++) {
+        for (int i = 0; i < POOL_BATCH; i++) {
+            bufs[i] = malloc(EDTSP_POOL_BUF_SIZE);
+            ((uint8_t*)bufs[i])[0] = (uint8_t)i;
+        }
+        for (int i = 0; i < POOL_BATCH; i++) free(bufs[i]);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("malloc/free", ops, elapsed);
+    
+    edtsp_pool_init(POOL_BATCH * (POOL_THREADS + 1) * 2);
+    
+    start = now_ns();
+    pool_worker(NULL);
+    elapsed = now_ns() - start;
+    report("edtsp_pool (1 thread)", ops, elapsed);
+    
+    pthread_t tids[POOL_THREADS];
+    start = now_ns();
+    for (int t = 0; t < POOL_THREADS; t++) pthread_create(&tids[t], NULL, pool_worker, NULL);
+    for (int t = 0; t < POOL_THREADS; t++) pthread_join(tids[t], NULL);
+    elapsed = now_ns() - start;
+    report("edtsp_pool (4 threads, aggregate)", ops * POOL_THREADS, elapsed);
+    
+    EDTSPPoolStats st;
+    edtsp_pool_stats(&st);
+    printf("  in use after run: %u, exhausted=%llu, refills=%llu, heap allocs=%u\n",
+           st.in_use, (unsigned long long)st.exhausted,
+           (unsigned long long)st.refills, st.heap_allocs);
+    edtsp_pool_destroy();
+    
+    static uint8_t arena_mem[64 * 1024];
+    EDTSPArena arena;
+    edtsp_arena_init(&arena, arena_mem, sizeof(arena_mem));
+    
+    start = now_ns();
+    for (int round = 0; round < POOL_ROUNDS; round++) {
+        for (int i = 0; i < POOL_BATCH; i++) {
+            uint8_t *rec = edtsp_arena_alloc(&arena, 48, 0);
+            rec[0] = (uint8_t)i;
+            pool_sink += (uintptr_t)rec;
+        }
+        edtsp_arena_reset(&arena);
+    }
+    elapsed = now_ns() - start;
+    report("edtsp_arena_alloc (48 B records)", ops, elapsed);
+}
+
+// ============================================================================
+// GROUP CONFIGURATION
+// ============================================================================
+
+/**
+ * Fleet reconfiguration: one sensor setting for 500 slaves by ID list,
+ * then the slave-side membership test over a full packet (hits and misses).
+ */
+static void bench_group(void) {
+    enum { SLAVES = 500, LOOKUPS = 10000000 };
+    static uint32_t ids[SLAVES];
+    static EDTSPGroupConfigPacket pkts[SLAVES];
+    EDTSPSensorSetting setting = { 0, 1, 1000 };
+    uint32_t rng = 0xC0FFEE11;
+    
+    printf("[BENCH] group (%d slaves, 1 setting)\n", SLAVES);
+    
+    for (int i = 0; i < SLAVES; i++) ids[i] = bench_rand(&rng);
+    int n = edtsp_group_sort_ids(ids, SLAVES);
+    
+    int packets = 0;
+    size_t bytes = 0;
+    for (int done = 0; done < n; packets++) {
+        int used;
+        bytes += edtsp_group_build(&pkts[packets], 0x1, 0, EDTSP_GROUP_IDS, 0,
+                                   &setting, 1, ids + done, n - done, &used);
+        done += used;
+    }
+    printf("  GROUP_CONFIG: %d packets, %zu bytes (CONFIG per slave: %d packets, %zu bytes)\n",
+           packets, bytes, n, (size_t)n * sizeof(EDTSPConfigPacket));
+    
+    // Slave view: fixed fields decoded in place
+    EDTSPGroupConfigPacket *pkt = &pkts[0];
+    edtsp_decode_group_config(pkt);
+    uint32_t members = 0;
+    uint64_t start = now_ns();
+    for (int i = 0; i < LOOKUPS; i++) {
+        uint32_t id = (i & 1) ? ids[i % pkt->target_count] : bench_rand(&rng);
+        members += edtsp_group_match(pkt, id, 0);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("edtsp_group_match (60 IDs)", LOOKUPS, elapsed);
+    printf("  members found: %u of %d\n", members, LOOKUPS);
+}
+
+// ============================================================================
+// DEVICE INDEX
+// ============================================================================
+
+/**
+ * "Active devices with temperature and humidity on WiFi" over a full
+ * device table: table scan against the bitset intersection (+ ID list).
+ */
+static void bench_index(void) {
+    enum { QUERIES = 2000000 };
+    static struct { uint32_t id; EDTSPCapabilityMask caps; uint8_t iface; bool active; } table[EDTSP_INDEX_SLOTS];
+    static uint32_t ids[EDTSP_INDEX_SLOTS];
+    const EDTSPCapabilityMask want = EDTSP_CAP_TEMPERATURE | EDTSP_CAP_HUMIDITY;
+    uint32_t rng = 0xBADC0DE5;
+    uint64_t found = 0;
+    
+    printf("[BENCH] index (%d devices, 2 capabilities + interface)\n", EDTSP_INDEX_SLOTS);
+    
+    edtsp_index_init();
+    for (int i = 0; i < EDTSP_INDEX_SLOTS; i++) {
+        table[i].id = bench_rand(&rng);
+        table[i].caps = (EDTSPCapabilityMask)bench_rand(&rng);
+        table[i].iface = (uint8_t)(1 + bench_rand(&rng) % 3);
+        table[i].active = bench_rand(&rng) % 8 != 0;
+        edtsp_index_set_active(i, table[i].id, table[i].active);
+        edtsp_index_set_capabilities(i, table[i].caps);
+        edtsp_index_set_interface(i, table[i].iface);
+    }
+    
+    uint64_t start = now_ns();
+    for (int q = 0; q < QUERIES; q++) {
+        int n = 0;
+        for (int i = 0; i < EDTSP_INDEX_SLOTS; i++) {
+            if (table[i].active && (table[i].caps & want) == want && table[i].iface == EDTSP_IFACE_WIFI) {
+                ids[n++] = table[i].id;
+            }
+        }
+        found += (uint64_t)n + ids[0];
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("table scan", QUERIES, elapsed);
+    
+    EDTSPBitset set;
+    start = now_ns();
+    for (int q = 0; q < QUERIES; q++) {
+        found += (uint64_t)edtsp_index_select(want, EDTSP_IFACE_WIFI, &set);
+    }
+    elapsed = now_ns() - start;
+    report("edtsp_index_select (count)", QUERIES, elapsed);
+    
+    start = now_ns();
+    for (int q = 0; q < QUERIES; q++) {
+        edtsp_index_select(want, EDTSP_IFACE_WIFI, &set);
+        found += (uint64_t)edtsp_index_ids(&set, ids, EDTSP_INDEX_SLOTS) + ids[0];
+    }
+    elapsed = now_ns() - start;
+    report("edtsp_index_select + ids", QUERIES, elapsed);
+    printf("  matching devices: %d (checksum %llu)\n",
+           edtsp_index_count(&set), (unsigned long long)found);
+}
+
+// ============================================================================
+// JOIN HANDSHAKE
+// ============================================================================
+
+/*
+ * Virtual-time fleet join: N slaves learn the master at t=0. 1 ms one-way
+ * latency, 5% loss each way, and a master that drains at most 8 packets
+ * per millisecond from a 64-packet receive buffer (overflow is dropped).
+ */
+enum { HS_MASTER = 0x7FFFFFFF, HS_RING = 8192, HS_RXBUF = 64, HS_RX_PER_MS = 8 };
+
+typedef struct {
+    uint8_t  step;
+    uint32_t source;
+    uint32_t target;
+    uint64_t arrive_us;
+} HsFrame;
+
+static HsFrame hs_ring[HS_RING];
+static uint32_t hs_head, hs_tail, hs_rng, hs_sent;
+static uint64_t hs_now;
+
+static void hs_emit(uint32_t source, uint8_t step, uint32_t target) {
+    hs_sent++;
+    if (bench_rand(&hs_rng) % 100 < 5) return; // Lost
+    if (hs_tail - hs_head == HS_RING) return;
+    hs_ring[hs_tail++ % HS_RING] = (HsFrame){ step, source, target, hs_now + 1000 };
+}
+
+static void hs_master_send(uint8_t step, uint32_t target, void *ctx) {
+    (void)ctx;
+    hs_emit(HS_MASTER, step, target);
+}
+
+static void hs_slave_send(uint8_t step, uint32_t target, void *ctx) {
+    hs_emit((uint32_t)(uintptr_t)ctx, step, target);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @param serial Admit one join at a time (SYNs from others are dropped
+ *               while a join is open) instead of answering every SYN
+ */
+static void hs_simulate(int nodes, bool serial) {
+    static EDTSPJoin joins[EDTSP_MAX_DEVICES];
+    static HsFrame rxbuf[HS_RXBUF];
+    static uint32_t join_us[EDTSP_MAX_DEVICES];
+    int rx_count = 0, joined = 0;
+    uint32_t current = 0;
+    
+    hs_head = hs_tail = hs_sent = 0;
+    hs_rng = 0x5EED0000u + (uint32_t)nodes;
+    edtsp_hs_init(hs_master_send, NULL);
+    for (int i = 0; i < nodes; i++) {
+        edtsp_join_init(&joins[i], 0xA5A50000u + (uint32_t)i, hs_slave_send, (void*)(uintptr_t)(i + 1));
+        edtsp_join_set_master(&joins[i], HS_MASTER, 0);
+    }
+    
+    for (hs_now = 0; joined < nodes && hs_now < 120000000; hs_now += 1000) {
+        // Deliver: slaves handle at once, the master's buffer may overflow
+        while (hs_head != hs_tail && hs_ring[hs_head % HS_RING].arrive_us <= hs_now) {
+            HsFrame f = hs_ring[hs_head++ % HS_RING];
+            if (f.target != HS_MASTER) {
+                EDTSPHandshakePacket pkt = { .handshake_step = f.step };
+                pkt.header.source_id = HS_MASTER;
+                edtsp_join_on_packet(&joins[f.target - 1], &pkt, hs_now);
+            } else if (rx_count < HS_RXBUF) {
+                rxbuf[rx_count++] = f;
+            }
+        }
+        
+        int take = rx_count < HS_RX_PER_MS ? rx_count : HS_RX_PER_MS;
+        for (int i = 0; i < take; i++) {
+            EDTSPHandshakePacket pkt = { .handshake_step = rxbuf[i].step, .target_id = HS_MASTER };
+            pkt.header.source_id = rxbuf[i].source;
+            if (serial && pkt.handshake_step == EDTSP_HANDSHAKE_SYN) {
+                if (edtsp_hs_stats()->in_progress && pkt.header.source_id != current) continue;
+                current = pkt.header.source_id;
+            }
+            edtsp_hs_on_packet(&pkt, hs_now);
+        }
+        memmove(rxbuf, rxbuf + take, (size_t)(rx_count - take) * sizeof(rxbuf[0]));
+        rx_count -= take;
+        
+        edtsp_hs_poll(hs_now);
+        joined = 0;
+        for (int i = 0; i < nodes; i++) {
+            edtsp_join_poll(&joins[i], hs_now);
+            joined += joins[i].state == EDTSP_JOIN_ESTABLISHED;
+        }
+    }
+    
+    for (int i = 0; i < nodes; i++) {
+        join_us[i] = joins[i].state == EDTSP_JOIN_ESTABLISHED ? joins[i].join_us : UINT32_MAX;
+    }
+    qsort(join_us, (size_t)nodes, sizeof(join_us[0]), cmp_u32);
+    
+    const EDTSPHandshakeStats *st = edtsp_hs_stats();
+    printf("  %-10s %4d nodes: joined %4d, p50 %7.1f ms, all %8.1f ms, %5u packets "
+           "(%u dup SYN, %u SYN-ACK retx)\n", serial ? "serial" : "pipelined", nodes, joined,
+           join_us[nodes / 2] / 1000.0, hs_now / 1000.0, hs_sent,
+           st->duplicate_syns, st->synack_retx);
+}
+
+static void bench_handshake(void) {
+    static const int fleet[] = { 16, 64, 256 };
+    
+    printf("[BENCH] handshake (1 ms one-way, 5%% loss, master drains %d pkt/ms)\n", HS_RX_PER_MS);
+    for (size_t i = 0; i < sizeof(fleet) / sizeof(fleet[0]); i++) hs_simulate(fleet[i], false);
+    for (size_t i = 0; i < sizeof(fleet) / sizeof(fleet[0]); i++) hs_simulate(fleet[i], true);
+}
+
+// ============================================================================
+// CAPABILITY DESCRIPTORS
+// ============================================================================
+
+/**
+ * A full device table joining with one of three firmware descriptor sets:
+ * SYN decode + intern per device, storage against one copy per device,
+ * then planning a sensor interval for the whole fleet.
+ */
+static void bench_capdesc(void) {
+    enum { ROUNDS = 20000 };
+    static const EDTSPSensorDesc firmware[3][4] = {
+        { {0, 0, EDTSP_UNIT_CELSIUS, -1, -400, 800, 2000}, {1, 0, EDTSP_UNIT_PERCENT_RH, -1, 0, 1000, 2000},
+          {3, 0, EDTSP_UNIT_METER, -2, 2, 400, 60} },
+        { {0, 0, EDTSP_UNIT_CELSIUS, -2, -5500, 12500, 100}, {0, 1, EDTSP_UNIT_CELSIUS, -2, -5500, 12500, 750},
+          {2, 0, EDTSP_UNIT_PASCAL, 1, 3000, 11000, 40}, {7, 0, EDTSP_UNIT_G, -3, -16000, 16000, 1} },
+        { {10, 0, EDTSP_UNIT_AMPERE, -3, 0, 30000, 10}, {11, 0, EDTSP_UNIT_VOLT, -2, 0, 25000, 10} },
+    };
+    static const int counts[3] = { 3, 4, 2 };
+    static EDTSPHandshakePacket syn[3];
+    size_t raw_bytes = 0;
+    
+    printf("[BENCH] capdesc (%d devices, 3 firmware descriptor sets)\n", EDTSP_MAX_DEVICES);
+    
+    for (int f = 0; f < 3; f++) {
+        uint8_t tlv[sizeof(syn[f].descriptors)];
+        int len = edtsp_capdesc_encode(firmware[f], counts[f], tlv, sizeof(tlv));
+        edtsp_build_handshake(&syn[f], 0x100 + (uint32_t)f, EDTSP_HANDSHAKE_SYN, 0x1,
+                              edtsp_capdesc_mask(firmware[f], counts[f]), EDTSP_IFACE_WIFI);
+        edtsp_capdesc_attach(&syn[f], tlv, len);
+    }
+    
+    uint64_t start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        edtsp_capdesc_init();
+        for (int slot = 0; slot < EDTSP_MAX_DEVICES; slot++) {
+            const EDTSPHandshakePacket *pkt = &syn[slot % 3];
+            edtsp_capdesc_set(slot, pkt, offsetof(EDTSPHandshakePacket, descriptors) + pkt->desc_len);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("edtsp_capdesc_set (decode + intern)", (uint64_t)ROUNDS * EDTSP_MAX_DEVICES, elapsed);
+    
+    for (int slot = 0; slot < EDTSP_MAX_DEVICES; slot++) raw_bytes += (size_t)counts[slot % 3] * sizeof(EDTSPSensorDesc);
+    printf("  descriptor data: %zu bytes as per-device copies, %zu bytes interned (%u sets) + %d bytes of references\n",
+           raw_bytes, (size_t)(counts[0] + counts[1] + counts[2]) * sizeof(EDTSPSensorDesc),
+           edtsp_capdesc_stats()->interned, EDTSP_MAX_DEVICES);
+    
+    uint32_t sum = 0;
+    start = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int slot = 0; slot < EDTSP_MAX_DEVICES; slot++) sum += edtsp_capdesc_plan_interval(slot, 0, 500);
+    }
+    elapsed = now_ns() - start;
+    report("edtsp_capdesc_plan_interval", (uint64_t)ROUNDS * EDTSP_MAX_DEVICES, elapsed);
+    printf("  temperature at 500 ms requested: clamped=%u skipped=%u (checksum %u)\n",
+           edtsp_capdesc_stats()->plans_clamped / ROUNDS, edtsp_capdesc_stats()->plans_skipped / ROUNDS, sum);
+}
+
+// ============================================================================
+// REPORT BY EXCEPTION
+// ============================================================================
+
+enum { DB_DAY = 86400 };    // 1 s samples
+
+static int32_t db_truth[DB_DAY];
+static int64_t db_err_sum;
+static int32_t db_err_max;
+
+static void db_check(uint32_t device_id, uint8_t sensor_id, uint32_t timestamp_ms,
+                     int32_t value, bool reported, void *ctx) {
+    (void)device_id; (void)sensor_id; (void)reported; (void)ctx;
+    int32_t err = value - db_truth[timestamp_ms / 1000];
+    if (err < 0) err = -err;
+    if (err > db_err_max) db_err_max = err;
+    db_err_sum += err;
+}
+
+/**
+ * One day of a room temperature (0.1 C raw units, 1 s samples): a daily
+ * swing of +-5 C with +-0.1 C sensor noise, filtered at several deadbands
+ * with a 5 min deadline. Every report is fed to the master, whose rebuilt
+ * series is compared sample by sample against the original.
+ */
+static void bench_deadband(void) {
+    static const uint16_t deadbands[] = { 0, 1, 2, 5 };
+    static EDTSPDataPacket pkt;
+    uint32_t rng = 0xDEADBA5Eu;
+    
+    for (int t = 0; t < DB_DAY; t++) {
+        int phase = t % DB_DAY;
+        int tri = phase < DB_DAY / 2 ? phase : DB_DAY - phase;     // 0 .. 43200
+        db_truth[t] = 170 + tri * 100 / (DB_DAY / 2) + (int32_t)(bench_rand(&rng) % 3) - 1;
+    }
+    
+    printf("[BENCH] deadband (1 day of 1 s samples, 0.1 C units, 300 s deadline)\n");
+    for (size_t i = 0; i < sizeof(deadbands) / sizeof(deadbands[0]); i++) {
+        EDTSPDeadband db = {0};
+        edtsp_deadband_configure(&db, deadbands[i], 300000);
+        edtsp_recon_init(db_check, NULL);
+        db_err_sum = 0;
+        db_err_max = 0;
+        
+        pkt.header.source_id = 0x100;
+        pkt.sensor_id = 0;
+        for (int t = 0; t < DB_DAY; t++) {
+            if (!edtsp_deadband_sample(&db, db_truth[t], (uint32_t)t * 1000)) continue;
+            pkt.timestamp_ms = (uint32_t)t * 1000;
+            pkt.data_len = edtsp_deadband_record(&db, db_truth[t], pkt.data);
+            edtsp_recon_on_data(&pkt);
+        }
+        
+        const EDTSPReconSensorStats *st = edtsp_recon_stats(0);
+        printf("  deadband %2u: %5u reports (%4u deadline), %5.1f%% saved, rebuilt %u, "
+               "error max %d mean %.2f\n", deadbands[i], db.sent, db.deadline_sent,
+               100.0 * (DB_DAY - db.sent) / DB_DAY, st->samples, db_err_max,
+               st->samples ? (double)db_err_sum / st->samples : 0.0);
+    }
+    
+    // Filter cost on the slave, per sample
+    EDTSPDeadband db = {0};
+    uint32_t sent = 0;
+    edtsp_deadband_configure(&db, 2, 300000);
+    uint64_t start = now_ns();
+    for (int r = 0; r < 20; r++) {
+        for (int t = 0; t < DB_DAY; t++) sent += edtsp_deadband_sample(&db, db_truth[t], (uint32_t)(r * DB_DAY + t) * 1000);
+    }
+    uint64_t elapsed = now_ns() - start;
+    report("edtsp_deadband_sample", 20ull * DB_DAY, elapsed);
+    printf("  (%u sent)\n", sent);
+}
+
+// ============================================================================
+// WINDOWED AGGREGATION
+// ============================================================================
+
+/**
+ * A 1 kHz vibration-like signal summarized over 1 s tumbling windows:
+ * per-sample fold cost (the ESP32 loop path), summaries checked against a
+ * direct computation, and bytes sent against streaming every sample.
+ */
+static void bench_window(void) {
+    enum { RATE_HZ = 1000, SECONDS = 3600, SAMPLES = RATE_HZ * SECONDS };
+    static int16_t signal[RATE_HZ];
+    static EDTSPDataPacket pkt;
+    uint32_t rng = 0x57A7u;
+    
+    for (int i = 0; i < RATE_HZ; i++) {
+        int tri = (i % 50) < 25 ? (i % 50) : 50 - (i % 50);       // 20 Hz, +-12
+        signal[i] = (int16_t)(tri * 40 - 500 + (int)(bench_rand(&rng) % 61) - 30);
+    }
+    
+    EDTSPWindow w = {0};
+    EDTSPWindowSummary sum = {0};
+    uint32_t windows = 0;
+    int64_t check = 0;
+    edtsp_window_configure(&w, 1000);
+    
+    uint64_t start = now_ns();
+    for (int t = 0; t < SAMPLES; t++) {
+        if (edtsp_window_sample(&w, signal[t % RATE_HZ], (uint32_t)t, &sum)) {
+            windows++;
+            check += sum.mean + sum.rms;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    
+    printf("[BENCH] window (%d Hz samples, 1 s tumbling windows, %d s)\n", RATE_HZ, SECONDS);
+    report("edtsp_window_sample", SAMPLES, elapsed);
+    
+    // Reference over one window (the signal repeats every second)
+    int64_t s1 = 0, s2 = 0;
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    for (int i = 0; i < RATE_HZ; i++) {
+        s1 += signal[i];
+        s2 += (int64_t)signal[i] * signal[i];
+        if (signal[i] < lo) lo = signal[i];
+        if (signal[i] > hi) hi = signal[i];
+    }
+    double ms = (double)s2 / RATE_HZ, rms = ms;
+    for (int i = 0; i < 40; i++) rms = 0.5 * (rms + ms / rms);     // Newton, no libm
+    
+    edtsp_summary_init();
+    pkt.sensor_id = 7;
+    pkt.timestamp_ms = sum.start_ms;
+    pkt.data_len = edtsp_window_record(&sum, pkt.data);
+    EDTSPWindowSummary rx;
+    bool ok = edtsp_summary_on_data(&pkt, &rx) && rx.count == RATE_HZ && rx.min == lo && rx.max == hi;
+    printf("  last window: n=%u min=%d max=%d mean=%d rms=%u (direct: mean %.2f rms %.2f) %s\n",
+           rx.count, rx.min, rx.max, rx.mean, rx.rms, (double)s1 / RATE_HZ,
+           rms, ok ? "ok" : "MISMATCH");
+    
+    size_t raw = (size_t)SAMPLES * (offsetof(EDTSPDataPacket, data) + 4);
+    size_t sent = (size_t)windows * (offsetof(EDTSPDataPacket, data) + EDTSP_WINDOW_RECORD_LEN);
+    printf("  %u summaries: %zu bytes vs %zu bytes of samples (%.2f%% saved, checksum %lld)\n",
+           windows, sent, raw, 100.0 * (double)(raw - sent) / (double)raw, (long long)check);
+}
+
+// ============================================================================
+// PACKED SAMPLES
+// ============================================================================
+
+enum { PACK_TRACE_MAX = 1 << 20 };
+
+static int32_t pack_trace[PACK_TRACE_MAX];
+static int32_t pack_check[PACK_TRACE_MAX + EDTSP_PACK_MAX_SAMPLES];
+static uint8_t pack_blocks[PACK_TRACE_MAX / 2 * 64];
+static uint16_t pack_lens[PACK_TRACE_MAX];
+
+/** Pack a trace sampled every 10 ms, then decode the blocks repeatedly */
+static void pack_run(const char *name, int n, uint8_t pack_samples) {
+    EDTSPPacker *p = calloc(1, sizeof(*p));
+    uint8_t *at = pack_blocks;
+    uint32_t start_ms;
+    int blocks = 0;
+    
+    // Framing of one DATA frame: v2 header + DATA fields
+    const double frame = sizeof(EDTSPHeaderV2) + offsetof(EDTSPDataPacket, data) - sizeof(EDTSPHeader);
+    
+    edtsp_pack_configure(p, pack_samples);
+    uint64_t start = now_ns();
+    for (int i = 0; i <= n; i++) {
+        uint16_t len = i < n ? edtsp_pack_sample(p, pack_trace[i], (uint32_t)i * 10, at, &start_ms)
+                             : edtsp_pack_flush(p, at, &start_ms);
+        if (len) {
+            pack_lens[blocks++] = len;
+            at += len;
+        }
+    }
+    uint64_t encode_ns = now_ns() - start;
+    size_t bytes = (size_t)(at - pack_blocks);
+    
+    int rounds = 0, decoded = 0;
+    start = now_ns();
+    do {
+        const uint8_t *b = pack_blocks;
+        decoded = 0;
+        for (int k = 0; k < blocks; k++) {
+            decoded += edtsp_unpack(b, pack_lens[k], pack_check + decoded, NULL);
+            b += pack_lens[k];
+        }
+        rounds++;
+    } while (now_ns() - start < 200000000ull);
+    uint64_t decode_ns = now_ns() - start;
+    
+    bool ok = decoded == n && !memcmp(pack_check, pack_trace, (size_t)n * sizeof(int32_t));
+    printf("  %-12s %4s %7d samples: %5d blocks (%4.0f samples/frame), %5.2f bits/sample, "
+           "ratio %5.1fx payload / %5.1fx frames, encode %4.1f ns, decode %4.2f ns/sample (%.0f M/s) %s\n",
+           name, pack_samples == EDTSP_PACK_FILL ? "fill" : "64", n, blocks, (double)n / blocks, 8.0 * bytes / n, 4.0 * n / bytes,
+           (double)n * (frame + 4) / (bytes + (double)blocks * frame),
+           (double)encode_ns / n, (double)decode_ns / ((double)rounds * n),
+           (double)rounds * n * 1e3 / (double)decode_ns, ok ? "ok" : "MISMATCH");
+    free(p);
+}
+
+/**
+ * Delta + zigzag + bit-packing on synthetic traces: a slow temperature
+ * random walk, a noisy 20 Hz vibration and a 16-bit ADC with occasional
+ * spikes. `edtsp_bench pack FILE` also replays a recorded trace (one
+ * integer per line).
+ */
+static void bench_pack(void) {
+    enum { N = 1 << 18 };
+    uint32_t rng = 0x9ACCu;
+    int32_t v = 215;
+    
+#ifdef EDTSP_PACK_SCALAR
+    printf("[BENCH] pack (scalar decode)\n");
+#else
+    printf("[BENCH] pack (vector decode)\n");
+#endif
+    
+    for (int i = 0; i < N; i++) {
+        uint32_t r = bench_rand(&rng) % 16;
+        v += (r == 0) - (r == 1);
+        pack_trace[i] = v;
+    }
+    pack_run("temperature", N, 64);
+    pack_run("temperature", N, EDTSP_PACK_FILL);
+    
+    for (int i = 0; i < N; i++) {
+        int tri = (i % 50) < 25 ? (i % 50) : 50 - (i % 50);
+        pack_trace[i] = tri * 40 - 500 + (int32_t)(bench_rand(&rng) % 61) - 30;
+    }
+    pack_run("vibration", N, 64);
+    pack_run("vibration", N, EDTSP_PACK_FILL);
+    
+    for (int i = 0; i < N; i++) {
+        uint32_t r = bench_rand(&rng);
+        pack_trace[i] = 32768 + (int32_t)(r % 9) - 4 + ((r >> 8) % 500 == 0 ? 20000 : 0);
+    }
+    pack_run("adc-spikes", N, 64);
+    pack_run("adc-spikes", N, EDTSP_PACK_FILL);
+    
+    if (!bench_arg) return;
+    FILE *f = fopen(bench_arg, "r");
+    if (!f) {
+        printf("  %s: cannot open\n", bench_arg);
+        return;
+    }
+    int n = 0;
+    long x;
+    while (n < PACK_TRACE_MAX && fscanf(f, "%ld", &x) == 1) pack_trace[n++] = (int32_t)x;
+    fclose(f);
+    if (n) {
+        pack_run("replay", n, 64);
+        pack_run("replay", n, EDTSP_PACK_FILL);
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+// RATE LIMITING
+// ============================================================================
+
+/**
+ * 200 joined slaves at 100 frames/s each share the segment with one joined
+ * slave stuck in a 200k frames/s send loop and a spoofer sending 10k
+ * frames/s, each from a new random source ID. Ten simulated seconds:
+ * admit cost per frame and what each class got through.
+ */
+static void bench_ratelimit(void) {
+    enum { DEVICES = 200, MS = 10000, LEGIT_PER_MS = 20, FLOOD_PER_MS = 200, SPOOF_PER_MS = 10 };
+    static uint32_t ids[DEVICES + 1];
+    uint32_t rng = 0x4A7E5u;
+    uint32_t legit = 0, legit_ok = 0, flood = 0, flood_ok = 0, spoof = 0, spoof_ok = 0;
+    
+    edtsp_ratelimit_init(NULL);
+    for (int i = 0; i <= DEVICES; i++) {
+        ids[i] = bench_rand(&rng) | 1;
+        edtsp_ratelimit_set_known(ids[i], true);
+    }
+    uint32_t flooder = ids[DEVICES];
+    
+    uint64_t start = now_ns();
+    for (int ms = 0; ms < MS; ms++) {
+        uint64_t t = (uint64_t)ms * 1000;
+        for (int k = 0; k < FLOOD_PER_MS; k++) {
+            uint64_t now = t + (uint64_t)k * 1000 / FLOOD_PER_MS;
+            flood_ok += edtsp_ratelimit_admit(flooder, now);
+            if (k % (FLOOD_PER_MS / LEGIT_PER_MS) == 0) {
+                legit_ok += edtsp_ratelimit_admit(ids[bench_rand(&rng) % DEVICES], now);
+                legit++;
+            }
+            if (k % (FLOOD_PER_MS / SPOOF_PER_MS) == 0) {
+                spoof_ok += edtsp_ratelimit_admit(bench_rand(&rng) | 1, now);
+                spoof++;
+            }
+        }
+        flood += FLOOD_PER_MS;
+    }
+    uint64_t elapsed = now_ns() - start;
+    
+    const EDTSPRateLimitStats *st = edtsp_ratelimit_stats();
+    printf("[BENCH] ratelimit (%d slaves at 100/s, one at %d/s, spoofed IDs at %d/s, %d s)\n",
+           DEVICES, FLOOD_PER_MS * 1000, SPOOF_PER_MS * 1000, MS / 1000);
+    report("edtsp_ratelimit_admit", (uint64_t)legit + flood + spoof, elapsed);
+    printf("  slaves: %u of %u passed (%.2f%%)\n", legit_ok, legit, 100.0 * legit_ok / legit);
+    printf("  flooder: %u of %u passed (%.0f/s incl. 1/%u sampled)\n", flood_ok, flood,
+           flood_ok * 1000.0 / MS, EDTSP_RATELIMIT_SAMPLE_EVERY);
+    printf("  spoofed: %u of %u passed (%.0f/s), %u sources tracked, %u via overflow bucket\n",
+           spoof_ok, spoof, spoof_ok * 1000.0 / MS, st->sources, st->overflow);
+}
+
+// ============================================================================
+// FLOW CONTROL
+// ============================================================================
+
+/**
+ * 10 heavy slaves (100 samples/s) and 10 light ones (20 samples/s) feed a
+ * master that serves 700 frames/s from a 256-frame receive queue. One
+ * minute in 1 ms steps, with and without CREDIT: frames lost to the full
+ * queue, how many of the light slaves' frames got through and how many
+ * samples were folded into averages instead.
+ */
+static void flow_run(bool control) {
+    enum { SLAVES = 20, HEAVY = 10, MS = 60000, QUEUE = 256, SERVE_FPS = 700 };
+    static EDTSPFlowSlave slave[SLAVES];
+    static EDTSPDecimator dec[SLAVES];
+    static uint32_t queue[QUEUE];
+    uint32_t head = 0, count = 0, drops = 0, served_credit = 0;
+    uint32_t sent = 0, light_sent = 0, light_served = 0, merged = 0;
+    
+    edtsp_flow_init();
+    memset(dec, 0, sizeof(dec));
+    for (int i = 0; i < SLAVES; i++) edtsp_flow_slave_init(&slave[i], 0);
+    
+    for (uint32_t t = 1; t <= MS; t++) {
+        for (int i = 0; i < SLAVES; i++) {
+            uint32_t every = i < HEAVY ? 10 : 50;
+            if ((t + (uint32_t)i) % every) continue;
+            int32_t avg;
+            uint32_t avg_ms;
+            if (!edtsp_decimate(&slave[i], &dec[i], (int32_t)t, t, &avg, &avg_ms)) continue;
+            edtsp_flow_on_sent(&slave[i]);
+            sent++;
+            light_sent += i >= HEAVY;
+            if (count == QUEUE) {
+                drops++;
+                continue;
+            }
+            queue[(head + count++) % QUEUE] = (uint32_t)i;
+        }
+        
+        // Serve at a fixed rate (7 frames every 10 ms)
+        served_credit += SERVE_FPS;
+        while (served_credit >= 1000 && count) {
+            uint32_t i = queue[head];
+            head = (head + 1) % QUEUE;
+            count--;
+            served_credit -= 1000;
+            edtsp_flow_on_data((int)i);
+            light_served += i >= HEAVY;
+        }
+        if (!count) served_credit = 0;
+        
+        if (control && t % EDTSP_FLOW_SAMPLE_MS == 0) {
+            uint16_t max_fps;
+            uint8_t pct;
+            EDTSPCreditPacket pkt = {0};
+            edtsp_flow_on_queue((uint8_t)(count * 100 / QUEUE), drops);
+            if (edtsp_flow_tick(t, &max_fps, &pct)) {
+                pkt.max_fps = max_fps;
+                pkt.lifetime_ms = EDTSP_FLOW_LIFETIME_MS;
+                for (int i = 0; i < SLAVES; i++) edtsp_flow_on_credit(&slave[i], &pkt, 0, t);
+            }
+        }
+        for (int i = 0; i < SLAVES; i++) edtsp_flow_slave_tick(&slave[i], t);
+    }
+    
+    for (int i = 0; i < SLAVES; i++) merged += slave[i].merged;
+    printf("  %-11s %6u frames sent, %6u lost to a full queue (%5.1f%%), light slaves %u of %u served, "
+           "%u samples averaged\n", control ? "CREDIT" : "no control", sent, drops, 100.0 * drops / sent,
+           light_served, light_sent, merged);
+}
+
+/**
+ * Rate entries: senders outside the device table (slot -1) take none, and
+ * slaves that stop sending lose theirs while a busy one keeps its own.
+ */
+static void flow_entries(void) {
+    uint32_t t = 1;
+    uint16_t max_fps;
+    uint8_t pct;
+    
+    edtsp_flow_init();
+    edtsp_flow_tick(t, &max_fps, &pct);
+    for (int slot = 0; slot < 4; slot++) edtsp_flow_on_data(slot);
+    edtsp_flow_on_data(-1);
+    edtsp_flow_on_data(EDTSP_FLOW_SLAVES);
+    uint16_t counted = edtsp_flow_stats()->slaves;
+    
+    while (edtsp_flow_stats()->slaves > 1 && edtsp_flow_stats()->periods < 100) {
+        edtsp_flow_on_data(0);
+        t += EDTSP_FLOW_PERIOD_MS;
+        edtsp_flow_tick(t, &max_fps, &pct);
+    }
+    const EDTSPFlowStats *st = edtsp_flow_stats();
+    printf("  entries: %u of 6 senders counted %s, %u idle dropped after %u periods, %u kept %s\n",
+           counted, check(counted == 4), st->evicted, st->periods, st->slaves,
+           check(st->evicted == 3 && st->slaves == 1 && st->periods < 100));
+}
+
+static void bench_flow(void) {
+    printf("[BENCH] flow (10 slaves at 100/s + 10 at 20/s, master serves 700/s, 60 s)\n");
+    flow_run(false);
+    flow_run(true);
+    flow_entries();
+}
+
+// ============================================================================
+// AUTHENTICATION
+// ============================================================================
+
+/**
+ * Receive path over 32-frame batches of signed v2 frames (1 HEARTBEAT in
+ * 4, DATA with 4-16 data bytes, 256 sources). Plain = copy out of the
+ * receive buffer + decode; authenticated adds batch verification and the
+ * replay check. Also: the MAC alone, and verification alone.
+ */
+/** SipHash-2-4 reference vectors: key 00..0f, message 00..len-1 for len 0..63 */
+static const uint64_t siphash_vectors[64] = {
+    0x726fdb47dd0e0e31ull, 0x74f839c593dc67fdull, 0x0d6c8009d9a94f5aull, 0x85676696d7fb7e2dull,
+    0xcf2794e0277187b7ull, 0x18765564cd99a68dull, 0xcbc9466e58fee3ceull, 0xab0200f58b01d137ull,
+    0x93f5f5799a932462ull, 0x9e0082df0ba9e4b0ull, 0x7a5dbbc594ddb9f3ull, 0xf4b32f46226bada7ull,
+    0x751e8fbc860ee5fbull, 0x14ea5627c0843d90ull, 0xf723ca908e7af2eeull, 0xa129ca6149be45e5ull,
+    0x3f2acc7f57c29bdbull, 0x699ae9f52cbe4794ull, 0x4bc1b3f0968dd39cull, 0xbb6dc91da77961bdull,
+    0xbed65cf21aa2ee98ull, 0xd0f2cbb02e3b67c7ull, 0x93536795e3a33e88ull, 0xa80c038ccd5ccec8ull,
+    0xb8ad50c6f649af94ull, 0xbce192de8a85b8eaull, 0x17d835b85bbb15f3ull, 0x2f2e6163076bcfadull,
+    0xde4daaaca71dc9a5ull, 0xa6a2506687956571ull, 0xad87a3535c49ef28ull, 0x32d892fad841c342ull,
+    0x7127512f72f27cceull, 0xa7f32346f95978e3ull, 0x12e0b01abb051238ull, 0x15e034d40fa197aeull,
+    0x314dffbe0815a3b4ull, 0x027990f029623981ull, 0xcadcd4e59ef40c4dull, 0x9abfd8766a33735cull,
+    0x0e3ea96b5304a7d0ull, 0xad0c42d6fc585992ull, 0x187306c89bc215a9ull, 0xd4a60abcf3792b95ull,
+    0xf935451de4f21df2ull, 0xa9538f0419755787ull, 0xdb9acddff56ca510ull, 0xd06c98cd5c0975ebull,
+    0xe612a3cb9ecba951ull, 0xc766e62cfcadaf96ull, 0xee64435a9752fe72ull, 0xa192d576b245165aull,
+    0x0a8787bf8ecb74b2ull, 0x81b3e73d20b49b6full, 0x7fa8220ba3b2eceaull, 0x245731c13ca42499ull,
+    0xb78dbfaf3a8d83bdull, 0xea1ad565322a1a0bull, 0x60e61c23a3795013ull, 0x6606d7e446282b93ull,
+    0x6ca4ecb15c5f91e1ull, 0x9f626da15c9625f3ull, 0xe51b38608ef25f57ull, 0x958a324ceb064572ull
+};
+
+/** Reference vectors, then a signed frame with each of its bits flipped in turn */
+static void auth_known_answers(void) {
+    uint8_t key[EDTSP_AUTH_KEY_LEN];
+    uint8_t msg[64];
+    int matched = 0;
+    
+    for (int i = 0; i < EDTSP_AUTH_KEY_LEN; i++) key[i] = (uint8_t)i;
+    for (int i = 0; i < 64; i++) msg[i] = (uint8_t)i;
+    edtsp_auth_init(key);
+    for (int len = 0; len < 64; len++) matched += edtsp_auth_mac(msg, (size_t)len) == siphash_vectors[len];
+    
+    EDTSPHeartbeatPacket hb;
+    uint8_t frame[64];
+    edtsp_build_heartbeat(&hb, 0x1234, EDTSP_ROLE_SLAVE, 1, 1, 0, 0);
+    size_t len = edtsp_auth_sign(frame, edtsp_reframe_v2(frame, sizeof(frame), &hb, sizeof(hb), 0, 1));
+    int rejected = 0;
+    for (size_t bit = 0; bit < 8 * len; bit++) {
+        frame[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        rejected += !edtsp_auth_verify(frame, len);
+        frame[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+    }
+    bool intact = edtsp_auth_verify(frame, len);
+    
+    printf("  known answers: SipHash-2-4 reference vectors %d/64 %s, "
+           "flipped bits rejected %d/%zu %s\n",
+           matched, check(matched == 64), rejected, 8 * len, check(rejected == (int)(8 * len) && intact));
+}
+
+static void bench_auth(void) {
+    enum { FRAMES = 4096, BATCH = 32, ROUNDS = 500, SOURCES = 256, ROOM = 64 };
+    static uint8_t wire[FRAMES][ROOM];
+    static uint8_t work[BATCH][ROOM];
+    static uint16_t lens[FRAMES];
+    static uint32_t seqs[FRAMES];
+    static uint32_t srcs[FRAMES];
+    static const uint8_t *ptrs[FRAMES];
+    uint8_t key[EDTSP_AUTH_KEY_LEN];
+    uint32_t rng = 0xA0771u;
+    size_t bytes = 0;
+    
+    for (int i = 0; i < EDTSP_AUTH_KEY_LEN; i++) key[i] = (uint8_t)bench_rand(&rng);
+    edtsp_auth_init(key);
+    
+    for (int i = 0; i < FRAMES; i++) {
+        uint32_t src = 0x1000 + bench_rand(&rng) % SOURCES;
+        EDTSPDataPacket data;
+        EDTSPHeartbeatPacket hb;
+        size_t len;
+        
+        if (i % 4 == 0) {
+            edtsp_build_heartbeat(&hb, src, EDTSP_ROLE_SLAVE, (uint32_t)i, 8, 0, 0);
+            len = edtsp_reframe_v2(wire[i], ROOM, &hb, sizeof(hb), 0, (uint32_t)i);
+        } else {
+            uint8_t value[16] = {0};
+            uint8_t n = (uint8_t)(4 + bench_rand(&rng) % 13);
+            edtsp_build_data(&data, src, 0, (uint32_t)i, value, n);
+            len = edtsp_reframe_v2(wire[i], ROOM, &data, offsetof(EDTSPDataPacket, data) + n, 0, (uint32_t)i);
+        }
+        lens[i] = (uint16_t)edtsp_auth_sign(wire[i], len);
+        seqs[i] = (uint32_t)i;
+        srcs[i] = src;
+        ptrs[i] = wire[i];
+        bytes += lens[i];
+    }
+    
+    printf("[BENCH] auth (SipHash-2-4 tags, %d-frame batches, %.0f bytes/frame avg)\n",
+           BATCH, (double)bytes / FRAMES);
+    auth_known_answers();
+    edtsp_auth_init(key);
+    
+    EDTSPFrameInfo info;
+    uint32_t accepted = 0;
+    uint64_t start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int b = 0; b < FRAMES; b += BATCH) {
+            for (int i = 0; i < BATCH; i++) {
+                memcpy(work[i], wire[b + i], lens[b + i]);
+                accepted += edtsp_decode_frame(work[i], lens[b + i], &info);
+            }
+        }
+    }
+    uint64_t plain = now_ns() - start;
+    report("plain: copy + decode", (uint64_t)FRAMES * ROUNDS, plain);
+    
+    // Each round is a fresh stretch of sequence numbers, as on the wire
+    const uint8_t *batch[BATCH];
+    bool ok[BATCH];
+    for (int i = 0; i < BATCH; i++) batch[i] = work[i];
+    start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int b = 0; b < FRAMES; b += BATCH) {
+            for (int i = 0; i < BATCH; i++) memcpy(work[i], wire[b + i], lens[b + i]);
+            edtsp_auth_verify_batch(batch, &lens[b], BATCH, ok);
+            for (int i = 0; i < BATCH; i++) {
+                if (!ok[i] || !edtsp_decode_frame(work[i], lens[b + i], &info)) continue;
+                accepted += edtsp_auth_replay_check(info.source_id, seqs[b + i] + (uint32_t)round * FRAMES, 0);
+            }
+        }
+    }
+    uint64_t authed = now_ns() - start;
+    report("auth: + verify batch + replay", (uint64_t)FRAMES * ROUNDS, authed);
+    printf("  authentication adds %.1f ns/frame, throughput %.0f%% of plain\n",
+           (double)(authed - plain) / ((double)FRAMES * ROUNDS), 100.0 * plain / authed);
+    
+    start = now_ns();
+    uint64_t sink = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < FRAMES; i++) sink += edtsp_auth_mac(wire[i], lens[i] - EDTSP_AUTH_TAG_LEN);
+    }
+    report("edtsp_auth_mac (one frame)", (uint64_t)FRAMES * ROUNDS, now_ns() - start);
+    
+    start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int b = 0; b < FRAMES; b += BATCH) {
+            edtsp_auth_verify_batch(&ptrs[b], &lens[b], BATCH, ok);
+            sink += ok[0];
+        }
+    }
+    report("edtsp_auth_verify_batch", (uint64_t)FRAMES * ROUNDS, now_ns() - start);
+    
+    // Replay the last round
+    uint32_t replays = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        replays += !edtsp_auth_replay_check(srcs[i], seqs[i] + (uint32_t)(ROUNDS - 1) * FRAMES, 0);
+    }
+    
+    // Source 0 has a window like any other
+    bool zero_ok = edtsp_auth_replay_check(0, 100, 0) && !edtsp_auth_replay_check(0, 100, 0);
+    
+    // Restart behind the window: dropped while the old run is live, the
+    // window restarts once it has been quiet; a replay then stays dropped
+    uint32_t old_seq = 5000000;
+    edtsp_auth_replay_check(0xBEEF, old_seq, 1000);
+    bool live = !edtsp_auth_replay_check(0xBEEF, old_seq - 100000, 1000 + EDTSP_AUTH_RESYNC_MS / 2);
+    bool resynced = edtsp_auth_replay_check(0xBEEF, old_seq - 99999, 1000 + EDTSP_AUTH_RESYNC_MS);
+    bool next = edtsp_auth_replay_check(0xBEEF, old_seq - 99998, 1001 + EDTSP_AUTH_RESYNC_MS);
+    bool stale = !edtsp_auth_replay_check(0xBEEF, old_seq - 99999, 1002 + EDTSP_AUTH_RESYNC_MS);
+    
+    // Handshake: everything up to the join frame counts as seen
+    edtsp_auth_reset(0xBEEF, old_seq - 99000, 1003 + EDTSP_AUTH_RESYNC_MS);
+    bool joined = !edtsp_auth_replay_check(0xBEEF, old_seq - 99001, 1004 + EDTSP_AUTH_RESYNC_MS) &&
+                  edtsp_auth_replay_check(0xBEEF, old_seq - 98999, 1004 + EDTSP_AUTH_RESYNC_MS);
+    
+    // Timed-out device: its window is freed, the rest stay findable
+    uint32_t tracked = edtsp_auth_stats()->sources;
+    edtsp_auth_forget(0xBEEF);
+    edtsp_auth_forget(0);
+    bool freed = edtsp_auth_stats()->sources == tracked - 2 &&
+                 !edtsp_auth_replay_check(srcs[0], seqs[0] + (uint32_t)(ROUNDS - 1) * FRAMES, 0);
+    
+    // Forged master: unsigned and wrongly signed HEARTBEATs from 0xFFFFFFFF
+    EDTSPHeartbeatPacket hb;
+    uint8_t forged[2][ROOM];
+    uint16_t forged_len[2];
+    const uint8_t *forged_ptr[2] = { forged[0], forged[1] };
+    edtsp_build_heartbeat(&hb, 0xFFFFFFFF, EDTSP_ROLE_MASTER, 1, 1, 0, 0);
+    forged_len[0] = (uint16_t)edtsp_reframe_v2(forged[0], ROOM, &hb, sizeof(hb), 0, 1);
+    forged_len[1] = (uint16_t)edtsp_reframe_v2(forged[1], ROOM, &hb, sizeof(hb), EDTSP_FLAG_AUTHENTICATED, 1);
+    memset(forged[1] + forged_len[1], 0x5A, EDTSP_AUTH_TAG_LEN);
+    forged_len[1] += EDTSP_AUTH_TAG_LEN;
+    edtsp_auth_verify_batch(forged_ptr, forged_len, 2, ok);
+    
+    const EDTSPAuthStats *st = edtsp_auth_stats();
+    printf("  forged HEARTBEAT from 0xFFFFFFFF: unsigned %s, bad tag %s; replayed %u/%d dropped\n",
+           ok[0] ? "ACCEPTED" : "dropped", ok[1] ? "ACCEPTED" : "dropped", replays, FRAMES);
+    printf("  counters: verified=%u unauthenticated=%u bad tag=%u replayed=%u resyncs=%u\n",
+           st->verified, st->unauthenticated, st->bad_tag, st->replayed, st->resyncs);
+    printf("  source 0 tracked: %s\n", check(zero_ok));
+    printf("  restart behind window: dropped while live %s, resync after %d ms %s, replay after resync dropped %s\n",
+           check(live), EDTSP_AUTH_RESYNC_MS, check(resynced && next), check(stale));
+    printf("  join handshake resets window: %s; forget frees windows: %s\n", check(joined), check(freed));
+    if (sink == 42 || accepted == 42) printf(" \n");
+}
+
+// ============================================================================
+// ENCRYPTION
+// ============================================================================
+
+enum { AI_FRAMES = 4096, AI_BATCH = 32, AI_RUNS = 3, AI_PASSES = 200 };
+
+static uint8_t aead_net_key[EDTSP_AUTH_KEY_LEN];
+static uint8_t ai_wire[AI_RUNS][AI_FRAMES][80];
+static uint16_t ai_lens[AI_RUNS][AI_FRAMES];
+
+/**
+ * Signed (and optionally sealed) DATA frames from 128 sources of their
+ * own to master 0x1, one run per algorithm
+ */
+static size_t aead_frames(int run, uint8_t alg) {
+    uint32_t rng = 0xAEAD1u;
+    size_t bytes = 0;
+    
+    for (int i = 0; i < AI_FRAMES; i++) {
+        uint32_t src = 0x1000 * (uint32_t)(run + 1) + bench_rand(&rng) % 128;
+        uint8_t value[16];
+        uint8_t n = (uint8_t)(4 + bench_rand(&rng) % 13);
+        EDTSPDataPacket data;
+        
+        for (int j = 0; j < n; j++) value[j] = (uint8_t)bench_rand(&rng);
+        edtsp_build_data(&data, src, 0, (uint32_t)i, value, n);
+        size_t len = edtsp_reframe_v2(ai_wire[run][i], 80, &data, offsetof(EDTSPDataPacket, data) + n,
+                                      EDTSP_FLAG_AUTHENTICATED, (uint32_t)i);
+        if (alg) {
+            // Both ends derive the same key; seal with the master's copy
+            edtsp_aead_install(src, 0x1, src, src, ~(uint64_t)src, alg);
+            len = edtsp_aead_seal_frame(ai_wire[run][i], len, src);
+        }
+        ai_lens[run][i] = (uint16_t)edtsp_auth_sign(ai_wire[run][i], len);
+        bytes += ai_lens[run][i];
+    }
+    return bytes;
+}
+
+/** State of one ingest pass, for the DATA handler */
+typedef struct {
+    FILE     *store;
+    uint64_t  sum;
+    uint32_t  accepted;
+} AeadIngest;
+
+/** What handle_data does with a plain DATA frame on the master */
+static void aead_on_data(void *data, const EDTSPRxPacket *rx, void *ctx) {
+    const EDTSPDataPacket *pkt = data;
+    AeadIngest *in = ctx;
+    uint64_t master_us;
+    
+    if (pkt->data_len > sizeof(pkt->data) || offsetof(EDTSPDataPacket, data) + pkt->data_len > rx->len) return;
+    // Stands in for the device-table slot: sources are 0x1000 * run + 0..127
+    edtsp_flow_on_data((int)(pkt->header.source_id & 127));
+    bool synced = edtsp_clock_to_master_us(pkt->header.source_id, pkt->timestamp_ms, rx->rx_us, &master_us);
+    if (in->store) {
+        fprintf(in->store, "[RX] DATA from 0x%08X: Sensor=%u, Len=%u, T=%llu us%s\n",
+                pkt->header.source_id, pkt->sensor_id, pkt->data_len,
+                (unsigned long long)master_us, synced ? "" : " (unsynced)");
+    } else {
+        for (int j = 0; j < pkt->data_len; j++) in->sum += pkt->data[j];
+    }
+    in->accepted++;
+}
+
+/**
+ * One pass of master ingest over a run, the steps of the daemon's receive
+ * loop: copy out of the receive buffer, verify tags, open (when sealed),
+ * then prepare_packet (decode, replay window, rate limit) and dispatch to
+ * the DATA handler (flow accounting, timebase, record). With a store, the
+ * handler writes the record line handle_data prints; without, it only sums
+ * the data bytes. Returns elapsed ns.
+ */
+static uint64_t aead_ingest(int run, uint8_t alg, FILE *store, uint32_t *accepted) {
+    static uint8_t work[AI_BATCH][80];
+    static uint64_t rx_us = 1000000;
+    uint8_t *batch[AI_BATCH];
+    uint16_t blens[AI_BATCH];
+    bool ok[AI_BATCH];
+    EDTSPRxPacket rx[AI_BATCH];
+    AeadIngest in = { store, 0, 0 };
+    
+    for (int i = 0; i < AI_BATCH; i++) batch[i] = work[i];
+    
+    // Same frames every pass: start with empty replay windows
+    edtsp_auth_init(aead_net_key);
+    edtsp_dispatch_register(EDTSP_TYPE_DATA, 0, NULL, aead_on_data, &in);
+    if (store) rewind(store);
+    
+    uint64_t start = now_ns();
+    for (int b = 0; b < AI_FRAMES; b += AI_BATCH) {
+        int n = 0;
+        
+        rx_us += 1000;
+        for (int i = 0; i < AI_BATCH; i++) {
+            memcpy(work[i], ai_wire[run][b + i], ai_lens[run][b + i]);
+            blens[i] = ai_lens[run][b + i];
+        }
+        edtsp_auth_verify_batch((const uint8_t *const *)batch, blens, AI_BATCH, ok);
+        if (alg) edtsp_aead_open_frames(batch, blens, AI_BATCH, ok);
+        for (int i = 0; i < AI_BATCH; i++) {
+            EDTSPFrameInfo *info = &rx[n].frame;
+            if (!ok[i] || !edtsp_decode_frame(work[i], blens[i], info)) continue;
+            if (info->flags & EDTSP_FLAG_ENCRYPTED) continue;
+            if (!edtsp_auth_replay_check(info->source_id, info->seq, rx_us / 1000)) continue;
+            if (!edtsp_ratelimit_admit(info->source_id, rx_us)) continue;
+            
+            rx[n].pkt = work[i] + info->offset;
+            rx[n].len = (uint16_t)(blens[i] - info->offset - EDTSP_AUTH_TAG_LEN);
+            rx[n].iface = NULL;
+            rx[n].rx_us = rx_us;
+            rx[n].arena = NULL;
+            n++;
+        }
+        edtsp_dispatch_batch(rx, n);
+    }
+    if (store) fflush(store);
+    uint64_t elapsed = now_ns() - start;
+    
+    *accepted += in.accepted;
+    if (in.sum == 42) printf(" \n");
+    return elapsed;
+}
+
+/** Raw AEAD cost: seal one by one, open one by one, open in batches */
+static void aead_raw(EDTSPAeadAlg alg, size_t len) {
+    enum { MSGS = 256, ROUNDS = 200 };
+    static uint8_t buf[MSGS][1024 + EDTSP_AEAD_TAG_LEN];
+    static EDTSPAeadMsg msgs[MSGS];
+    static bool ok[MSGS];
+    static const uint8_t aad[16] = { 0xED, 0x62 };
+    EDTSPAeadKey key;
+    uint8_t raw[EDTSP_AEAD_KEY_LEN];
+    uint32_t rng = 0x5EA1u;
+    char label[48];
+    
+    for (int i = 0; i < EDTSP_AEAD_KEY_LEN; i++) raw[i] = (uint8_t)bench_rand(&rng);
+    edtsp_aead_set_key(&key, alg, raw);
+    for (int m = 0; m < MSGS; m++) {
+        msgs[m] = (EDTSPAeadMsg){ &key, (uint32_t)m, aad, sizeof(aad), buf[m], len };
+    }
+    
+    uint64_t start = now_ns();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int m = 0; m < MSGS; m++) edtsp_aead_seal(&key, (uint32_t)m, aad, sizeof(aad), buf[m], len);
+    }
+    uint64_t sealed = now_ns() - start;
+    snprintf(label, sizeof(label), "seal %zu B", len);
+    report(label, (uint64_t)MSGS * ROUNDS, sealed);
+    
+    // Decrypting in place flips the buffers between plaintext and ciphertext:
+    // re-seal the same way before each timed pass so every tag matches
+    uint64_t single = 0, batched = 0;
+    uint32_t opened = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        start = now_ns();
+        for (int m = 0; m < MSGS; m++) opened += edtsp_aead_open(&key, (uint32_t)m, aad, sizeof(aad), buf[m], len);
+        single += now_ns() - start;
+        for (int m = 0; m < MSGS; m++) edtsp_aead_seal(&key, (uint32_t)m, aad, sizeof(aad), buf[m], len);
+        
+        start = now_ns();
+        for (int m = 0; m < MSGS; m += EDTSP_AEAD_BATCH) {
+            edtsp_aead_open_batch(&msgs[m], EDTSP_AEAD_BATCH, &ok[m]);
+        }
+        batched += now_ns() - start;
+        for (int m = 0; m < MSGS; m++) {
+            opened += ok[m];
+            edtsp_aead_seal(&key, (uint32_t)m, aad, sizeof(aad), buf[m], len);
+        }
+    }
+    snprintf(label, sizeof(label), "open %zu B", len);
+    report(label, (uint64_t)MSGS * ROUNDS, single);
+    snprintf(label, sizeof(label), "open_batch %zu B", len);
+    report(label, (uint64_t)MSGS * ROUNDS, batched);
+    printf("  %.2f GB/s batched%s\n", (double)len * MSGS * ROUNDS / (double)batched,
+           opened == 2u * MSGS * ROUNDS ? "" : "  (TAG MISMATCH!)");
+}
+
+/** One AEAD known answer (hex strings) */
+typedef struct {
+    const char  *name;
+    EDTSPAeadAlg alg;
+    const char  *key, *nonce, *aad, *plain, *cipher, *tag;
+} AeadVector;
+
+/**
+ * RFC 8439 section 2.8.2, the GCM spec test cases with 96-bit IVs, and two
+ * of DATA frame shape (a 16-byte header, one and two text blocks: test
+ * case 4 cut short, tags from OpenSSL)
+ */
+static const AeadVector aead_vectors[] = {
+    { "RFC 8439 2.8.2", EDTSP_AEAD_CHACHA20_POLY1305,
+      "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f",
+      "070000004041424344454647", "50515253c0c1c2c3c4c5c6c7",
+      "4c616469657320616e642047656e746c656d656e206f662074686520636c6173"
+      "73206f66202739393a204966204920636f756c64206f6666657220796f75206f"
+      "6e6c79206f6e652074697020666f7220746865206675747572652c2073756e73"
+      "637265656e20776f756c642062652069742e",
+      "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+      "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+      "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+      "3ff4def08e4b7a9de576d26586cec64b6116",
+      "1ae10b594f09e26a7e902ecbd0600691" },
+    { "GCM test case 1", EDTSP_AEAD_AES128_GCM,
+      "00000000000000000000000000000000", "000000000000000000000000", "", "", "",
+      "58e2fccefa7e3061367f1d57a4e7455a" },
+    { "GCM test case 2", EDTSP_AEAD_AES128_GCM,
+      "00000000000000000000000000000000", "000000000000000000000000", "",
+      "00000000000000000000000000000000", "0388dace60b6a392f328c2b971b2fe78",
+      "ab6e47d42cec13bdf53a67b21257bddf" },
+    { "GCM test case 3", EDTSP_AEAD_AES128_GCM,
+      "feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", "",
+      "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+      "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255",
+      "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+      "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091473f5985",
+      "4d5c2af327cd64a62cf35abd2ba6fab4" },
+    { "GCM test case 4", EDTSP_AEAD_AES128_GCM,
+      "feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888",
+      "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+      "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+      "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+      "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+      "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+      "5bc94fbc3221a5db94fae95ae7121a47" },
+    { "GCM 16 B AAD, 13 B", EDTSP_AEAD_AES128_GCM,
+      "feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", "feedfacedeadbeeffeedfacedeadbeef",
+      "d9313225f88406e5a55909c5af", "42831ec2217774244b7221b784", "c03d611dbae1199f69b8f80ffd319599" },
+    { "GCM 16 B AAD, 29 B", EDTSP_AEAD_AES128_GCM,
+      "feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", "feedfacedeadbeeffeedfacedeadbeef",
+      "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a",
+      "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329", "df3b16c2aa5af4e19b8e244bc973ccdf" },
+};
+
+#define AEAD_VECTORS ((int)(sizeof(aead_vectors) / sizeof(aead_vectors[0])))
+
+/** Decode a hex string; returns the byte count */
+static size_t from_hex(const char *hex, uint8_t *out) {
+    size_t n = strlen(hex) / 2;
+    for (size_t i = 0; i < n; i++) {
+        unsigned byte;
+        sscanf(hex + 2 * i, "%2x", &byte);
+        out[i] = (uint8_t)byte;
+    }
+    return n;
+}
+
+/** Decoded vector, its key set up with the vector's nonce */
+typedef struct {
+    EDTSPAeadKey key;
+    uint32_t     seq;
+    uint8_t      aad[32], plain[128], cipher[128 + EDTSP_AEAD_TAG_LEN];
+    size_t       aad_len, len;
+} AeadKnown;
+
+static void aead_decode(const AeadVector *v, AeadKnown *k) {
+    uint8_t raw[EDTSP_AEAD_KEY_LEN] = {0};
+    uint8_t nonce[12];
+    
+    from_hex(v->key, raw);
+    from_hex(v->nonce, nonce);
+    edtsp_aead_set_key(&k->key, v->alg, raw);
+    memcpy(k->key.nonce_fixed, nonce, 8);
+    k->seq = (uint32_t)nonce[8] << 24 | (uint32_t)nonce[9] << 16 | (uint32_t)nonce[10] << 8 | nonce[11];
+    k->aad_len = from_hex(v->aad, k->aad);
+    k->len = from_hex(v->plain, k->plain);
+    from_hex(v->cipher, k->cipher);
+    from_hex(v->tag, k->cipher + k->len);
+}
+
+/**
+ * Known answers: each vector sealed and opened; tampered ciphertext, tag,
+ * AAD, nonce and key rejected with the data left as it was. Then one
+ * batch over EDTSP_AEAD_BATCH mixing both algorithms, the vectors, long
+ * messages that need the second pass and tampered messages.
+ */
+static void aead_known_answers(uint8_t cpu) {
+    enum { MSGS = 48, LONG = 1400 };
+    static AeadKnown known[AEAD_VECTORS];
+    static uint8_t buf[MSGS][LONG + EDTSP_AEAD_TAG_LEN];
+    static uint8_t plain[MSGS][LONG];
+    static EDTSPAeadKey long_keys[2];
+    EDTSPAeadMsg msgs[MSGS];
+    bool expect[MSGS], ok[MSGS];
+    uint8_t work[128 + EDTSP_AEAD_TAG_LEN];
+    int run = 0, matched = 0, tampered = 0, rejected = 0;
+    
+    for (int v = 0; v < AEAD_VECTORS; v++) {
+        AeadKnown *k = &known[v];
+        if (!(cpu & aead_vectors[v].alg)) continue;
+        aead_decode(&aead_vectors[v], k);
+        run++;
+        
+        memcpy(work, k->plain, k->len);
+        edtsp_aead_seal(&k->key, k->seq, k->aad, k->aad_len, work, k->len);
+        bool sealed = memcmp(work, k->cipher, k->len + EDTSP_AEAD_TAG_LEN) == 0;
+        bool opened = edtsp_aead_open(&k->key, k->seq, k->aad, k->aad_len, work, k->len) &&
+                      memcmp(work, k->plain, k->len) == 0;
+        matched += sealed && opened;
+        
+        // One change each: ciphertext bit, tag bit, AAD bit, seq, fixed nonce part
+        for (int t = 0; t < 5; t++) {
+            EDTSPAeadKey key = k->key;
+            uint8_t aad[32];
+            uint32_t seq = k->seq;
+            
+            memcpy(work, k->cipher, k->len + EDTSP_AEAD_TAG_LEN);
+            memcpy(aad, k->aad, k->aad_len);
+            if (t == 0 && !k->len) continue;
+            if (t == 2 && !k->aad_len) continue;
+            if (t == 0) work[k->len / 2] ^= 0x01;
+            if (t == 1) work[k->len + 15] ^= 0x80;
+            if (t == 2) aad[0] ^= 0x01;
+            if (t == 3) seq++;
+            if (t == 4) key.nonce_fixed[0] ^= 0x01;
+            
+            uint8_t before[sizeof(work)];
+            memcpy(before, work, sizeof(work));
+            tampered++;
+            rejected += !edtsp_aead_open(&key, seq, aad, k->aad_len, work, k->len) &&
+                        memcmp(work, before, sizeof(work)) == 0;
+        }
+    }
+    
+    // Batch: vectors (every third message), long and short random
+    // messages under both algorithms; every fifth message tampered
+    uint32_t rng = 0xCA7B0u;
+    uint8_t raw[EDTSP_AEAD_KEY_LEN];
+    for (int a = 0; a < 2; a++) {
+        for (int i = 0; i < EDTSP_AEAD_KEY_LEN; i++) raw[i] = (uint8_t)bench_rand(&rng);
+        edtsp_aead_set_key(&long_keys[a], a ? EDTSP_AEAD_CHACHA20_POLY1305 : EDTSP_AEAD_AES128_GCM, raw);
+    }
+    int n = 0, algs = 0;
+    for (int m = 0; m < MSGS; m++) {
+        const AeadKnown *k = NULL;
+        if (m % 3 == 0) {
+            int v = (m / 3) % AEAD_VECTORS;
+            if (cpu & aead_vectors[v].alg) k = &known[v];
+        }
+        if (k) {
+            memcpy(buf[n], k->cipher, k->len + EDTSP_AEAD_TAG_LEN);
+            memcpy(plain[n], k->plain, k->len);
+            msgs[n] = (EDTSPAeadMsg){ &k->key, k->seq, k->aad, k->aad_len, buf[n], k->len };
+        } else {
+            const EDTSPAeadKey *key = &long_keys[(m & 1) || !(cpu & EDTSP_AEAD_AES128_GCM)];
+            size_t len = m % 3 == 1 ? 65 + bench_rand(&rng) % (LONG - 64) : bench_rand(&rng) % 64;
+            for (size_t i = 0; i < len; i++) plain[n][i] = buf[n][i] = (uint8_t)bench_rand(&rng);
+            msgs[n] = (EDTSPAeadMsg){ key, (uint32_t)m, plain[n], 8, buf[n], len };
+            edtsp_aead_seal(key, (uint32_t)m, plain[n], 8, buf[n], len);
+        }
+        algs |= msgs[n].key->alg;
+        expect[n] = n % 5 != 4;
+        if (!expect[n]) buf[n][msgs[n].len] ^= 0x01;
+        n++;
+    }
+    edtsp_aead_open_batch(msgs, n, ok);
+    int batch_ok = 0;
+    for (int m = 0; m < n; m++) {
+        bool right = ok[m] == expect[m] && (!ok[m] || memcmp(buf[m], plain[m], msgs[m].len) == 0);
+        batch_ok += right;
+    }
+    
+    printf("  known answers: %d/%d vectors %s, tampered rejected %d/%d %s, "
+           "mixed batch (%s) %d/%d %s\n",
+           matched, run, check(matched == run), rejected, tampered, check(rejected == tampered),
+           algs == (EDTSP_AEAD_AES128_GCM | EDTSP_AEAD_CHACHA20_POLY1305) ? "both AEADs" : "ChaCha20 only",
+           batch_ok, n, check(batch_ok == n));
+}
+
+/**
+ * Session churn: 4096 peers (peer 0 among them) join one after another,
+ * 200 live at a time, the oldest timing out as each new one joins.
+ */
+static void aead_sessions(void) {
+    enum { PEERS = 4096, LIVE = 200 };
+    int installed = 0, found = 0, gone = 0;
+    
+    edtsp_aead_init(true, EDTSP_AEAD_CHACHA20_POLY1305, 0x1);
+    for (uint32_t p = 0; p < PEERS; p++) {
+        uint32_t peer = p * 0x9E3779B1u;     // Spread over the table, 0 first
+        installed += edtsp_aead_install(peer, 0x1, peer, p, ~(uint64_t)p, EDTSP_AEAD_CHACHA20_POLY1305) != NULL;
+        if (p >= LIVE) edtsp_aead_forget((p - LIVE) * 0x9E3779B1u);
+    }
+    for (uint32_t p = 0; p < PEERS; p++) {
+        const EDTSPAeadSession *s = edtsp_aead_session(p * 0x9E3779B1u);
+        if (p >= PEERS - LIVE) found += s && s->slave_nonce == p;
+        else gone += !s;
+    }
+    printf("  sessions: %d/%d peers installed %s, live found %d/%d %s, timed out freed %d/%d %s\n",
+           installed, PEERS, check(installed == PEERS), found, LIVE, check(found == LIVE),
+           gone, PEERS - LIVE, check(gone == PEERS - LIVE));
+}
+
+/**
+ * Master ingest of signed DATA frames (4-16 data bytes, 128 slaves per
+ * run): plaintext against AES-128-GCM and ChaCha20-Poly1305 sealed
+ * payloads. Passes of the runs alternate, so load on the machine hits
+ * them alike: the fastest pass of each is reported, the overhead is the
+ * median over passes against the plaintext pass beside it. The receive
+ * path is measured alone and with the handler's record write to a file.
+ * Then the AEADs alone on 32-byte and 1 KiB messages.
+ */
+static void bench_aead(void) {
+    static const uint8_t algs[AI_RUNS] = { 0, EDTSP_AEAD_AES128_GCM, EDTSP_AEAD_CHACHA20_POLY1305 };
+    static uint64_t pass_ns[AI_RUNS][2][AI_PASSES];
+    static double over[2][AI_PASSES];
+    uint8_t cpu = edtsp_aead_supported();
+    uint64_t best[AI_RUNS][2];
+    uint32_t accepted[AI_RUNS] = {0};
+    size_t bytes[AI_RUNS];
+    FILE *store = tmpfile();
+    uint32_t rng = 0xAEAD0u;
+    
+    printf("[BENCH] aead (%s available)\n", cpu & EDTSP_AEAD_AES128_GCM ? "AES-NI/PCLMUL" : "no AES-NI");
+    aead_known_answers(cpu);
+    aead_sessions();
+    
+    for (int i = 0; i < EDTSP_AUTH_KEY_LEN; i++) aead_net_key[i] = (uint8_t)bench_rand(&rng);
+    edtsp_auth_init(aead_net_key);
+    edtsp_aead_init(true, cpu, 0x1);
+    edtsp_ratelimit_init(NULL);
+    edtsp_flow_init();
+    edtsp_dispatch_init();
+    for (int r = 0; r < AI_RUNS; r++) {
+        bytes[r] = (cpu & algs[r]) || !algs[r] ? aead_frames(r, algs[r]) : 0;
+        for (uint32_t src = 0; src < 128; src++) edtsp_ratelimit_set_known(0x1000 * (uint32_t)(r + 1) + src, true);
+        best[r][0] = best[r][1] = UINT64_MAX;
+    }
+    
+    for (int pass = 0; pass < AI_PASSES; pass++) {
+        for (int r = 0; r < AI_RUNS; r++) {
+            if (!bytes[r]) continue;
+            for (int w = 0; w < 2; w++) {
+                uint64_t ns = aead_ingest(r, algs[r], w && store ? store : NULL, &accepted[r]);
+                if (ns < best[r][w]) best[r][w] = ns;
+                pass_ns[r][w][pass] = ns;
+            }
+        }
+    }
+    if (store) fclose(store);
+    
+    for (int r = 0; r < AI_RUNS; r++) {
+        if (!bytes[r]) continue;
+        
+        char label[48];
+        const char *name = algs[r] ? edtsp_aead_name(algs[r]) : "signed plaintext";
+        snprintf(label, sizeof(label), "ingest: %s (%.0f B)", name, (double)bytes[r] / AI_FRAMES);
+        report(label, AI_FRAMES, best[r][0]);
+        report("  + record write", AI_FRAMES, best[r][1]);
+        if (accepted[r] != (uint32_t)AI_FRAMES * AI_PASSES * 2) {
+            printf("  %s: only %u of %d frames accepted!\n", name, accepted[r], AI_FRAMES * AI_PASSES * 2);
+        }
+        if (!algs[r]) continue;
+        
+        // Overhead against the plaintext pass run next to it: the median
+        // shrugs off passes that a stall on the machine hit on one side
+        for (int w = 0; w < 2; w++) {
+            for (int pass = 0; pass < AI_PASSES; pass++) {
+                over[w][pass] = 100.0 * ((double)pass_ns[r][w][pass] / (double)pass_ns[0][w][pass] - 1);
+            }
+            qsort(over[w], AI_PASSES, sizeof(over[w][0]), cmp_double);
+        }
+        printf("  %s ingest: %+.1f ns/frame; %+.0f%% on the receive path alone, %+.0f%% with the record write\n",
+               name, (double)((int64_t)best[r][0] - (int64_t)best[0][0]) / AI_FRAMES,
+               over[0][AI_PASSES / 2], over[1][AI_PASSES / 2]);
+    }
+    
+    for (int a = 0; a < 2; a++) {
+        EDTSPAeadAlg alg = a ? EDTSP_AEAD_CHACHA20_POLY1305 : EDTSP_AEAD_AES128_GCM;
+        if (!(cpu & alg)) continue;
+        
+        printf("  %s:\n", edtsp_aead_name(alg));
+        aead_raw(alg, 32);
+        aead_raw(alg, 1024);
+    }
+}
+
+// ============================================================================
+// HIERARCHICAL ZONES
+// ============================================================================
+
+enum { ZN_NODES = 10000, ZN_ZONE = 200, ZN_ZONES = ZN_NODES / ZN_ZONE, ZN_FPS = 10, ZN_SECONDS = 60,
+       ZN_KILL_S = 20, ZN_CHURN = 20, ZN_DOWN_S = 8 };
+
+static uint32_t zn_id[ZN_NODES];
+static int16_t zn_value[ZN_NODES];
+static uint32_t zn_down_until[ZN_NODES];   // 0 = up
+static int zn_sub[ZN_ZONES];               // Sub-master node, -1 = electing
+static uint32_t zn_elect_at[ZN_ZONES];     // Zone notices the loss (heartbeat timeout)
+static EDTSPZoneAgg zn_agg[ZN_ZONES];
+
+/** Zone election: highest live ID */
+static int zn_elect(int z) {
+    int best = -1;
+    for (int i = z * ZN_ZONE; i < (z + 1) * ZN_ZONE; i++) {
+        if (!zn_down_until[i] && (best < 0 || zn_id[i] > zn_id[best])) best = i;
+    }
+    return best;
+}
+
+/**
+ * 10,000 nodes in 50 zones of 200, each slave sending 10 DATA frames/s,
+ * for one minute in one-second summary intervals. 20 slaves drop out
+ * every second and come back 8 s later. At 20 s the top master dies: its
+ * zone re-elects after the heartbeat timeout and the sub-masters elect a
+ * new top. The top tier is the real one (edtsp_zone.c) as seen by the
+ * lowest sub-master; the result is checked against the simulation's own
+ * totals.
+ */
+static void bench_zone(void) {
+    EDTSPZoneSummaryPacket wire[ZN_ZONES];
+    size_t wire_len[ZN_ZONES];
+    uint32_t rng = 0x20AE0001u;
+    uint64_t sent = 0, ingested = 0, agg_ns = 0, top_ns = 0, summaries = 0, summary_bytes = 0;
+    int64_t exact_sum = 0;
+    uint32_t killed = 0, killed_top_s = 0, new_top_s = 0, handover_s = 0;
+    int observer = -1, killed_zone = -1;
+    
+    printf("[BENCH] zone (%d nodes, %d zones of %d, %d DATA/s per slave, %d s, top master killed at %d s)\n",
+           ZN_NODES, ZN_ZONES, ZN_ZONE, ZN_FPS, ZN_SECONDS, ZN_KILL_S);
+    
+    memset(zn_down_until, 0, sizeof(zn_down_until));
+    for (int i = 0; i < ZN_NODES; i++) {
+        do zn_id[i] = bench_rand(&rng); while (!zn_id[i]);
+        zn_value[i] = (int16_t)(bench_rand(&rng) % 2001) - 1000;
+    }
+    for (int z = 0; z < ZN_ZONES; z++) {
+        edtsp_zone_agg_reset(&zn_agg[z], 0);
+        for (int i = z * ZN_ZONE; i < (z + 1) * ZN_ZONE; i++) edtsp_zone_agg_member(&zn_agg[z], zn_id[i], true);
+        zn_sub[z] = zn_elect(z);
+        if (observer < 0 || zn_id[zn_sub[z]] < zn_id[observer]) observer = zn_sub[z];
+    }
+    
+    // The observer's top-tier table
+    edtsp_zone_init((uint16_t)(observer / ZN_ZONE + 1), zn_id[observer]);
+    edtsp_zone_set_uplink(true, 0);
+    
+    for (uint32_t t = 1; t <= ZN_SECONDS; t++) {
+        uint64_t now_ms = (uint64_t)t * 1000;
+        
+        // Top master dies; its zone finds out one heartbeat timeout later
+        if (t == ZN_KILL_S) {
+            killed = edtsp_zone_top_id();
+            for (int z = 0; z < ZN_ZONES; z++) {
+                if (zn_sub[z] >= 0 && zn_id[zn_sub[z]] == killed) killed_zone = z;
+            }
+            int node = zn_sub[killed_zone];
+            zn_down_until[node] = UINT32_MAX;
+            zn_sub[killed_zone] = -1;
+            zn_elect_at[killed_zone] = t + EDTSP_HEARTBEAT_TIMEOUT_MS / 1000;
+            killed_top_s = t;
+        }
+        for (int z = 0; z < ZN_ZONES; z++) {
+            if (zn_sub[z] >= 0 || t < zn_elect_at[z]) continue;
+            for (int i = z * ZN_ZONE; i < (z + 1) * ZN_ZONE; i++) {
+                if (zn_down_until[i] == UINT32_MAX) {
+                    edtsp_zone_agg_member(&zn_agg[z], zn_id[i], false);
+                    zn_down_until[i] = UINT32_MAX - 1; // Stays down, counted once
+                }
+            }
+            zn_sub[z] = zn_elect(z);
+        }
+        
+        // Churn: slaves leave and rejoin
+        for (int c = 0; c < ZN_CHURN; c++) {
+            int i = (int)(bench_rand(&rng) % ZN_NODES);
+            int z = i / ZN_ZONE;
+            if (zn_down_until[i] || i == zn_sub[z]) continue;
+            zn_down_until[i] = t + ZN_DOWN_S;
+            edtsp_zone_agg_member(&zn_agg[z], zn_id[i], false);
+        }
+        for (int i = 0; i < ZN_NODES; i++) {
+            if (zn_down_until[i] && zn_down_until[i] < UINT32_MAX - 1 && zn_down_until[i] <= t) {
+                zn_down_until[i] = 0;
+                edtsp_zone_agg_member(&zn_agg[i / ZN_ZONE], zn_id[i], true);
+            }
+        }
+        
+        // DATA: every live slave, ingested by its sub-master (if the zone has one)
+        uint64_t start = now_ns();
+        for (int i = 0; i < ZN_NODES; i++) {
+            int z = i / ZN_ZONE;
+            if (zn_down_until[i] || i == zn_sub[z]) continue;
+            for (int f = 0; f < ZN_FPS; f++) {
+                int32_t v = zn_value[i] += (int16_t)((bench_rand(&rng) % 3) - 1);
+                sent++;
+                if (zn_sub[z] < 0) continue;
+                edtsp_zone_agg_frame(&zn_agg[z], 4);
+                edtsp_zone_agg_samples(&zn_agg[z], 0, &v, 1);
+                exact_sum += v;
+                ingested++;
+            }
+        }
+        agg_ns += now_ns() - start;
+        
+        // Summaries on the uplink, heard by the observer
+        int count = 0;
+        for (int z = 0; z < ZN_ZONES; z++) {
+            if (zn_sub[z] < 0) continue;
+            uint8_t role = zn_id[zn_sub[z]] == edtsp_zone_top_id() ? EDTSP_ROLE_MASTER : EDTSP_ROLE_SLAVE;
+            wire_len[count] = edtsp_zone_agg_build(&zn_agg[z], &wire[count], zn_id[zn_sub[z]],
+                                                   (uint16_t)(z + 1), role, now_ms);
+            summary_bytes += wire_len[count];
+            count++;
+        }
+        start = now_ns();
+        for (int k = 0; k < count; k++) {
+            edtsp_decode_zone_summary(&wire[k]);
+            uint32_t source = EDTSP_WIRE32(wire[k].header.source_id);
+            edtsp_zone_on_summary(source, &wire[k], wire_len[k], now_ms);
+            if (killed_zone >= 0 && wire[k].zone_id == killed_zone + 1 && !handover_s &&
+                edtsp_zone_entry((uint16_t)(killed_zone + 1))->handovers) {
+                handover_s = t;
+            }
+        }
+        edtsp_zone_check_timeouts(now_ms);
+        top_ns += now_ns() - start;
+        summaries += (uint64_t)count;
+        if (killed && !new_top_s && edtsp_zone_top_id() != killed) new_top_s = t;
+    }
+    
+    // Expected view: live nodes, highest sub-master
+    uint32_t live = 0, expect_top = 0;
+    for (int i = 0; i < ZN_NODES; i++) live += !zn_down_until[i];
+    for (int z = 0; z < ZN_ZONES; z++) {
+        if (zn_sub[z] >= 0 && zn_id[zn_sub[z]] > expect_top) expect_top = zn_id[zn_sub[z]];
+    }
+    const EDTSPZoneStats *st = edtsp_zone_stats();
+    
+    printf("  flat:  one master ingests %d frames/s and tracks %d devices (table holds %d)\n",
+           (ZN_NODES - 1) * ZN_FPS, ZN_NODES - 1, EDTSP_MAX_DEVICES);
+    printf("  zoned: each sub-master ingests <= %d frames/s and tracks <= %d devices;\n"
+           "         the top ingests %d summaries/s (%.0f B/s) and tracks %d zones\n",
+           (ZN_ZONE - 1) * ZN_FPS, ZN_ZONE - 1, ZN_ZONES,
+           (double)summary_bytes / ZN_SECONDS, ZN_ZONES);
+    report("sub-master aggregate (per frame)", ingested, agg_ns);
+    report("top ingest + timeouts (per summary)", summaries, top_ns);
+    printf("  failover: top 0x%08X lost at %u s; zone %d handed over at %u s, new top 0x%08X at %u s\n",
+           killed, killed_top_s, killed_zone + 1, handover_s, edtsp_zone_top_id(), new_top_s);
+    printf("  top view at %d s: %u of %u devices in %u zones, top 0x%08X (expected 0x%08X) %s\n",
+           ZN_SECONDS, st->members, live, st->zones, edtsp_zone_top_id(), expect_top,
+           st->members == live && st->zones == ZN_ZONES && edtsp_zone_top_id() == expect_top ? "OK" : "MISMATCH!");
+    printf("  DATA: %llu frames summarized of %llu ingested (%llu sent, %llu lost with no sub-master), "
+           "sensor mean %.2f (exact %.2f) %s\n",
+           (unsigned long long)st->frames, (unsigned long long)ingested, (unsigned long long)sent,
+           (unsigned long long)(sent - ingested),
+           st->sensors[0].samples ? (double)st->sensors[0].sum / st->sensors[0].samples : 0.0,
+           ingested ? (double)exact_sum / (double)ingested : 0.0,
+           st->frames == ingested && st->sensors[0].samples == ingested ? "OK" : "MISMATCH!");
+    edtsp_zone_init(0, 0);
+}
+
+// ============================================================================
+// SHARDED INGEST
+// ============================================================================
+
+enum { SH_SLAVES = 10000, SH_MAX_K = 16, SH_LOOKUPS = 4000000 };
+
+static uint32_t sh_slave[SH_SLAVES];
+static uint32_t sh_owner[SH_SLAVES];
+
+/** Owners of every slave; returns the largest node share */
+static int sh_assign(const EDTSPShardRing *r) {
+    int load[SH_MAX_K + 1] = {0};
+    int peak = 0;
+    for (int i = 0; i < SH_SLAVES; i++) {
+        sh_owner[i] = edtsp_shard_ring_lookup(r, sh_slave[i]);
+        for (int n = 0; n < r->nodes; n++) {
+            if (r->ids[n] == sh_owner[i] && ++load[n] > peak) peak = load[n];
+        }
+    }
+    return peak;
+}
+
+/**
+ * Consistent hashing of 10,000 slaves over 2-16 ingest nodes: balance
+ * (the busiest node bounds aggregate throughput), the share that moves
+ * when a node fails or joins against modulo hashing, then the master's
+ * assignment path (edtsp_shard_assign over a full device table) through a
+ * node timeout, counting the CONFIGs it sends.
+ */
+static void bench_shard(void) {
+    static EDTSPShardRing ring;
+    static uint32_t before[SH_SLAVES];
+    uint32_t nodes[SH_MAX_K + 1];
+    uint32_t rng = 0x5A4D0001u;
+    
+    printf("[BENCH] shard (%d slaves, %d points per ingest node)\n", SH_SLAVES, EDTSP_SHARD_VNODES);
+    
+    for (int i = 0; i < SH_SLAVES; i++) {
+        do sh_slave[i] = bench_rand(&rng); while (!sh_slave[i]);
+    }
+    for (int n = 0; n <= SH_MAX_K; n++) {
+        do nodes[n] = bench_rand(&rng); while (!nodes[n]);
+    }
+    
+    for (int k = 2; k <= SH_MAX_K; k *= 2) {
+        edtsp_shard_ring_build(&ring, nodes, k);
+        int peak = sh_assign(&ring);
+        memcpy(before, sh_owner, sizeof(before));
+        
+        // Node 0 fails: only its slaves may move
+        edtsp_shard_ring_build(&ring, nodes + 1, k - 1);
+        sh_assign(&ring);
+        int orphans = 0, moved = 0, modulo = 0;
+        for (int i = 0; i < SH_SLAVES; i++) {
+            orphans += before[i] == nodes[0];
+            moved += sh_owner[i] != before[i];
+            modulo += sh_slave[i] % (uint32_t)k != sh_slave[i] % (uint32_t)(k - 1);
+        }
+        memcpy(before, sh_owner, sizeof(before));
+        
+        // A new node k brings it back to k: only slaves it takes over move
+        edtsp_shard_ring_build(&ring, nodes + 1, k);
+        sh_assign(&ring);
+        int joined = 0, stray = 0;
+        for (int i = 0; i < SH_SLAVES; i++) {
+            if (sh_owner[i] == before[i]) continue;
+            joined++;
+            stray += sh_owner[i] != nodes[k];
+        }
+        
+        printf("  %2d nodes: busiest %4.1f%% (ideal %4.1f%%), aggregate ingest %5.2fx one master; "
+               "a failure moves %4.1f%% (modulo hashing %4.1f%%), a join %4.1f%% %s\n",
+               k, 100.0 * peak / SH_SLAVES, 100.0 / k, (double)SH_SLAVES / peak,
+               100.0 * moved / SH_SLAVES, 100.0 * modulo / SH_SLAVES, 100.0 * joined / SH_SLAVES,
+               moved == orphans && !stray ? "OK" : "EXTRA MOVES!");
+    }
+    
+    edtsp_shard_ring_build(&ring, nodes, SH_MAX_K);
+    uint32_t sink = 0;
+    uint64_t start = now_ns();
+    for (int i = 0; i < SH_LOOKUPS; i++) sink += edtsp_shard_ring_lookup(&ring, sh_slave[i % SH_SLAVES]);
+    report("ring lookup (16 nodes)", SH_LOOKUPS, now_ns() - start);
+    start = now_ns();
+    for (int i = 0; i < 1000; i++) edtsp_shard_ring_build(&ring, nodes, SH_MAX_K);
+    report("ring build (16 nodes)", 1000, now_ns() - start);
+    
+    // Master: a full device table, 4 ingest nodes
+    enum { SLOTS = EDTSP_MAX_DEVICES, K = 4 };
+    EDTSPShardTarget t;
+    int owned = 0, configs = 0;
+    edtsp_shard_init(0xFFFFFFFFu);
+    for (int n = 0; n < K; n++) edtsp_shard_on_ingest(nodes[n], 0x7F000001u, (uint16_t)(40000 + n), 0);
+    for (int s = 0; s < SLOTS; s++) configs += edtsp_shard_assign(s, sh_slave[s], 1000, &t);
+    int first = configs;
+    
+    // Node 0 stops: the others keep heartbeating, it times out
+    for (int s = 0; s < SLOTS; s++) {
+        EDTSPShardTarget cur;
+        edtsp_shard_assign(s, sh_slave[s], 1500, &cur);
+        owned += cur.id == nodes[0];
+    }
+    uint64_t fail_ms = 1000 + EDTSP_HEARTBEAT_TIMEOUT_MS + 1;
+    for (int n = 1; n < K; n++) edtsp_shard_on_ingest(nodes[n], 0x7F000001u, (uint16_t)(40000 + n), fail_ms);
+    edtsp_shard_check_timeouts(fail_ms);
+    configs = 0;
+    start = now_ns();
+    for (int s = 0; s < SLOTS; s++) configs += edtsp_shard_assign(s, sh_slave[s], fail_ms, &t);
+    uint64_t tick_ns = now_ns() - start;
+    int refresh = 0;
+    for (int s = 0; s < SLOTS; s++) refresh += edtsp_shard_assign(s, sh_slave[s], fail_ms + EDTSP_SHARD_REFRESH_MS, &t);
+    const EDTSPShardStats *st = edtsp_shard_stats();
+    
+    printf("  master, %d slaves on %d nodes: %d CONFIGs to start; node lost after %d ms: %d CONFIGs "
+           "for %d orphaned slaves, %u moved %s; %d refreshes after %d ms\n",
+           SLOTS, K, first, EDTSP_HEARTBEAT_TIMEOUT_MS, configs, owned, st->last_moved,
+           configs == owned && st->last_moved == (uint32_t)owned ? "OK" : "MISMATCH!", refresh,
+           EDTSP_SHARD_REFRESH_MS);
+    report("assignment tick (per slave)", SLOTS, tick_ns);
+    if (sink == 1) printf("  (sink)\n");
+    edtsp_shard_init(0);
+}
+
+// ============================================================================
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} EDTSPBench;
+
+static const EDTSPBench benches[] = {
+    {"dedup", bench_dedup},
+    {"clocksync", bench_clocksync},
+    {"codec", bench_codec},
+    {"dispatch", bench_dispatch},
+    {"pool", bench_pool},
+    {"group", bench_group},
+    {"index", bench_index},
+    {"handshake", bench_handshake},
+    {"capdesc", bench_capdesc},
+    {"deadband", bench_deadband},
+    {"window", bench_window},
+    {"pack", bench_pack},
+    {"ratelimit", bench_ratelimit},
+    {"flow", bench_flow},
+    {"auth", bench_auth},
+    {"aead", bench_aead},
+    {"zone", bench_zone},
+    {"shard", bench_shard},
+};
+
+int main(int argc, char **argv) {
+    const char *only = argc > 1 ? argv[1] : NULL;
+    bench_arg = argc > 2 ? argv[2] : NULL;
+    int ran = 0;
+    
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (only && strcmp(only, benches[i].name) != 0) continue;
+        benches[i].run();
+        ran++;
+    }
+    
+    if (!ran) {
+        fprintf(stderr, "Unknown benchmark: %s\n", only);
+        return 1;
+    }
+    return failed_checks ? 1 : 0;
+}
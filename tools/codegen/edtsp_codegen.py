@@ -0,0 +1,698 @@
+#!/usr/bin/env python3
+"""
+EDTSP code generator
+
+Reads tools/codegen/edtsp.schema and writes:
+  include/edtsp_packets.h          packet structs, enum, per-type codecs
+  platform/esp32/edtsp_packets.h   identical copy for the Arduino sketch
+  platform/esp32/protocol.h        identical copy of include/protocol.h
+  src/edtsp_codec.c                dispatch table indexed by packet type
+  tools/wireshark/edtsp.lua        Wireshark dissector
+
+Usage: edtsp_codegen.py [--check]
+  --check  Do not write, exit 1 if any output is out of date
+"""
+
+import os
+import re
+import shlex
+import sys
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+SCHEMA = "tools/codegen/edtsp.schema"
+GENERATOR = "tools/codegen/edtsp_codegen.py"
+
+SCALARS = {
+    "u8":  ("uint8_t", 1),
+    "u16": ("uint16_t", 2),
+    "u32": ("uint32_t", 4),
+    "u64": ("uint64_t", 8),
+}
+
+
+class SchemaError(Exception):
+    pass
+
+
+class Field:
+    def __init__(self, kind, name, label, attrs, doc):
+        self.name = name
+        self.label = label
+        self.doc = doc
+        self.hex = "hex" in attrs
+        self.info = "info" in attrs
+        self.names = attrs.get("names")
+        self.len_field = attrs.get("len")
+        self.filter = attrs.get("filter", name)
+        self.count = 0
+
+        m = re.fullmatch(r"(u8|u16|u32|u64|char)(?:\[(\d+)\])?", kind)
+        if not m:
+            raise SchemaError("unknown field type '%s'" % kind)
+        base, count = m.group(1), m.group(2)
+        if base == "char" and not count:
+            raise SchemaError("char fields must be arrays")
+        if count:
+            if base not in ("u8", "char"):
+                raise SchemaError("only u8/char arrays are supported")
+            self.count = int(count)
+            self.ctype = "char" if base == "char" else "uint8_t"
+            self.width = 1
+            self.size = self.count
+        else:
+            self.ctype, self.width = SCALARS[base]
+            self.size = self.width
+        self.base = base
+        self.ctype = attrs.get("ctype", self.ctype)
+
+
+class Packet:
+    def __init__(self, name, type_id):
+        self.name = name
+        self.type_id = type_id
+        self.brief = ""
+        self.title = ""
+        self.struct = ""
+        self.doc = []
+        self.fields = []
+
+    @property
+    def lower(self):
+        return self.name.lower()
+
+    @property
+    def payload_size(self):
+        return sum(f.size for f in self.fields)
+
+    @property
+    def fixed_size(self):
+        """Payload bytes up to the first variable-length array"""
+        size = 0
+        for f in self.fields:
+            if f.len_field:
+                break
+            size += f.size
+        return size
+
+
+class Names:
+    def __init__(self, table, prefix=None, doc=None):
+        self.table = table
+        self.prefix = prefix
+        self.doc = doc
+        self.values = []
+
+
+def parse_schema(path):
+    packets, names = [], []
+    current = None
+
+    with open(path) as fh:
+        for lineno, raw in enumerate(fh, 1):
+            line = raw.rstrip()
+            if not line.strip() or line.lstrip().startswith("#"):
+                continue
+            try:
+                current = parse_line(line, current, packets, names)
+            except (SchemaError, ValueError) as exc:
+                raise SchemaError("%s:%d: %s" % (path, lineno, exc))
+
+    validate(packets, names)
+    return packets, names
+
+
+def parse_line(line, current, packets, names):
+    indented = line[0].isspace()
+    text = line.strip()
+
+    if not indented:
+        words = shlex.split(text)
+        if words[0] == "packet":
+            if len(words) != 4 or words[2] != "=":
+                raise SchemaError("expected 'packet <NAME> = <id>'")
+            pkt = Packet(words[1], int(words[3], 0))
+            packets.append(pkt)
+            return pkt
+        if words[0] == "names":
+            tbl = Names(words[1])
+            if len(words) > 2:
+                if len(words) != 5 or words[2] != "define":
+                    raise SchemaError("expected 'names <table> [define <PREFIX> \"doc\"]'")
+                tbl.prefix, tbl.doc = words[3], words[4]
+            names.append(tbl)
+            return tbl
+        raise SchemaError("unknown directive '%s'" % words[0])
+
+    if current is None:
+        raise SchemaError("indented line outside a block")
+
+    if isinstance(current, Names):
+        value, name = text.split()
+        current.values.append((int(value, 0), name))
+        return current
+
+    key, _, rest = text.partition(" ")
+    rest = rest.strip()
+    if key == "brief":
+        current.brief = rest
+    elif key == "title":
+        current.title = rest
+    elif key == "struct":
+        current.struct = rest
+    elif key == "doc":
+        current.doc.append(rest)
+    elif key == "field":
+        spec, sep, doc = rest.partition(" -- ")
+        if not sep:
+            raise SchemaError("field needs a '-- <C doc>' comment")
+        words = shlex.split(spec)
+        if len(words) < 3:
+            raise SchemaError("expected 'field <type> <name> \"<Label>\" [attrs]'")
+        attrs = {}
+        for word in words[3:]:
+            k, _, v = word.partition("=")
+            attrs[k] = v if v else True
+        current.fields.append(Field(words[0], words[1], words[2], attrs, doc.strip()))
+    else:
+        raise SchemaError("unknown packet key '%s'" % key)
+    return current
+
+
+def validate(packets, names):
+    tables = {n.table for n in names}
+    ids = set()
+    for pkt in packets:
+        if pkt.type_id in ids:
+            raise SchemaError("duplicate packet type id %d" % pkt.type_id)
+        ids.add(pkt.type_id)
+        if not pkt.struct:
+            raise SchemaError("packet %s has no struct name" % pkt.name)
+        field_names = [f.name for f in pkt.fields]
+        for f in pkt.fields:
+            if f.names and f.names not in tables:
+                raise SchemaError("%s.%s: unknown names table '%s'" % (pkt.name, f.name, f.names))
+            if f.len_field and f.len_field not in field_names[:field_names.index(f.name)]:
+                raise SchemaError("%s.%s: len field must precede the array" % (pkt.name, f.name))
+    if sorted(ids) != list(range(1, len(ids) + 1)):
+        raise SchemaError("packet type ids must be contiguous from 1")
+
+    # One Wireshark field per filter name
+    seen = {}
+    for pkt in packets:
+        for f in pkt.fields:
+            key = (f.base, f.count, f.hex, f.label)
+            if seen.setdefault(f.filter, key) != key:
+                raise SchemaError("filter edtsp.%s used with different types/labels" % f.filter)
+
+
+# ============================================================================
+# C HEADER
+# ============================================================================
+
+def gen_header(packets, names):
+    out = []
+    w = out.append
+    pkts = sorted(packets, key=lambda p: p.type_id)
+    last = pkts[-1]
+
+    w("/**")
+    w(" * @file edtsp_packets.h")
+    w(" * @brief EDTSP Packet Layouts and Codecs")
+    w(" * ")
+    w(" * GENERATED by %s from %s - do not edit." % (GENERATOR, SCHEMA))
+    w(" * Run `make generate` after changing the schema.")
+    w(" * ")
+    w(" * Included by protocol.h; relies on EDTSPHeader and EDTSPCapabilityMask.")
+    w(" */")
+    w("")
+    w("#ifndef EDTSP_PACKETS_H")
+    w("#define EDTSP_PACKETS_H")
+    w("")
+    w("// ============================================================================")
+    w("// PACKET TYPES")
+    w("// ============================================================================")
+    w("")
+    w("/** Packet type enumeration */")
+    w("typedef enum {")
+    width = max(len("EDTSP_TYPE_" + p.name) for p in pkts)
+    for p in pkts:
+        ident = "EDTSP_TYPE_" + p.name
+        value = "%d%s" % (p.type_id, "," if p is not last else " ")
+        w("    %s = %s  /**< %s */" % (ident.ljust(width + 1), value, p.brief))
+    w("} EDTSPPacketType;")
+    w("")
+    w("/** Highest valid packet type */")
+    w("#define EDTSP_TYPE_MAX EDTSP_TYPE_%s" % last.name)
+    w("")
+
+    w("// ============================================================================")
+    w("// PACKET STRUCTURES")
+    w("// ============================================================================")
+    w("")
+    w("#pragma pack(push, 1)")
+    for p in pkts:
+        w("")
+        w("/**")
+        w(" * Type %d: %s" % (p.type_id, p.title or p.name + " Packet"))
+        if p.doc:
+            w(" * ")
+            for line in p.doc:
+                w(" * " + line)
+        w(" */")
+        w("typedef struct {")
+        tw = max([len("EDTSPHeader")] + [len(f.ctype) for f in p.fields])
+        decls = [("EDTSPHeader", "header;", "Standard header")]
+        for f in p.fields:
+            decl = f.name + ("[%d]" % f.count if f.count else "") + ";"
+            decls.append((f.ctype, decl, f.doc))
+        nw = max(37 - 4 - (tw + 1), max(len(d[1]) for d in decls) + 1)
+        for ctype, decl, doc in decls:
+            w("    %s %s/**< %s */" % (ctype.ljust(tw), decl.ljust(nw), doc))
+        w("} %s;" % p.struct)
+    w("")
+    w("#pragma pack(pop)")
+    w("")
+    for p in pkts:
+        size = 8 + p.payload_size
+        w("_Static_assert(sizeof(%s) == %d, \"%s must be %d bytes\");" % (p.struct, size, p.struct, size))
+    for tbl in names:
+        if not tbl.prefix:
+            continue
+        w("")
+        w("/** %s */" % tbl.doc)
+        vw = max(len("%s_%s" % (tbl.prefix, n)) for _, n in tbl.values)
+        for value, n in tbl.values:
+            w("#define %s %d" % (("%s_%s" % (tbl.prefix, n)).ljust(vw), value))
+    w("")
+
+    w("// ============================================================================")
+    w("// CODECS (payload fields, header handled by edtsp_init_header/parse_header)")
+    w("// ============================================================================")
+    w("")
+    w("// Wire order is big-endian; the swap is selected at compile time so every")
+    w("// codec is a straight sequence of byte-swap instructions without branches")
+    w("#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)")
+    w("#define EDTSP_WIRE16(x) (x)")
+    w("#define EDTSP_WIRE32(x) (x)")
+    w("#define EDTSP_WIRE64(x) (x)")
+    w("#else")
+    w("#define EDTSP_WIRE16(x) __builtin_bswap16(x)")
+    w("#define EDTSP_WIRE32(x) __builtin_bswap32(x)")
+    w("#define EDTSP_WIRE64(x) __builtin_bswap64(x)")
+    w("#endif")
+    for p in pkts:
+        swaps = [f for f in p.fields if not f.count and f.width > 1]
+        for verb, what in (("encode", "host to network"), ("decode", "network to host")):
+            w("")
+            w("/** %s payload: %s byte order */" % (p.name, what))
+            w("static inline void edtsp_%s_%s(%s *pkt) {" % (verb, p.lower, p.struct))
+            if not swaps:
+                w("    (void)pkt;")
+            for f in swaps:
+                w("    pkt->%s = EDTSP_WIRE%d(pkt->%s);" % (f.name, f.width * 8, f.name))
+            w("}")
+    w("")
+    w("/** Codec entry (one per packet type) */")
+    w("typedef struct {")
+    w("    const char *name;              /**< Type name */")
+    w("    uint16_t    size;              /**< Packet struct size */")
+    w("    uint16_t    min_len;           /**< Smallest valid v1 frame (header + fixed fields) */")
+    w("    void      (*encode)(void *pkt);  /**< Payload to network byte order */")
+    w("    void      (*decode)(void *pkt);  /**< Payload to host byte order */")
+    w("} EDTSPCodec;")
+    w("")
+    w("/** Dispatch table indexed by packet type (entry 0 unused, src/edtsp_codec.c) */")
+    w("extern const EDTSPCodec edtsp_codecs[EDTSP_TYPE_MAX + 1];")
+    w("")
+    w("/**")
+    w(" * Get packet type name (for debugging)")
+    w(" * ")
+    w(" * @param type Packet type")
+    w(" * @return String name")
+    w(" */")
+    w("static inline const char* edtsp_type_name(uint8_t type) {")
+    w("    switch (type) {")
+    cw = max(len("EDTSP_TYPE_%s:" % p.name) for p in pkts)
+    for p in pkts:
+        w("        case %s return \"%s\";" % (("EDTSP_TYPE_%s:" % p.name).ljust(cw), p.name))
+    w("        default:%s return \"UNKNOWN\";" % (" " * (cw - len("default:") + 5)))
+    w("    }")
+    w("}")
+    w("")
+    w("#endif // EDTSP_PACKETS_H")
+    return "\n".join(out) + "\n"
+
+
+# ============================================================================
+# C DISPATCH TABLE
+# ============================================================================
+
+def gen_codec(packets):
+    out = []
+    w = out.append
+    pkts = sorted(packets, key=lambda p: p.type_id)
+
+    w("/**")
+    w(" * @file edtsp_codec.c")
+    w(" * @brief EDTSP Codec Dispatch Table")
+    w(" * ")
+    w(" * GENERATED by %s from %s - do not edit." % (GENERATOR, SCHEMA))
+    w(" */")
+    w("")
+    w("#include \"../include/protocol.h\"")
+    w("#include <stddef.h>")
+    w("")
+    for p in pkts:
+        w("static void encode_%s(void *pkt) { edtsp_encode_%s((%s*)pkt); }" % (p.lower, p.lower, p.struct))
+        w("static void decode_%s(void *pkt) { edtsp_decode_%s((%s*)pkt); }" % (p.lower, p.lower, p.struct))
+    w("")
+    w("const EDTSPCodec edtsp_codecs[EDTSP_TYPE_MAX + 1] = {")
+    iw = max(len("[EDTSP_TYPE_%s]" % p.name) for p in pkts)
+    for p in pkts:
+        if p.fixed_size == p.payload_size:
+            min_len = "sizeof(%s)" % p.struct
+        else:
+            var = next(f for f in p.fields if f.len_field)
+            min_len = "offsetof(%s, %s)" % (p.struct, var.name)
+        idx = "[EDTSP_TYPE_%s]" % p.name
+        w("    %s = { \"%s\", sizeof(%s), %s, encode_%s, decode_%s }," %
+          (idx.ljust(iw), p.name, p.struct, min_len, p.lower, p.lower))
+    w("};")
+    return "\n".join(out) + "\n"
+
+
+# ============================================================================
+# WIRESHARK DISSECTOR
+# ============================================================================
+
+LUA_FIELD_TYPES = {"u8": "uint8", "u16": "uint16", "u32": "uint32", "u64": "uint64"}
+
+LUA_HEAD = '''-- EDTSP Wireshark Dissector
+-- Protocol: EDTSP (ED61 Transport Protocol)
+-- GENERATED by %s from %s - do not edit.
+
+-- Create protocol object
+local edtsp_proto = Proto("EDTSP", "ED61 Transport Protocol")
+
+-- Protocol fields
+local f_magic = ProtoField.uint16("edtsp.magic", "Magic", base.HEX)
+local f_type = ProtoField.uint8("edtsp.type", "Packet Type", base.DEC)
+local f_source_id = ProtoField.uint32("edtsp.source_id", "Source ID", base.HEX)
+local f_payload_len = ProtoField.uint8("edtsp.payload_len", "Payload Length", base.DEC)
+
+-- v2 header fields
+local f_flags = ProtoField.uint8("edtsp.flags", "Flags", base.HEX)
+local f_flag_aggregated = ProtoField.bool("edtsp.flags.aggregated", "Aggregated", 8, nil, 0x01)
+local f_flag_compressed = ProtoField.bool("edtsp.flags.compressed", "Compressed", 8, nil, 0x02)
+local f_flag_authenticated = ProtoField.bool("edtsp.flags.authenticated", "Authenticated", 8, nil, 0x04)
+local f_flag_encrypted = ProtoField.bool("edtsp.flags.encrypted", "Encrypted", 8, nil, 0x10)
+local f_payload_len16 = ProtoField.uint16("edtsp.payload_len16", "Payload Length", base.DEC)
+local f_hdr_version = ProtoField.uint8("edtsp.hdr_version", "Header Version", base.DEC)
+local f_header_len = ProtoField.uint8("edtsp.header_len", "Header Length", base.DEC)
+local f_seq = ProtoField.uint32("edtsp.seq", "Sequence Number", base.DEC)
+local f_auth_tag = ProtoField.uint64("edtsp.auth_tag", "Authentication Tag", base.HEX)
+local f_ciphertext = ProtoField.bytes("edtsp.ciphertext", "Encrypted Payload (ciphertext + AEAD tag)")
+'''
+
+LUA_HEADER_PARSE = '''
+-- Dissector function
+function edtsp_proto.dissector(buffer, pinfo, tree)
+    -- Check minimum packet size
+    if buffer:len() < 8 then
+        return 0
+    end
+
+    -- Check magic number (0xED61 = v1 header, 0xED62 = v2 header)
+    local magic = buffer(0, 2):uint()
+    if magic ~= 0xED61 and magic ~= 0xED62 then
+        return 0
+    end
+    if magic == 0xED62 and buffer:len() < 16 then
+        return 0
+    end
+
+    -- Set protocol column
+    pinfo.cols.protocol = "EDTSP"
+
+    -- Parse header
+    local pkt_type = buffer(2, 1):uint()
+    local type_name = packet_types[pkt_type] or "UNKNOWN"
+    local source_id, payload_len, offset
+    local header_tree
+    local subtree = tree:add(edtsp_proto, buffer(), "EDTSP Protocol")
+
+    if magic == 0xED61 then
+        source_id = buffer(3, 4):uint()
+        payload_len = buffer(7, 1):uint()
+        offset = 8
+
+        header_tree = subtree:add(buffer(0, 8), "Header")
+        header_tree:add(f_magic, buffer(0, 2))
+        header_tree:add(f_type, buffer(2, 1)):append_text(" (" .. type_name .. ")")
+        header_tree:add(f_source_id, buffer(3, 4))
+        header_tree:add(f_payload_len, buffer(7, 1))
+    else
+        source_id = buffer(4, 4):uint()
+        payload_len = buffer(8, 2):uint()
+        offset = buffer(11, 1):uint()
+        if offset < 16 or buffer:len() < offset then
+            offset = 16
+        end
+
+        header_tree = subtree:add(buffer(0, offset), "Header v2")
+        header_tree:add(f_magic, buffer(0, 2))
+        header_tree:add(f_type, buffer(2, 1)):append_text(" (" .. type_name .. ")")
+        local flags_tree = header_tree:add(f_flags, buffer(3, 1))
+        flags_tree:add(f_flag_aggregated, buffer(3, 1))
+        flags_tree:add(f_flag_compressed, buffer(3, 1))
+        flags_tree:add(f_flag_authenticated, buffer(3, 1))
+        flags_tree:add(f_flag_encrypted, buffer(3, 1))
+        header_tree:add(f_source_id, buffer(4, 4))
+        header_tree:add(f_payload_len16, buffer(8, 2))
+        header_tree:add(f_hdr_version, buffer(10, 1))
+        header_tree:add(f_header_len, buffer(11, 1))
+        header_tree:add(f_seq, buffer(12, 4))
+    end
+
+    -- Set info column
+    pinfo.cols.info = string.format("%s from 0x%08X", type_name, source_id)
+    if magic == 0xED62 then
+        pinfo.cols.info = pinfo.cols.info .. string.format(" v2 #%d", buffer(12, 4):uint())
+    end
+
+    -- Parse payload based on type (payload starts at offset); a sealed
+    -- payload is shown as is
+    local encrypted = magic == 0xED62 and math.floor(buffer(3, 1):uint() / 16) % 2 == 1
+    if encrypted then
+        pinfo.cols.info = pinfo.cols.info .. " [encrypted]"
+        if buffer:len() >= offset + payload_len then
+            subtree:add(f_ciphertext, buffer(offset, payload_len))
+        end
+
+'''
+
+LUA_TAIL = '''
+    -- Authentication tag (SipHash-2-4, little-endian) behind the payload
+    local frame_len = offset + payload_len
+    if magic == 0xED62 and math.floor(buffer(3, 1):uint() / 4) % 2 == 1 and buffer:len() >= frame_len + 8 then
+        subtree:add_le(f_auth_tag, buffer(frame_len, 8))
+        frame_len = frame_len + 8
+    end
+
+    -- Redundancy trailer directly behind header + payload (+ tag)
+    if buffer:len() == frame_len + 6 and buffer(frame_len + 4, 2):uint() == 0x88FB then
+        local rct_tree = subtree:add(buffer(frame_len, 6), "Redundancy Trailer")
+        rct_tree:add(f_rct_seq, buffer(frame_len, 2))
+        rct_tree:add(f_rct_path, buffer(frame_len + 2, 2))
+        rct_tree:add(f_rct_size, buffer(frame_len + 2, 2))
+        rct_tree:add(f_rct_suffix, buffer(frame_len + 4, 2))
+        local path = math.floor(buffer(frame_len + 2, 2):uint() / 4096)
+        pinfo.cols.info = pinfo.cols.info .. string.format(" [seq %d, path %X]", buffer(frame_len, 2):uint(), path)
+    end
+
+    return buffer:len()
+end
+
+-- Register dissector
+-- Try heuristic detection first (magic number based)
+function heuristic_checker(buffer, pinfo, tree)
+    if buffer:len() < 8 then
+        return false
+    end
+
+    local magic = buffer(0, 2):uint()
+    if magic == 0xED61 or magic == 0xED62 then
+        edtsp_proto.dissector(buffer, pinfo, tree)
+        return true
+    end
+
+    return false
+end
+
+-- Register as heuristic dissector
+edtsp_proto:register_heuristic("udp", heuristic_checker)
+
+-- Also register for specific UDP port
+local udp_table = DissectorTable.get("udp.port")
+udp_table:add(5000, edtsp_proto)
+
+print("EDTSP dissector loaded successfully!")
+'''
+
+
+def lua_var(f):
+    return "f_" + f.filter.replace(".", "_")
+
+
+def gen_lua(packets, names):
+    out = []
+    w = out.append
+    pkts = sorted(packets, key=lambda p: p.type_id)
+
+    w(LUA_HEAD % (GENERATOR, SCHEMA))
+    w("-- Payload fields (type-specific)")
+    declared = []
+    for p in pkts:
+        for f in p.fields:
+            if f.filter in declared:
+                continue
+            declared.append(f.filter)
+            if f.base == "char":
+                w('local %s = ProtoField.string("edtsp.%s", "%s")' % (lua_var(f), f.filter, f.label))
+            elif f.count:
+                w('local %s = ProtoField.bytes("edtsp.%s", "%s")' % (lua_var(f), f.filter, f.label))
+            else:
+                w('local %s = ProtoField.%s("edtsp.%s", "%s", base.%s)' %
+                  (lua_var(f), LUA_FIELD_TYPES[f.base], f.filter, f.label, "HEX" if f.hex else "DEC"))
+    w("")
+    w("-- Redundancy trailer fields (dual-path transmission)")
+    w('local f_rct_seq = ProtoField.uint16("edtsp.rct.seq", "Sequence", base.DEC)')
+    w('local f_rct_path = ProtoField.uint16("edtsp.rct.path", "Path", base.HEX, nil, 0xF000)')
+    w('local f_rct_size = ProtoField.uint16("edtsp.rct.size", "Frame Size", base.DEC, nil, 0x0FFF)')
+    w('local f_rct_suffix = ProtoField.uint16("edtsp.rct.suffix", "Suffix", base.HEX)')
+    w("")
+    w("-- Register fields")
+    w("edtsp_proto.fields = {")
+    w("    f_magic, f_type, f_source_id, f_payload_len,")
+    w("    f_flags, f_flag_aggregated, f_flag_compressed, f_flag_authenticated,")
+    w("    f_flag_encrypted, f_payload_len16, f_hdr_version, f_header_len, f_seq, f_auth_tag, f_ciphertext,")
+    by_packet = []
+    for p in pkts:
+        vars_ = []
+        for f in p.fields:
+            v = lua_var(f)
+            if v not in [x for row in by_packet for x in row] and v not in vars_:
+                vars_.append(v)
+        if vars_:
+            by_packet.append(vars_)
+    for row in by_packet:
+        w("    " + ", ".join(row) + ",")
+    w("    f_rct_seq, f_rct_path, f_rct_size, f_rct_suffix")
+    w("}")
+    w("")
+    w("-- Packet type names")
+    w("local packet_types = {")
+    for i, p in enumerate(pkts):
+        w('    [%d] = "%s"%s' % (p.type_id, p.name, "," if i < len(pkts) - 1 else ""))
+    w("}")
+    for tbl in names:
+        w("")
+        w("-- %s names" % tbl.table.replace("_", " ").capitalize())
+        w("local %s_names = {" % tbl.table)
+        for i, (value, n) in enumerate(tbl.values):
+            w('    [%d] = "%s"%s' % (value, n, "," if i < len(tbl.values) - 1 else ""))
+        w("}")
+    out.append(LUA_HEADER_PARSE.rstrip("\n"))
+
+    for i, p in enumerate(pkts):
+        w("    elseif pkt_type == %d then  -- %s" % (p.type_id, p.name))
+        w("        if buffer:len() >= offset + %d then" % p.fixed_size)
+        w('            local payload_tree = subtree:add(buffer(offset), "%s Payload")' % p.name.capitalize())
+        referenced = {f.len_field for f in p.fields if f.len_field}
+        pos = 0
+        for f in p.fields:
+            at = "offset" if pos == 0 else "offset + %d" % pos
+            rng = "buffer(%s, %d)" % (at, f.size)
+            if f.len_field:
+                w("            if buffer:len() >= %s + %s then" % (at, f.len_field))
+                w("                payload_tree:add(%s, buffer(%s, %s))" % (lua_var(f), at, f.len_field))
+                w("            end")
+            elif f.names:
+                tbl = "%s_names" % f.names
+                w("            local %s = %s:uint()" % (f.name, rng))
+                w('            payload_tree:add(%s, %s):append_text(" (" .. (%s[%s] or "UNKNOWN") .. ")")' %
+                  (lua_var(f), rng, tbl, f.name))
+                if f.info:
+                    w('            pinfo.cols.info = pinfo.cols.info .. " [" .. (%s[%s] or "UNKNOWN") .. "]"' %
+                      (tbl, f.name))
+            else:
+                if f.name in referenced:
+                    w("            local %s = %s:uint()" % (f.name, rng))
+                w("            payload_tree:add(%s, %s)" % (lua_var(f), rng))
+            pos += f.size
+        w("        end")
+        w("")
+    out[-1] = "    end"
+    out.append(LUA_TAIL.rstrip("\n"))
+    return indent_blank_lines("\n".join(out) + "\n")
+
+
+def indent_blank_lines(text):
+    """Blank lines inside a block carry the block indentation (repo style)"""
+    lines = text.split("\n")
+    for i, line in enumerate(lines):
+        if line or i == 0 or i + 1 >= len(lines):
+            continue
+        prev = next((l for l in reversed(lines[:i]) if l.strip()), "")
+        following = next((l for l in lines[i + 1:] if l.strip()), "")
+        if following[:1].isspace() and prev[:1].isspace():
+            lines[i] = prev[:len(prev) - len(prev.lstrip())]
+    return "\n".join(lines)
+
+
+# ============================================================================
+# MAIN
+# ============================================================================
+
+def main(argv):
+    check = "--check" in argv[1:]
+    packets, names = parse_schema(os.path.join(ROOT, SCHEMA))
+
+    header = gen_header(packets, names)
+    with open(os.path.join(ROOT, "include/protocol.h")) as fh:
+        protocol = fh.read()
+
+    outputs = {
+        "include/edtsp_packets.h": header,
+        "platform/esp32/edtsp_packets.h": header,
+        "platform/esp32/protocol.h": protocol,
+        "src/edtsp_codec.c": gen_codec(packets),
+        "tools/wireshark/edtsp.lua": gen_lua(packets, names),
+    }
+
+    stale = []
+    for rel, text in outputs.items():
+        path = os.path.join(ROOT, rel)
+        try:
+            with open(path) as fh:
+                current = fh.read()
+        except FileNotFoundError:
+            current = None
+        if current == text:
+            continue
+        stale.append(rel)
+        if not check:
+            with open(path, "w") as fh:
+                fh.write(text)
+
+    for rel in stale:
+        print("%s %s" % ("out of date:" if check else "generated", rel))
+    return 1 if check and stale else 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main(sys.argv))
+    except SchemaError as exc:
+        sys.stderr.write("edtsp_codegen: %s\n" % exc)
+        sys.exit(2)
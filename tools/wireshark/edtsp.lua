@@ -1,6 +1,6 @@
 -- EDTSP Wireshark Dissector
 -- Protocol: EDTSP (ED61 Transport Protocol)
--- Author: Auto-generated for EDTSP project
+-- GENERATED by tools/codegen/edtsp_codegen.py from tools/codegen/edtsp.schema - do not edit.
 
 -- Create protocol object
 local edtsp_proto = Proto("EDTSP", "ED61 Transport Protocol")
@@ -11,31 +11,115 @@ local f_type = ProtoField.uint8("edtsp.type", "Packet Type", base.DEC)
 local f_source_id = ProtoField.uint32("edtsp.source_id", "Source ID", base.HEX)
 local f_payload_len = ProtoField.uint8("edtsp.payload_len", "Payload Length", base.DEC)
 
+-- v2 header fields
+local f_flags = ProtoField.uint8("edtsp.flags", "Flags", base.HEX)
+local f_flag_aggregated = ProtoField.bool("edtsp.flags.aggregated", "Aggregated", 8, nil, 0x01)
+local f_flag_compressed = ProtoField.bool("edtsp.flags.compressed", "Compressed", 8, nil, 0x02)
+local f_flag_authenticated = ProtoField.bool("edtsp.flags.authenticated", "Authenticated", 8, nil, 0x04)
+local f_flag_encrypted = ProtoField.bool("edtsp.flags.encrypted", "Encrypted", 8, nil, 0x10)
+local f_payload_len16 = ProtoField.uint16("edtsp.payload_len16", "Payload Length", base.DEC)
+local f_hdr_version = ProtoField.uint8("edtsp.hdr_version", "Header Version", base.DEC)
+local f_header_len = ProtoField.uint8("edtsp.header_len", "Header Length", base.DEC)
+local f_seq = ProtoField.uint32("edtsp.seq", "Sequence Number", base.DEC)
+local f_auth_tag = ProtoField.uint64("edtsp.auth_tag", "Authentication Tag", base.HEX)
+local f_ciphertext = ProtoField.bytes("edtsp.ciphertext", "Encrypted Payload (ciphertext + AEAD tag)")
+
 -- Payload fields (type-specific)
 local f_iface_type = ProtoField.uint8("edtsp.iface_type", "Interface Type", base.DEC)
 local f_version = ProtoField.uint8("edtsp.version", "Protocol Version", base.DEC)
 local f_device_name = ProtoField.string("edtsp.device_name", "Device Name")
 local f_role = ProtoField.uint8("edtsp.role", "Role", base.DEC)
-local f_uptime = ProtoField.uint32("edtsp.uptime_ms", "Uptime (ms)", base.DEC)
+local f_uptime_ms = ProtoField.uint32("edtsp.uptime_ms", "Uptime (ms)", base.DEC)
 local f_active_devices = ProtoField.uint8("edtsp.active_devices", "Active Devices", base.DEC)
+local f_ingest_addr = ProtoField.uint32("edtsp.ingest.addr", "Ingest Address", base.HEX)
+local f_ingest_port = ProtoField.uint16("edtsp.ingest.port", "Ingest Port", base.DEC)
 local f_handshake_step = ProtoField.uint8("edtsp.handshake_step", "Handshake Step", base.DEC)
 local f_target_id = ProtoField.uint32("edtsp.target_id", "Target ID", base.HEX)
 local f_capabilities = ProtoField.uint16("edtsp.capabilities", "Capabilities", base.HEX)
+local f_desc_len = ProtoField.uint8("edtsp.desc_len", "Descriptor Length", base.DEC)
+local f_descriptors = ProtoField.bytes("edtsp.descriptors", "Capability Descriptors")
 local f_sensor_id = ProtoField.uint8("edtsp.sensor_id", "Sensor ID", base.DEC)
-local f_sampling_rate = ProtoField.uint16("edtsp.sampling_rate_ms", "Sampling Rate (ms)", base.DEC)
+local f_sampling_rate_ms = ProtoField.uint16("edtsp.sampling_rate_ms", "Sampling Rate (ms)", base.DEC)
 local f_enable = ProtoField.uint8("edtsp.enable", "Enable", base.DEC)
-local f_timestamp = ProtoField.uint32("edtsp.timestamp_ms", "Timestamp (ms)", base.DEC)
+local f_deadband = ProtoField.uint16("edtsp.deadband", "Deadband", base.DEC)
+local f_max_silence_ms = ProtoField.uint32("edtsp.max_silence_ms", "Max Silence (ms)", base.DEC)
+local f_window_ms = ProtoField.uint32("edtsp.window_ms", "Window (ms)", base.DEC)
+local f_pack_samples = ProtoField.uint8("edtsp.pack_samples", "Pack Samples", base.DEC)
+local f_ingest_id = ProtoField.uint32("edtsp.ingest.id", "Ingest Node", base.HEX)
+local f_timestamp_ms = ProtoField.uint32("edtsp.timestamp_ms", "Timestamp (ms)", base.DEC)
 local f_data_len = ProtoField.uint8("edtsp.data_len", "Data Length", base.DEC)
 local f_data = ProtoField.bytes("edtsp.data", "Sensor Data")
+local f_probe_kind = ProtoField.uint8("edtsp.probe.kind", "Probe Kind", base.DEC)
+local f_probe_seq = ProtoField.uint16("edtsp.probe.seq", "Probe Sequence", base.DEC)
+local f_probe_t1_us = ProtoField.uint64("edtsp.probe.t1_us", "T1 Originator TX (us)", base.DEC)
+local f_probe_t2_us = ProtoField.uint64("edtsp.probe.t2_us", "T2 Responder RX (us)", base.DEC)
+local f_probe_t3_us = ProtoField.uint64("edtsp.probe.t3_us", "T3 Responder TX (us)", base.DEC)
+local f_sync_kind = ProtoField.uint8("edtsp.sync.kind", "Sync Kind", base.DEC)
+local f_sync_reserved = ProtoField.uint8("edtsp.sync.reserved", "Reserved", base.DEC)
+local f_sync_seq = ProtoField.uint16("edtsp.sync.seq", "Sync Sequence", base.DEC)
+local f_sync_t1_us = ProtoField.uint64("edtsp.sync.t1_us", "T1 Master TX (us)", base.DEC)
+local f_sync_t2_us = ProtoField.uint64("edtsp.sync.t2_us", "T2 Slave RX (us)", base.DEC)
+local f_sync_t3_us = ProtoField.uint64("edtsp.sync.t3_us", "T3 Slave TX (us)", base.DEC)
+local f_actuate_kind = ProtoField.uint8("edtsp.actuate.kind", "Actuate Kind", base.DEC)
+local f_actuate_priority = ProtoField.uint8("edtsp.actuate.priority", "Priority", base.DEC)
+local f_actuate_seq = ProtoField.uint16("edtsp.actuate.seq", "Command Sequence", base.DEC)
+local f_actuate_output = ProtoField.uint8("edtsp.actuate.output", "Output", base.DEC)
+local f_actuate_channel = ProtoField.uint8("edtsp.actuate.channel", "Channel", base.DEC)
+local f_actuate_status = ProtoField.uint8("edtsp.actuate.status", "Status", base.DEC)
+local f_actuate_reserved = ProtoField.uint8("edtsp.actuate.reserved", "Reserved", base.DEC)
+local f_actuate_value = ProtoField.uint32("edtsp.actuate.value", "Value", base.DEC)
+local f_actuate_t1_us = ProtoField.uint64("edtsp.actuate.t1_us", "T1 Master TX (us)", base.DEC)
+local f_actuate_t2_us = ProtoField.uint64("edtsp.actuate.t2_us", "T2 Slave RX (us)", base.DEC)
+local f_actuate_t3_us = ProtoField.uint64("edtsp.actuate.t3_us", "T3 Slave Applied (us)", base.DEC)
+local f_group_selector = ProtoField.uint8("edtsp.group.selector", "Selector", base.DEC)
+local f_group_settings = ProtoField.uint8("edtsp.group.settings", "Settings", base.DEC)
+local f_group_seq = ProtoField.uint16("edtsp.group.seq", "Config Sequence", base.DEC)
+local f_group_caps = ProtoField.uint16("edtsp.group.caps", "Required Capabilities", base.HEX)
+local f_group_targets = ProtoField.uint16("edtsp.group.targets", "Targets", base.DEC)
+local f_group_body_len = ProtoField.uint8("edtsp.group.body_len", "Body Length", base.DEC)
+local f_group_body = ProtoField.bytes("edtsp.group.body", "Settings + Targets")
+local f_credit_seq = ProtoField.uint16("edtsp.credit.seq", "Credit Sequence", base.DEC)
+local f_credit_max_fps = ProtoField.uint16("edtsp.credit.max_fps", "Max Frames/s", base.DEC)
+local f_credit_lifetime = ProtoField.uint16("edtsp.credit.lifetime", "Lifetime (ms)", base.DEC)
+local f_credit_queue = ProtoField.uint8("edtsp.credit.queue", "Queue Depth (%)", base.DEC)
+local f_credit_reserved = ProtoField.uint8("edtsp.credit.reserved", "Reserved", base.DEC)
+local f_zone_id = ProtoField.uint16("edtsp.zone.id", "Zone", base.DEC)
+local f_zone_role = ProtoField.uint8("edtsp.zone.role", "Tier Role", base.DEC)
+local f_zone_sensors = ProtoField.uint8("edtsp.zone.sensors", "Sensors", base.DEC)
+local f_zone_members = ProtoField.uint16("edtsp.zone.members", "Members", base.DEC)
+local f_zone_joins = ProtoField.uint16("edtsp.zone.joins", "Joins", base.DEC)
+local f_zone_leaves = ProtoField.uint16("edtsp.zone.leaves", "Leaves", base.DEC)
+local f_zone_reserved = ProtoField.uint16("edtsp.zone.reserved", "Reserved", base.DEC)
+local f_zone_digest = ProtoField.uint32("edtsp.zone.digest", "Member Digest", base.HEX)
+local f_zone_interval = ProtoField.uint32("edtsp.zone.interval", "Interval (ms)", base.DEC)
+local f_zone_frames = ProtoField.uint32("edtsp.zone.frames", "DATA Frames", base.DEC)
+local f_zone_bytes = ProtoField.uint32("edtsp.zone.bytes", "DATA Bytes", base.DEC)
+local f_zone_body_len = ProtoField.uint8("edtsp.zone.body_len", "Body Length", base.DEC)
+local f_zone_body = ProtoField.bytes("edtsp.zone.body", "Sensor Records")
+
+-- Redundancy trailer fields (dual-path transmission)
+local f_rct_seq = ProtoField.uint16("edtsp.rct.seq", "Sequence", base.DEC)
+local f_rct_path = ProtoField.uint16("edtsp.rct.path", "Path", base.HEX, nil, 0xF000)
+local f_rct_size = ProtoField.uint16("edtsp.rct.size", "Frame Size", base.DEC, nil, 0x0FFF)
+local f_rct_suffix = ProtoField.uint16("edtsp.rct.suffix", "Suffix", base.HEX)
 
 -- Register fields
 edtsp_proto.fields = {
     f_magic, f_type, f_source_id, f_payload_len,
+    f_flags, f_flag_aggregated, f_flag_compressed, f_flag_authenticated,
+    f_flag_encrypted, f_payload_len16, f_hdr_version, f_header_len, f_seq, f_auth_tag, f_ciphertext,
     f_iface_type, f_version, f_device_name,
-    f_role, f_uptime, f_active_devices,
-    f_handshake_step, f_target_id, f_capabilities,
-    f_sensor_id, f_sampling_rate, f_enable,
-    f_timestamp, f_data_len, f_data
+    f_role, f_uptime_ms, f_active_devices, f_ingest_addr, f_ingest_port,
+    f_handshake_step, f_target_id, f_capabilities, f_desc_len, f_descriptors,
+    f_sensor_id, f_sampling_rate_ms, f_enable, f_deadband, f_max_silence_ms, f_window_ms, f_pack_samples, f_ingest_id,
+    f_timestamp_ms, f_data_len, f_data,
+    f_probe_kind, f_probe_seq, f_probe_t1_us, f_probe_t2_us, f_probe_t3_us,
+    f_sync_kind, f_sync_reserved, f_sync_seq, f_sync_t1_us, f_sync_t2_us, f_sync_t3_us,
+    f_actuate_kind, f_actuate_priority, f_actuate_seq, f_actuate_output, f_actuate_channel, f_actuate_status, f_actuate_reserved, f_actuate_value, f_actuate_t1_us, f_actuate_t2_us, f_actuate_t3_us,
+    f_group_selector, f_group_settings, f_group_seq, f_group_caps, f_group_targets, f_group_body_len, f_group_body,
+    f_credit_seq, f_credit_max_fps, f_credit_lifetime, f_credit_queue, f_credit_reserved,
+    f_zone_id, f_zone_role, f_zone_sensors, f_zone_members, f_zone_joins, f_zone_leaves, f_zone_reserved, f_zone_digest, f_zone_interval, f_zone_frames, f_zone_bytes, f_zone_body_len, f_zone_body,
+    f_rct_seq, f_rct_path, f_rct_size, f_rct_suffix
 }
 
 -- Packet type names
@@ -44,7 +128,13 @@ local packet_types = {
     [2] = "HEARTBEAT",
     [3] = "HANDSHAKE",
     [4] = "CONFIG",
-    [5] = "DATA"
+    [5] = "DATA",
+    [6] = "PROBE",
+    [7] = "SYNC",
+    [8] = "ACTUATE",
+    [9] = "GROUP_CONFIG",
+    [10] = "CREDIT",
+    [11] = "ZONE_SUMMARY"
 }
 
 -- Role names
@@ -54,7 +144,7 @@ local role_names = {
     [2] = "MASTER"
 }
 
--- Interface names
+-- Iface names
 local iface_names = {
     [0] = "UNKNOWN",
     [1] = "ETHERNET",
@@ -62,6 +152,51 @@ local iface_names = {
     [3] = "5G"
 }
 
+-- Handshake step names
+local handshake_step_names = {
+    [1] = "SYN",
+    [2] = "SYN_ACK",
+    [3] = "ACK"
+}
+
+-- Probe kind names
+local probe_kind_names = {
+    [1] = "REQUEST",
+    [2] = "ECHO"
+}
+
+-- Sync kind names
+local sync_kind_names = {
+    [1] = "REQUEST",
+    [2] = "REPLY"
+}
+
+-- Actuate kind names
+local actuate_kind_names = {
+    [1] = "COMMAND",
+    [2] = "ACK"
+}
+
+-- Actuate prio names
+local actuate_prio_names = {
+    [0] = "NORMAL",
+    [1] = "URGENT"
+}
+
+-- Actuate status names
+local actuate_status_names = {
+    [0] = "OK",
+    [1] = "NO_OUTPUT",
+    [2] = "REJECTED"
+}
+
+-- Group sel names
+local group_sel_names = {
+    [0] = "ALL",
+    [1] = "IDS",
+    [2] = "CAPS"
+}
+
 -- Dissector function
 function edtsp_proto.dissector(buffer, pinfo, tree)
     -- Check minimum packet size
@@ -69,9 +204,12 @@ function edtsp_proto.dissector(buffer, pinfo, tree)
         return 0
     end
     
-    -- Check magic number
+    -- Check magic number (0xED61 = v1 header, 0xED62 = v2 header)
     local magic = buffer(0, 2):uint()
-    if magic ~= 0xED61 then
+    if magic ~= 0xED61 and magic ~= 0xED62 then
+        return 0
+    end
+    if magic == 0xED62 and buffer:len() < 16 then
         return 0
     end
     
@@ -80,78 +218,242 @@ function edtsp_proto.dissector(buffer, pinfo, tree)
     
     -- Parse header
     local pkt_type = buffer(2, 1):uint()
-    local source_id = buffer(3, 4):uint()
-    local payload_len = buffer(7, 1):uint()
-    
     local type_name = packet_types[pkt_type] or "UNKNOWN"
-    
-    -- Set info column
-    pinfo.cols.info = string.format("%s from 0x%08X", type_name, source_id)
-    
-    -- Create protocol tree
+    local source_id, payload_len, offset
+    local header_tree
     local subtree = tree:add(edtsp_proto, buffer(), "EDTSP Protocol")
     
-    -- Add header fields
-    local header_tree = subtree:add(buffer(0, 8), "Header")
-    header_tree:add(f_magic, buffer(0, 2))
-    header_tree:add(f_type, buffer(2, 1)):append_text(" (" .. type_name .. ")")
-    header_tree:add(f_source_id, buffer(3, 4))
-    header_tree:add(f_payload_len, buffer(7, 1))
+    if magic == 0xED61 then
+        source_id = buffer(3, 4):uint()
+        payload_len = buffer(7, 1):uint()
+        offset = 8
+        
+        header_tree = subtree:add(buffer(0, 8), "Header")
+        header_tree:add(f_magic, buffer(0, 2))
+        header_tree:add(f_type, buffer(2, 1)):append_text(" (" .. type_name .. ")")
+        header_tree:add(f_source_id, buffer(3, 4))
+        header_tree:add(f_payload_len, buffer(7, 1))
+    else
+        source_id = buffer(4, 4):uint()
+        payload_len = buffer(8, 2):uint()
+        offset = buffer(11, 1):uint()
+        if offset < 16 or buffer:len() < offset then
+            offset = 16
+        end
+        
+        header_tree = subtree:add(buffer(0, offset), "Header v2")
+        header_tree:add(f_magic, buffer(0, 2))
+        header_tree:add(f_type, buffer(2, 1)):append_text(" (" .. type_name .. ")")
+        local flags_tree = header_tree:add(f_flags, buffer(3, 1))
+        flags_tree:add(f_flag_aggregated, buffer(3, 1))
+        flags_tree:add(f_flag_compressed, buffer(3, 1))
+        flags_tree:add(f_flag_authenticated, buffer(3, 1))
+        flags_tree:add(f_flag_encrypted, buffer(3, 1))
+        header_tree:add(f_source_id, buffer(4, 4))
+        header_tree:add(f_payload_len16, buffer(8, 2))
+        header_tree:add(f_hdr_version, buffer(10, 1))
+        header_tree:add(f_header_len, buffer(11, 1))
+        header_tree:add(f_seq, buffer(12, 4))
+    end
     
-    -- Parse payload based on type
-    local offset = 8
+    -- Set info column
+    pinfo.cols.info = string.format("%s from 0x%08X", type_name, source_id)
+    if magic == 0xED62 then
+        pinfo.cols.info = pinfo.cols.info .. string.format(" v2 #%d", buffer(12, 4):uint())
+    end
     
-    if pkt_type == 1 then  -- DISCOVERY
-        if buffer:len() >= offset + 2 + 32 then
+    -- Parse payload based on type (payload starts at offset); a sealed
+    -- payload is shown as is
+    local encrypted = magic == 0xED62 and math.floor(buffer(3, 1):uint() / 16) % 2 == 1
+    if encrypted then
+        pinfo.cols.info = pinfo.cols.info .. " [encrypted]"
+        if buffer:len() >= offset + payload_len then
+            subtree:add(f_ciphertext, buffer(offset, payload_len))
+        end
+    elseif pkt_type == 1 then  -- DISCOVERY
+        if buffer:len() >= offset + 34 then
             local payload_tree = subtree:add(buffer(offset), "Discovery Payload")
-            local iface = buffer(offset, 1):uint()
-            payload_tree:add(f_iface_type, buffer(offset, 1)):append_text(" (" .. (iface_names[iface] or "UNKNOWN") .. ")")
+            local interface_type = buffer(offset, 1):uint()
+            payload_tree:add(f_iface_type, buffer(offset, 1)):append_text(" (" .. (iface_names[interface_type] or "UNKNOWN") .. ")")
             payload_tree:add(f_version, buffer(offset + 1, 1))
             payload_tree:add(f_device_name, buffer(offset + 2, 32))
         end
         
     elseif pkt_type == 2 then  -- HEARTBEAT
-        if buffer:len() >= offset + 6 then
+        if buffer:len() >= offset + 12 then
             local payload_tree = subtree:add(buffer(offset), "Heartbeat Payload")
             local role = buffer(offset, 1):uint()
             payload_tree:add(f_role, buffer(offset, 1)):append_text(" (" .. (role_names[role] or "UNKNOWN") .. ")")
-            payload_tree:add(f_uptime, buffer(offset + 1, 4))
-            payload_tree:add(f_active_devices, buffer(offset + 5, 1))
-            
-            -- Update info with role
             pinfo.cols.info = pinfo.cols.info .. " [" .. (role_names[role] or "UNKNOWN") .. "]"
+            payload_tree:add(f_uptime_ms, buffer(offset + 1, 4))
+            payload_tree:add(f_active_devices, buffer(offset + 5, 1))
+            payload_tree:add(f_ingest_addr, buffer(offset + 6, 4))
+            payload_tree:add(f_ingest_port, buffer(offset + 10, 2))
         end
         
     elseif pkt_type == 3 then  -- HANDSHAKE
-        if buffer:len() >= offset + 8 then
+        if buffer:len() >= offset + 9 then
             local payload_tree = subtree:add(buffer(offset), "Handshake Payload")
-            payload_tree:add(f_handshake_step, buffer(offset, 1))
+            local handshake_step = buffer(offset, 1):uint()
+            payload_tree:add(f_handshake_step, buffer(offset, 1)):append_text(" (" .. (handshake_step_names[handshake_step] or "UNKNOWN") .. ")")
+            pinfo.cols.info = pinfo.cols.info .. " [" .. (handshake_step_names[handshake_step] or "UNKNOWN") .. "]"
             payload_tree:add(f_target_id, buffer(offset + 1, 4))
             payload_tree:add(f_capabilities, buffer(offset + 5, 2))
-            local iface = buffer(offset + 7, 1):uint()
-            payload_tree:add(f_iface_type, buffer(offset + 7, 1)):append_text(" (" .. (iface_names[iface] or "UNKNOWN") .. ")")
+            local interface_type = buffer(offset + 7, 1):uint()
+            payload_tree:add(f_iface_type, buffer(offset + 7, 1)):append_text(" (" .. (iface_names[interface_type] or "UNKNOWN") .. ")")
+            local desc_len = buffer(offset + 8, 1):uint()
+            payload_tree:add(f_desc_len, buffer(offset + 8, 1))
+            if buffer:len() >= offset + 9 + desc_len then
+                payload_tree:add(f_descriptors, buffer(offset + 9, desc_len))
+            end
         end
         
     elseif pkt_type == 4 then  -- CONFIG
-        if buffer:len() >= offset + 8 then
+        if buffer:len() >= offset + 29 then
             local payload_tree = subtree:add(buffer(offset), "Config Payload")
             payload_tree:add(f_target_id, buffer(offset, 4))
             payload_tree:add(f_sensor_id, buffer(offset + 4, 1))
-            payload_tree:add(f_sampling_rate, buffer(offset + 5, 2))
+            payload_tree:add(f_sampling_rate_ms, buffer(offset + 5, 2))
             payload_tree:add(f_enable, buffer(offset + 7, 1))
+            payload_tree:add(f_deadband, buffer(offset + 8, 2))
+            payload_tree:add(f_max_silence_ms, buffer(offset + 10, 4))
+            payload_tree:add(f_window_ms, buffer(offset + 14, 4))
+            payload_tree:add(f_pack_samples, buffer(offset + 18, 1))
+            payload_tree:add(f_ingest_id, buffer(offset + 19, 4))
+            payload_tree:add(f_ingest_addr, buffer(offset + 23, 4))
+            payload_tree:add(f_ingest_port, buffer(offset + 27, 2))
         end
         
     elseif pkt_type == 5 then  -- DATA
         if buffer:len() >= offset + 6 then
             local payload_tree = subtree:add(buffer(offset), "Data Payload")
             payload_tree:add(f_sensor_id, buffer(offset, 1))
-            payload_tree:add(f_timestamp, buffer(offset + 1, 4))
+            payload_tree:add(f_timestamp_ms, buffer(offset + 1, 4))
             local data_len = buffer(offset + 5, 1):uint()
             payload_tree:add(f_data_len, buffer(offset + 5, 1))
             if buffer:len() >= offset + 6 + data_len then
                 payload_tree:add(f_data, buffer(offset + 6, data_len))
             end
         end
+        
+    elseif pkt_type == 6 then  -- PROBE
+        if buffer:len() >= offset + 32 then
+            local payload_tree = subtree:add(buffer(offset), "Probe Payload")
+            local kind = buffer(offset, 1):uint()
+            payload_tree:add(f_probe_kind, buffer(offset, 1)):append_text(" (" .. (probe_kind_names[kind] or "UNKNOWN") .. ")")
+            pinfo.cols.info = pinfo.cols.info .. " [" .. (probe_kind_names[kind] or "UNKNOWN") .. "]"
+            local interface_type = buffer(offset + 1, 1):uint()
+            payload_tree:add(f_iface_type, buffer(offset + 1, 1)):append_text(" (" .. (iface_names[interface_type] or "UNKNOWN") .. ")")
+            payload_tree:add(f_probe_seq, buffer(offset + 2, 2))
+            payload_tree:add(f_target_id, buffer(offset + 4, 4))
+            payload_tree:add(f_probe_t1_us, buffer(offset + 8, 8))
+            payload_tree:add(f_probe_t2_us, buffer(offset + 16, 8))
+            payload_tree:add(f_probe_t3_us, buffer(offset + 24, 8))
+        end
+        
+    elseif pkt_type == 7 then  -- SYNC
+        if buffer:len() >= offset + 32 then
+            local payload_tree = subtree:add(buffer(offset), "Sync Payload")
+            local kind = buffer(offset, 1):uint()
+            payload_tree:add(f_sync_kind, buffer(offset, 1)):append_text(" (" .. (sync_kind_names[kind] or "UNKNOWN") .. ")")
+            pinfo.cols.info = pinfo.cols.info .. " [" .. (sync_kind_names[kind] or "UNKNOWN") .. "]"
+            payload_tree:add(f_sync_reserved, buffer(offset + 1, 1))
+            payload_tree:add(f_sync_seq, buffer(offset + 2, 2))
+            payload_tree:add(f_target_id, buffer(offset + 4, 4))
+            payload_tree:add(f_sync_t1_us, buffer(offset + 8, 8))
+            payload_tree:add(f_sync_t2_us, buffer(offset + 16, 8))
+            payload_tree:add(f_sync_t3_us, buffer(offset + 24, 8))
+        end
+        
+    elseif pkt_type == 8 then  -- ACTUATE
+        if buffer:len() >= offset + 40 then
+            local payload_tree = subtree:add(buffer(offset), "Actuate Payload")
+            local kind = buffer(offset, 1):uint()
+            payload_tree:add(f_actuate_kind, buffer(offset, 1)):append_text(" (" .. (actuate_kind_names[kind] or "UNKNOWN") .. ")")
+            pinfo.cols.info = pinfo.cols.info .. " [" .. (actuate_kind_names[kind] or "UNKNOWN") .. "]"
+            local priority = buffer(offset + 1, 1):uint()
+            payload_tree:add(f_actuate_priority, buffer(offset + 1, 1)):append_text(" (" .. (actuate_prio_names[priority] or "UNKNOWN") .. ")")
+            payload_tree:add(f_actuate_seq, buffer(offset + 2, 2))
+            payload_tree:add(f_target_id, buffer(offset + 4, 4))
+            payload_tree:add(f_actuate_output, buffer(offset + 8, 1))
+            payload_tree:add(f_actuate_channel, buffer(offset + 9, 1))
+            local status = buffer(offset + 10, 1):uint()
+            payload_tree:add(f_actuate_status, buffer(offset + 10, 1)):append_text(" (" .. (actuate_status_names[status] or "UNKNOWN") .. ")")
+            payload_tree:add(f_actuate_reserved, buffer(offset + 11, 1))
+            payload_tree:add(f_actuate_value, buffer(offset + 12, 4))
+            payload_tree:add(f_actuate_t1_us, buffer(offset + 16, 8))
+            payload_tree:add(f_actuate_t2_us, buffer(offset + 24, 8))
+            payload_tree:add(f_actuate_t3_us, buffer(offset + 32, 8))
+        end
+        
+    elseif pkt_type == 9 then  -- GROUP_CONFIG
+        if buffer:len() >= offset + 9 then
+            local payload_tree = subtree:add(buffer(offset), "Group_config Payload")
+            local selector = buffer(offset, 1):uint()
+            payload_tree:add(f_group_selector, buffer(offset, 1)):append_text(" (" .. (group_sel_names[selector] or "UNKNOWN") .. ")")
+            pinfo.cols.info = pinfo.cols.info .. " [" .. (group_sel_names[selector] or "UNKNOWN") .. "]"
+            payload_tree:add(f_group_settings, buffer(offset + 1, 1))
+            payload_tree:add(f_group_seq, buffer(offset + 2, 2))
+            payload_tree:add(f_group_caps, buffer(offset + 4, 2))
+            payload_tree:add(f_group_targets, buffer(offset + 6, 2))
+            local body_len = buffer(offset + 8, 1):uint()
+            payload_tree:add(f_group_body_len, buffer(offset + 8, 1))
+            if buffer:len() >= offset + 9 + body_len then
+                payload_tree:add(f_group_body, buffer(offset + 9, body_len))
+            end
+        end
+        
+    elseif pkt_type == 10 then  -- CREDIT
+        if buffer:len() >= offset + 12 then
+            local payload_tree = subtree:add(buffer(offset), "Credit Payload")
+            payload_tree:add(f_target_id, buffer(offset, 4))
+            payload_tree:add(f_credit_seq, buffer(offset + 4, 2))
+            payload_tree:add(f_credit_max_fps, buffer(offset + 6, 2))
+            payload_tree:add(f_credit_lifetime, buffer(offset + 8, 2))
+            payload_tree:add(f_credit_queue, buffer(offset + 10, 1))
+            payload_tree:add(f_credit_reserved, buffer(offset + 11, 1))
+        end
+        
+    elseif pkt_type == 11 then  -- ZONE_SUMMARY
+        if buffer:len() >= offset + 29 then
+            local payload_tree = subtree:add(buffer(offset), "Zone_summary Payload")
+            payload_tree:add(f_zone_id, buffer(offset, 2))
+            local role = buffer(offset + 2, 1):uint()
+            payload_tree:add(f_zone_role, buffer(offset + 2, 1)):append_text(" (" .. (role_names[role] or "UNKNOWN") .. ")")
+            pinfo.cols.info = pinfo.cols.info .. " [" .. (role_names[role] or "UNKNOWN") .. "]"
+            payload_tree:add(f_zone_sensors, buffer(offset + 3, 1))
+            payload_tree:add(f_zone_members, buffer(offset + 4, 2))
+            payload_tree:add(f_zone_joins, buffer(offset + 6, 2))
+            payload_tree:add(f_zone_leaves, buffer(offset + 8, 2))
+            payload_tree:add(f_zone_reserved, buffer(offset + 10, 2))
+            payload_tree:add(f_zone_digest, buffer(offset + 12, 4))
+            payload_tree:add(f_zone_interval, buffer(offset + 16, 4))
+            payload_tree:add(f_zone_frames, buffer(offset + 20, 4))
+            payload_tree:add(f_zone_bytes, buffer(offset + 24, 4))
+            local body_len = buffer(offset + 28, 1):uint()
+            payload_tree:add(f_zone_body_len, buffer(offset + 28, 1))
+            if buffer:len() >= offset + 29 + body_len then
+                payload_tree:add(f_zone_body, buffer(offset + 29, body_len))
+            end
+        end
+    end
+    
+    -- Authentication tag (SipHash-2-4, little-endian) behind the payload
+    local frame_len = offset + payload_len
+    if magic == 0xED62 and math.floor(buffer(3, 1):uint() / 4) % 2 == 1 and buffer:len() >= frame_len + 8 then
+        subtree:add_le(f_auth_tag, buffer(frame_len, 8))
+        frame_len = frame_len + 8
+    end
+    
+    -- Redundancy trailer directly behind header + payload (+ tag)
+    if buffer:len() == frame_len + 6 and buffer(frame_len + 4, 2):uint() == 0x88FB then
+        local rct_tree = subtree:add(buffer(frame_len, 6), "Redundancy Trailer")
+        rct_tree:add(f_rct_seq, buffer(frame_len, 2))
+        rct_tree:add(f_rct_path, buffer(frame_len + 2, 2))
+        rct_tree:add(f_rct_size, buffer(frame_len + 2, 2))
+        rct_tree:add(f_rct_suffix, buffer(frame_len + 4, 2))
+        local path = math.floor(buffer(frame_len + 2, 2):uint() / 4096)
+        pinfo.cols.info = pinfo.cols.info .. string.format(" [seq %d, path %X]", buffer(frame_len, 2):uint(), path)
     end
     
     return buffer:len()
@@ -165,7 +467,7 @@ function heuristic_checker(buffer, pinfo, tree)
     end
     
     local magic = buffer(0, 2):uint()
-    if magic == 0xED61 then
+    if magic == 0xED61 or magic == 0xED62 then
         edtsp_proto.dissector(buffer, pinfo, tree)
         return true
     end